@@ -21,6 +21,8 @@ extern "C" {
 #include "redis/zmalloc.h"  // for non-string objects.
 }
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_map.h>
+#include <absl/strings/match.h>
 #include <absl/strings/str_cat.h>
 #include <absl/strings/strip.h>
 
@@ -422,6 +424,158 @@ struct Huffman {
   HuffmanDecoder decoder;
 };
 
+// Prefixed keys store a prefix id followed by the key suffix. Ids below 128 take a single
+// byte, larger ids take two bytes with the high bit of the first byte set.
+constexpr unsigned kMaxKeyPrefixes = 1u << 15;
+
+inline unsigned PrefixIdLen(uint16_t id) {
+  return id < 0x80 ? 1 : 2;
+}
+
+inline void EncodePrefixId(uint16_t id, char* dest) {
+  if (id < 0x80) {
+    dest[0] = id;
+  } else {
+    dest[0] = 0x80 | (id >> 8);
+    dest[1] = id & 0xFF;
+  }
+}
+
+inline uint16_t DecodePrefixId(const char* src, unsigned* id_len) {
+  uint8_t first = src[0];
+  if (first < 0x80) {
+    *id_len = 1;
+    return first;
+  }
+  *id_len = 2;
+  return (uint16_t(first & 0x7F) << 8) | uint8_t(src[1]);
+}
+
+// Per-thread dictionary of key prefixes. A prefix is the part of the key up to and including
+// the last delimiter. It is interned after it has been seen in admit_threshold keys
+// and is released when the last key referencing it is gone.
+class KeyPrefixTable {
+ public:
+  static constexpr size_t kMinPrefixLen = 4;
+  static constexpr size_t kMaxPrefixLen = 256;
+
+  ~KeyPrefixTable() {
+    if (xxh_state_)
+      XXH3_freeState(xxh_state_);
+  }
+
+  void Init(char delimiter, uint32_t admit_threshold) {
+    delimiter_ = delimiter;
+    admit_threshold_ = std::max(admit_threshold, 1u);
+    if (!xxh_state_)
+      xxh_state_ = XXH3_createState();
+  }
+
+  bool enabled() const {
+    return delimiter_ != 0;
+  }
+
+  // Returns the length of the prefix that can be interned for the key, 0 if there is none.
+  size_t PrefixLen(std::string_view key) const {
+    size_t pos = key.rfind(delimiter_, kMaxPrefixLen - 1);
+    if (pos == std::string_view::npos || pos + 1 < kMinPrefixLen)
+      return 0;
+    return pos + 1;
+  }
+
+  // Returns the id of the interned prefix or -1 if it is not admitted yet.
+  int Intern(std::string_view prefix);
+
+  std::string_view Get(uint16_t id) const {
+    DCHECK_LT(id, entries_.size());
+    return *entries_[id].prefix;
+  }
+
+  void Ref(uint16_t id) {
+    ++entries_[id].refcnt;
+    saved_bytes_ += entries_[id].prefix->size() - PrefixIdLen(id);
+  }
+
+  void Unref(uint16_t id);
+
+  XXH3_state_t* xxh_state() const {
+    return xxh_state_;
+  }
+
+  size_t saved_bytes() const {
+    return saved_bytes_;
+  }
+
+ private:
+  static constexpr size_t kMaxCandidates = 1024;
+
+  struct Entry {
+    const std::string* prefix = nullptr;  // owned by ids_, nullptr for free slots.
+    uint32_t refcnt = 0;
+  };
+
+  char delimiter_ = 0;
+  uint32_t admit_threshold_ = 1;
+  XXH3_state_t* xxh_state_ = nullptr;
+  size_t saved_bytes_ = 0;
+
+  absl::node_hash_map<std::string, uint16_t> ids_;
+  std::vector<Entry> entries_;
+  std::vector<uint16_t> free_ids_;
+
+  // Number of keys seen with a prefix that has not been interned yet.
+  absl::flat_hash_map<std::string, uint32_t> candidates_;
+};
+
+int KeyPrefixTable::Intern(std::string_view prefix) {
+  if (auto it = ids_.find(prefix); it != ids_.end())
+    return it->second;
+
+  if (!enabled() || (free_ids_.empty() && entries_.size() >= kMaxKeyPrefixes))
+    return -1;
+
+  if (admit_threshold_ > 1) {
+    auto it = candidates_.find(prefix);
+    if (it == candidates_.end()) {
+      // Restart the counting once the candidates table is full, so that rare prefixes
+      // do not occupy it forever.
+      if (candidates_.size() >= kMaxCandidates)
+        candidates_.clear();
+      candidates_.emplace(prefix, 1);
+      return -1;
+    }
+
+    if (++it->second < admit_threshold_)
+      return -1;
+    candidates_.erase(it);
+  }
+
+  uint16_t id;
+  if (free_ids_.empty()) {
+    id = entries_.size();
+    entries_.emplace_back();
+  } else {
+    id = free_ids_.back();
+    free_ids_.pop_back();
+  }
+
+  auto [it, _] = ids_.emplace(prefix, id);
+  entries_[id].prefix = &it->first;
+  return id;
+}
+
+void KeyPrefixTable::Unref(uint16_t id) {
+  Entry& entry = entries_[id];
+  DCHECK_GT(entry.refcnt, 0u);
+  saved_bytes_ -= entry.prefix->size() - PrefixIdLen(id);
+  if (--entry.refcnt > 0)
+    return;
+
+  ids_.erase(ids_.find(*entry.prefix));
+  entry.prefix = nullptr;
+  free_ids_.push_back(id);
+}
+
 // Internal pin entry tracked by PinnedMap. Not exposed in compact_object.h.
 struct PendingRead {
   const void* ptr = nullptr;
@@ -548,6 +702,7 @@ struct TL {
   string tmp_str;
   size_t small_str_bytes;
   Huffman huff_keys, huff_string_values;
+  KeyPrefixTable key_prefixes;
   uint64_t huff_encode_total = 0, huff_encode_success = 0;  // success/total metrics.
   PinnedMap pin_map;
 
@@ -710,6 +865,7 @@ using namespace std;
 auto CompactObj::GetStatsThreadLocal() -> Stats {
   Stats res;
   res.small_string_bytes = tl.small_str_bytes;
+  res.key_prefix_saved_bytes = tl.key_prefixes.saved_bytes();
   res.huff_encode_total = tl.huff_encode_total;
   res.huff_encode_success = tl.huff_encode_success;
   return res;
@@ -767,7 +923,49 @@ bool CompactObj::InitHuffmanThreadLocal(HuffmanDomain domain, std::string_view h
   return true;
 }
 
+void CompactObj::InitKeyPrefixThreadLocal(char delimiter, uint32_t admit_threshold) {
+  tl.key_prefixes.Init(delimiter, admit_threshold);
+}
+
+bool CompactObj::HasHuffmanTable(HuffmanDomain domain) {
+  return (domain == HUFF_KEYS ? tl.huff_keys : tl.huff_string_values).encoder.valid();
+}
+
+int64_t CompactObj::HuffmanReencode() {
+  if ((taglen_ != SMALL_TAG && taglen_ != LARGE_STR_TAG) || encoding_ == HUFFMAN_ENC ||
+      mask_bits_.prefixed)
+    return 0;
+
+  const auto& huffman = is_key_ ? tl.huff_keys : tl.huff_string_values;
+  if (!huffman.encoder.valid() || Size() > kMaxHuffLen)
+    return 0;
+
+  string str;
+  GetString(&str);
+
+  // Short ascii strings are packed rather than huffman coded, see EncodeString.
+  if (kUseAsciiEncoding && str.size() < 19 && detail::validate_ascii_fast(str.data(), str.size()))
+    return 0;
+
+  // Check upfront that EncodeString would pick huffman, so that we do not reallocate in vain.
+  HuffEncodeResult huff = TryHuffEncode(str, huffman.encoder);
+  if (huff.blob.empty() ||
+      (huff.blob.size() > kInlineLen && (huff.dest_len + huff.dest_len / 5) >= str.size())) {
+    return 0;
+  }
+
+  int64_t before = MallocUsed();
+  Free();
+  encoding_ = NONE_ENC;
+  SetMeta(0, mask_);
+  EncodeString(str);
+  return int64_t(MallocUsed()) - before;
+}
+
 CompactObj::~CompactObj() {
+  if (mask_bits_.prefixed) {
+    ReleasePrefix();
+  }
   if (HasAllocated()) {
     Free();
   }
@@ -778,6 +976,7 @@ CompactObj& CompactObj::operator=(CompactObj&& o) noexcept {
   DCHECK_EQ(is_key_, o.is_key_);
 
   SetMeta(o.taglen_, o.mask_);  // frees own previous resources
+  mask_bits_.prefixed = o.mask_bits_.prefixed;
   encoding_ = o.encoding_;
   memcpy(&u_, &o.u_, sizeof(u_));
 
@@ -788,6 +987,9 @@ CompactObj& CompactObj::operator=(CompactObj&& o) noexcept {
 }
 
 size_t CompactObj::Size() const {
+  if (mask_bits_.prefixed)
+    return PrefixedSize();
+
   auto decoded_str_size = [this](size_t raw_size, uint16_t huff_header) {
     DCHECK_EQ(ObjType(), OBJ_STRING);
     return GetStrEncoding().DecodedSize(raw_size, huff_header);
@@ -875,6 +1077,9 @@ size_t CompactObj::Size() const {
 uint64_t CompactObj::HashCode() const {
   DCHECK(taglen_ != JSON_TAG) << "JSON type cannot be used for keys!";
 
+  if (mask_bits_.prefixed)
+    return PrefixedHashCode();
+
   if (encoding_ == NONE_ENC) {
     if (IsInline()) {
       return XXH3_64bits_withSeed(u_.inline_str, taglen_, kHashSeed);
@@ -1172,6 +1377,9 @@ CuckooFilter* CompactObj::GetCuckooFilter() const {
 void CompactObj::SetString(std::string_view str) {
   CHECK(!IsExternal());
   encoding_ = NONE_ENC;
+  if (mask_bits_.prefixed) {
+    ReleasePrefix();
+  }
 
   // Trying auto-detection heuristics first.
   if (str.size() <= 20) {
@@ -1194,6 +1402,9 @@ void CompactObj::SetString(std::string_view str) {
     }
   }
 
+  if (is_key_ && tl.key_prefixes.enabled() && TrySetPrefixed(str))
+    return;
+
   EncodeString(str);
 }
 
@@ -1229,7 +1440,7 @@ std::optional<cmn::BorrowedString> CompactObj::TryBorrow() const {
 string_view CompactObj::GetSlice(string* scratch) const {
   CHECK(!IsExternal());
 
-  if (encoding_) {
+  if (encoding_ || mask_bits_.prefixed) {
     GetString(scratch);
     return *scratch;
   }
@@ -1358,6 +1569,11 @@ void __attribute__((noinline)) CompactObj::GetString(string* res) const {
 void CompactObj::GetString(char* dest) const {
   CHECK(!IsExternal());
 
+  if (mask_bits_.prefixed) {
+    GetPrefixed(dest);
+    return;
+  }
+
   if (IsInline()) {
     GetStrEncoding().Decode({u_.inline_str, taglen_}, dest);
     return;
@@ -1495,6 +1711,9 @@ void CompactObj::Materialize(std::string_view blob, bool is_raw) {
 }
 
 void CompactObj::Reset() {
+  if (mask_bits_.prefixed) {
+    ReleasePrefix();
+  }
   if (HasAllocated()) {
     Free();
   }
@@ -1801,6 +2020,9 @@ bool CompactObj::CmpNonInline(std::string_view sv) const {
 }
 
 bool CompactObj::CmpEncoded(string_view sv) const {
+  if (mask_bits_.prefixed)
+    return CmpPrefixed(sv);
+
   DCHECK(encoding_);
 
   if (encoding_ == HUFFMAN_ENC) {
@@ -1975,6 +2197,114 @@ void CompactObj::EncodeString(string_view str) {
   u_.large_str.SetString(encoded, tl.local_mr);
 }
 
+bool CompactObj::TrySetPrefixed(string_view str) {
+  DCHECK(is_key_);
+  DCHECK_GT(str.size(), kInlineLen);
+
+  size_t pref_len = tl.key_prefixes.PrefixLen(str);
+  if (pref_len == 0)
+    return false;
+
+  int id = tl.key_prefixes.Intern(str.substr(0, pref_len));
+  if (id < 0)
+    return false;
+
+  string_view suffix = str.substr(pref_len);
+  unsigned id_len = PrefixIdLen(id);
+  size_t body_len = id_len + suffix.size();
+
+  if (body_len <= kInlineLen) {
+    SetMeta(body_len, mask_);
+    EncodePrefixId(id, u_.inline_str);
+    memcpy(u_.inline_str + id_len, suffix.data(), suffix.size());
+  } else {
+    tl.tmp_buf.resize(body_len);
+    char* body = reinterpret_cast<char*>(tl.tmp_buf.data());
+    EncodePrefixId(id, body);
+    memcpy(body + id_len, suffix.data(), suffix.size());
+
+    if (SmallString::CanAllocate(body_len)) {
+      if (taglen_ == SMALL_TAG)
+        tl.small_str_bytes -= u_.small_str.MallocUsed();
+      else
+        SetMeta(SMALL_TAG, mask_);
+      tl.small_str_bytes += u_.small_str.Assign({body, body_len});
+    } else {
+      SetMeta(LARGE_STR_TAG, mask_);
+      u_.large_str.SetString({body, body_len}, tl.local_mr);
+    }
+  }
+
+  tl.key_prefixes.Ref(id);
+  mask_bits_.prefixed = 1;
+  return true;
+}
+
+void CompactObj::ReleasePrefix() {
+  DCHECK(mask_bits_.prefixed);
+
+  unsigned id_len;
+  tl.key_prefixes.Unref(DecodePrefixId(PrefixedBody()[0].data(), &id_len));
+  mask_bits_.prefixed = 0;
+}
+
+std::array<std::string_view, 2> CompactObj::PrefixedBody() const {
+  DCHECK(mask_bits_.prefixed);
+  if (IsInline())
+    return {string_view{u_.inline_str, taglen_}, {}};
+
+  return GetRawString();
+}
+
+size_t CompactObj::PrefixedSize() const {
+  auto body = PrefixedBody();
+  unsigned id_len;
+  uint16_t id = DecodePrefixId(body[0].data(), &id_len);
+  return tl.key_prefixes.Get(id).size() + body[0].size() + body[1].size() - id_len;
+}
+
+void CompactObj::GetPrefixed(char* dest) const {
+  auto body = PrefixedBody();
+  unsigned id_len;
+  string_view prefix = tl.key_prefixes.Get(DecodePrefixId(body[0].data(), &id_len));
+  body[0].remove_prefix(id_len);
+
+  memcpy(dest, prefix.data(), prefix.size());
+  dest += prefix.size();
+  memcpy(dest, body[0].data(), body[0].size());
+  if (!body[1].empty())
+    memcpy(dest + body[0].size(), body[1].data(), body[1].size());
+}
+
+uint64_t CompactObj::PrefixedHashCode() const {
+  auto body = PrefixedBody();
+  unsigned id_len;
+  string_view prefix = tl.key_prefixes.Get(DecodePrefixId(body[0].data(), &id_len));
+  body[0].remove_prefix(id_len);
+
+  // Hash the parts without materializing the key, the result equals HashCode(key).
+  XXH3_state_t* state = tl.key_prefixes.xxh_state();
+  XXH3_64bits_reset_withSeed(state, kHashSeed);
+  XXH3_64bits_update(state, prefix.data(), prefix.size());
+  XXH3_64bits_update(state, body[0].data(), body[0].size());
+  XXH3_64bits_update(state, body[1].data(), body[1].size());
+  return XXH3_64bits_digest(state);
+}
+
+bool CompactObj::CmpPrefixed(string_view sv) const {
+  auto body = PrefixedBody();
+  unsigned id_len;
+  string_view prefix = tl.key_prefixes.Get(DecodePrefixId(body[0].data(), &id_len));
+  body[0].remove_prefix(id_len);
+
+  size_t suffix_len = body[0].size() + body[1].size();
+  if (sv.size() != prefix.size() + suffix_len || !absl::StartsWith(sv, prefix))
+    return false;
+
+  sv.remove_prefix(prefix.size());
+  return sv.substr(0, body[0].size()) == body[0] && sv.substr(body[0].size()) == body[1];
+}
+
 std::array<std::string_view, 2> CompactObj::GetRawString() const {
   DCHECK(!IsExternal());
 
@@ -484,6 +484,7 @@ class CompactObj {
 
   struct Stats {
     size_t small_string_bytes = 0;
+    size_t key_prefix_saved_bytes = 0;
     uint64_t huff_encode_total = 0, huff_encode_success = 0;
   };
 
@@ -502,6 +503,20 @@ class CompactObj {
   };
 
   static bool InitHuffmanThreadLocal(HuffmanDomain domain, std::string_view hufftable);
+
+  // Enables interning of key prefixes on this thread. A prefix is the part of the key up to and
+  // including the last delimiter. Once a prefix was seen in admit_threshold keys,
+  // keys that share it store a 1-2 byte prefix id instead. Accessors expand them transparently.
+  static void InitKeyPrefixThreadLocal(char delimiter, uint32_t admit_threshold);
+
+  // Returns true if a huffman table was installed for the domain on this thread.
+  static bool HasHuffmanTable(HuffmanDomain domain);
+
+  // Re-encodes a heap allocated string that was stored before the huffman table of its domain
+  // had been installed. Does nothing unless huffman encoding is accepted for the string.
+  // Returns the change in allocated bytes, negative if memory was saved.
+  int64_t HuffmanReencode();
+
   static MemoryResource* memory_resource();  // thread-local.
 
   template <typename T, typename... Args> static T* AllocateMR(Args&&... args) {
@@ -549,6 +564,9 @@ class CompactObj {
   bool CmpNonInline(std::string_view sv) const;
 
   void SetMeta(uint8_t taglen, uint8_t mask = 0) {
+    if (mask_bits_.prefixed) {
+      ReleasePrefix();
+    }
     if (HasAllocated()) {
       Free();
     } else {
@@ -556,8 +574,18 @@ class CompactObj {
     }
     taglen_ = taglen;
     mask_ = mask;
+    mask_bits_.prefixed = 0;
   }
 
+  // Prefixed keys, see InitKeyPrefixThreadLocal.
+  bool TrySetPrefixed(std::string_view str);
+  void ReleasePrefix();
+  std::array<std::string_view, 2> PrefixedBody() const;
+  size_t PrefixedSize() const;
+  void GetPrefixed(char* dest) const;
+  uint64_t PrefixedHashCode() const;
+  bool CmpPrefixed(std::string_view sv) const;
+
   struct ExternalPtr {
     uint32_t serialized_size;
     // page_offset only needs 12 bits (0..4095). We use the remaining 4 bits of the 16-bit
@@ -642,7 +670,10 @@ class CompactObj {
   union {
     uint8_t mask_ = 0;
     struct {
-      uint8_t unused : 2;
+      uint8_t unused : 1;
+
+      // Marks keys that store an id of an interned prefix followed by the suffix.
+      uint8_t prefixed : 1;
       uint8_t mc_flag : 1;  // Marks keys that have memcache flags assigned.
 
       // IO_PENDING is set when the tiered storage has issued an i/o request to save the value.
@@ -705,7 +736,7 @@ struct CompactKey : public CompactObj {
 };
 
 inline bool CompactKey::operator==(std::string_view sv) const {
-  if (encoding_)
+  if (encoding_ || mask_bits_.prefixed)
     return CmpEncoded(sv);
 
   if (IsInline()) {
@@ -11,6 +11,7 @@
 
 #include <cstddef>
 #include <random>
+#include <thread>
 
 #include "base/gtest.h"
 #include "base/logging.h"
@@ -1065,6 +1066,108 @@ TEST_F(CompactObjectTest, HuffmanVarintHeader) {
   EXPECT_TRUE(seen_2byte) << "Expected at least one 2-byte header (delta >= 128)";
 }
 
+// Strings stored before the table was installed are re-encoded in place.
+// Runs on a fresh thread since huffman tables can not be removed once installed.
+TEST_F(CompactObjectTest, HuffmanReencode) {
+  HuffmanEncoder encoder;
+  BuildEncoderAB(&encoder);
+  auto bindata = encoder.Export();
+  ASSERT_TRUE(bindata.has_value());
+
+  std::thread th([&] {
+    InitThreadStructs();
+    EXPECT_FALSE(CompactObj::HasHuffmanTable(CompactObj::HUFF_STRING_VALUES));
+
+    string data(500, 'a');
+    string incompressible;
+    for (unsigned i = 0; i < 256; ++i)
+      incompressible.push_back(char(i));
+
+    CompactValue val, raw;
+    CompactKey key;
+    val.SetString(data);
+    key.SetString(data);
+    raw.SetString(incompressible);
+    EXPECT_EQ(0, val.HuffmanReencode());
+
+    ASSERT_TRUE(CompactObj::InitHuffmanThreadLocal(CompactObj::HUFF_STRING_VALUES, *bindata));
+    EXPECT_TRUE(CompactObj::HasHuffmanTable(CompactObj::HUFF_STRING_VALUES));
+
+    size_t before = val.MallocUsed();
+    int64_t delta = val.HuffmanReencode();
+    EXPECT_LT(delta, 0);
+    EXPECT_EQ(int64_t(before) + delta, int64_t(val.MallocUsed()));
+    EXPECT_EQ(data, val.ToString());
+    EXPECT_EQ(0, val.HuffmanReencode());  // already huffman encoded.
+
+    EXPECT_EQ(0, raw.HuffmanReencode());
+    EXPECT_EQ(incompressible, raw.ToString());
+
+    // Keys use their own table.
+    EXPECT_EQ(0, key.HuffmanReencode());
+    EXPECT_EQ(key, data);
+
+    val.Reset();
+    raw.Reset();
+    key.Reset();
+  });
+  th.join();
+}
+
+TEST_F(CompactObjectTest, KeyPrefix) {
+  // Runs on a fresh thread to keep the prefix table away from other tests.
+  std::thread th([] {
+    InitThreadStructs();
+    CompactObj::InitKeyPrefixThreadLocal(':', 2);
+    auto saved_bytes = [] { return CompactObj::GetStatsThreadLocal().key_prefix_saved_bytes; };
+
+    const string prefix = "svc:region:tenant:";
+    const string k1 = prefix + "0001", k2 = prefix + "0002", k3 = prefix + string(40, 'x');
+
+    CompactKey key1{k1};  // the prefix is seen for the first time and not interned yet.
+    EXPECT_GT(key1.MallocUsed(), 0u);
+    EXPECT_EQ(0u, saved_bytes());
+
+    CompactKey key2{k2}, key3{k3};
+    EXPECT_EQ(0u, key2.MallocUsed());
+    EXPECT_GT(key3.MallocUsed(), 0u);
+    EXPECT_EQ(2 * (prefix.size() - 1), saved_bytes());
+
+    for (auto [key, str] : {pair{&key2, &k2}, pair{&key3, &k3}}) {
+      EXPECT_EQ(*key, *str);
+      EXPECT_NE(*key, k1);
+      EXPECT_NE(*key, prefix);
+      EXPECT_EQ(str->size(), key->Size());
+      EXPECT_EQ(CompactObj::HashCode(*str), key->HashCode());
+      EXPECT_EQ(*str, key->ToString());
+
+      string scratch;
+      EXPECT_EQ(*str, key->GetSlice(&scratch));
+    }
+
+    key2.SetExpireTime(100);
+    EXPECT_EQ(key2, k2);
+    EXPECT_EQ(CompactObj::HashCode(k2), key2.HashCode());
+    EXPECT_TRUE(key2.ClearExpireTime());
+    EXPECT_EQ(key2, k2);
+    EXPECT_EQ(0u, key2.MallocUsed());
+
+    CompactKey moved{std::move(key2)};
+    EXPECT_EQ(moved, k2);
+    EXPECT_EQ(2 * (prefix.size() - 1), saved_bytes());
+
+    moved.SetString("anotherkeywithoutdelimiter");
+    EXPECT_EQ(prefix.size() - 1, saved_bytes());
+    moved = std::move(key3);
+    EXPECT_EQ(moved, k3);
+
+    key1.Reset();
+    moved.Reset();
+    EXPECT_EQ(0u, saved_bytes());
+  });
+  th.join();
+}
+
 TEST_F(CompactObjectTest, GetByteAtOffset) {
   // Inline string (INLINE_TAG)
   {
@@ -141,6 +141,14 @@ class DashTable : public detail::DashTableBase {
         .first;
   }
 
+  // Same as Insert, but with the key hash already computed by the caller with DoHash().
+  template <typename U, typename V, typename EvictionPolicy>
+  std::pair<iterator, bool> InsertHashed(U&& key, V&& value, uint64_t key_hash,
+                                         EvictionPolicy& ev) {
+    return InsertInternal(std::forward<U>(key), std::forward<V>(value), key_hash, ev,
+                          InsertMode::kInsertIfNotFound);
+  }
+
   template <typename U> const_iterator Find(U&& key) const;
   template <typename U> iterator Find(U&& key);
 
@@ -422,7 +430,14 @@ class DashTable : public detail::DashTableBase {
 
   template <typename U, typename V, typename EvictionPolicy>
   std::pair<iterator, bool> InsertInternal(U&& key, V&& value, EvictionPolicy& policy,
-                                           InsertMode mode);
+                                           InsertMode mode) {
+    uint64_t key_hash = DoHash(key);
+    return InsertInternal(std::forward<U>(key), std::forward<V>(value), key_hash, policy, mode);
+  }
+
+  template <typename U, typename V, typename EvictionPolicy>
+  std::pair<iterator, bool> InsertInternal(U&& key, V&& value, uint64_t key_hash,
+                                           EvictionPolicy& policy, InsertMode mode);
 
   void IncreaseDepth(unsigned new_depth);
   template <typename EvictionPolicy> void Split(uint32_t seg_id, EvictionPolicy& ev);
@@ -951,9 +966,9 @@ void DashTable<_Key, _Value, Policy>::Reserve(size_t size) {
 
 template <typename _Key, typename _Value, typename Policy>
 template <typename U, typename V, typename EvictionPolicy>
-auto DashTable<_Key, _Value, Policy>::InsertInternal(U&& key, V&& value, EvictionPolicy& ev,
-                                                     InsertMode mode) -> std::pair<iterator, bool> {
-  uint64_t key_hash = DoHash(key);
+auto DashTable<_Key, _Value, Policy>::InsertInternal(U&& key, V&& value, uint64_t key_hash,
+                                                     EvictionPolicy& ev, InsertMode mode)
+    -> std::pair<iterator, bool> {
   uint32_t target_seg_id = SegmentId(key_hash);
 
   while (true) {
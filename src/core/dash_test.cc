@@ -1186,6 +1186,27 @@ TEST_F(DashTest, Reserve) {
   }
 }
 
+TEST_F(DashTest, InsertHashed) {
+  Dash64::DefaultEvictionPolicy ev;
+  for (uint64_t i = 0; i < 5000; ++i) {
+    auto [it, inserted] = dt_.InsertHashed(i, i * 2, dt_.DoHash(i), ev);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(it->first, i);
+  }
+
+  const uint64_t dup = 17;
+  auto [it, inserted] = dt_.InsertHashed(dup, uint64_t(0), dt_.DoHash(dup), ev);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(it->second, 34u);
+
+  EXPECT_EQ(dt_.size(), 5000u);
+  for (uint64_t i = 0; i < 5000; ++i) {
+    auto fit = dt_.Find(i);
+    ASSERT_TRUE(fit != dt_.end());
+    ASSERT_EQ(fit->second, i * 2);
+  }
+}
+
 TEST_F(DashTest, Insert) {
   constexpr size_t kNumItems = 10000;
   double sum = 0;
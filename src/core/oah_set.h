@@ -47,6 +47,12 @@ class OAHSet : public OAHTable<OAHEntry> {
     return res;
   }
 
+  // Same contract as StringSet::ContainsMany.
+  void ContainsMany(absl::Span<const std::string_view> span, bool* found) {
+    for (size_t i = 0; i < span.size(); ++i)
+      found[i] = Contains(span[i]);
+  }
+
   // TODO: Consider using chunks for this as in StringSet
   void Fill(OAHSet* other) {
     assert(other->entries_.empty());
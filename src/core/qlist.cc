@@ -309,6 +309,31 @@ ssize_t TryCompress(QList::Node* node) {
   return 0;
 }
 
+// Decompresses the payload of a compressed node into dest that has room for node->sz bytes.
+// ZSTD-compressed nodes require the thread-local dictionary.
+bool DecompressInto(const QList::Node* node, void* dest) {
+  const quicklistLZF* lzf = GetLzf(const_cast<QList::Node*>(node));
+  QList::stats.decompression_calls++;
+
+  if (node->encoding == QLIST_NODE_ENCODING_ZSTD) {
+    DCHECK(tl_zstd_dict && tl_zstd_dict->dctx);
+    ZSTD_DCtx_reset(tl_zstd_dict->dctx, ZSTD_reset_session_only);
+    size_t dsz = ZSTD_decompress_usingDDict(tl_zstd_dict->dctx, dest, node->sz, lzf->compressed,
+                                            lzf->sz, tl_zstd_dict->ddict);
+    if (ZSTD_isError(dsz) || dsz != node->sz) {
+      LOG(DFATAL) << "ZSTD decompression error: " << ZSTD_getErrorName(dsz);
+      return false;
+    }
+    return true;
+  }
+
+  if (lzf_decompress(lzf->compressed, lzf->sz, dest, node->sz) == 0) {
+    LOG(DFATAL) << "Invalid LZF compressed data";
+    return false;
+  }
+  return true;
+}
+
 /* Uncompress the listpack in 'node' and update encoding details.
  * Returns 1 on successful decode, 0 on failure to decode.
  * ddict is required for ZSTD-compressed nodes (encoding == QLIST_NODE_ENCODING_ZSTD). */
@@ -320,34 +345,67 @@ bool DecompressRaw(bool recompress, QList::Node* node) {
 
   void* decompressed = zmalloc(node->sz);
   quicklistLZF* lzf = GetLzf(node);
-  QList::stats.decompression_calls++;
   QList::stats.compressed_bytes -= lzf->sz;
   QList::stats.raw_compressed_bytes -= node->sz;
 
-  if (node->encoding == QLIST_NODE_ENCODING_ZSTD) {
-    DCHECK(tl_zstd_dict && tl_zstd_dict->dctx);
-    ZSTD_DCtx_reset(tl_zstd_dict->dctx, ZSTD_reset_session_only);
-    size_t dsz = ZSTD_decompress_usingDDict(tl_zstd_dict->dctx, decompressed, node->sz,
-                                            lzf->compressed, lzf->sz, tl_zstd_dict->ddict);
-    if (ZSTD_isError(dsz) || dsz != node->sz) {
-      LOG(DFATAL) << "ZSTD decompression error: " << ZSTD_getErrorName(dsz);
-      zfree(decompressed);
-      return false;
-    }
-  } else {
-    if (lzf_decompress(lzf->compressed, lzf->sz, decompressed, node->sz) == 0) {
-      LOG(DFATAL) << "Invalid LZF compressed data";
-      /* Someone requested decompress, but we can't decompress.  Not good. */
-      zfree(decompressed);
-      return false;
-    }
+  if (!DecompressInto(node, decompressed)) {
+    /* Someone requested decompress, but we can't decompress.  Not good. */
+    zfree(decompressed);
+    return false;
   }
+
   zfree(lzf);
   node->entry = (uint8_t*)decompressed;
   node->encoding = QUICKLIST_NODE_ENCODING_RAW;
   return true;
 }
 
+// Nodes up to this size are decompressed into the thread-local scratch buffer during
+// read-only iteration. Larger (plain) nodes use a temporary allocation.
+constexpr size_t kMaxScratchSize = 1u << 16;
+
+thread_local std::unique_ptr<uint8_t[]> tl_scratch;
+thread_local bool tl_scratch_busy = false;
+
+// Provides a buffer for decompressing nodes during read-only iteration without touching the
+// node itself. Falls back to a private allocation if the thread-local buffer is taken, for
+// example when an iteration callback yields and another fiber iterates a list.
+class DecompressScratch {
+ public:
+  DecompressScratch() : shared_(!tl_scratch_busy) {
+    if (shared_)
+      tl_scratch_busy = true;
+  }
+
+  ~DecompressScratch() {
+    if (shared_)
+      tl_scratch_busy = false;
+  }
+
+  // Returns the decompressed payload of node or nullptr on failure. The result is valid until
+  // the next call.
+  uint8_t* Decompress(const QList::Node* node) {
+    uint8_t* dest;
+    if (shared_ && node->sz <= kMaxScratchSize) {
+      if (!tl_scratch)
+        tl_scratch.reset(new uint8_t[kMaxScratchSize]);
+      dest = tl_scratch.get();
+    } else {
+      if (local_size_ < node->sz) {
+        local_.reset(new uint8_t[node->sz]);
+        local_size_ = node->sz;
+      }
+      dest = local_.get();
+    }
+    return DecompressInto(node, dest) ? dest : nullptr;
+  }
+
+ private:
+  bool shared_;
+  std::unique_ptr<uint8_t[]> local_;
+  size_t local_size_ = 0;
+};
+
 /* Decompress only compressed nodes.
    recompress: if true, the node will be marked for recompression after decompression.
    returns by how much the size of the node has increased.
@@ -684,18 +742,45 @@ size_t QList::MallocUsed(bool slow) const {
 
 void QList::Iterate(IterateFunc cb, long start, long end) const {
   long llen = Size();
-  if (llen == 0)
+  if (start < 0)
+    start += llen;
+  if (end < 0 || end >= llen)
+    end = llen - 1;
+  if (start < 0 || start > end)
     return;
 
-  if (end < 0 || end >= long(Size()))
-    end = Size() - 1;
-  Iterator it = GetIterator(start);
-  if (it.Valid()) {
-    do {
-      if (start > end || !cb(it.Get()))
-        break;
-      start++;
-    } while (it.Next());
+  // Walks the nodes directly instead of going through Iterator, so that compressed nodes
+  // are decompressed once into a scratch buffer rather than being decompressed in place and
+  // recompressed when the iteration moves on.
+  DecompressScratch scratch;
+  long offset = 0;
+  for (Node* node = FindNode(start, &offset); node && start <= end; node = node->next) {
+    const_cast<QList*>(this)->Materialize(node);
+    stats.total_node_reads++;
+    if (IsInterior(node)) {
+      stats.interior_node_reads++;
+    }
+
+    uint8_t* data = node->IsCompressed() ? scratch.Decompress(node) : node->entry;
+    if (!data)
+      return;
+
+    if (QL_NODE_IS_PLAIN(node)) {
+      if (!cb(Entry(reinterpret_cast<char*>(data), node->sz)))
+        return;
+      ++start;
+      continue;
+    }
+
+    for (uint8_t* p = lpSeek(data, offset); p && start <= end; p = lpNext(data, p)) {
+      unsigned int sz = 0;
+      long long val;
+      uint8_t* ptr = lpGetValue(p, &sz, &val);
+      if (!cb(ptr ? Entry(reinterpret_cast<char*>(ptr), sz) : Entry(val)))
+        return;
+      ++start;
+    }
+    offset = 0;
   }
 }
 
@@ -1303,6 +1388,34 @@ auto QList::GetIterator(Where where) const -> Iterator {
   return it;
 }
 
+auto QList::FindNode(long idx, long* offset) const -> Node* {
+  DCHECK_GE(idx, 0);
+  if (size_t(idx) >= count_)
+    return nullptr;
+
+  // Seek from the tail if it is closer.
+  if (size_t(idx) > (count_ - 1) / 2) {
+    size_t accum = count_;
+    for (Node* n = head_->prev;; n = n->prev) {
+      accum -= n->count;
+      if (accum <= size_t(idx)) {
+        *offset = idx - accum;
+        return n;
+      }
+    }
+  }
+
+  size_t accum = 0;
+  for (Node* n = head_; n; n = n->next) {
+    if (accum + n->count > size_t(idx)) {
+      *offset = idx - accum;
+      return n;
+    }
+    accum += n->count;
+  }
+  return nullptr;
+}
+
 auto QList::GetIterator(long idx) const -> Iterator {
   unsigned long long accum = 0;
   int forward = idx < 0 ? 0 : 1; /* < 0 -> reverse, 0+ -> forward */
@@ -1423,9 +1536,12 @@ bool QList::Erase(const long start, unsigned count) {
     extent = -start; /* c.f. LREM -29 29; just delete until end. */
   }
 
-  Iterator it = GetIterator(start);
-  Node* node = it.current_;
-  long offset = it.offset_;
+  // Locate the first node without decompressing it: whole nodes are dropped below as is.
+  long offset = 0;
+  long idx = start < 0 ? long(count_) + start : start;
+  Node* node = idx >= 0 ? FindNode(idx, &offset) : nullptr;
+  if (!node)
+    return false;
 
   /* iterate over next nodes until everything is deleted. */
   while (extent) {
@@ -1733,6 +1849,7 @@ bool QList::DecompressZstdNode(const Node* node, std::string* dest) {
 void QList::ShutdownThread() {
   delete tl_zstd_dict;
   tl_zstd_dict = nullptr;
+  tl_scratch.reset();
 }
 
 }  // namespace dfly
@@ -213,7 +213,8 @@ class QList {
 
   size_t MallocUsed(bool slow) const;
 
-  // Iterates over entries from start to end (inclusive).
+  // Iterates over entries from start to end (inclusive). Read-only: compressed nodes are
+  // decompressed into a thread-local scratch buffer and are left compressed.
   void Iterate(IterateFunc cb, long start, long end) const;
 
   // Returns an iterator to tail or the head of the list.
@@ -388,6 +389,11 @@ class QList {
   void DelNode(Node* node);
   bool DelPackedIndex(Node* node, uint8_t* p);
 
+  // Returns the node that holds the element at non-negative index idx and sets offset to its
+  // position inside the node. Does not materialize or decompress the node.
+  // Returns nullptr if idx is out of range.
+  Node* FindNode(long idx, long* offset) const;
+
   // Initializes iterator's zi_ to point to the element at offset_.
   // Decompresses the node if needed. Assumes current_ is not null.
   void InitIteratorEntry(Iterator* it) const;
@@ -353,6 +353,38 @@ TEST_F(QListTest, CompressionPlain) {
   EXPECT_EQ(500, i);
 }
 
+TEST_F(QListTest, IterateKeepsNodesCompressed) {
+  ql_ = QList(-2, 1);
+  for (int i = 0; i < 2000; i++) {
+    ql_.Push(StrCat("value", i, string(100, 'x')), QList::TAIL);
+  }
+  ASSERT_GT(ql_.node_count(), 3u);
+  const QList::Node* interior = ql_.Head()->next;
+  ASSERT_TRUE(interior->IsCompressed());
+  size_t malloc_used = ql_.MallocUsed(false);
+
+  int i = 10;
+  ql_.Iterate(
+      [&](const QList::Entry& e) {
+        EXPECT_EQ(StrCat("value", i, string(100, 'x')), e.view());
+        ++i;
+        return true;
+      },
+      10, 1500);
+  EXPECT_EQ(1501, i);
+  EXPECT_TRUE(interior->IsCompressed());
+  EXPECT_EQ(malloc_used, ql_.MallocUsed(false));
+
+  // Whole interior nodes are dropped without being decompressed.
+  uint64_t decompressions = QList::stats.decompression_calls;
+  unsigned count = interior->count + interior->next->count;
+  size_t node_count = ql_.node_count();
+  ASSERT_TRUE(ql_.Erase(ql_.Head()->count, count));
+  EXPECT_EQ(decompressions, QList::stats.decompression_calls);
+  EXPECT_EQ(node_count - 2, ql_.node_count());
+  EXPECT_EQ(2000u - count, ql_.Size());
+}
+
 TEST_F(QListTest, LargeValues) {
   string val(100000, 'a');
   ql_.Push(val, QList::HEAD);
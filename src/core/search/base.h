@@ -7,7 +7,9 @@
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 #include <absl/container/inlined_vector.h>
+#include <absl/functional/function_ref.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -140,11 +142,27 @@ struct BaseIndex {
   }
 };
 
+// How a sort index finds the top matches of a query.
+enum class SortStrategy : uint8_t {
+  kHeap,       // Collect all matched ids and select the top `limit` with a bounded heap
+  kIndexScan,  // Walk the index in sort order and stop after `limit` matched ids
+};
+
 // Base class for type-specific sorting indices.
 struct BaseSortIndex : BaseIndex {
   virtual SortableValue Lookup(DocId doc) const = 0;
+
+  // Leaves the first min(limit, ids->size()) ids sorted and returns their values.
   virtual std::vector<SortableValue> Sort(std::vector<DocId>* ids, size_t limit,
                                           bool desc) const = 0;
+
+  // Strategy for `num_matches` matched ids that can be checked one by one without collecting them.
+  virtual SortStrategy ChooseSortStrategy(size_t num_matches, size_t limit, bool desc) const = 0;
+
+  // Walks docs with non-null values in sort order and stores the first `limit` accepted by
+  // `matches` in `ids`. Returns their values.
+  virtual std::vector<SortableValue> ScanSorted(std::vector<DocId>* ids, size_t limit, bool desc,
+                                                absl::FunctionRef<bool(DocId)> matches) const = 0;
 };
 
 /* Used in iterators of inverse indices.
@@ -180,13 +198,6 @@ template <typename InlinedVector> std::optional<InlinedVector> EmptyAccessResult
 
 // Implementation
 /******************************************************************/
-namespace details {
-inline size_t GetHighestPowerOfTwo(size_t n) {
-  static constexpr size_t kBitsNumber = sizeof(size_t) * 8;
-  return size_t(1) << (kBitsNumber - 1 - __builtin_clzl(n));
-}
-}  // namespace details
-
 template <typename Iterator> void BasicSeekGE(DocId min_doc_id, const Iterator& end, Iterator* it) {
   using Category = typename std::iterator_traits<Iterator>::iterator_category;
 
@@ -199,17 +210,22 @@ template <typename Iterator> void BasicSeekGE(DocId min_doc_id, const Iterator&
     }
   };
 
+  // Gallop for random access iterators: probe 1, 2, 4, ... elements ahead and binary search the
+  // last step. Seeks cost O(log distance) instead of O(log length), which matters for
+  // intersections where most seeks are short.
   if constexpr (std::is_base_of_v<std::random_access_iterator_tag, Category>) {
     size_t length = std::distance(*it, end);
-    for (size_t step = details::GetHighestPowerOfTwo(length); step > 0; step >>= 1) {
-      if (step < length) {
-        auto next_it = *it + step;
-        if (extract_doc_id(*next_it) < min_doc_id) {
-          *it = next_it;
-          length -= step;
-        }
-      }
+    size_t step = 1;
+    while (step < length && extract_doc_id(*(*it + step)) < min_doc_id) {
+      *it += step;
+      length -= step;
+      step *= 2;
     }
+
+    *it = std::partition_point(*it, *it + std::min(step, length), [&](const auto& value) {
+      return extract_doc_id(value) < min_doc_id;
+    });
+    return;
   }
 
   while (*it != end && extract_doc_id(**it) < min_doc_id) {
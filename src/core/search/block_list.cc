@@ -263,24 +263,31 @@ template <typename C> void BlockList<C>::BlockListIterator::SeekGE(DocId min_doc
     }
   };
 
-  auto needed_block = [&](const auto& it) {
-    return it->begin() != it->end() && min_doc_id <= extract_doc_id(it->Back());
+  auto needed_block = [&](const C& block) {
+    return min_doc_id <= extract_doc_id(block.Back());
   };
 
-  // Choose the first block that has the last element >= min_doc_id
-  if (!needed_block(it)) {
-    while (++it != it_end) {
-      if (needed_block(it)) {
-        block_it = it->begin();
-        block_end = it->end();
+  // Choose the first block that has the last element >= min_doc_id. Blocks are never empty and
+  // their last elements are sorted, so gallop over them: probe 1, 2, 4, ... blocks ahead and binary
+  // search the last step. Long skips over posting lists cost O(log distance) block headers.
+  if (!needed_block(*it)) {
+    ConstBlockIt lo = it, hi = it_end;
+    for (size_t step = 1; step < size_t(it_end - lo); step *= 2) {
+      if (needed_block(*(lo + step))) {
+        hi = lo + step;
         break;
       }
+      lo += step;
     }
+
+    it = std::partition_point(lo + 1, hi, [&](const C& block) { return !needed_block(block); });
     if (it == it_end) {
       block_it = {};
       block_end = {};
       return;
     }
+    block_it = it->begin();
+    block_end = it->end();
   }
 
   BasicSeekGE(min_doc_id, block_end, &block_it);
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <type_traits>
 #include <vector>
 
 #include "core/search/base.h"
@@ -125,6 +126,25 @@ template <typename Container /* underlying container */> class BlockList {
       }
     }
 
+    // Upper bound of Freq() over the current block. Together with BlockBack() it forms a block-max
+    // skip header: a scorer can bound the score of all documents of the block without decoding it.
+    uint32_t BlockMaxFreq() const {
+      if constexpr (requires { it->MaxFreq(); }) {
+        return it->MaxFreq();
+      } else {
+        return 1;
+      }
+    }
+
+    // Last document id of the current block.
+    DocId BlockBack() const {
+      if constexpr (std::is_same_v<ElementType, DocId>) {
+        return it->Back();
+      } else {
+        return it->Back().first;
+      }
+    }
+
     BlockListIterator& operator++();
     void SeekGE(DocId min_doc_id);
 
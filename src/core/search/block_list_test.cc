@@ -161,6 +161,41 @@ TYPED_TEST(TemplatedBlockListTest, RandomNumbers) {
   }
 }
 
+TYPED_TEST(TemplatedBlockListTest, SeekGE) {
+  auto list = this->Make();
+  std::set<DocId> ids;
+  for (DocId i = 0; i < 5'000; i++) {
+    if (rand() % 3 == 0) {
+      list.Insert(this->AddNewBlockListElement(i));
+      ids.insert(i);
+    }
+  }
+
+  // Seek forward from a single iterator with both short and long (many blocks) steps
+  auto it = list.begin();
+  for (DocId target = 0; target < 5'200; target += rand() % 400) {
+    it.SeekGE(target);
+    auto expected = ids.lower_bound(target);
+    if (expected == ids.end()) {
+      EXPECT_TRUE(it == list.end());
+      break;
+    }
+    ASSERT_TRUE(it != list.end());
+    EXPECT_EQ(this->GetDocId(*it), *expected);
+    EXPECT_GE(it.BlockBack(), *expected);
+  }
+
+  // Seek from the start to every position
+  for (DocId target = 0; target < 5'000; target += 37) {
+    auto seek_it = list.begin();
+    seek_it.SeekGE(target);
+    auto expected = ids.lower_bound(target);
+    ASSERT_EQ(seek_it == list.end(), expected == ids.end());
+    if (expected != ids.end())
+      EXPECT_EQ(this->GetDocId(*seek_it), *expected);
+  }
+}
+
 class BlockListTest : public testing::Test {
  protected:
 };
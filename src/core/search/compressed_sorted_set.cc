@@ -117,6 +117,7 @@ CompressedSortedSet::ConstIterator CompressedSortedSet::end() const {
 void CompressedSortedSet::PushBackDiff(IntType diff, uint32_t freq,
                                        absl::Span<const uint32_t> positions) {
   size_++;
+  max_freq_ = max(max_freq_, freq);
 
   VarintBuffer buf;
   auto diff_span = WriteVarLen(diff, absl::MakeSpan(buf));
@@ -198,6 +199,7 @@ bool CompressedSortedSet::Insert(IntType value, uint32_t freq,
   }
 
   size_++;
+  max_freq_ = max(max_freq_, freq);
 
   // Now the list certainly contains the bound B > V and possibly A < V (or 0 by default),
   // so we need to encode both new entries replacing the old one
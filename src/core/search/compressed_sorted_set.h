@@ -93,6 +93,7 @@ class CompressedSortedSet {
 
   void Clear() {
     size_ = 0;
+    max_freq_ = 0;
     tail_value_.reset();
     diffs_.clear();
   }
@@ -105,6 +106,12 @@ class CompressedSortedSet {
     return store_positions_;
   }
 
+  // Upper bound of the frequencies stored in the set, 1 for sets without frequencies. Kept as a
+  // per block header by BlockList to bound scores of whole blocks. Not lowered by Remove.
+  uint32_t MaxFreq() const {
+    return store_freq_ ? max_freq_ : uint32_t(!Empty());
+  }
+
   // Add all values from other
   void Merge(CompressedSortedSet&& other);
 
@@ -147,6 +154,7 @@ class CompressedSortedSet {
 
  private:
   uint32_t size_{0};
+  uint32_t max_freq_{0};
   bool store_freq_;       // Whether to encode/decode freq alongside diffs
   bool store_positions_;  // Whether to encode/decode positions; implies store_freq_
 
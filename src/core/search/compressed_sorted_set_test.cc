@@ -349,6 +349,31 @@ TEST_F(CompressedSortedSetTest, FreqSplit) {
   EXPECT_EQ(expected_id, 20u);
 }
 
+TEST_F(CompressedSortedSetTest, MaxFreq) {
+  CompressedSortedSet list{PMR_NS::get_default_resource(), /*store_freq=*/true};
+  EXPECT_EQ(list.MaxFreq(), 0u);
+
+  list.Insert(10, 3);
+  list.Insert(30, 2);
+  EXPECT_EQ(list.MaxFreq(), 3u);
+
+  list.Insert(20, 7);  // insert in the middle
+  EXPECT_EQ(list.MaxFreq(), 7u);
+
+  for (uint32_t i = 0; i < 10; i++)
+    list.Insert(100 + i, 1);
+  auto [first, second] = std::move(list).Split();
+  EXPECT_GE(first.MaxFreq(), 7u);
+  EXPECT_EQ(second.MaxFreq(), 1u);
+
+  first.Clear();
+  EXPECT_EQ(first.MaxFreq(), 0u);
+
+  CompressedSortedSet no_freq{PMR_NS::get_default_resource()};
+  no_freq.Insert(5);
+  EXPECT_EQ(no_freq.MaxFreq(), 1u);
+}
+
 TEST_F(CompressedSortedSetTest, FreqLargeValues) {
   CompressedSortedSet list{PMR_NS::get_default_resource(), /*store_freq=*/true};
 
@@ -0,0 +1,103 @@
+// Copyright 2025, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "core/search/doc_bitmap.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace dfly::search {
+
+DocBitmap::Iterator::Iterator(const DocBitmap* bitmap, size_t word_idx, uint64_t rest)
+    : bitmap_{bitmap}, word_idx_{word_idx}, rest_{rest} {
+  Advance();
+}
+
+void DocBitmap::Iterator::Advance() {
+  const auto& words = bitmap_->words_;
+  while (rest_ == 0) {
+    if (word_idx_ + 1 >= words.size()) {
+      word_idx_ = words.size();
+      doc_ = kEnd;
+      return;
+    }
+    rest_ = words[++word_idx_];
+  }
+
+  doc_ = word_idx_ * 64 + std::countr_zero(rest_);
+  rest_ &= rest_ - 1;  // clear lowest bit
+}
+
+void DocBitmap::Iterator::SeekGE(DocId min_doc_id) {
+  if (min_doc_id <= doc_)
+    return;
+
+  const auto& words = bitmap_->words_;
+  size_t idx = min_doc_id / 64;
+  if (idx >= words.size()) {
+    word_idx_ = words.size();
+    rest_ = 0;
+    doc_ = kEnd;
+    return;
+  }
+
+  // rest_ already excludes visited bits if we stay in the same word
+  uint64_t mask = ~uint64_t{0} << (min_doc_id % 64);
+  rest_ = (idx == word_idx_ ? rest_ : words[idx]) & mask;
+  word_idx_ = idx;
+  Advance();
+}
+
+DocBitmap::DocBitmap(PMR_NS::memory_resource* mr) : words_{mr} {
+}
+
+bool DocBitmap::Insert(DocId id) {
+  size_t idx = id / 64;
+  if (idx >= words_.size())
+    words_.resize(idx + 1, 0);
+
+  uint64_t bit = uint64_t{1} << (id % 64);
+  if (words_[idx] & bit)
+    return false;
+
+  words_[idx] |= bit;
+  count_++;
+  return true;
+}
+
+bool DocBitmap::Remove(DocId id) {
+  if (!Contains(id))
+    return false;
+
+  words_[id / 64] &= ~(uint64_t{1} << (id % 64));
+  count_--;
+  return true;
+}
+
+void DocBitmap::And(const DocBitmap& other) {
+  words_.resize(std::min(words_.size(), other.words_.size()));
+
+  size_t count = 0;
+  for (size_t i = 0; i < words_.size(); i++) {
+    words_[i] &= other.words_[i];
+    count += std::popcount(words_[i]);
+  }
+  count_ = count;
+}
+
+void DocBitmap::Or(const DocBitmap& other) {
+  if (words_.size() < other.words_.size())
+    words_.resize(other.words_.size(), 0);
+
+  size_t count = 0;
+  for (size_t i = 0; i < other.words_.size(); i++) {
+    words_[i] |= other.words_[i];
+    count += std::popcount(words_[i]);
+  }
+  for (size_t i = other.words_.size(); i < words_.size(); i++)
+    count += std::popcount(words_[i]);
+  count_ = count;
+}
+
+}  // namespace dfly::search
@@ -0,0 +1,123 @@
+// Copyright 2025, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+
+#include "base/pmr/memory_resource.h"
+#include "core/search/base.h"
+
+namespace dfly::search {
+
+// Set of document ids stored as a plain bitmap of 64 bit words. It takes max id / 8 bytes
+// regardless of the number of ids, so it is smaller than a sorted list of ids only for dense
+// sets, like tags shared by a large part of all documents. Boolean operations combine whole
+// words in simple loops that compilers vectorize, instead of merging ids one by one.
+class DocBitmap {
+ public:
+  // Iterates over the contained ids in ascending order
+  class Iterator : public SeekableTag {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = DocId;
+    using pointer = DocId*;
+    using reference = DocId&;
+
+    DocId operator*() const {
+      return doc_;
+    }
+
+    Iterator& operator++() {
+      Advance();
+      return *this;
+    }
+
+    void SeekGE(DocId min_doc_id);
+
+    bool operator==(const Iterator& other) const {
+      return doc_ == other.doc_;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return doc_ != other.doc_;
+    }
+
+   private:
+    friend class DocBitmap;
+    static constexpr DocId kEnd = std::numeric_limits<DocId>::max();
+
+    Iterator(const DocBitmap* bitmap, size_t word_idx, uint64_t rest);
+
+    // Moves to the lowest bit of rest_ or of the following words
+    void Advance();
+
+    const DocBitmap* bitmap_;
+    size_t word_idx_;
+    uint64_t rest_;  // Bits of the current word that were not visited yet
+    DocId doc_ = kEnd;
+  };
+
+  using iterator = Iterator;
+
+  explicit DocBitmap(PMR_NS::memory_resource* mr = PMR_NS::get_default_resource());
+
+  // Builds a bitmap from a range of ids
+  template <typename It>
+  DocBitmap(It begin, It end, PMR_NS::memory_resource* mr = PMR_NS::get_default_resource())
+      : DocBitmap{mr} {
+    Insert(begin, end);
+  }
+
+  // Return true if the set was changed
+  bool Insert(DocId id);
+  bool Remove(DocId id);
+
+  template <typename It> void Insert(It begin, It end) {
+    for (; begin != end; ++begin)
+      Insert(*begin);
+  }
+
+  bool Contains(DocId id) const {
+    size_t idx = id / 64;
+    return idx < words_.size() && (words_[idx] >> (id % 64)) & 1;
+  }
+
+  // Intersect or unite with `other` in place
+  void And(const DocBitmap& other);
+  void Or(const DocBitmap& other);
+
+  size_t Size() const {
+    return count_;
+  }
+
+  size_t size() const {
+    return count_;
+  }
+
+  bool Empty() const {
+    return count_ == 0;
+  }
+
+  Iterator begin() const {
+    return Iterator{this, 0, words_.empty() ? 0 : words_[0]};
+  }
+
+  Iterator end() const {
+    return Iterator{this, words_.size(), 0};
+  }
+
+  size_t MemUsage() const {
+    return words_.capacity() * sizeof(uint64_t);
+  }
+
+ private:
+  PMR_NS::vector<uint64_t> words_;
+  size_t count_ = 0;
+};
+
+}  // namespace dfly::search
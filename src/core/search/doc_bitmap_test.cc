@@ -0,0 +1,124 @@
+// Copyright 2025, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "core/search/doc_bitmap.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "base/gtest.h"
+#include "base/logging.h"
+#include "core/search/index_result.h"
+
+namespace dfly::search {
+
+using namespace std;
+using testing::ElementsAre;
+using testing::ElementsAreArray;
+
+class DocBitmapTest : public testing::Test {
+ protected:
+  // Random set with roughly `density` of the ids below `universe`
+  static set<DocId> RandomSet(DocId universe, double density, unsigned seed) {
+    default_random_engine rnd{seed};
+    bernoulli_distribution coin{density};
+    set<DocId> out;
+    for (DocId id = 0; id < universe; id++) {
+      if (coin(rnd))
+        out.insert(id);
+    }
+    return out;
+  }
+};
+
+TEST_F(DocBitmapTest, InsertRemove) {
+  DocBitmap bitmap;
+  EXPECT_TRUE(bitmap.Empty());
+  EXPECT_EQ(bitmap.begin(), bitmap.end());
+
+  for (DocId id : {5u, 64u, 0u, 63u, 1000u})
+    EXPECT_TRUE(bitmap.Insert(id));
+  EXPECT_FALSE(bitmap.Insert(64));
+
+  EXPECT_EQ(bitmap.Size(), 5u);
+  EXPECT_TRUE(bitmap.Contains(63));
+  EXPECT_FALSE(bitmap.Contains(62));
+  EXPECT_FALSE(bitmap.Contains(100'000));
+  EXPECT_THAT(vector<DocId>(bitmap.begin(), bitmap.end()), ElementsAre(0, 5, 63, 64, 1000));
+
+  EXPECT_TRUE(bitmap.Remove(63));
+  EXPECT_FALSE(bitmap.Remove(63));
+  EXPECT_FALSE(bitmap.Remove(100'000));
+  EXPECT_EQ(bitmap.Size(), 4u);
+  EXPECT_THAT(vector<DocId>(bitmap.begin(), bitmap.end()), ElementsAre(0, 5, 64, 1000));
+}
+
+TEST_F(DocBitmapTest, SeekGE) {
+  auto ids = RandomSet(10'000, 0.05, 1);
+  DocBitmap bitmap{ids.begin(), ids.end()};
+
+  for (DocId start : {0u, 100u, 4321u}) {
+    for (DocId target : {start, start + 1, start + 63, start + 64, start + 500, 20'000u}) {
+      auto it = bitmap.begin();
+      it.SeekGE(start);
+      it.SeekGE(target);
+
+      auto expected = ids.lower_bound(target);
+      if (expected == ids.end())
+        EXPECT_EQ(it, bitmap.end()) << target;
+      else
+        EXPECT_EQ(*it, *expected) << target;
+    }
+  }
+}
+
+TEST_F(DocBitmapTest, BooleanOperations) {
+  auto left = RandomSet(5000, 0.4, 2);
+  auto right = RandomSet(3000, 0.6, 3);
+
+  vector<DocId> expected_and, expected_or;
+  set_intersection(left.begin(), left.end(), right.begin(), right.end(),
+                   back_inserter(expected_and));
+  set_union(left.begin(), left.end(), right.begin(), right.end(), back_inserter(expected_or));
+
+  DocBitmap bitmap_and{left.begin(), left.end()};
+  bitmap_and.And(DocBitmap{right.begin(), right.end()});
+  EXPECT_EQ(bitmap_and.Size(), expected_and.size());
+  EXPECT_THAT(vector<DocId>(bitmap_and.begin(), bitmap_and.end()),
+              ElementsAreArray(expected_and));
+
+  DocBitmap bitmap_or{right.begin(), right.end()};
+  bitmap_or.Or(DocBitmap{left.begin(), left.end()});
+  EXPECT_EQ(bitmap_or.Size(), expected_or.size());
+  EXPECT_THAT(vector<DocId>(bitmap_or.begin(), bitmap_or.end()), ElementsAreArray(expected_or));
+}
+
+// Bitmaps merged with each other and with sorted lists give the same results as sorted lists
+TEST_F(DocBitmapTest, MergeIndexResults) {
+  auto dense = RandomSet(5000, 0.5, 4);
+  auto sparse = RandomSet(5000, 0.01, 5);
+  DocBitmap dense_bitmap{dense.begin(), dense.end()};
+  vector<DocId> dense_vec(dense.begin(), dense.end()), sparse_vec(sparse.begin(), sparse.end());
+
+  using LogicOp = AstLogicalNode::LogicOp;
+  for (auto op : {LogicOp::AND, LogicOp::OR}) {
+    auto expected = MergeIndexResults(IndexResult{&dense_vec}, IndexResult{&sparse_vec}, op);
+    EXPECT_EQ(expected.GetBitmap(), nullptr);
+
+    auto with_bitmap = MergeIndexResults(IndexResult{&dense_bitmap}, IndexResult{&sparse_vec}, op);
+    EXPECT_EQ(with_bitmap.Take().first, expected.Take().first);
+
+    // Two bitmaps stay a bitmap
+    auto both = MergeIndexResults(IndexResult{&dense_bitmap}, IndexResult{&dense_bitmap}, op);
+    ASSERT_NE(both.GetBitmap(), nullptr);
+    EXPECT_EQ(both.Take().first, dense_vec);
+  }
+}
+
+}  // namespace dfly::search
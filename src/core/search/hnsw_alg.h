@@ -1445,6 +1445,91 @@ template <typename dist_t> class HierarchicalNSW : public hnswlib::AlgorithmInte
     return result;
   }
 
+  // KNN search for several queries at once. Queries descend the upper layers together: the
+  // queries standing on the same node share one pass over its neighbor list, and
+  // dist_many(node_data, queries, num_queries, out) computes the distances from a neighbor to all
+  // of them. Every query takes the same path as with searchKnnWithEf, so results are identical.
+  template <typename DistMany>
+  std::vector<std::priority_queue<std::pair<dist_t, labeltype>>> searchKnnBatchWithEf(
+      const void* const* queries, size_t num_queries, size_t k, uint32_t ef_runtime,
+      DistMany&& dist_many) const {
+    std::vector<std::priority_queue<std::pair<dist_t, labeltype>>> results(num_queries);
+    if (cur_element_count == 0 || num_queries == 0)
+      return results;
+
+    std::vector<tableint> curr_obj(num_queries, enterpoint_node_);
+    std::vector<dist_t> curdist(num_queries);
+    dist_many(getDataByInternalId(enterpoint_node_), queries, num_queries, curdist.data());
+
+    // (node, query) pairs of queries that moved in the last round
+    std::vector<std::pair<tableint, size_t>> moving, moved;
+    std::vector<const void*> group_queries;
+    std::vector<dist_t> group_dists;
+
+    for (int level = maxlevel_; level > 0; level--) {
+      moving.clear();
+      for (size_t q = 0; q < num_queries; q++)
+        moving.emplace_back(curr_obj[q], q);
+
+      while (!moving.empty()) {
+        std::sort(moving.begin(), moving.end());
+        moved.clear();
+
+        for (size_t begin = 0, end = 0; begin < moving.size(); begin = end) {
+          tableint node = moving[begin].first;
+          group_queries.clear();
+          for (end = begin; end < moving.size() && moving[end].first == node; end++)
+            group_queries.push_back(queries[moving[end].second]);
+          group_dists.resize(group_queries.size());
+
+          unsigned int* data = (unsigned int*)get_linklist(node, level);
+          int size = getListCount(data);
+          metric_hops += group_queries.size();
+          metric_distance_computations += size * group_queries.size();
+
+          tableint* datal = (tableint*)(data + 1);
+          for (int i = 0; i < size; i++) {
+            tableint cand = datal[i];
+            if (cand > max_elements_)
+              throw std::runtime_error("cand error");
+            dist_many(getDataByInternalId(cand), group_queries.data(), group_queries.size(),
+                      group_dists.data());
+
+            for (size_t j = begin; j < end; j++) {
+              size_t q = moving[j].second;
+              if (group_dists[j - begin] < curdist[q]) {
+                curdist[q] = group_dists[j - begin];
+                curr_obj[q] = cand;
+              }
+            }
+          }
+
+          for (size_t j = begin; j < end; j++) {
+            size_t q = moving[j].second;
+            if (curr_obj[q] != node)
+              moved.emplace_back(curr_obj[q], q);
+          }
+        }
+        moving.swap(moved);
+      }
+    }
+
+    // Searches on the base layer diverge quickly, so they run one by one
+    size_t effective_ef = std::max<size_t>(ef_runtime, k);
+    for (size_t q = 0; q < num_queries; q++) {
+      auto top_candidates =
+          num_deleted_ ? searchBaseLayerST<false>(curr_obj[q], queries[q], effective_ef)
+                       : searchBaseLayerST<true>(curr_obj[q], queries[q], effective_ef);
+      while (top_candidates.size() > k)
+        top_candidates.pop();
+      for (; !top_candidates.empty(); top_candidates.pop()) {
+        auto [dist, id] = top_candidates.top();
+        results[q].emplace(dist, getExternalLabel(id));
+      }
+    }
+    return results;
+  }
+
   // Brute-force KNN search over a pre-filtered set of label IDs.
   // Computes distances for all provided IDs and returns the top-k closest, ordered by distance.
   std::priority_queue<std::pair<dist_t, labeltype>> subsetKnnSearch(
@@ -4,12 +4,20 @@
 
 #include "core/search/hnsw_index.h"
 
+#include <absl/functional/function_ref.h>
 #include <absl/strings/match.h>
 #include <hnswlib/hnswlib.h>
 #include <hnswlib/space_ip.h>
 #include <hnswlib/space_l2.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
 #include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "base/logging.h"
 #include "core/search/hnsw_alg.h"
@@ -50,10 +58,120 @@ class HnswSpace : public hnswlib::SpaceInterface<float> {
     return DistStatic;
   }
 
+  // Same as the distance function, for one stored vector and several queries
+  void DistanceToMany(const void* v, const void* const* queries, size_t num_queries,
+                      float* out) const {
+    VectorDistanceOneToMany(v, queries, num_queries, params_.dim, params_.sim, params_.dt, out);
+  }
+
   void* get_dist_func_param() {
     return &params_;
   }
 };
+
+// Threads that help HnswlibAdapter::AddBatch insert vectors in parallel. The pool is shared by
+// all indices, so the number of extra threads competing with shard threads stays bounded by the
+// largest requested number of helpers. Threads are started lazily.
+class HnswBuildPool {
+ public:
+  static HnswBuildPool& Instance() {
+    static HnswBuildPool pool;
+    return pool;
+  }
+
+  ~HnswBuildPool() {
+    {
+      std::lock_guard lk(mu_);
+      stopped_ = true;
+    }
+    job_cv_.notify_all();
+    for (auto& thread : threads_)
+      thread.join();
+  }
+
+  // Calls fn(i) for all i in [0, n) on the calling thread and up to `num_helpers` pool threads.
+  // Returns once all calls finished. The calling thread always takes part, so the work
+  // progresses even if all pool threads are busy with batches of other callers.
+  void ParallelFor(size_t n, size_t num_helpers, absl::FunctionRef<void(size_t)> fn) {
+    num_helpers = std::min({num_helpers, kMaxThreads, n > 0 ? n - 1 : 0});
+    Job job{fn, n};
+
+    if (num_helpers > 0) {
+      std::lock_guard lk(mu_);
+      while (threads_.size() < num_helpers)
+        threads_.emplace_back([this] { RunHelper(); });
+      job.free_slots = num_helpers;
+      jobs_.push_back(&job);
+    }
+    if (num_helpers > 0)
+      job_cv_.notify_all();
+
+    job.Work();
+
+    if (num_helpers > 0) {
+      std::unique_lock lk(mu_);
+      if (auto it = std::find(jobs_.begin(), jobs_.end(), &job); it != jobs_.end())
+        jobs_.erase(it);
+      done_cv_.wait(lk, [&job] { return job.active == 0; });
+    }
+  }
+
+ private:
+  static constexpr size_t kMaxThreads = 64;
+
+  struct Job {
+    Job(absl::FunctionRef<void(size_t)> fn, size_t n) : fn{fn}, n{n} {
+    }
+
+    void Work() {
+      for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1))
+        fn(i);
+    }
+
+    absl::FunctionRef<void(size_t)> fn;
+    size_t n;
+    std::atomic<size_t> next = 0;
+
+    // Guarded by mu_
+    size_t free_slots = 0;  // Number of helpers that can still join
+    size_t active = 0;      // Number of helpers working on the job
+  };
+
+  void RunHelper() {
+    std::unique_lock lk(mu_);
+    while (true) {
+      job_cv_.wait(lk, [this] { return stopped_ || !jobs_.empty(); });
+      if (stopped_)
+        return;
+
+      // jobs_ contains only jobs with free slots
+      Job* job = jobs_.front();
+      if (--job->free_slots == 0)
+        jobs_.pop_front();
+      job->active++;
+
+      lk.unlock();
+      job->Work();
+      lk.lock();
+
+      if (--job->active == 0)
+        done_cv_.notify_all();
+    }
+  }
+
+  std::mutex mu_;
+  std::condition_variable job_cv_, done_cv_;
+  std::deque<Job*> jobs_;
+  std::vector<std::thread> threads_;
+  bool stopped_ = false;
+};
+
+const void* GetVectorData(const DocumentAccessor::VectorInfo& info) {
+  if (std::holds_alternative<OwnedFtVector>(info))
+    return std::get<OwnedFtVector>(info).first.get();
+  return std::get<BorrowedFtVector>(info);
+}
+
 }  // namespace
 
 // TODO: to replace it and use HierarchicalNSW directly.
@@ -84,12 +202,40 @@ struct HnswlibAdapter {
     DoRemove(id);
   }
 
+  // hnswlib inserts are thread safe, so the batch is spread over helper threads. The write lock
+  // is shared with concurrent writers, only readers are blocked.
+  void AddBatch(const HnswBatch& batch, size_t num_helpers) {
+    MRMWMutexLock lock(&mrmw_mutex_, MRMWMutex::LockMode::kWriteLock);
+    Reserve(batch.size());
+    HnswBuildPool::Instance().ParallelFor(batch.size(), num_helpers, [&](size_t i) {
+      DoAdd(batch.vectors[i].second, batch.vectors[i].first);
+    });
+  }
+
   vector<pair<float, GlobalDocId>> Knn(const void* target, size_t k, std::optional<uint32_t> ef) {
     uint32_t ef_runtime = ef.value_or(ef_runtime_);
     MRMWMutexLock lock(&mrmw_mutex_, MRMWMutex::LockMode::kReadLock);
     return QueueToVec(world_.searchKnnWithEf(target, k, nullptr, ef_runtime));
   }
 
+  vector<vector<pair<float, GlobalDocId>>> KnnBatch(absl::Span<const void* const> targets,
+                                                     size_t k, std::optional<uint32_t> ef) {
+    uint32_t ef_runtime = ef.value_or(ef_runtime_);
+    auto dist_many = [this](const void* v, const void* const* queries, size_t n, float* out) {
+      space_.DistanceToMany(v, queries, n, out);
+    };
+
+    MRMWMutexLock lock(&mrmw_mutex_, MRMWMutex::LockMode::kReadLock);
+    auto queues = world_.searchKnnBatchWithEf(targets.data(), targets.size(), k, ef_runtime,
+                                              dist_many);
+
+    vector<vector<pair<float, GlobalDocId>>> results;
+    results.reserve(queues.size());
+    for (auto& queue : queues)
+      results.push_back(QueueToVec(std::move(queue)));
+    return results;
+  }
+
   vector<pair<float, GlobalDocId>> Knn(const void* target, size_t k, std::optional<uint32_t> ef,
                                        const vector<GlobalDocId>& allowed) {
     struct BinsearchFilter : hnswlib::BaseFilterFunctor {
@@ -143,6 +289,10 @@ struct HnswlibAdapter {
     return world_.cur_element_count.load();
   }
 
+  uint32_t GetEfRuntime() const {
+    return ef_runtime_;
+  }
+
   std::vector<HnswNodeData> GetNodesRange(size_t start, size_t end) const {
     DCHECK(mrmw_mutex_.IsReadLocked());
     size_t count = world_.cur_element_count.load();
@@ -228,6 +378,22 @@ struct HnswlibAdapter {
     }
   }
 
+  // Grow capacity once for `extra` new elements instead of doubling it repeatedly while
+  // inserting them.
+  void Reserve(size_t extra) {
+    try {
+      absl::WriterMutexLock lock(&resize_mutex_);
+      size_t needed = world_.getCurrentElementCount() + extra;
+      size_t max_elements = world_.getMaxElements();
+      if (needed > max_elements) {
+        world_.resizeIndex(std::max(needed, max_elements * 2));
+        VLOG(1) << "Resizing HNSW Index from " << max_elements << " for " << extra << " elements";
+      }
+    } catch (const std::exception& e) {
+      LOG(FATAL) << "HnswlibAdapter::Reserve exception: " << e.what();
+    }
+  }
+
   // Function requires that we hold mutex while resizing index. resizeIndex is not thread safe with
   // insertion (https://github.com/nmslib/hnswlib/issues/267)
   void ResizeIfFull() {
@@ -465,13 +631,7 @@ bool HnswVectorIndex::Add(GlobalDocId id, const DocumentAccessor& doc, std::stri
     return false;
   }
 
-  const void* data = nullptr;
-  if (std::holds_alternative<OwnedFtVector>(*vector_ptr)) {
-    data = std::get<OwnedFtVector>(*vector_ptr).first.get();
-  } else {
-    data = std::get<BorrowedFtVector>(*vector_ptr);
-  }
-
+  const void* data = GetVectorData(*vector_ptr);
   if (!data) {
     return false;
   }
@@ -480,11 +640,37 @@ bool HnswVectorIndex::Add(GlobalDocId id, const DocumentAccessor& doc, std::stri
   return true;
 }
 
+bool HnswVectorIndex::Collect(GlobalDocId id, const DocumentAccessor& doc, std::string_view field,
+                              HnswBatch* batch) const {
+  auto vector_ptr = doc.GetVector(field, dim_, data_type_);
+  if (!vector_ptr)
+    return false;
+
+  const void* data = GetVectorData(*vector_ptr);
+  if (!data)
+    return false;
+
+  if (auto* owned = std::get_if<OwnedFtVector>(&*vector_ptr))
+    batch->owned.push_back(std::move(owned->first));
+  batch->vectors.emplace_back(id, data);
+  return true;
+}
+
+void HnswVectorIndex::AddBatch(const HnswBatch& batch, size_t num_helpers) {
+  if (!batch.empty())
+    adapter_->AddBatch(batch, num_helpers);
+}
+
 std::vector<std::pair<float, GlobalDocId>> HnswVectorIndex::Knn(const void* target, size_t k,
                                                                 std::optional<uint32_t> ef) const {
   return adapter_->Knn(target, k, ef);
 }
 
+std::vector<std::vector<std::pair<float, GlobalDocId>>> HnswVectorIndex::KnnBatch(
+    absl::Span<const void* const> targets, size_t k, std::optional<uint32_t> ef) const {
+  return adapter_->KnnBatch(targets, k, ef);
+}
+
 std::vector<std::pair<float, GlobalDocId>> HnswVectorIndex::Knn(
     const void* target, size_t k, std::optional<uint32_t> ef,
     const std::vector<GlobalDocId>& allowed) const {
@@ -496,6 +682,19 @@ std::vector<std::pair<float, GlobalDocId>> HnswVectorIndex::SubsetKnn(
   return adapter_->SubsetKnn(target, k, docs);
 }
 
+bool HnswVectorIndex::PreferSubsetKnn(size_t num_allowed, size_t k,
+                                      std::optional<uint32_t> ef) const {
+  size_t num_nodes = GetNodeCount();
+  if (num_allowed == 0 || num_allowed >= num_nodes)
+    return num_allowed == 0;
+
+  // Subset search computes num_allowed distances, graph search about
+  // max(ef, k) * log2(N) / selectivity, with selectivity = num_allowed / N
+  double breadth = std::max<double>(ef.value_or(adapter_->GetEfRuntime()), k);
+  double graph_cost = breadth * std::log2(double(num_nodes)) * num_nodes / num_allowed;
+  return double(num_allowed) <= graph_cost;
+}
+
 std::vector<std::pair<float, GlobalDocId>> HnswVectorIndex::RangeQuery(
     const void* target, float radius, std::optional<double> epsilon) const {
   return adapter_->RangeSearch(target, radius, epsilon);
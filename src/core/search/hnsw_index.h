@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <absl/types/span.h>
+
 #include <memory>
 
 #include "core/search/mrmw_mutex.h"
@@ -38,6 +40,25 @@ struct HnswNodeData {
   }
 };
 
+// Vectors of several documents collected for HnswVectorIndex::AddBatch
+struct HnswBatch {
+  size_t size() const {
+    return vectors.size();
+  }
+
+  bool empty() const {
+    return vectors.empty();
+  }
+
+  void clear() {
+    vectors.clear();
+    owned.clear();
+  }
+
+  std::vector<std::pair<GlobalDocId, const void*>> vectors;
+  std::vector<std::unique_ptr<std::byte[]>> owned;  // Storage of vectors that were not borrowed
+};
+
 struct HnswlibAdapter;
 class HnswVectorIndex {
  public:
@@ -50,6 +71,14 @@ class HnswVectorIndex {
 
   void Remove(search::GlobalDocId id);
 
+  // Appends the vector of `doc` to `batch` for a later AddBatch. Returns false if it has none.
+  bool Collect(search::GlobalDocId id, const search::DocumentAccessor& doc, std::string_view field,
+               HnswBatch* batch) const;
+
+  // Inserts all vectors of `batch`, in parallel on the calling thread and up to `num_helpers`
+  // threads of a process wide build pool. Blocks the calling thread until all are inserted.
+  void AddBatch(const HnswBatch& batch, size_t num_helpers);
+
   bool IsVectorCopied() const {
     return copy_vector_;
   }
@@ -59,9 +88,19 @@ class HnswVectorIndex {
   std::vector<std::pair<float, GlobalDocId>> Knn(const void* target, size_t k,
                                                  std::optional<uint32_t> ef,
                                                  const std::vector<GlobalDocId>& allowed) const;
+
+  // Knn for several targets at once, returns the same results as separate Knn calls. The
+  // traversal of the upper graph layers is shared by targets that pass the same nodes.
+  std::vector<std::vector<std::pair<float, GlobalDocId>>> KnnBatch(
+      absl::Span<const void* const> targets, size_t k, std::optional<uint32_t> ef) const;
   std::vector<std::pair<float, GlobalDocId>> SubsetKnn(const void* target, size_t k,
                                                        const std::vector<GlobalDocId>& docs) const;
 
+  // Cost model for filtered KNN: true if brute force SubsetKnn over `num_allowed` documents is
+  // expected to be cheaper than a filtered graph search. The graph search has to expand about
+  // max(ef, k) / selectivity nodes per layer to collect enough allowed results.
+  bool PreferSubsetKnn(size_t num_allowed, size_t k, std::optional<uint32_t> ef) const;
+
   // Returns all documents within radius, with their distances.
   std::vector<std::pair<float, GlobalDocId>> RangeQuery(const void* target, float radius,
                                                         std::optional<double> epsilon) const;
@@ -4,11 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <variant>
 #include <vector>
 
 #include "core/search/ast_expr.h"
 #include "core/search/block_list.h"
+#include "core/search/doc_bitmap.h"
 #include "core/search/range_tree.h"
 
 namespace dfly::search {
@@ -18,13 +20,14 @@ class IndexResult {
  private:
   using DocVec = std::vector<DocId>;
   using Variant =
-      std::variant<DocVec /*owned*/, const DocVec*, const BlockList<CompressedSortedSet>*,
-                   const BlockList<SortedVector<DocId>>*, RangeResult>;
+      std::variant<DocVec /*owned*/, DocBitmap /*owned*/, const DocVec*,
+                   const BlockList<CompressedSortedSet>*, const BlockList<SortedVector<DocId>>*,
+                   const DocBitmap*, RangeResult>;
 
   template <typename... Ts> using VariantOfConstPtrs = std::variant<const Ts*...>;
   using BorrowedView =
       VariantOfConstPtrs<DocVec, BlockList<CompressedSortedSet>, BlockList<SortedVector<DocId>>,
-                         SingleBlockRangeResult, TwoBlocksRangeResult>;
+                         DocBitmap, SingleBlockRangeResult, TwoBlocksRangeResult>;
 
  public:
   IndexResult() = default;
@@ -39,6 +42,16 @@ class IndexResult {
 
   BorrowedView Borrowed() const;
 
+  // Owned or borrowed bitmap if the result is stored as one, nullptr otherwise
+  const DocBitmap* GetBitmap() const;
+
+  // True if the result knows its exact size and can be probed with Contains(). Owned vectors are
+  // excluded, because top level results of KNN or GEO queries are not sorted.
+  bool CanProbe() const;
+
+  // Whether `id` is part of the result. Requires CanProbe().
+  bool Contains(DocId id) const;
+
   // Move out of owned or copy borrowed. Take up to `limit` entries and return original size.
   std::pair<DocVec, size_t /* full size */> Take(size_t limit = std::numeric_limits<size_t>::max());
 
@@ -48,8 +61,9 @@ class IndexResult {
   Variant value_;
 };
 
-std::vector<DocId> MergeIndexResults(const IndexResult& left, const IndexResult& right,
-                                     AstLogicalNode::LogicOp op);
+// Bitmaps are merged word by word into a bitmap, other results into a sorted vector
+IndexResult MergeIndexResults(const IndexResult& left, const IndexResult& right,
+                              AstLogicalNode::LogicOp op);
 
 // Implementation
 /******************************************************************/
@@ -116,6 +130,38 @@ inline std::pair<IndexResult::DocVec, size_t> IndexResult::Take(size_t limit) {
   return std::visit(cb, Borrowed());
 }
 
+inline const DocBitmap* IndexResult::GetBitmap() const {
+  if (const auto* bitmap = std::get_if<DocBitmap>(&value_); bitmap)
+    return bitmap;
+  if (const auto* bitmap = std::get_if<const DocBitmap*>(&value_); bitmap)
+    return *bitmap;
+  return nullptr;
+}
+
+inline bool IndexResult::CanProbe() const {
+  return !IsOwned() && !std::holds_alternative<RangeResult>(value_);
+}
+
+inline bool IndexResult::Contains(DocId id) const {
+  DCHECK(CanProbe());
+  auto cb = [id](auto* set) {
+    using T = std::decay_t<decltype(*set)>;
+    if constexpr (std::is_same_v<T, DocBitmap>) {
+      return set->Contains(id);
+    } else if constexpr (std::is_same_v<T, DocVec>) {
+      return std::binary_search(set->begin(), set->end(), id);
+    } else if constexpr (std::is_same_v<T, BlockList<CompressedSortedSet>> ||
+                         std::is_same_v<T, BlockList<SortedVector<DocId>>>) {
+      auto it = set->begin();
+      it.SeekGE(id);
+      return it != set->end() && *it == id;
+    } else {
+      return false;  // range results can't be probed
+    }
+  };
+  return std::visit(cb, Borrowed());
+}
+
 inline bool IndexResult::IsOwned() const {
   return std::holds_alternative<DocVec>(value_);
 }
@@ -181,8 +227,45 @@ void SetIntersection(FirstIterator first_begin, FirstIterator first_end,
 
 }  // namespace details
 
-inline std::vector<DocId> MergeIndexResults(const IndexResult& left, const IndexResult& right,
-                                            AstLogicalNode::LogicOp op) {
+inline IndexResult MergeIndexResults(const IndexResult& left, const IndexResult& right,
+                                     AstLogicalNode::LogicOp op) {
+  const DocBitmap* left_bitmap = left.GetBitmap();
+  const DocBitmap* right_bitmap = right.GetBitmap();
+  if (left_bitmap || right_bitmap) {
+    const DocBitmap& bitmap = left_bitmap ? *left_bitmap : *right_bitmap;
+    const IndexResult& other = left_bitmap ? right : left;
+
+    if (op == AstLogicalNode::LogicOp::AND) {
+      if (const DocBitmap* other_bitmap = other.GetBitmap(); other_bitmap) {
+        DocBitmap result = bitmap;
+        result.And(*other_bitmap);
+        return IndexResult{std::move(result)};
+      }
+
+      // Probing the bitmap is cheaper than seeking in it
+      std::vector<DocId> result;
+      result.reserve(std::min(bitmap.size(), other.ApproximateSize()));
+      auto cb = [&](auto* set) {
+        for (DocId id : *set) {
+          if (bitmap.Contains(id))
+            result.push_back(id);
+        }
+      };
+      std::visit(cb, other.Borrowed());
+      return IndexResult{std::move(result)};
+    }
+
+    // The union of a dense set with anything is dense as well
+    DocBitmap result = bitmap;
+    if (const DocBitmap* other_bitmap = other.GetBitmap(); other_bitmap) {
+      result.Or(*other_bitmap);
+    } else {
+      std::visit([&result](auto* set) { result.Insert(set->begin(), set->end()); },
+                 other.Borrowed());
+    }
+    return IndexResult{std::move(result)};
+  }
+
   std::vector<DocId> result;
 
   if (op == AstLogicalNode::LogicOp::AND) {
@@ -200,7 +283,7 @@ inline std::vector<DocId> MergeIndexResults(const IndexResult& left, const Index
     std::visit(cb, left.Borrowed(), right.Borrowed());
   }
 
-  return result;
+  return IndexResult{std::move(result)};
 }
 
 }  // namespace dfly::search
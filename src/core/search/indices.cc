@@ -7,11 +7,13 @@
 #include <absl/cleanup/cleanup.h>
 #include <absl/container/flat_hash_set.h>
 #include <absl/strings/ascii.h>
+#include <absl/strings/match.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 
 #include <boost/iterator/function_output_iterator.hpp>
+#include <hnswlib/hnswlib.h>
 #include <string_view>
 
 #define UNI_ALGO_DISABLE_NFKC_NFKD
@@ -22,8 +24,12 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cmath>
 
 #include "base/flags.h"
+#include "base/logging.h"
+#include "core/search/hnsw_alg.h"
+#include "core/search/vector_utils.h"
 
 namespace rng = std::ranges;
 
@@ -335,6 +341,15 @@ class RangeTreeAdapter : public NumericIndex::RangeTreeBase {
     return range_tree_.Range(l, r);
   }
 
+  size_t EstimateRange(double l, double r) const override {
+    return range_tree_.EstimateRange(l, r);
+  }
+
+  vector<DocId> FilterRange(absl::Span<const DocId> candidates, double l,
+                            double r) const override {
+    return range_tree_.FilterRange(candidates, l, r);
+  }
+
   vector<DocId> GetAllDocIds() const override {
     // TODO: remove take
     return range_tree_.GetAllDocIds().Take();
@@ -389,6 +404,22 @@ class BtreeSetImpl : public NumericIndex::RangeTreeBase {
     return RangeResult(std::move(out));
   }
 
+  size_t EstimateRange(double l, double r) const override {
+    DCHECK(l <= r);
+    auto it_l = entries_.lower_bound({l, 0});
+    auto it_r = entries_.lower_bound({r, numeric_limits<DocId>::max()});
+    return it_r - it_l;
+  }
+
+  vector<DocId> FilterRange(absl::Span<const DocId> candidates, double l,
+                            double r) const override {
+    // Entries are ordered by value, so there is no cheaper way than intersecting with the range
+    vector<DocId> matches = Range(l, r).Take();
+    vector<DocId> out;
+    rng::set_intersection(candidates, matches, back_inserter(out));
+    return out;
+  }
+
   vector<DocId> GetAllDocIds() const override {
     std::vector<DocId> result;
 
@@ -453,6 +484,19 @@ RangeResult NumericIndex::Range(double l, double r) const {
   return range_tree_->Range(l, r);
 }
 
+size_t NumericIndex::EstimateRange(double l, double r) const {
+  if (r < l)
+    return 0;
+  return range_tree_->EstimateRange(l, r);
+}
+
+vector<DocId> NumericIndex::FilterRange(absl::Span<const DocId> candidates, double l,
+                                        double r) const {
+  if (r < l)
+    return {};
+  return range_tree_->FilterRange(candidates, l, r);
+}
+
 vector<DocId> NumericIndex::GetAllDocsWithNonNullValues() const {
   return range_tree_->GetAllDocIds();
 }
@@ -665,6 +709,8 @@ bool BaseStringIndex<C>::Add(DocId id, const DocumentAccessor& doc, string_view
                        [&](string_view str) { GetOrCreate(&*suffix_trie_, str)->Insert(id); });
   }
 
+  OnTokensUpdated(id, tokens, true);
+
   return true;
 }
 
@@ -696,6 +742,8 @@ void BaseStringIndex<C>::Remove(DocId id, const DocumentAccessor& doc, string_vi
       token_keys.insert(token);
     IterateAllSuffixes(token_keys, [&](string_view str) { Remove(&*suffix_trie_, id, str); });
   }
+
+  OnTokensUpdated(id, tokens, false);
 }
 
 template <typename C> vector<string> BaseStringIndex<C>::GetTerms() const {
@@ -842,6 +890,50 @@ std::vector<std::string> TextIndex::TokenizePhraseQuery(std::string_view phrase)
   return out;
 }
 
+void TagIndex::OnTokensUpdated(DocId id, const absl::flat_hash_map<std::string, TermInfo>& tags,
+                               bool added) {
+  if (added)
+    max_doc_id_ = max(max_doc_id_, id);
+  else if (bitmaps_.empty())
+    return;
+
+  for (const auto& [tag, _] : tags)
+    UpdateBitmap(tag, id, added);
+}
+
+const DocBitmap* TagIndex::MatchingBitmap(std::string_view tag) const {
+  if (bitmaps_.empty())
+    return nullptr;
+
+  auto it = bitmaps_.find(NormalizeForExactQuery(tag).view());
+  return it != bitmaps_.end() ? &it->second : nullptr;
+}
+
+void TagIndex::UpdateBitmap(std::string_view tag, DocId id, bool added) {
+  auto entry = entries_.find(tag);
+  const size_t size = entry != entries_.end() ? entry->second.Size() : 0;
+  const size_t bitmap_bytes = (size_t(max_doc_id_) + 8) / 8;
+  const size_t list_bytes = size * sizeof(DocId);
+
+  if (auto it = bitmaps_.find(tag); it != bitmaps_.end()) {
+    if (size < kMinBitmapSize / 2 || bitmap_bytes * kBitmapDensity > list_bytes * 2) {
+      bitmaps_.erase(it);
+      return;
+    }
+
+    if (added)
+      it->second.Insert(id);
+    else
+      it->second.Remove(id);
+    return;
+  }
+
+  if (added && size >= kMinBitmapSize && bitmap_bytes * kBitmapDensity <= list_bytes) {
+    auto* mr = entries_.get_allocator().resource();
+    bitmaps_.emplace(tag, DocBitmap{entry->second.begin(), entry->second.end(), mr});
+  }
+}
+
 DefragmentResult TagIndex::Defragment(PageUsage* page_usage) {
   auto defrag = [&](auto& tree, string* key) {
     DefragmentMap dm{tree, key};
@@ -934,6 +1026,228 @@ std::vector<DocId> FlatVectorIndex::GetAllDocsWithNonNullValues() const {
   return result;
 }
 
+namespace {
+
+// Keeps full precision vectors in memory, used when no other store is set
+struct QuantRange {
+  float min, scale;  // element i is approximately min + code[i] * scale
+};
+
+void Dequantize(const char* entry, size_t dim, float* out) {
+  QuantRange range;
+  memcpy(&range, entry, sizeof(range));
+  const auto* codes = reinterpret_cast<const uint8_t*>(entry + sizeof(range));
+  for (size_t i = 0; i < dim; i++)
+    out[i] = range.min + codes[i] * range.scale;
+}
+
+class MemoryVectorStore : public VectorStore {
+ public:
+  MemoryVectorStore(size_t vector_size, PMR_NS::memory_resource* mr)
+      : vector_size_{vector_size}, entries_{mr}, present_{mr} {
+  }
+
+  void Add(DocId id, const void* vector) override {
+    if (present_.size() <= id) {
+      entries_.resize((static_cast<size_t>(id) + 1) * vector_size_);
+      present_.resize(id + 1, false);
+    }
+    present_[id] = true;
+    memcpy(entries_.data() + static_cast<size_t>(id) * vector_size_, vector, vector_size_);
+  }
+
+  void Remove(DocId id) override {
+    if (id < present_.size())
+      present_[id] = false;
+  }
+
+  void Fetch(absl::Span<const DocId> ids, absl::FunctionRef<void(DocId, const void*)> cb) override {
+    for (DocId id : ids) {
+      if (id < present_.size() && present_[id])
+        cb(id, entries_.data() + static_cast<size_t>(id) * vector_size_);
+    }
+  }
+
+ private:
+  size_t vector_size_;
+  PMR_NS::vector<std::byte> entries_;
+  PMR_NS::vector<bool> present_;
+};
+
+}  // namespace
+
+// Distance between two graph entries of CompressedVectorIndex, decoded to float.
+class CompressedVectorIndex::QuantizedSpace : public hnswlib::SpaceInterface<float> {
+  struct DistParams {
+    size_t dim;  // must stay first: hnsw_alg.h reads *((size_t*)dist_func_param_) as dim
+    VectorSimilarity sim;
+  };
+  DistParams params_;
+
+  static float DistStatic(const void* pVect1, const void* pVect2, const void* param) {
+    const auto* p = static_cast<const DistParams*>(param);
+    thread_local std::vector<float> u, v;
+    u.resize(p->dim);
+    v.resize(p->dim);
+    Dequantize(static_cast<const char*>(pVect1), p->dim, u.data());
+    Dequantize(static_cast<const char*>(pVect2), p->dim, v.data());
+    return VectorDistance(u.data(), v.data(), p->dim, p->sim);
+  }
+
+ public:
+  QuantizedSpace(size_t dim, VectorSimilarity sim) : params_{dim, sim} {
+  }
+
+  size_t get_data_size() {
+    return sizeof(QuantRange) + params_.dim;
+  }
+
+  hnswlib::DISTFUNC<float> get_dist_func() {
+    return DistStatic;
+  }
+
+  void* get_dist_func_param() {
+    return &params_;
+  }
+};
+
+CompressedVectorIndex::CompressedVectorIndex(const SchemaField::VectorParams& params,
+                                             PMR_NS::memory_resource* mr)
+    : BaseVectorIndex{params.dim, params.sim, params.data_type},
+      ef_runtime_{params.hnsw_ef_runtime},
+      present_{mr},
+      space_{make_unique<QuantizedSpace>(params.dim, params.sim)},
+      graph_{make_unique<HierarchicalNSW<float>>(space_.get(), max<size_t>(params.capacity, 1),
+                                                 params.hnsw_m, params.hnsw_ef_construction)},
+      store_{make_unique<MemoryVectorStore>(params.dim * ElementSize(params.data_type), mr)},
+      decoded_(params.dim),
+      entry_(sizeof(QuantRange) + params.dim, '\0') {
+  DCHECK(params.use_disk);
+  present_.reserve(params.capacity);
+}
+
+CompressedVectorIndex::~CompressedVectorIndex() {
+}
+
+void CompressedVectorIndex::SetStore(std::unique_ptr<VectorStore> store) {
+  DCHECK(rng::none_of(present_, [](bool present) { return present; }));
+  store_ = std::move(store);
+}
+
+void CompressedVectorIndex::Quantize(const float* values, char* entry) const {
+  auto [min_it, max_it] = minmax_element(values, values + dim_);
+  QuantRange range{*min_it, (*max_it - *min_it) / 255};
+  memcpy(entry, &range, sizeof(range));
+
+  auto* codes = reinterpret_cast<uint8_t*>(entry + sizeof(range));
+  for (size_t i = 0; i < dim_; i++) {
+    float code = range.scale > 0 ? (values[i] - range.min) / range.scale : 0;
+    codes[i] = static_cast<uint8_t>(lround(code));
+  }
+}
+
+void CompressedVectorIndex::AddVector(DocId id, const void* vector) {
+  if (!vector)
+    return;
+
+  // Grow, never shrink: DocIds are recycled, see FlatVectorIndex::AddVector
+  if (present_.size() <= id)
+    present_.resize(id + 1, false);
+
+  // Scalar quantization with the value range of this vector. A recycled DocId updates its
+  // graph node in place.
+  ToFloatVector(vector, dim_, data_type_, decoded_.data());
+  Quantize(decoded_.data(), entry_.data());
+  while (true) {
+    try {
+      graph_->addPoint(entry_.data(), id);
+      break;
+    } catch (const std::exception& e) {
+      if (!absl::StrContains(e.what(), "The number of elements exceeds the specified limit")) {
+        LOG(ERROR) << "CompressedVectorIndex::AddVector exception: " << e.what();
+        return;
+      }
+      graph_->resizeIndex(graph_->getMaxElements() * 2);
+    }
+  }
+
+  present_[id] = true;
+  store_->Add(id, vector);
+}
+
+void CompressedVectorIndex::Remove(DocId id, const DocumentAccessor& doc, string_view field) {
+  if (id < present_.size() && present_[id]) {
+    present_[id] = false;
+    graph_->markDelete(id);
+    store_->Remove(id);
+  }
+}
+
+std::vector<DocId> CompressedVectorIndex::GetAllDocsWithNonNullValues() const {
+  std::vector<DocId> result;
+  for (size_t id = 0; id < present_.size(); ++id) {
+    if (present_[id])
+      result.push_back(static_cast<DocId>(id));
+  }
+  return result;
+}
+
+std::vector<float> CompressedVectorIndex::PrepareQuery(const void* target) const {
+  std::vector<float> query(dim_);
+  ToFloatVector(target, dim_, data_type_, query.data());
+  return query;
+}
+
+std::optional<float> CompressedVectorIndex::ApproxDistance(absl::Span<const float> query,
+                                                           DocId id) const {
+  if (id >= present_.size() || !present_[id])
+    return std::nullopt;
+
+  auto it = graph_->label_lookup_.find(id);
+  DCHECK(it != graph_->label_lookup_.end());
+  Dequantize(graph_->getDataByInternalId(it->second), dim_, decoded_.data());
+  return VectorDistance(query.data(), decoded_.data(), dim_, sim_);
+}
+
+std::vector<std::pair<float, DocId>> CompressedVectorIndex::GraphKnn(
+    absl::Span<const float> query, size_t k, std::optional<uint32_t> ef) const {
+  // The graph compares quantized entries, so the query is quantized as well
+  Quantize(query.data(), entry_.data());
+  uint32_t ef_runtime = max<uint32_t>(ef.value_or(ef_runtime_), k);
+  auto queue = graph_->searchKnnWithEf(entry_.data(), k, nullptr, ef_runtime);
+
+  std::vector<std::pair<float, DocId>> out;
+  out.reserve(queue.size());
+  for (; !queue.empty(); queue.pop())
+    out.emplace_back(queue.top().first, static_cast<DocId>(queue.top().second));
+  return out;
+}
+
+std::vector<std::pair<float, DocId>> CompressedVectorIndex::Rerank(
+    const void* target, size_t limit, std::vector<std::pair<float, DocId>> candidates) {
+  size_t num_candidates = candidates.size();
+  if (limit < num_candidates / kRerankFactor)
+    num_candidates = limit * kRerankFactor;
+  partial_sort(candidates.begin(), candidates.begin() + num_candidates, candidates.end());
+
+  // Sorted ids let the store read neighboring vectors together
+  std::vector<DocId> ids(num_candidates);
+  for (size_t i = 0; i < num_candidates; i++)
+    ids[i] = candidates[i].second;
+  sort(ids.begin(), ids.end());
+
+  std::vector<std::pair<float, DocId>> out;
+  out.reserve(num_candidates);
+  store_->Fetch(ids, [&](DocId id, const void* vector) {
+    out.emplace_back(VectorDistance(target, vector, dim_, sim_, data_type_), id);
+  });
+
+  size_t prefix_size = min(limit, out.size());
+  partial_sort(out.begin(), out.begin() + prefix_size, out.end());
+  out.resize(prefix_size);
+  return out;
+}
+
 GeoIndex::GeoIndex(PMR_NS::memory_resource* mr) : rtree_(make_unique<rtree>()) {
 }
 
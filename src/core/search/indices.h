@@ -18,11 +18,13 @@
 #endif
 
 #include <absl/functional/function_ref.h>
+#include <absl/types/span.h>
 
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "base/pmr/memory_resource.h"
@@ -30,6 +32,7 @@
 #include "core/search/base.h"
 #include "core/search/block_list.h"
 #include "core/search/compressed_sorted_set.h"
+#include "core/search/doc_bitmap.h"
 #include "core/search/range_tree.h"
 #include "core/search/rax_tree.h"
 #include "core/search/stemmer.h"
@@ -60,6 +63,13 @@ struct NumericIndex : public BaseIndex {
     // Returns all DocIds that match the range [l, r].
     virtual RangeResult Range(double l, double r) const = 0;
 
+    // Estimated number of entries in the range [l, r], used for query planning.
+    virtual size_t EstimateRange(double l, double r) const = 0;
+
+    // Returns the sorted subset of the sorted `candidates` that match the range [l, r].
+    virtual std::vector<DocId> FilterRange(absl::Span<const DocId> candidates, double l,
+                                           double r) const = 0;
+
     // Returns all DocIds that have non-null values in the index.
     virtual std::vector<DocId> GetAllDocIds() const = 0;
 
@@ -79,6 +89,13 @@ struct NumericIndex : public BaseIndex {
 
   RangeResult Range(double l, double r) const;
 
+  // Cardinality estimate of Range(l, r), cheap enough to be computed while planning a query.
+  size_t EstimateRange(double l, double r) const;
+
+  // Applies the range as a post-filter to already selected candidates. Cheaper than
+  // intersecting with Range(l, r) when there are far fewer candidates than matches.
+  std::vector<DocId> FilterRange(absl::Span<const DocId> candidates, double l, double r) const;
+
   std::vector<DocId> GetAllDocsWithNonNullValues() const override;
 
  private:
@@ -185,6 +202,11 @@ template <typename C> struct BaseStringIndex : public BaseIndex {
   virtual void Tokenize(std::string_view value, uint32_t* pos_counter,
                         absl::flat_hash_map<std::string, TermInfo>* out) const = 0;
 
+  // Called by Add & Remove after the tokens of document `id` were added or removed.
+  virtual void OnTokensUpdated(DocId id, const absl::flat_hash_map<std::string, TermInfo>& tokens,
+                               bool added) {
+  }
+
   cmn::StringOrView NormalizeQueryWord(std::string_view word) const;
   cmn::StringOrView NormalizeForExactQuery(std::string_view word) const;
   static Container* GetOrCreate(search::RaxTreeMap<Container>* map, std::string_view word,
@@ -256,6 +278,10 @@ struct TagIndex : public BaseStringIndex<SortedVector<DocId>> {
         separator_{params.separator} {
   }
 
+  // Bitmap of the documents with `tag` if the tag is dense enough to keep one, nullptr otherwise.
+  // Pointer is valid as long as index is not mutated.
+  const DocBitmap* MatchingBitmap(std::string_view tag) const;
+
   DefragmentResult Defragment(PageUsage* page_usage) override;
 
  protected:
@@ -263,11 +289,25 @@ struct TagIndex : public BaseStringIndex<SortedVector<DocId>> {
                                        std::string_view field) const override;
   void Tokenize(std::string_view value, uint32_t* pos_counter,
                 absl::flat_hash_map<std::string, TermInfo>* out) const override;
+  void OnTokensUpdated(DocId id, const absl::flat_hash_map<std::string, TermInfo>& tokens,
+                       bool added) override;
 
  private:
+  // Dense tags (like statuses or categories) get a bitmap next to their posting list once it
+  // takes at most 1 / kBitmapDensity of the list's memory, so that boolean operations on them
+  // run over bitmap words. The bitmap is dropped when it grows twice as large as that.
+  static constexpr size_t kBitmapDensity = 8;
+  static constexpr size_t kMinBitmapSize = 4096;  // Smaller lists are merged quickly anyway
+
+  // Adds or drops the bitmap of `tag` after document `id` was added to or removed from it
+  void UpdateBitmap(std::string_view tag, DocId id, bool added);
+
   char separator_;
   std::string next_defrag_entry_;
   std::string next_defrag_suffix_entry_;
+
+  absl::flat_hash_map<std::string, DocBitmap> bitmaps_;
+  DocId max_doc_id_ = 0;  // Bitmaps take max_doc_id_ / 8 bytes
 };
 
 struct VectorIndexInfo {
@@ -313,6 +353,73 @@ struct FlatVectorIndex : public BaseVectorIndex {
   PMR_NS::vector<bool> present_;       // presence flag per doc (bit-packed)
 };
 
+// Storage for the full precision vectors of CompressedVectorIndex. The default one keeps them in
+// memory, the server provides one that keeps them on disk.
+struct VectorStore {
+  virtual ~VectorStore() = default;
+
+  virtual void Add(DocId id, const void* vector) = 0;
+  virtual void Remove(DocId id) = 0;
+
+  // Reads the vectors of `ids` and calls `cb` for every one that was found. All reads are issued
+  // at once, the calling fiber can be suspended until they complete.
+  virtual void Fetch(absl::Span<const DocId> ids,
+                     absl::FunctionRef<void(DocId, const void*)> cb) = 0;
+};
+
+template <typename dist_t> class HierarchicalNSW;
+
+// Vector index for corpora that don't fit into memory. Only vectors quantized to one byte per
+// element are kept in memory, linked into an HNSW graph, full precision vectors are kept in a
+// VectorStore. KNN queries take candidates by approximate distance and re-rank the best ones
+// with exact distances.
+struct CompressedVectorIndex : public BaseVectorIndex {
+  // Number of candidates per requested result that are re-ranked with exact distances
+  static constexpr size_t kRerankFactor = 4;
+
+  CompressedVectorIndex(const SchemaField::VectorParams& params, PMR_NS::memory_resource* mr);
+  ~CompressedVectorIndex();
+
+  void Remove(DocId id, const DocumentAccessor& doc, std::string_view field) override;
+
+  std::vector<DocId> GetAllDocsWithNonNullValues() const override;
+
+  // Replace the store of full precision vectors. Must be called before adding any vector.
+  void SetStore(std::unique_ptr<VectorStore> store);
+
+  // Widen the native-width query vector to float for ApproxDistance and GraphKnn.
+  std::vector<float> PrepareQuery(const void* target) const;
+
+  // Distance to the quantized vector of `id`, std::nullopt if it has no vector.
+  std::optional<float> ApproxDistance(absl::Span<const float> query, DocId id) const;
+
+  // Approximate distances of the `k` closest documents found by the graph search, unordered.
+  std::vector<std::pair<float, DocId>> GraphKnn(absl::Span<const float> query, size_t k,
+                                                std::optional<uint32_t> ef) const;
+
+  // Take the kRerankFactor * `limit` candidates with the lowest approximate distances, fetch
+  // their full precision vectors and return the `limit` closest ones with exact distances.
+  std::vector<std::pair<float, DocId>> Rerank(const void* target, size_t limit,
+                                              std::vector<std::pair<float, DocId>> candidates);
+
+ protected:
+  void AddVector(DocId id, const void* vector) override;
+
+ private:
+  class QuantizedSpace;
+
+  // Graph entry of the quantized `values`: their range followed by one code per element
+  void Quantize(const float* values, char* entry) const;
+
+  uint32_t ef_runtime_;
+  PMR_NS::vector<bool> present_;
+  std::unique_ptr<QuantizedSpace> space_;
+  std::unique_ptr<HierarchicalNSW<float>> graph_;  // keeps copies of the entries
+  std::unique_ptr<VectorStore> store_;
+  mutable std::vector<float> decoded_;  // scratch buffer for AddVector and ApproxDistance
+  mutable std::string entry_;           // scratch buffer for AddVector and GraphKnn
+};
+
 struct GeoIndex : public BaseIndex {
   using point =
       boost::geometry::model::point<double, 2,
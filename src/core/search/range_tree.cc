@@ -156,6 +156,61 @@ absl::InlinedVector<const RangeTree::RangeBlock*, 5> RangeTree::RangeBlocks(doub
   return blocks;
 }
 
+size_t RangeTree::EstimateRange(double l, double r) const {
+  DCHECK(l <= r);
+
+  auto it_l = FindRangeBlock(l);
+  auto it_r = FindRangeBlock(r);
+
+  double estimate = 0;
+  for (auto it = it_l;; ++it) {
+    const RangeBlock& block = it->second;
+
+    // Values of the block lie in [lb, ub]. The last block is bounded by the max value it has seen
+    auto next = std::next(it);
+    double lb = it->first;
+    double ub = next != entries_.end() ? next->first : block.max_seen;
+
+    double fraction = 1.0;
+    double width = ub - lb;
+    if (std::isfinite(width) && width > 0) {
+      double overlap = std::min(r, ub) - std::max(l, lb);
+      fraction = std::clamp(overlap / width, 0.0, 1.0);
+    }
+    estimate += fraction * block.Size();
+
+    if (it == it_r)
+      break;
+  }
+
+  return static_cast<size_t>(std::ceil(estimate));
+}
+
+std::vector<DocId> RangeTree::FilterRange(absl::Span<const DocId> candidates, double l,
+                                          double r) const {
+  auto blocks = RangeBlocks(l, r);
+
+  std::vector<DocId> out;
+  for (const RangeBlock* block : blocks) {
+    auto it = MakeBegin(*block, l, r);
+    for (DocId id : candidates) {
+      if (it.HasReachedEnd())
+        break;
+      if (*it < id)
+        it.SeekGE(id);
+      if (!it.HasReachedEnd() && *it == id)
+        out.push_back(id);
+    }
+  }
+
+  // Each block yields sorted ids, but a document with multiple values can be in multiple blocks
+  if (blocks.size() > 1) {
+    rng::sort(out);
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+  }
+  return out;
+}
+
 RangeResult RangeTree::GetAllDocIds() const {
   return RangeResult{GetAllBlocks()};
 }
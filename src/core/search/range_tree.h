@@ -84,6 +84,15 @@ class RangeTree {
   // Same as Range, but returns the blocks that contain the results.
   absl::InlinedVector<const RangeBlock*, 5> RangeBlocks(double l, double r) const;
 
+  // Estimates the number of entries with values in [l, r] without touching the entries. Blocks
+  // serve as a histogram: inner blocks are counted fully, boundary blocks proportionally to how
+  // much of their value range overlaps [l, r].
+  size_t EstimateRange(double l, double r) const;
+
+  // Returns the sorted subset of `candidates` (sorted) with values in [l, r]. Seeks the blocks
+  // covering the range instead of merging them, which is cheaper for few candidates.
+  std::vector<DocId> FilterRange(absl::Span<const DocId> candidates, double l, double r) const;
+
   RangeResult GetAllDocIds() const;
   // Returns all blocks in the tree.
   absl::InlinedVector<const RangeBlock*, 5> GetAllBlocks() const;
@@ -628,6 +628,48 @@ TEST_F(RangeTreeTest, DiscreteIntialization) {
   EXPECT_EQ(result.size(), 4u);
 }
 
+TEST_F(RangeTreeTest, EstimateRange) {
+  RangeTree tree{PMR_NS::get_default_resource(), 100};
+  for (DocId id = 0; id < 10'000; id++)
+    tree.Add(id, double(id));
+
+  EXPECT_EQ(tree.EstimateRange(0, 9999), 10'000u);
+  EXPECT_EQ(tree.EstimateRange(20'000, 30'000), 0u);
+
+  // Only the boundary blocks are prorated, so the error is bounded by two blocks
+  for (auto [l, r] : {std::pair{1000.0, 2999.0}, {10.5, 20.5}, {5000.0, 5000.0}}) {
+    double expected = std::floor(r) - std::ceil(l) + 1;
+    EXPECT_NEAR(double(tree.EstimateRange(l, r)), expected, 2 * 100) << l << " " << r;
+  }
+}
+
+TEST_F(RangeTreeTest, FilterRange) {
+  RangeTree tree{PMR_NS::get_default_resource(), 16};
+
+  absl::InsecureBitGen gen{};
+  for (DocId id = 0; id < 1000; id++) {
+    // Some documents have multiple values that can end up in different blocks
+    size_t num_values = absl::Uniform(gen, 1u, 4u);
+    for (size_t i = 0; i < num_values; i++)
+      tree.Add(id, absl::Uniform(gen, 0, 100));
+  }
+
+  for (size_t i = 0; i < 50; i++) {
+    double l = absl::Uniform(gen, 0.0, 100.0);
+    double r = absl::Uniform(gen, l, 100.0);
+
+    std::vector<DocId> candidates;
+    for (DocId id = 0; id < 1000; id++) {
+      if (absl::Bernoulli(gen, 0.1))
+        candidates.push_back(id);
+    }
+
+    std::vector<DocId> matches = tree.Range(l, r).Take(), expected;
+    rng::set_intersection(candidates, matches, std::back_inserter(expected));
+    EXPECT_EQ(tree.FilterRange(candidates, l, r), expected) << l << " " << r;
+  }
+}
+
 // Benchmark tree insertion performance with set of discrete values
 static void BM_DiscreteInsertion(benchmark::State& state) {
   RangeTree tree{PMR_NS::get_default_resource()};
@@ -28,12 +28,15 @@ ScorerFn RawScorer(const ScorerSpec& scorer) {
   return &BM25Std;
 }
 
+double FinalizeScore(const ScorerSpec& scorer, double raw_score) {
+  if (scorer.kind == ScorerKind::BM25STD_TANH)
+    return std::tanh(raw_score / scorer.bm25std_tanh_factor);
+  return raw_score;
+}
+
 double ScoreDocument(const ScorerSpec& scorer, const ScoringContext& ctx,
                      const std::vector<ScoringTermInfo>& terms) {
-  double score = ScoreDocument(RawScorer(scorer), ctx, terms);
-  if (scorer.kind == ScorerKind::BM25STD_TANH)
-    score = std::tanh(score / scorer.bm25std_tanh_factor);
-  return score;
+  return FinalizeScore(scorer, ScoreDocument(RawScorer(scorer), ctx, terms));
 }
 
 void GlobalScoringStats::Merge(const ShardScoringStats& shard) {
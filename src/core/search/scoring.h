@@ -122,6 +122,10 @@ double ScoreDocument(const ScorerSpec& scorer, const ScoringContext& ctx,
 
 ScorerFn RawScorer(const ScorerSpec& scorer);
 
+// Apply the document-level post processing of `scorer` to a sum of raw per-term scores.
+// Non-decreasing in `raw_score`, so upper bounds of raw scores remain upper bounds.
+double FinalizeScore(const ScorerSpec& scorer, double raw_score);
+
 // Single-shard slice of the counts a scorer needs. Keys are schema canonical
 // names; terms are post-synonym-resolution.
 struct ShardScoringStats {
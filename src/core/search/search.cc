@@ -11,6 +11,7 @@
 #include <uni_algo/case.h>
 
 #include <chrono>
+#include <limits>
 #include <type_traits>
 #include <variant>
 
@@ -107,6 +108,17 @@ struct ProfileBuilder {
     depth_--;
   }
 
+  // Records a planner decision for an operand that was not evaluated as a node, like a post-filter
+  // or a skipped operand, as a child of the node currently being evaluated.
+  void AddPlanEvent(string descr, size_t micros, size_t num_processed) {
+    profile_.events.push_back({std::move(descr), micros, depth_, num_processed});
+  }
+
+  // Records the SORTBY step applied while searching. Its description is set by the caller.
+  void SetSortEvent(AlgorithmProfile::ProfileEvent event) {
+    profile_.sort = std::move(event);
+  }
+
   AlgorithmProfile Take() {
     reverse(profile_.events.begin(), profile_.events.end());
     return std::move(profile_);
@@ -129,6 +141,40 @@ struct BasicSearch {
     profile_builder_ = ProfileBuilder{};
   }
 
+  // Finds the top matches of a probeable result by walking the sort index, if the planner expects
+  // that to visit few docs. Returns nullopt if all matches have to be collected and sorted.
+  optional<pair<vector<DocId>, vector<SortableValue>>> ScanSortIndex(const IndexResult& result,
+                                                                      const SortIndexScan& scan) {
+    if (!result.CanProbe())
+      return nullopt;
+
+    size_t num_matches = result.ApproximateSize();  // exact for probeable results
+    if (scan.index->ChooseSortStrategy(num_matches, scan.limit, scan.desc) !=
+        SortStrategy::kIndexScan)
+      return nullopt;
+
+    auto start = chrono::steady_clock::now();
+    size_t visited = 0;
+    auto matches = [&](DocId id) {
+      visited++;
+      return result.Contains(id);
+    };
+
+    vector<DocId> ids;
+    auto values = scan.index->ScanSorted(&ids, scan.limit, scan.desc, matches);
+
+    // Too few matches have values, the rest are null and can only be found by collecting them
+    if (ids.size() < scan.limit)
+      return nullopt;
+
+    if (profile_builder_) {
+      auto took = chrono::steady_clock::now() - start;
+      size_t micros = chrono::duration_cast<chrono::microseconds>(took).count();
+      profile_builder_->SetSortEvent({"", micros, 0, visited});
+    }
+    return make_pair(std::move(ids), std::move(values));
+  }
+
   BaseIndex* GetBaseIndex(string_view field) {
     auto index = indices_->GetIndex(field);
     if (!index) {
@@ -156,6 +202,12 @@ struct BasicSearch {
     return casted_ptr;
   }
 
+  // Like GetIndex, but doesn't report errors. Used for planning, where errors are left to be
+  // reported by the evaluation of the node itself.
+  template <typename T> T* FindIndex(string_view field) const {
+    return dynamic_cast<T*>(indices_->GetIndex(field));
+  }
+
   BaseSortIndex* GetSortIndex(string_view field) {
     auto index = indices_->GetSortIndex(field);
     if (!index) {
@@ -177,8 +229,7 @@ struct BasicSearch {
 
   void Merge(IndexResult matched, IndexResult* current_ptr, LogicOp op) {
     IndexResult& current = *current_ptr;
-    auto vec = MergeIndexResults(matched, current, op);
-    current = IndexResult{std::move(vec)};
+    current = MergeIndexResults(matched, current, op);
   }
 
   // Efficiently unify multiple sub results with specified logical op
@@ -472,7 +523,7 @@ struct BasicSearch {
 
   // negate -(*subquery*): explicitly compute result complement. Needs further optimizations
   IndexResult Search(const AstNegateNode& node, string_view active_field) {
-    auto matched = SearchGeneric(*node.node, active_field).Take().first;
+    IndexResult result = SearchGeneric(*node.node, active_field);
     if (!error_.empty())
       return IndexResult{};
 
@@ -480,6 +531,12 @@ struct BasicSearch {
 
     // To negate a result, we have to find the complement of matched to all documents,
     // so we remove all matched documents from the set of all documents.
+    if (const DocBitmap* bitmap = result.GetBitmap(); bitmap) {
+      erase_if(all, [bitmap](DocId doc) { return bitmap->Contains(doc); });
+      return IndexResult{std::move(all)};
+    }
+
+    auto matched = result.Take().first;
     auto pred = [&matched](DocId doc) {
       return binary_search(matched.begin(), matched.end(), doc);
     };
@@ -508,19 +565,194 @@ struct BasicSearch {
     return SearchGeneric(*node.node, active_field);
   }
 
+  bool IsStopWordOperand(const AstNode& node) const {
+    const auto* term = get_if<AstTermNode>(&node.Variant());
+    return term && indices_->IsStopWord(term->affix);
+  }
+
+  // Estimates the number of documents matched by a subtree without evaluating it. Uses posting
+  // list sizes for text terms and tags and the block histogram of numeric indices. Returns nullopt
+  // if the subtree has no cheap estimate or references an invalid field.
+  optional<size_t> EstimateSize(const AstNode& node, string_view active_field) const {
+    const size_t num_docs = indices_->GetAllDocs().size();
+    auto posting_size = [](const auto* container) -> size_t {
+      return container ? container->Size() : 0;
+    };
+
+    Overloaded estimate{
+        [&](const AstStarNode&) -> optional<size_t> { return num_docs; },
+        [&](const AstTermNode& term) -> optional<size_t> {
+          vector<TextIndex*> indices;
+          if (active_field.empty())
+            indices = indices_->GetAllTextIndices();
+          else if (auto* index = FindIndex<TextIndex>(active_field); index)
+            indices = {index};
+          else
+            return nullopt;
+
+          optional<string> group_id;
+          if (auto synonyms = indices_->GetSynonyms(); synonyms)
+            group_id = synonyms->GetGroupToken(term.affix);
+
+          size_t size = 0;
+          for (auto* index : indices) {
+            size += posting_size(index->Matching(term.affix, /*strip_whitespace=*/true));
+            if (group_id)
+              size += posting_size(index->Matching(*group_id, /*strip_whitespace=*/false));
+          }
+          return min(size, num_docs);
+        },
+        [&](const AstTagsNode& tags) -> optional<size_t> {
+          auto* index = FindIndex<TagIndex>(active_field);
+          if (!index)
+            return nullopt;
+
+          size_t size = 0;
+          for (const auto& tag : tags.tags) {
+            const auto* term = get_if<AstTermNode>(&tag);
+            if (!term)
+              return nullopt;  // Affix matches would need a trie walk
+            size += posting_size(index->Matching(term->affix));
+          }
+          return min(size, num_docs);
+        },
+        [&](const AstRangeNode& range) -> optional<size_t> {
+          auto* index = FindIndex<NumericIndex>(active_field);
+          if (!index)
+            return nullopt;
+          return min(index->EstimateRange(range.lo, range.hi), num_docs);
+        },
+        [&](const AstFieldNode& field) { return EstimateSize(*field.node, field.field); },
+        [&](const AstAttributeNode& attr) { return EstimateSize(*attr.node, active_field); },
+        [&](const AstNegateNode& negate) -> optional<size_t> {
+          auto size = EstimateSize(*negate.node, active_field);
+          if (!size)
+            return nullopt;
+          return num_docs - min(*size, num_docs);
+        },
+        [&](const AstLogicalNode& logical) -> optional<size_t> {
+          // AND matches at most the smallest known operand, OR at most the sum of all operands
+          optional<size_t> out;
+          for (const auto& sub : logical.nodes) {
+            if (IsStopWordOperand(sub))
+              continue;
+
+            auto size = EstimateSize(sub, active_field);
+            if (logical.op == LogicOp::AND) {
+              if (size)
+                out = min(*size, out.value_or(num_docs));
+            } else {
+              if (!size)
+                return nullopt;
+              out = min(out.value_or(0) + *size, num_docs);
+            }
+          }
+          return out;
+        },
+        [](const auto&) -> optional<size_t> { return nullopt; },
+    };
+    return visit(estimate, node.Variant());
+  }
+
+  struct RangeFilter {
+    string_view field;
+    const NumericIndex* index;
+    const AstRangeNode* range;
+  };
+
+  // Matches `@field:[lo hi]` operands that can be applied as post-filters
+  optional<RangeFilter> GetRangeFilter(const AstNode& node, string_view active_field) const {
+    if (const auto* field = get_if<AstFieldNode>(&node.Variant()); field)
+      return GetRangeFilter(*field->node, field->field);
+
+    const auto* range = get_if<AstRangeNode>(&node.Variant());
+    if (!range || active_field.empty())
+      return nullopt;
+    if (auto* index = FindIndex<NumericIndex>(active_field); index)
+      return RangeFilter{active_field, index, range};
+    return nullopt;
+  }
+
+  // Planned AND query: operands are evaluated in order of their estimated sizes, so that the
+  // intersection shrinks as early as possible. Numeric ranges that are much larger than the
+  // current candidates are applied as post-filters instead of being materialized. Once the
+  // intersection is empty, the remaining operands with estimates are skipped. Operands without
+  // estimates are always evaluated, so that they can report errors.
+  IndexResult SearchAnd(absl::Span<const AstNode* const> operands, string_view active_field) {
+    // Post-filtering probes the range blocks for every candidate, so it pays off only if
+    // there are several times fewer candidates than documents in the range
+    constexpr size_t kPostFilterRatio = 8;
+
+    vector<pair<const AstNode*, optional<size_t>>> planned;
+    planned.reserve(operands.size());
+    for (const AstNode* operand : operands)
+      planned.emplace_back(operand, EstimateSize(*operand, active_field));
+
+    // Operands without estimates go last
+    constexpr size_t kNoEstimate = numeric_limits<size_t>::max();
+    stable_sort(planned.begin(), planned.end(), [](const auto& l, const auto& r) {
+      return l.second.value_or(kNoEstimate) < r.second.value_or(kNoEstimate);
+    });
+
+    optional<IndexResult> current;
+    for (const auto& [operand, estimate] : planned) {
+      if (current && estimate && error_.empty()) {
+        const size_t candidates = current->ApproximateSize();
+
+        // Skipped terms would still contribute to the scores of documents matched elsewhere
+        if (candidates == 0 && !scorer_) {
+          if (profile_builder_) {
+            string descr = absl::StrCat("Skipped{", profile_builder_->GetNodeInfo(*operand), "}");
+            profile_builder_->AddPlanEvent(std::move(descr), 0, 0);
+          }
+          continue;
+        }
+
+        if (auto filter = GetRangeFilter(*operand, active_field);
+            filter && candidates * kPostFilterRatio <= *estimate) {
+          auto start = chrono::steady_clock::now();
+          auto filtered = filter->index->FilterRange(current->Take().first, filter->range->lo,
+                                                     filter->range->hi);
+          if (profile_builder_) {
+            auto took = chrono::steady_clock::now() - start;
+            size_t micros = chrono::duration_cast<chrono::microseconds>(took).count();
+            string descr = absl::StrCat("PostFilter{", filter->field, ",Range{", filter->range->lo,
+                                        "<>", filter->range->hi, "}}");
+            profile_builder_->AddPlanEvent(std::move(descr), micros, candidates);
+          }
+          current = IndexResult{std::move(filtered)};
+          continue;
+        }
+      }
+
+      IndexResult matched = SearchGeneric(*operand, active_field);
+      if (current)
+        Merge(std::move(matched), &*current, LogicOp::AND);
+      else
+        current = std::move(matched);
+    }
+    return current ? std::move(*current) : IndexResult{};
+  }
+
   // logical query: unify all sub results
   IndexResult Search(const AstLogicalNode& node, string_view active_field) {
     // Stopwords are never indexed, so a bare stopword operand matches nothing: as an AND term it
     // would zero the whole result (e.g. `@title:(foo) and bar`), as an OR term it adds nothing.
     // Drop such operands so the surrounding query still matches.
-    vector<IndexResult> sub_results;
-    sub_results.reserve(node.nodes.size());
+    vector<const AstNode*> operands;
+    operands.reserve(node.nodes.size());
     for (const auto& sub : node.nodes) {
-      if (const auto* term = get_if<AstTermNode>(&sub.Variant());
-          term && indices_->IsStopWord(term->affix))
-        continue;
-      sub_results.push_back(SearchGeneric(sub, active_field));
+      if (!IsStopWordOperand(sub))
+        operands.push_back(&sub);
     }
+
+    if (node.op == LogicOp::AND && operands.size() > 1)
+      return SearchAnd(operands, active_field);
+
+    vector<IndexResult> sub_results;
+    sub_results.reserve(operands.size());
+    for (const AstNode* sub : operands)
+      sub_results.push_back(SearchGeneric(*sub, active_field));
     return UnifyResults(std::move(sub_results), node.op);
   }
 
@@ -538,6 +770,8 @@ struct BasicSearch {
       return IndexResult{};
 
     Overloaded ov{[tag_index](const AstTermNode& term) -> IndexResult {
+                    if (const DocBitmap* bitmap = tag_index->MatchingBitmap(term.affix); bitmap)
+                      return IndexResult{bitmap};
                     return IndexResult{tag_index->Matching(term.affix)};
                   },
                   [tag_index, this](const AstPrefixNode& prefix) {
@@ -576,6 +810,31 @@ struct BasicSearch {
     knn_distances_.resize(prefix_size);
   }
 
+  // Take candidates by approximate distance and re-rank the best ones with exact distances.
+  // Unfiltered queries search the graph, filtered ones scan the matched documents.
+  void SearchKnnCompressed(CompressedVectorIndex* vec_index, const AstKnnNode& knn,
+                           IndexResult&& sub_results) {
+    vector<float> query = vec_index->PrepareQuery(knn.blob.data());
+    vector<pair<float, DocId>> candidates;
+    if (holds_alternative<AstStarNode>(*knn.filter)) {
+      size_t k = knn.limit * CompressedVectorIndex::kRerankFactor;
+      candidates = vec_index->GraphKnn(query, k, knn.ef_runtime);
+      knn_distances_ = vec_index->Rerank(knn.blob.data(), knn.limit, std::move(candidates));
+      return;
+    }
+
+    candidates.reserve(sub_results.ApproximateSize());
+    auto cb = [&](auto* set) {
+      for (DocId matched_doc : *set) {
+        if (auto dist = vec_index->ApproxDistance(query, matched_doc); dist)
+          candidates.emplace_back(*dist, matched_doc);
+      }
+    };
+    visit(cb, sub_results.Borrowed());
+
+    knn_distances_ = vec_index->Rerank(knn.blob.data(), knn.limit, std::move(candidates));
+  }
+
   void SearchVectorRangeFlat(FlatVectorIndex* vec_index, const AstVectorRangeNode& node,
                              vector<DocId>* out) {
     const auto& all_docs = indices_->GetAllDocs();
@@ -617,6 +876,10 @@ struct BasicSearch {
       error_ = "EPSILON is supported only for HNSW VECTOR_RANGE";
       return IndexResult{};
     }
+    if (dynamic_cast<CompressedVectorIndex*>(vec_index)) {
+      error_ = "VECTOR_RANGE is not supported for DISK vector indexes";
+      return IndexResult{};
+    }
 
     if (info.dim != qdim) {
       error_ = absl::StrCat("Wrong vector index dimensions, got: ", qdim, ", expected: ", info.dim);
@@ -660,6 +923,8 @@ struct BasicSearch {
 
     if (auto flat_index = dynamic_cast<FlatVectorIndex*>(vec_index); flat_index)
       SearchKnnFlat(dynamic_cast<FlatVectorIndex*>(vec_index), knn, std::move(sub_results));
+    else if (auto* compressed = dynamic_cast<CompressedVectorIndex*>(vec_index); compressed)
+      SearchKnnCompressed(compressed, knn, std::move(sub_results));
 
     vector<DocId> out(knn_distances_.size());
     knn_scores_.reserve(knn_distances_.size());
@@ -696,9 +961,13 @@ struct BasicSearch {
     return result;
   }
 
-  SearchResult Search(const AstNode& query, size_t cuttoff_limit) {
+  SearchResult Search(const AstNode& query, size_t cuttoff_limit, const SortIndexScan* sort_scan) {
     IndexResult result = SearchGeneric(query, "", true);
 
+    optional<pair<vector<DocId>, vector<SortableValue>>> scanned;
+    if (sort_scan && !scorer_)
+      scanned = ScanSortIndex(result, *sort_scan);
+
     // Extract profile if enabled
     optional<AlgorithmProfile> profile =
         profile_builder_ ? make_optional(profile_builder_->Take()) : nullopt;
@@ -712,6 +981,14 @@ struct BasicSearch {
           max_text_score, std::move(profile), std::move(error_)};
     }
 
+    if (scanned) {
+      auto& [ids, values] = *scanned;
+      size_t total = result.ApproximateSize();  // exact for probeable results
+      return SearchResult{total,             std::move(ids),    std::move(knn_scores_),
+                          {},                0.0f,              std::move(profile),
+                          std::move(error_), std::move(values)};
+    }
+
     auto [out, total_size] = result.Take(cuttoff_limit);
     return SearchResult{total_size, std::move(out),     std::move(knn_scores_), {},
                         0.0f,       std::move(profile), std::move(error_)};
@@ -719,7 +996,8 @@ struct BasicSearch {
 
  private:
   // Cursor for sequential freq lookup in a posting list.
-  // Advances forward only - amortized O(1) per doc when docs are sorted.
+  // Advances forward only - amortized O(1) per doc when docs are sorted, galloping over whole
+  // blocks when the next doc is far ahead.
   struct TermCursor {
     TextIndex* index;
     size_t term_docs;
@@ -728,17 +1006,42 @@ struct BasicSearch {
     double field_weight;       // folded into effective TF (schema TEXT WEIGHT)
     TextIndex::Container::BlockListIterator it;
     TextIndex::Container::BlockListIterator end;
+
+    // Cached block-max bound of the current block, keyed by the block's last doc.
+    std::optional<DocId> bound_block{};
+    double block_bound = 0;
   };
 
   // Advance cursor past entries < doc. Return freq if doc found, 0 otherwise.
   static uint32_t SeekCursor(TermCursor& c, DocId doc) {
-    while (c.it != c.end && *c.it < doc)
-      ++c.it;
+    if (c.it != c.end && *c.it < doc)
+      c.it.SeekGE(doc);
     return (c.it != c.end && *c.it == doc) ? c.it.Freq() : 0;
   }
 
+  // Upper bound of the raw score contribution of the cursor's term to any doc of its current
+  // block: the block's max frequency in the shortest possible document. All scorers are
+  // non-decreasing in the frequency and non-increasing in the document length.
+  double BlockBound(TermCursor& c, const ScoringContext& ctx) const {
+    DCHECK(c.it != c.end);
+    if (DocId back = c.it.BlockBack(); c.bound_block != back) {
+      ScoringTermInfo info{.term_freq = c.it.BlockMaxFreq(),
+                           .term_docs = c.term_docs,
+                           .field_doc_len = 0,
+                           .field_avg_doc_len = c.field_avg_doc_len,
+                           .query_weight = c.query_weight,
+                           .field_weight = c.field_weight};
+      c.bound_block = back;
+      c.block_bound = c.query_weight * RawScorer(*scorer_)(ctx, info);
+    }
+    return c.block_bound;
+  }
+
   // Score all matched docs via cursor-based posting list traversal and return top-K by score.
   // Total work: O(sum of posting_list_sizes) for cursors + O(N log K) for partial sort.
+  // When only a few of the matched docs are requested, docs are kept in a top-K heap and the
+  // block-max bounds of the posting lists let whole runs of docs that can't beat the K-th score
+  // skip scoring.
   std::tuple<vector<DocId>, size_t, absl::flat_hash_map<DocId, float>, float> TakeScoredTopK(
       IndexResult&& result, size_t limit) {
     auto [all_docs, total_size] = result.Take();  // all matched docs
@@ -769,15 +1072,9 @@ struct BasicSearch {
 
     ScoringContext ctx{global_stats_ ? global_stats_->num_docs : indices_->GetAllDocs().size()};
 
-    // Score all docs - reuse term_infos buffer across iterations
-    vector<pair<float, DocId>> scored;
-    scored.reserve(all_docs.size());
+    // Reuse term_infos buffer across iterations
     vector<ScoringTermInfo> term_infos(cursors.size());
-
-    // Track the max score over the full matched set (before top-K trimming) so the command
-    // layer can normalize BM25STD.NORM by the global max. Cheap byproduct of scoring.
-    float max_text_score = 0.0f;
-    for (DocId doc : all_docs) {
+    auto score_doc = [&](DocId doc) {
       for (size_t t = 0; t < cursors.size(); t++) {
         term_infos[t].term_docs = cursors[t].term_docs;
         term_infos[t].term_freq = SeekCursor(cursors[t], doc);
@@ -788,23 +1085,32 @@ struct BasicSearch {
         term_infos[t].query_weight = cursors[t].query_weight;
         term_infos[t].field_weight = cursors[t].field_weight;
       }
-      float score = static_cast<float>(ScoreDocument(*scorer_, ctx, term_infos));
-      max_text_score = max(max_text_score, score);
-      scored.emplace_back(score, doc);
-    }
+      return static_cast<float>(ScoreDocument(*scorer_, ctx, term_infos));
+    };
 
     // Top-K by score (skip sort when no actual cutoff, e.g. FT.AGGREGATE)
-    size_t k = min(limit, scored.size());
-    if (k < scored.size()) {
-      partial_sort(scored.begin(), scored.begin() + k, scored.end(), greater<>());
-      scored.resize(k);
+    size_t k = min(limit, all_docs.size());
+    bool bounded = all_of(cursors.begin(), cursors.end(), [](const TermCursor& c) {
+      return c.query_weight >= 0 && c.field_weight >= 0;
+    });
+
+    // Track the max score over the full matched set (before top-K trimming) so the command
+    // layer can normalize BM25STD.NORM by the global max. The block-max path always keeps the
+    // best doc, so its max is exact as well.
+    float max_text_score = 0.0f;
+    vector<pair<float, DocId>> scored;
+    if (k > 0 && k < all_docs.size() && bounded) {
+      scored = ScoreTopKBlockMax(all_docs, k, ctx, cursors, score_doc);
+      max_text_score = max(max_text_score, scored.front().first);
+    } else {
+      scored = ScoreAll(all_docs, k, score_doc, &max_text_score);
     }
 
     // `out` carries score order; text_scores is a by-id score lookup.
     vector<DocId> out;
     absl::flat_hash_map<DocId, float> text_scores;
-    out.reserve(k);
-    text_scores.reserve(k);
+    out.reserve(scored.size());
+    text_scores.reserve(scored.size());
     for (auto& [score, doc] : scored) {
       out.push_back(doc);
       text_scores[doc] = score;
@@ -813,6 +1119,88 @@ struct BasicSearch {
     return std::make_tuple(std::move(out), total_size, std::move(text_scores), max_text_score);
   }
 
+  // Score every doc and keep the best k, sorted by descending (score, doc) if any were cut.
+  template <typename ScoreFn>
+  static vector<pair<float, DocId>> ScoreAll(const vector<DocId>& docs, size_t k,
+                                             ScoreFn&& score_doc, float* max_score) {
+    vector<pair<float, DocId>> scored;
+    scored.reserve(docs.size());
+    for (DocId doc : docs) {
+      float score = score_doc(doc);
+      *max_score = max(*max_score, score);
+      scored.emplace_back(score, doc);
+    }
+
+    if (k < scored.size()) {
+      partial_sort(scored.begin(), scored.begin() + k, scored.end(), greater<>());
+      scored.resize(k);
+    }
+    return scored;
+  }
+
+  // Block-max top-K: same result as ScoreAll, but docs whose score bound can't reach the
+  // current K-th best score are skipped without looking up their lengths and frequencies.
+  template <typename ScoreFn>
+  vector<pair<float, DocId>> ScoreTopKBlockMax(const vector<DocId>& docs, size_t k,
+                                               const ScoringContext& ctx,
+                                               vector<TermCursor>& cursors, ScoreFn&& score_doc) {
+    // Min-heap of the best k (score, doc) pairs, the top is the threshold to beat.
+    vector<pair<float, DocId>> heap;
+    heap.reserve(k);
+
+    // The slack covers rounding differences between a bound and the exact score, so a doc is
+    // only skipped if it scores strictly below the threshold.
+    auto below_threshold = [&](double raw_bound) {
+      return static_cast<float>(FinalizeScore(*scorer_, raw_bound * (1 + 1e-6))) <
+             heap.front().first;
+    };
+
+    for (auto doc_it = docs.begin(); doc_it != docs.end();) {
+      DocId doc = *doc_it;
+      if (heap.size() == k) {
+        // All postings of docs in [doc, window_end] lie in the cursors' current blocks, so the
+        // sum of the block bounds limits the score of the whole window.
+        double window_bound = 0;
+        DocId window_end = numeric_limits<DocId>::max();
+        double doc_bound = 0;
+        for (TermCursor& c : cursors) {
+          SeekCursor(c, doc);
+          if (c.it == c.end)
+            continue;
+
+          double bound = BlockBound(c, ctx);
+          window_bound += bound;
+          window_end = min(window_end, c.it.BlockBack());
+          if (*c.it == doc)
+            doc_bound += bound;
+        }
+
+        if (below_threshold(window_bound)) {
+          doc_it = upper_bound(doc_it, docs.end(), window_end);
+          continue;
+        }
+        if (below_threshold(doc_bound)) {
+          ++doc_it;
+          continue;
+        }
+      }
+
+      pair<float, DocId> entry{score_doc(doc), doc};
+      if (heap.size() < k) {
+        heap.push_back(entry);
+        push_heap(heap.begin(), heap.end(), greater<>());
+      } else if (entry > heap.front()) {
+        pop_heap(heap.begin(), heap.end(), greater<>());
+        heap.back() = entry;
+        push_heap(heap.begin(), heap.end(), greater<>());
+      }
+      ++doc_it;
+    }
+
+    sort(heap.begin(), heap.end(), greater<>());
+    return heap;
+  }
+
   double GetSchemaTextWeight(TextIndex* index) const {
     string_view field_ident = index->field_ident();
     auto it = indices_->GetSchema().fields.find(field_ident);
@@ -1041,7 +1429,10 @@ void FieldIndices::CreateIndices(PMR_NS::memory_resource* mr) {
         if (vparams.use_hnsw)
           break;
 
-        vector_index = make_unique<FlatVectorIndex>(vparams, mr);
+        if (vparams.use_disk)
+          vector_index = make_unique<CompressedVectorIndex>(vparams, mr);
+        else
+          vector_index = make_unique<FlatVectorIndex>(vparams, mr);
         indices_[field_ident] = std::move(vector_index);
 
         break;
@@ -1224,13 +1615,14 @@ bool SearchAlgorithm::Init(string_view query, const QueryParams* params,
 }
 
 SearchResult SearchAlgorithm::Search(const FieldIndices* index, size_t cuttoff_limit,
-                                     const GlobalScoringStats* global_stats) const {
+                                     const GlobalScoringStats* global_stats,
+                                     const SortIndexScan* sort_scan) const {
   DCHECK(query_);
 
   auto bs = BasicSearch{index, scorer_, global_stats};
   if (profiling_enabled_)
     bs.EnableProfiling();
-  return bs.Search(*query_, cuttoff_limit);
+  return bs.Search(*query_, cuttoff_limit, sort_scan);
 }
 
 ShardScoringStats SearchAlgorithm::CollectScoringStats(const FieldIndices* index) const {
@@ -92,6 +92,7 @@ struct SchemaField {
     VectorDataType data_type = VectorDataType::FLOAT32;
     uint32_t hnsw_ef_runtime = 10;
     double hnsw_epsilon = kDefaultHnswEpsilon;
+    bool use_disk = false;  // CompressedVectorIndex with full precision vectors in VectorStore
   };
 
   struct TagParams {
@@ -227,6 +228,10 @@ struct AlgorithmProfile {
   };
 
   std::vector<ProfileEvent> events;
+
+  // SORTBY step of the shard, applied to the results of the events tree. The description names
+  // how the matches were sorted.
+  std::optional<ProfileEvent> sort;
 };
 
 // Represents a search result returned from the search algorithm.
@@ -248,6 +253,16 @@ struct SearchResult {
 
   // If an error occurred, last recent one
   std::string error;
+
+  // Values of the sort field if `ids` were already ordered by walking its sort index
+  std::optional<std::vector<SortableValue>> sort_values;
+};
+
+// SORTBY on a field with a sort index, which the search can apply by walking the index in order
+struct SortIndexScan {
+  const BaseSortIndex* index;
+  size_t limit;
+  bool desc;
 };
 
 struct KnnScoreSortOption {
@@ -268,9 +283,13 @@ class SearchAlgorithm {
   // Search on given index with predefined limit for cutting off result ids.
   // When global_stats is non-null, scorers see cluster-wide counts instead of
   // values local to `index`.
+  // When sort_scan is set and the matches can be probed one by one, like all docs or the docs of
+  // a single tag, the top matches are found by walking the sort index if that is cheaper than
+  // collecting them. Only the top ids are returned then, with their sort_values.
   SearchResult Search(const FieldIndices* index,
                       size_t cuttoff_limit = std::numeric_limits<size_t>::max(),
-                      const GlobalScoringStats* global_stats = nullptr) const;
+                      const GlobalScoringStats* global_stats = nullptr,
+                      const SortIndexScan* sort_scan = nullptr) const;
 
   // This shard's contribution to GlobalScoringStats. Requires Init().
   ShardScoringStats CollectScoringStats(const FieldIndices* index) const;
@@ -8,6 +8,7 @@
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/escaping.h>
 #include <absl/strings/numbers.h>
+#include <absl/strings/str_join.h>
 #include <absl/strings/str_split.h>
 #include <benchmark/benchmark.h>
 #include <gmock/gmock.h>
@@ -524,6 +525,67 @@ TEST_F(SearchTest, CheckTagPrefix) {
   EXPECT_TRUE(Check()) << GetError();
 }
 
+// Dense tags are stored as bitmaps and combined word by word, the results must stay the same
+TEST_F(SearchTest, DenseTagBitmaps) {
+  auto schema = MakeSimpleSchema({{"status", SchemaField::TAG},
+                                  {"color", SchemaField::TAG},
+                                  {"title", SchemaField::TEXT}});
+  FieldIndices indices{schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+
+  const DocId kNumDocs = 20'000;
+  auto status = [](DocId id) { return id % 2 == 0 ? "active" : (id % 7 == 0 ? "new" : "idle"); };
+  auto color = [](DocId id) { return id % 5 < 2 ? "red" : "blue"; };
+  auto title = [](DocId id) { return id % 3 == 0 ? "fizz" : "buzz"; };
+  auto make_doc = [&](DocId id) {
+    return MockedDocument{Map{{"status", status(id)}, {"color", color(id)}, {"title", title(id)}}};
+  };
+  for (DocId i = 0; i < kNumDocs; i++)
+    indices.Add(i, make_doc(i));
+
+  auto* status_index = dynamic_cast<TagIndex*>(indices.GetIndex("status"));
+  ASSERT_NE(status_index, nullptr);
+  EXPECT_NE(status_index->MatchingBitmap("active"), nullptr);
+  EXPECT_NE(status_index->MatchingBitmap("ACTIVE"), nullptr);
+  EXPECT_EQ(status_index->MatchingBitmap("new"), nullptr);  // Too sparse
+
+  auto expect_matches = [&](string_view query, auto pred) {
+    SearchAlgorithm algo{};
+    QueryParams params;
+    ASSERT_TRUE(algo.Init(query, &params));
+    auto result = algo.Search(&indices);
+
+    vector<DocId> expected;
+    for (DocId i = 0; i < kNumDocs; i++) {
+      if (pred(i))
+        expected.push_back(i);
+    }
+    sort(result.ids.begin(), result.ids.end());
+    EXPECT_EQ(result.ids, expected) << query;
+  };
+
+  auto active = [&](DocId id) { return status(id) == "active"sv; };
+  auto red = [&](DocId id) { return color(id) == "red"sv; };
+  auto is_new = [&](DocId id) { return status(id) == "new"sv; };
+  auto fizz = [&](DocId id) { return title(id) == "fizz"sv; };
+
+  expect_matches("@status:{active} @color:{red}", [&](DocId i) { return active(i) && red(i); });
+  expect_matches("@status:{active} | @color:{red}", [&](DocId i) { return active(i) || red(i); });
+  expect_matches("@status:{active | new}", [&](DocId i) { return active(i) || is_new(i); });
+  expect_matches("-@status:{active}", [&](DocId i) { return !active(i); });
+  expect_matches("@status:{active} -@color:{red}", [&](DocId i) { return active(i) && !red(i); });
+  expect_matches("@status:{active} @title:fizz", [&](DocId i) { return active(i) && fizz(i); });
+  expect_matches("@status:{new} @color:{red}", [&](DocId i) { return is_new(i) && red(i); });
+
+  // Removing most active documents makes the tag sparse again
+  for (DocId i = 0; i < kNumDocs; i += 2) {
+    if (i % 16 != 0)
+      indices.Remove(i, make_doc(i));
+  }
+  EXPECT_EQ(status_index->MatchingBitmap("active"), nullptr);
+  expect_matches("@status:{active} @color:{red}",
+                 [&](DocId i) { return i % 16 == 0 && active(i) && red(i); });
+}
+
 TEST_F(SearchTest, IntegerTerms) {
   PrepareSchema({{"status", SchemaField::TAG}, {"title", SchemaField::TEXT}});
 
@@ -700,6 +762,83 @@ TEST_F(SearchTest, Errors) {
   EXPECT_THAT(algo.Search(&indices).error, HasSubstr("Wrong vector index dimensions"));
 }
 
+TEST_F(SearchTest, AndPlanning) {
+  // Small range blocks give the planner a fine-grained histogram of the prices
+  auto schema = MakeSimpleSchema(
+      {{"price", SchemaField::NUMERIC, SchemaField::NumericParams{.block_size = 100}},
+       {"color", SchemaField::TAG},
+       {"title", SchemaField::TEXT}});
+  FieldIndices indices{schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+
+  const DocId kNumDocs = 5000;
+  auto price = [](DocId id) { return id % 1000; };
+  auto is_red = [](DocId id) { return id % 100 == 0; };
+  for (DocId i = 0; i < kNumDocs; i++) {
+    indices.Add(i, MockedDocument{Map{{"price", absl::StrCat(price(i))},
+                                      {"color", is_red(i) ? "red" : "blue"},
+                                      {"title", "item"}}});
+  }
+  indices.FinalizeInitialization();
+
+  auto descriptions = [](const SearchResult& result) {
+    vector<string> out;
+    for (const auto& event : result.profile->events)
+      out.push_back(event.descr);
+    return out;
+  };
+
+  SearchAlgorithm algo{};
+  QueryParams params;
+
+  // The selective tag goes first, the broad range is applied to its few candidates
+  {
+    algo.Init("@price:[0 500] item @color:{red}", &params);
+    algo.EnableProfiling();
+    auto result = algo.Search(&indices);
+
+    vector<DocId> expected;
+    for (DocId i = 0; i < kNumDocs; i++) {
+      if (is_red(i) && price(i) <= 500)
+        expected.push_back(i);
+    }
+    EXPECT_EQ(result.ids, expected);
+    EXPECT_THAT(descriptions(result), testing::Contains("PostFilter{price,Range{0<>500}}"));
+  }
+
+  // A narrow range is cheaper to evaluate than to apply as a filter
+  {
+    algo.Init("@color:{red} @price:[0 1]", &params);
+    algo.EnableProfiling();
+    auto result = algo.Search(&indices);
+
+    vector<DocId> expected;
+    for (DocId i = 0; i < kNumDocs; i++) {
+      if (is_red(i) && price(i) <= 1)
+        expected.push_back(i);
+    }
+    EXPECT_EQ(result.ids, expected);
+    EXPECT_THAT(descriptions(result), testing::Contains("Range{0<>1}"));
+    EXPECT_THAT(descriptions(result), testing::Not(testing::Contains(HasSubstr("PostFilter"))));
+  }
+
+  // Nothing is left to intersect after the unknown tag, so the other operands are skipped
+  {
+    algo.Init("@price:[0 500] @color:{green} item", &params);
+    algo.EnableProfiling();
+    auto result = algo.Search(&indices);
+
+    EXPECT_TRUE(result.ids.empty());
+    EXPECT_THAT(descriptions(result),
+                testing::IsSupersetOf({"Skipped{Field{price}}", "Skipped{Term{item}}"}));
+  }
+
+  // Operands that can't be planned are still evaluated to report errors
+  {
+    algo.Init("@color:{green} @cantfindme:[1 10]", &params);
+    EXPECT_THAT(algo.Search(&indices).error, HasSubstr("Invalid field"));
+  }
+}
+
 TEST_F(SearchTest, MatchNumericRangeWithCommas) {
   PrepareSchema({{"f1", SchemaField::NUMERIC}, {"draw_end", SchemaField::NUMERIC}});
 
@@ -1216,6 +1355,106 @@ TEST_F(KnnTest, AutoResize) {
   EXPECT_EQ(indices.GetAllDocs().size(), 100);
 }
 
+// Counts the vectors that are fetched for re-ranking
+struct CountingVectorStore : public VectorStore {
+  explicit CountingVectorStore(size_t* fetched) : fetched{fetched} {
+  }
+
+  void Add(DocId id, const void* vector) override {
+    const auto* data = static_cast<const float*>(vector);
+    vectors[id].assign(data, data + kDim);
+  }
+
+  void Remove(DocId id) override {
+    vectors.erase(id);
+  }
+
+  void Fetch(absl::Span<const DocId> ids, absl::FunctionRef<void(DocId, const void*)> cb) override {
+    *fetched += ids.size();
+    for (DocId id : ids)
+      cb(id, vectors.at(id).data());
+  }
+
+  static constexpr size_t kDim = 8;
+  size_t* fetched;
+  map<DocId, vector<float>> vectors;
+};
+
+TEST_F(KnnTest, CompressedMatchesFlat) {
+  const size_t kDim = CountingVectorStore::kDim, kNumDocs = 2000, kLimit = 10;
+
+  auto flat_schema = MakeSimpleSchema({{"pos", SchemaField::VECTOR}, {"even", SchemaField::TAG}});
+  flat_schema.fields["pos"].special_params = SchemaField::VectorParams{false, kDim};
+  auto disk_schema = flat_schema;
+  get<SchemaField::VectorParams>(disk_schema.fields["pos"].special_params).use_disk = true;
+
+  FieldIndices flat{flat_schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+  FieldIndices disk{disk_schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+
+  size_t fetched = 0;
+  auto* compressed = dynamic_cast<CompressedVectorIndex*>(disk.GetIndex("pos"));
+  ASSERT_NE(compressed, nullptr);
+  compressed->SetStore(make_unique<CountingVectorStore>(&fetched));
+
+  mt19937 rng(42);
+  uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  auto random_vector = [&] {
+    vector<float> coords(kDim);
+    for (float& coord : coords)
+      coord = dist(rng);
+    return coords;
+  };
+
+  vector<MockedDocument> documents(kNumDocs);
+  for (size_t i = 0; i < kNumDocs; i++) {
+    documents[i] = Map{{"pos", ToBytes(absl::MakeConstSpan(random_vector()))},
+                       {"even", i % 2 == 0 ? "yes" : "no"}};
+    flat.Add(i, documents[i]);
+    disk.Add(i, documents[i]);
+  }
+
+  // Removed documents are neither ranked nor fetched
+  for (size_t i = 0; i < kNumDocs; i += 7) {
+    flat.Remove(i, documents[i]);
+    disk.Remove(i, documents[i]);
+  }
+
+  // Unfiltered queries search the graph, which finds almost all exact results
+  SearchAlgorithm algo{};
+  QueryParams params;
+  size_t found = 0;
+  for (size_t query = 0; query < 20; query++) {
+    fetched = 0;
+    params["vec"] = ToBytes(absl::MakeConstSpan(random_vector()));
+    algo.Init(absl::StrCat("*=>[KNN ", kLimit, " @pos $vec]"), &params);
+
+    auto expected = algo.Search(&flat);
+    auto result = algo.Search(&disk);
+    EXPECT_EQ(result.ids.size(), kLimit);
+    for (DocId id : result.ids)
+      found += count(expected.ids.begin(), expected.ids.end(), id);
+    EXPECT_LE(fetched, kLimit * CompressedVectorIndex::kRerankFactor);
+  }
+  EXPECT_GE(found, 20 * kLimit * 95 / 100);
+
+  // Filtered queries scan the matched documents
+  for (size_t query = 0; query < 20; query++) {
+    fetched = 0;
+    params["vec"] = ToBytes(absl::MakeConstSpan(random_vector()));
+    algo.Init(absl::StrCat("@even:{yes} =>[KNN ", kLimit, " @pos $vec]"), &params);
+
+    auto expected = algo.Search(&flat);
+    auto result = algo.Search(&disk);
+    EXPECT_EQ(result.ids, expected.ids);
+    EXPECT_LE(fetched, kLimit * CompressedVectorIndex::kRerankFactor);
+  }
+
+  // Range queries need all full precision vectors, they are not supported
+  params["vec"] = ToBytes(absl::MakeConstSpan(random_vector()));
+  algo.Init("@pos:[VECTOR_RANGE 1 $vec]", &params);
+  EXPECT_FALSE(algo.Search(&disk).error.empty());
+}
+
 // Seeds the given HNSW index with `n` deterministic random vectors of dim `dim` using
 // the given RNG seed. Returns the owning MockedDocuments so the caller can pass them
 // back to UpdateVectorData after a restore. Used by the serialization/restore tests.
@@ -1430,6 +1669,124 @@ TEST(HnswRestoreInvariant, MissingEntrypointFailsGracefully) {
   EXPECT_FALSE(restored.RestoreFromNodes(nodes, bad_metadata));
 }
 
+// Exact subset search wins for small prefilter results, graph search for large ones. A larger
+// ef makes graph search more expensive and moves the break-even point up.
+TEST(HnswCostModel, PreferSubsetKnn) {
+  constexpr size_t kDim = 4;
+  constexpr size_t kN = 1000;
+
+  InitTLSearchMR(PMR_NS::get_default_resource());
+  absl::Cleanup cleanup = [] { InitTLSearchMR(nullptr); };
+
+  SchemaField::VectorParams params;
+  params.use_hnsw = true;
+  params.dim = kDim;
+  params.sim = VectorSimilarity::L2;
+  params.capacity = kN;
+  params.hnsw_ef_runtime = 10;
+
+  HnswVectorIndex index(params, /*copy_vector=*/true);
+  SeedHnswIndex(index, kN, kDim, /*rng_seed=*/3);
+  ASSERT_EQ(index.GetNodeCount(), kN);
+
+  EXPECT_TRUE(index.PreferSubsetKnn(0, 10, std::nullopt));
+  EXPECT_TRUE(index.PreferSubsetKnn(100, 10, std::nullopt));
+  EXPECT_FALSE(index.PreferSubsetKnn(900, 10, std::nullopt));
+  EXPECT_FALSE(index.PreferSubsetKnn(kN, 10, std::nullopt));
+
+  EXPECT_TRUE(index.PreferSubsetKnn(900, 10, 500));
+  EXPECT_TRUE(index.PreferSubsetKnn(900, 500, std::nullopt));
+}
+
+// Vectors inserted in parallel batches form a graph as good as one built one by one: every
+// vector finds itself as its nearest neighbor.
+TEST(HnswBatchBuild, ParallelInsert) {
+  constexpr size_t kDim = 8;
+  constexpr size_t kN = 2000;
+  constexpr size_t kBatchSize = 300;
+
+  InitTLSearchMR(PMR_NS::get_default_resource());
+  absl::Cleanup cleanup = [] { InitTLSearchMR(nullptr); };
+
+  SchemaField::VectorParams params;
+  params.use_hnsw = true;
+  params.dim = kDim;
+  params.sim = VectorSimilarity::L2;
+  params.capacity = 10;  // Grows while inserting batches
+
+  HnswVectorIndex index(params, /*copy_vector=*/true);
+
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  vector<vector<float>> coords(kN, vector<float>(kDim));
+  HnswBatch batch;
+  for (size_t i = 0; i < kN; i++) {
+    for (float& c : coords[i])
+      c = dist(rng);
+    MockedDocument doc{Map{{"vec", ToBytes(absl::MakeConstSpan(coords[i]))}}};
+    ASSERT_TRUE(index.Collect(i, doc, "vec", &batch));
+
+    if (batch.size() == kBatchSize || i + 1 == kN) {
+      index.AddBatch(batch, /*num_helpers=*/3);
+      batch.clear();
+    }
+  }
+  EXPECT_FALSE(index.Collect(kN, MockedDocument{Map{{"other", "1"}}}, "vec", &batch));
+  EXPECT_TRUE(batch.empty());
+
+  ASSERT_EQ(index.GetNodeCount(), kN);
+  for (size_t i = 0; i < kN; i += 7) {
+    auto res = index.Knn(coords[i].data(), 1, std::nullopt);
+    ASSERT_EQ(res.size(), 1u);
+    EXPECT_EQ(res[0].second, i);
+  }
+}
+
+// Batched queries return exactly what separate queries return, also with deleted nodes
+TEST(HnswBatchKnn, MatchesSeparateQueries) {
+  constexpr size_t kDim = 16;
+  constexpr size_t kN = 3000;
+  constexpr size_t kNumQueries = 64;
+
+  InitTLSearchMR(PMR_NS::get_default_resource());
+  absl::Cleanup cleanup = [] { InitTLSearchMR(nullptr); };
+
+  SchemaField::VectorParams params;
+  params.use_hnsw = true;
+  params.dim = kDim;
+  params.sim = VectorSimilarity::L2;
+  params.capacity = kN;
+
+  HnswVectorIndex index(params, /*copy_vector=*/true);
+  SeedHnswIndex(index, kN, kDim, /*rng_seed=*/11);
+
+  // Similar queries share the first steps of their paths through the graph
+  std::mt19937 rng(12);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  vector<vector<float>> queries(kNumQueries, vector<float>(kDim));
+  for (size_t i = 0; i < kNumQueries; i++) {
+    for (size_t d = 0; d < kDim; d++)
+      queries[i][d] = i % 2 ? dist(rng) : queries[0][d] + dist(rng) * 0.01f;
+  }
+  vector<const void*> targets;
+  for (const auto& query : queries)
+    targets.push_back(query.data());
+
+  for (bool with_deletions : {false, true}) {
+    if (with_deletions) {
+      for (size_t i = 0; i < kN; i += 5)
+        index.Remove(i);
+    }
+
+    auto batched = index.KnnBatch(targets, 10, 20);
+    ASSERT_EQ(batched.size(), kNumQueries);
+    for (size_t i = 0; i < kNumQueries; i++)
+      EXPECT_EQ(batched[i], index.Knn(targets[i], 10, 20)) << i;
+  }
+
+  EXPECT_TRUE(index.KnnBatch({}, 10, std::nullopt).empty());
+}
+
 // Regression: in borrowed mode (copy_vector=false), Remove marks the node deleted
 // but hnswlib still traverses it and dereferences its data pointer.  If the external
 // data is freed (as happens after DEL), the pointer dangles.  The fix in DoRemove
@@ -2274,6 +2631,42 @@ static void BM_VectorSearch(benchmark::State& state) {
 
 BENCHMARK(BM_VectorSearch)->Args({120, 10'000});
 
+static void BM_HnswKnnBatch(benchmark::State& state) {
+  InitSimSIMD();
+  InitTLSearchMR(PMR_NS::get_default_resource());
+  absl::Cleanup cleanup = [] { InitTLSearchMR(nullptr); };
+
+  const size_t kDim = 64, kN = 20'000;
+  size_t batch_size = state.range(0);
+
+  SchemaField::VectorParams params;
+  params.use_hnsw = true;
+  params.dim = kDim;
+  params.capacity = kN;
+  HnswVectorIndex index(params, /*copy_vector=*/true);
+  SeedHnswIndex(index, kN, kDim, /*rng_seed=*/1);
+
+  std::mt19937 rng(2);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  vector<vector<float>> queries(batch_size, vector<float>(kDim));
+  vector<const void*> targets;
+  for (auto& query : queries) {
+    for (float& coord : query)
+      coord = dist(rng);
+    targets.push_back(query.data());
+  }
+
+  // Batch size 1 runs separate queries as the baseline
+  while (state.KeepRunningBatch(batch_size)) {
+    if (batch_size == 1)
+      benchmark::DoNotOptimize(index.Knn(targets[0], 10, std::nullopt));
+    else
+      benchmark::DoNotOptimize(index.KnnBatch(targets, 10, std::nullopt));
+  }
+}
+
+BENCHMARK(BM_HnswKnnBatch)->Arg(1)->Arg(16)->Arg(128)->ArgNames({"batch"});
+
 TEST_F(SearchTest, MatchNonNullField) {
   PrepareSchema({{"text_field", SchemaField::TEXT},
                  {"tag_field", SchemaField::TAG},
@@ -2412,6 +2805,65 @@ TEST_F(SortIndexTest, NumSort) {
   EXPECT_EQ(std::get<double>(lookup), 999);
 }
 
+TEST_F(SortIndexTest, IndexScanMatchesHeap) {
+  const auto schema = MakeSimpleSchema({{"cost", SchemaField::NUMERIC}, {"kind", SchemaField::TAG}},
+                                       true);
+  FieldIndices indices{schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+
+  const DocId kNumDocs = 1000;
+  auto make_doc = [](DocId id) {
+    auto cost = absl::StrCat((id * 37) % 101);
+    return MockedDocument{Map{{"cost", cost}, {"kind", id % 3 == 0 ? "fizz" : "buzz"}}};
+  };
+  for (DocId i = 0; i < kNumDocs; i++)
+    indices.Add(i, make_doc(i));
+
+  // Removed docs must disappear from the scanned order
+  for (DocId i = 0; i < kNumDocs; i += 10)
+    indices.Remove(i, make_doc(i));
+
+  auto* index = indices.GetSortIndex("cost");
+  auto search = [&](string_view query, size_t limit, bool desc) {
+    SearchAlgorithm algo{};
+    QueryParams params;
+    CHECK(algo.Init(query, &params));
+    SortIndexScan scan{index, limit, desc};
+    auto scanned = algo.Search(&indices, numeric_limits<size_t>::max(), nullptr, &scan);
+    return make_pair(std::move(scanned), algo.Search(&indices));
+  };
+
+  for (string_view query : {"*", "@kind:{buzz}"}) {
+    for (bool desc : {false, true}) {
+      SCOPED_TRACE(absl::StrCat(query, desc ? " desc" : " asc"));
+      auto [scanned, all] = search(query, 10, desc);
+      ASSERT_TRUE(scanned.sort_values);
+      EXPECT_EQ(scanned.total, all.total);
+      ASSERT_EQ(scanned.ids.size(), 10u);
+
+      // Ties are broken differently, so compare the values
+      auto expected = index->Sort(&all.ids, 10, desc);
+      EXPECT_EQ(*scanned.sort_values, expected);
+      for (DocId id : scanned.ids) {
+        EXPECT_NE(id % 10, 0u);
+        if (query != "*")
+          EXPECT_NE(id % 3, 0u);
+      }
+    }
+  }
+
+  // Numeric ranges can't be probed without collecting them
+  auto [range, range_all] = search("@cost:[0 50]", 10, false);
+  EXPECT_FALSE(range.sort_values);
+  EXPECT_EQ(range.ids.size(), range_all.ids.size());
+
+  // Nothing to stop early for
+  auto [all, unused] = search("*", kNumDocs, false);
+  EXPECT_FALSE(all.sort_values);
+
+  // A selective query is cheaper to sort than to find in the index
+  EXPECT_EQ(index->ChooseSortStrategy(20, 10, false), SortStrategy::kHeap);
+}
+
 // Enumeration for different search types
 enum class SearchType { PREFIX = 0, SUFFIX = 1, INFIX = 2 };
 
@@ -3529,6 +3981,49 @@ TEST_F(ScoringTest, ScorerTopKCutoff) {
   }
 }
 
+TEST_F(ScoringTest, BlockMaxTopKMatchesFullScoring) {
+  Schema schema = MakeSimpleSchema({{"field", SchemaField::TEXT}});
+  FieldIndices index{schema, kEmptyOptions, PMR_NS::get_default_resource(), nullptr};
+
+  // Enough docs to span several posting list blocks, with varying frequencies and lengths
+  const uint32_t kNumDocs = 5000;
+  for (uint32_t i = 0; i < kNumDocs; i++) {
+    vector<string> words;
+    if (i % 3 != 0)
+      words.insert(words.end(), (i * 7919) % 13 + 1, "hello");
+    if (i % 5 != 0)
+      words.insert(words.end(), (i * 104729) % 7 + 1, "world");
+    words.insert(words.end(), i % 11, "filler");
+    index.Add(i, MockedDocument(absl::StrJoin(words, " ")));
+  }
+  index.FinalizeInitialization();
+
+  for (auto kind : {ScorerKind::BM25STD, ScorerKind::BM25STD_TANH, ScorerKind::TFIDF,
+                    ScorerKind::TFIDF_DOCNORM}) {
+    QueryParams params;
+    SearchAlgorithm algo;
+    ASSERT_TRUE(algo.Init("hello | world", &params));
+    algo.SetScorer(ScorerSpec{kind});
+
+    auto full = algo.Search(&index, numeric_limits<size_t>::max());
+    vector<pair<float, DocId>> expected;
+    for (DocId id : full.ids)
+      expected.emplace_back(full.text_scores.at(id), id);
+    sort(expected.begin(), expected.end(), greater<>());
+
+    for (size_t limit : {1, 10, 100}) {
+      auto top = algo.Search(&index, limit);
+      EXPECT_EQ(top.total, full.total);
+      EXPECT_FLOAT_EQ(top.max_text_score, full.max_text_score);
+      ASSERT_EQ(top.ids.size(), limit);
+      for (size_t i = 0; i < limit; i++) {
+        EXPECT_EQ(top.ids[i], expected[i].second) << int(kind) << " " << limit << " " << i;
+        EXPECT_EQ(top.text_scores.at(top.ids[i]), expected[i].first);
+      }
+    }
+  }
+}
+
 TEST_F(SearchTest, MatchOptional) {
   // ~term returns ALL documents, not just matching ones
   PrepareQuery("~hello");
@@ -20,8 +20,20 @@ using namespace std;
 namespace {
 template <typename T>
 using ScoreT = std::conditional_t<is_same_v<T, StatelessString>, std::string, T>;
+
+// An index scan pays off when it is expected to visit at most 1/kIndexScanMaxFraction of the
+// number of matches, all of which the heap strategy has to collect and compare.
+constexpr size_t kIndexScanMaxFraction = 4;
 }  // namespace
 
+template <typename T> SimpleValueSortIndex<T>::SimpleValueSortIndex() : ordered_{ValueOrder{this}} {
+}
+
+template <typename T>
+bool SimpleValueSortIndex<T>::ValueOrder::operator()(DocId l, DocId r) const {
+  return make_pair(cref(index->values_[l]), l) < make_pair(cref(index->values_[r]), r);
+}
+
 template <typename T> bool SimpleValueSortIndex<T>::ParsedSortValue::HasValue() const {
   return !std::holds_alternative<std::monostate>(value);
 }
@@ -39,6 +51,41 @@ template <typename T> SortableValue SimpleValueSortIndex<T>::Lookup(DocId doc) c
   return ScoreT<T>{values_[doc]};
 }
 
+template <typename T>
+SortStrategy SimpleValueSortIndex<T>::ChooseSortStrategy(size_t num_matches, size_t limit,
+                                                         bool desc) const {
+  // Docs with null values rank first in descending order, they are not part of ordered_
+  if (limit >= num_matches || (desc && null_count_ > 0))
+    return SortStrategy::kHeap;
+
+  // Assume matches are spread evenly over the sort order
+  size_t expected_scan = limit * ordered_.size() / num_matches;
+  return expected_scan * kIndexScanMaxFraction <= num_matches ? SortStrategy::kIndexScan
+                                                              : SortStrategy::kHeap;
+}
+
+template <typename T>
+std::vector<SortableValue> SimpleValueSortIndex<T>::ScanSorted(
+    std::vector<DocId>* ids, size_t limit, bool desc,
+    absl::FunctionRef<bool(DocId)> matches) const {
+  ids->clear();
+  auto scan = [&](auto it, auto end) {
+    for (; it != end && ids->size() < limit; ++it) {
+      if (matches(*it))
+        ids->push_back(*it);
+    }
+  };
+  if (desc)
+    scan(ordered_.rbegin(), ordered_.rend());
+  else
+    scan(ordered_.begin(), ordered_.end());
+
+  vector<SortableValue> out(ids->size());
+  for (size_t i = 0; i < out.size(); i++)
+    out[i] = ScoreT<T>{values_[(*ids)[i]]};
+  return out;
+}
+
 template <typename T>
 std::vector<SortableValue> SimpleValueSortIndex<T>::Sort(std::vector<DocId>* ids, size_t limit,
                                                          bool desc) const {
@@ -69,9 +116,13 @@ bool SimpleValueSortIndex<T>::Add(DocId id, const DocumentAccessor& doc, std::st
     occupied_.resize(id + 1);
   }
 
+  DCHECK(!occupied_[id]);
   if (!field_value.IsNullValue()) {
     values_[id] = std::move(std::get<T>(field_value.value));
     occupied_[id] = true;
+    ordered_.insert(id);
+  } else {
+    null_count_++;
   }
   return true;
 }
@@ -81,6 +132,12 @@ void SimpleValueSortIndex<T>::Remove(DocId id, const DocumentAccessor& doc,
                                      std::string_view field) {
   DCHECK_LT(id, values_.size());
   DCHECK_EQ(values_.size(), occupied_.size());
+  if (occupied_[id]) {
+    ordered_.erase(id);  // before resetting the value it is ordered by
+  } else {
+    DCHECK_GT(null_count_, 0u);
+    null_count_--;
+  }
   values_[id] = T{};
   occupied_[id] = false;
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <absl/container/btree_set.h>
+
 #include "core/search/base.h"
 #include "core/search/stateless_allocator.h"
 
@@ -29,8 +31,14 @@ template <typename T> struct SimpleValueSortIndex : BaseSortIndex {
   };
 
  public:
+  SimpleValueSortIndex();
+  SimpleValueSortIndex(const SimpleValueSortIndex&) = delete;  // ordered_ points to this
+
   SortableValue Lookup(DocId doc) const override;
   std::vector<SortableValue> Sort(std::vector<DocId>* ids, size_t limit, bool desc) const override;
+  SortStrategy ChooseSortStrategy(size_t num_matches, size_t limit, bool desc) const override;
+  std::vector<SortableValue> ScanSorted(std::vector<DocId>* ids, size_t limit, bool desc,
+                                        absl::FunctionRef<bool(DocId)> matches) const override;
 
   bool Add(DocId id, const DocumentAccessor& doc, std::string_view field) override;
   void Remove(DocId id, const DocumentAccessor& doc, std::string_view field) override;
@@ -42,8 +50,18 @@ template <typename T> struct SimpleValueSortIndex : BaseSortIndex {
   virtual ParsedSortValue Get(const DocumentAccessor& doc, std::string_view field_value) = 0;
 
  private:
+  // Orders doc ids by (value, id)
+  struct ValueOrder {
+    bool operator()(DocId l, DocId r) const;
+    const SimpleValueSortIndex* index;
+  };
+
   StatelessVector<T> values_;
   StatelessVector<bool> occupied_;  // instead of optional<T> in values to avoid memory overhead
+
+  // Ids of docs with non-null values in sort order, walked by ScanSorted()
+  absl::btree_set<DocId, ValueOrder, StatelessSearchAllocator<DocId>> ordered_;
+  size_t null_count_ = 0;  // docs added with a null value
 };
 
 struct NumericSortIndex : SimpleValueSortIndex<double> {
@@ -121,6 +121,39 @@ float Bf16ToFloat(uint16_t b) {
   return static_cast<float>(std::bit_cast<__bf16>(b));
 }
 
+namespace {
+
+template <typename T, typename F>
+void WidenElements(const void* v, size_t dims, F decode, float* out) {
+  const char* bytes = static_cast<const char*>(v);
+  for (size_t i = 0; i < dims; i++) {
+    T elem;
+    memcpy(&elem, bytes + i * sizeof(T), sizeof(T));
+    out[i] = decode(elem);
+  }
+}
+
+}  // namespace
+
+void ToFloatVector(const void* v, size_t dims, VectorDataType dt, float* out) {
+  auto cast = [](auto elem) { return static_cast<float>(elem); };
+  switch (dt) {
+    case VectorDataType::FLOAT32:
+      memcpy(out, v, dims * sizeof(float));
+      return;
+    case VectorDataType::FLOAT64:
+      return WidenElements<double>(v, dims, cast, out);
+    case VectorDataType::FLOAT16:
+      return WidenElements<uint16_t>(v, dims, HalfToFloat, out);
+    case VectorDataType::BFLOAT16:
+      return WidenElements<uint16_t>(v, dims, Bf16ToFloat, out);
+    case VectorDataType::INT8:
+      return WidenElements<int8_t>(v, dims, cast, out);
+    case VectorDataType::UINT8:
+      return WidenElements<uint8_t>(v, dims, cast, out);
+  }
+}
+
 uint16_t FloatToHalf(float f) {
   return std::bit_cast<uint16_t>(static_cast<_Float16>(f));
 }
@@ -315,6 +348,54 @@ float VectorDistance(const void* u, const void* v, size_t dims, VectorSimilarity
   return 0.0f;
 }
 
+namespace {
+
+template <typename Dist>
+void DistancesToMany(Dist dist, const void* v, const void* const* queries, size_t num_queries,
+                     size_t dims, VectorSimilarity sim, float* out) {
+  for (size_t i = 0; i < num_queries; i++) {
+    if (i + 1 < num_queries)
+      __builtin_prefetch(queries[i + 1], 0, 3);
+    out[i] = dist(queries[i], v, dims, sim);
+  }
+}
+
+}  // namespace
+
+void VectorDistanceOneToMany(const void* v, const void* const* queries, size_t num_queries,
+                             size_t dims, VectorSimilarity sim, VectorDataType dt, float* out) {
+  // The element type is resolved once for all queries, `v` stays in cache between them
+  switch (dt) {
+#ifdef WITH_SIMSIMD
+    case VectorDataType::FLOAT32:
+      return DistancesToMany(SimsimdDist_f32, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::FLOAT64:
+      return DistancesToMany(SimsimdDist_f64, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::FLOAT16:
+      return DistancesToMany(SimsimdDist_f16, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::BFLOAT16:
+      return DistancesToMany(SimsimdDist_bf16, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::INT8:
+      return DistancesToMany(SimsimdDist_i8, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::UINT8:
+      return DistancesToMany(SimsimdDist_u8, v, queries, num_queries, dims, sim, out);
+#else
+    case VectorDataType::FLOAT32:
+      return DistancesToMany(DistByMetric<ReaderF32>, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::FLOAT64:
+      return DistancesToMany(DistByMetric<ReaderF64>, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::FLOAT16:
+      return DistancesToMany(DistByMetric<ReaderF16>, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::BFLOAT16:
+      return DistancesToMany(DistByMetric<ReaderBF16>, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::INT8:
+      return DistancesToMany(DistByMetric<ReaderI8>, v, queries, num_queries, dims, sim, out);
+    case VectorDataType::UINT8:
+      return DistancesToMany(DistByMetric<ReaderU8>, v, queries, num_queries, dims, sim, out);
+#endif
+  }
+}
+
 std::string_view VectorSimilarityToString(VectorSimilarity sim) {
   switch (sim) {
     case VectorSimilarity::L2:
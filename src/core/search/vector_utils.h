@@ -30,6 +30,15 @@ float VectorDistance(const float* u, const float* v, size_t dims, VectorSimilari
 float VectorDistance(const void* u, const void* v, size_t dims, VectorSimilarity sim,
                      VectorDataType dt);
 
+// Distances between each of `num_queries` query blobs and one stored blob `v`, written to `out`.
+// out[i] equals VectorDistance(queries[i], v, ...). Batched KNN compares a stored vector with
+// all queries that reach it while it is in cache, instead of fetching it once per query.
+void VectorDistanceOneToMany(const void* v, const void* const* queries, size_t num_queries,
+                             size_t dims, VectorSimilarity sim, VectorDataType dt, float* out);
+
+// Widens the `dims` native-width elements of `v` to float.
+void ToFloatVector(const void* v, size_t dims, VectorDataType dt, float* out);
+
 // Widen a half-precision (h) or bfloat16 (b) element, given as its raw 16-bit pattern, to float.
 float HalfToFloat(uint16_t h);
 float Bf16ToFloat(uint16_t b);
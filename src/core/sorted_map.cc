@@ -4,6 +4,7 @@
 
 #include "core/sorted_map.h"
 
+#include <absl/strings/numbers.h>
 #include <absl/strings/str_cat.h>
 
 #include <cmath>
@@ -1143,7 +1144,8 @@ uint64_t SortedMap::Scan(uint64_t cursor,
 }
 
 // taken from zsetConvert
-SortedMap* SortedMap::FromListPack(PMR_NS::memory_resource* res, const uint8_t* lp) {
+SortedMap* SortedMap::FromListPack(PMR_NS::memory_resource* res, const uint8_t* lp,
+                                   size_t extra) {
   uint8_t* zl = (uint8_t*)lp;
   unsigned char *eptr, *sptr;
   unsigned char* vstr;
@@ -1152,6 +1154,7 @@ SortedMap* SortedMap::FromListPack(PMR_NS::memory_resource* res, const uint8_t*
 
   void* ptr = res->allocate(sizeof(SortedMap), alignof(SortedMap));
   SortedMap* zs = new (ptr) SortedMap;
+  zs->Reserve(lpLength(zl) / 2 + extra);
 
   eptr = lpSeek(zl, 0);
   if (eptr != NULL) {
@@ -1163,7 +1166,9 @@ SortedMap* SortedMap::FromListPack(PMR_NS::memory_resource* res, const uint8_t*
     double score = ZzlGetScore(sptr);
     vstr = lpGetValue(eptr, &vlen, &vlong);
     if (vstr == NULL) {
-      CHECK(zs->InsertNew(score, absl::StrCat(vlong)));
+      char buf[32];
+      char* next = absl::numbers_internal::FastIntToBuffer(vlong, buf);
+      CHECK(zs->InsertNew(score, string_view{buf, size_t(next - buf)}));
     } else {
       CHECK(zs->InsertNew(score, string_view{reinterpret_cast<const char*>(vstr), vlen}));
     }
@@ -116,7 +116,11 @@ class SortedMap {
   uint64_t Scan(uint64_t cursor, absl::FunctionRef<void(std::string_view, double)> cb) const;
 
   uint8_t* ToListPack() const;
-  static SortedMap* FromListPack(PMR_NS::memory_resource* res, const uint8_t* lp);
+
+  // Converts the listpack, reserving room for `extra` more members that the caller is
+  // about to add, so that the conversion does not rehash on the following inserts.
+  static SortedMap* FromListPack(PMR_NS::memory_resource* res, const uint8_t* lp,
+                                 size_t extra = 0);
 
   bool DefragIfNeeded(PageUsage* page_usage);
 
@@ -107,6 +107,13 @@ bool StringMap::AddOrSkip(std::string_view field, std::string_view value, uint32
   return true;
 }
 
+void StringMap::AddNew(std::string_view field, std::string_view value, uint32_t ttl_sec) {
+  DCHECK(!Contains(field)) << field;
+  uint64_t hashcode = Hash(&field, 1);
+  auto [newkey, sdsval_tag] = CreateEntry(field, value, time_now(), ttl_sec);
+  AddUnique(newkey, sdsval_tag & kValTtlBit, hashcode);
+}
+
 bool StringMap::Erase(string_view key) {
   return EraseInternal(&key, 1);
 }
@@ -126,6 +126,10 @@ class StringMap : public DenseSet {
   // false, if already exists. In that case no update is done.
   bool AddOrSkip(std::string_view field, std::string_view value, uint32_t ttl_sec = UINT32_MAX);
 
+  // Adds a field that is known to be absent, e.g. when converting from a listpack.
+  // Skips the lookup, so the caller must guarantee uniqueness.
+  void AddNew(std::string_view field, std::string_view value, uint32_t ttl_sec = UINT32_MAX);
+
   bool Erase(std::string_view s1);
 
   // Removes and returns the sds entry for the given key without freeing it.
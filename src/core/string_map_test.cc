@@ -96,6 +96,20 @@ TEST_F(StringMapTest, Basic) {
   EXPECT_STREQ("baraaaaaaaaaaaa2", it->second);
 }
 
+TEST_F(StringMapTest, AddNew) {
+  sm_->Reserve(100);
+  for (unsigned i = 0; i < 100; ++i) {
+    sm_->AddNew(absl::StrCat("field", i), absl::StrCat("value", i));
+  }
+  EXPECT_EQ(100u, sm_->UpperBoundSize());
+  for (unsigned i = 0; i < 100; ++i) {
+    auto it = sm_->Find(absl::StrCat("field", i));
+    ASSERT_TRUE(it != sm_->end());
+    EXPECT_EQ(absl::StrCat("value", i), string_view(it->second, sdslen(it->second)));
+  }
+  EXPECT_FALSE(sm_->AddOrSkip("field1", "other"));
+}
+
 TEST_F(StringMapTest, EmptyFind) {
   sm_->Find("bar");
 }
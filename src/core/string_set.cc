@@ -112,6 +112,33 @@ unsigned StringSet::AddBatch(absl::Span<std::string_view> span, uint32_t ttl_sec
   return res;
 }
 
+void StringSet::ContainsMany(absl::Span<const std::string_view> span, bool* found) {
+  while (span.size() > kMaxBatchLen) {
+    ContainsBatch(span.subspan(0, kMaxBatchLen), found);
+    span.remove_prefix(kMaxBatchLen);
+    found += kMaxBatchLen;
+  }
+
+  if (!span.empty())
+    ContainsBatch(span, found);
+}
+
+void StringSet::ContainsBatch(absl::Span<const std::string_view> span, bool* found) {
+  uint64_t hash[kMaxBatchLen];
+  unsigned count = span.size();
+
+  DCHECK_LE(count, kMaxBatchLen);
+
+  for (unsigned i = 0; i < count; i++) {
+    hash[i] = Hash(&span[i], 1);
+    Prefetch(hash[i]);
+  }
+
+  for (unsigned i = 0; i < count; ++i) {
+    found[i] = FindInternal(&span[i], hash[i], 1) != nullptr;
+  }
+}
+
 StringSet::iterator StringSet::GetRandomMember() {
   return iterator{DenseSet::GetRandomIterator()};
 }
@@ -39,6 +39,10 @@ class StringSet : public DenseSet {
     return FindInternal(&s1, Hash(&s1, 1), 1) != nullptr;
   }
 
+  // Batched membership lookup: found[i] is set to whether span[i] is in the set.
+  // Hashes the whole batch first and prefetches the buckets before probing, similarly to AddMany.
+  void ContainsMany(absl::Span<const std::string_view> span, bool* found);
+
   class iterator : private IteratorBase {
    public:
     using iterator_category = std::forward_iterator_tag;
@@ -112,6 +116,7 @@ class StringSet : public DenseSet {
   uint64_t Hash(const void* ptr, uint32_t cookie) const final;
 
   unsigned AddBatch(absl::Span<std::string_view> span, uint32_t ttl_sec, bool keepttl);
+  void ContainsBatch(absl::Span<const std::string_view> span, bool* found);
 
   bool ObjEqual(const void* left, const void* right, uint32_t right_cookie) const final;
 
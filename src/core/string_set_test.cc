@@ -96,6 +96,24 @@ TEST_F(StringSetTest, Basic) {
   EXPECT_EQ(2, ss_->UpperBoundSize());
 }
 
+TEST_F(StringSetTest, ContainsMany) {
+  for (unsigned i = 0; i < 100; i += 2) {
+    EXPECT_TRUE(ss_->Add(absl::StrCat("m", i)));
+  }
+
+  // Cross the batch boundary to cover both full and partial batches.
+  vector<string> members;
+  for (unsigned i = 0; i < 100; ++i) {
+    members.push_back(absl::StrCat("m", i));
+  }
+  vector<string_view> views(members.begin(), members.end());
+  unique_ptr<bool[]> found(new bool[views.size()]);
+  ss_->ContainsMany(absl::MakeConstSpan(views), found.get());
+  for (unsigned i = 0; i < views.size(); ++i) {
+    EXPECT_EQ(i % 2 == 0, found[i]) << views[i];
+  }
+}
+
 TEST_F(StringSetTest, StandardAddErase) {
   EXPECT_TRUE(ss_->Add("@@@@@@@@@@@@@@@@"));
   EXPECT_TRUE(ss_->Add("A@@@@@@@@@@@@@@@"));
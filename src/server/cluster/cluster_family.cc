@@ -1003,6 +1003,8 @@ void ClusterFamily::InitMigration(CmdArgParser parser, CommandContext* cmd_cntx)
 
 void ClusterFamily::DflyMigrateFlow(CmdArgParser parser, CommandContext* cmd_cntx) {
   auto [source_id, shard_id] = parser.Next<std::string_view, uint32_t>();
+  // The source asks whether the flow can receive entries in the native snapshot format.
+  bool native = parser.Check("RDB");
 
   RETURN_ON_PARSE_ERROR(parser, cmd_cntx);
 
@@ -1022,7 +1024,10 @@ void ClusterFamily::DflyMigrateFlow(CmdArgParser parser, CommandContext* cmd_cnt
   // TODO provide a more clear approach
   conn_cntx->sync_dispatch = false;
 
-  cmd_cntx->SendOk();
+  if (native)
+    cmd_cntx->SendSimpleString("RDB");
+  else
+    cmd_cntx->SendOk();
 
   // Try migrating the connection if we have the same shard configuration
   if (migration->ShardNum() == shard_set->size() &&
@@ -0,0 +1,210 @@
+// Copyright 2025, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/cluster/cluster_proxy.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/ascii.h>
+#include <absl/strings/str_cat.h>
+
+#include "base/flags.h"
+#include "base/logging.h"
+#include "facade/error.h"
+#include "facade/reply_builder.h"
+#include "facade/resp_parser.h"
+#include "server/cluster/cluster_config.h"
+#include "server/cluster/coordinator.h"
+#include "server/cluster_support.h"
+
+ABSL_FLAG(bool, cluster_proxy_mode, false,
+          "If true, cluster nodes forward commands for slots they do not own to the owning node "
+          "instead of replying with MOVED. Cross-slot MGET, MSET, DEL, UNLINK, EXISTS and TOUCH "
+          "are split per slot and their replies are merged.");
+
+using namespace std;
+using namespace facade;
+
+namespace dfly::cluster {
+
+namespace {
+
+// How the replies of per-slot sub-commands are combined into the reply of the original command.
+enum class MergeKind : uint8_t {
+  kArray,  // one element per key, in the order of the original keys
+  kSum,    // sum of integer replies
+  kAllOk,  // OK if all sub-commands replied with OK
+};
+
+struct SplitSpec {
+  string_view name;
+  MergeKind merge;
+};
+
+constexpr SplitSpec kSplitCommands[] = {
+    {"MGET", MergeKind::kArray},  {"MSET", MergeKind::kAllOk}, {"DEL", MergeKind::kSum},
+    {"UNLINK", MergeKind::kSum},  {"EXISTS", MergeKind::kSum}, {"TOUCH", MergeKind::kSum},
+};
+
+const SplitSpec* FindSplitSpec(string_view name) {
+  for (const auto& spec : kSplitCommands) {
+    if (absl::EqualsIgnoreCase(spec.name, name))
+      return &spec;
+  }
+  return nullptr;
+}
+
+struct SubCommand {
+  SlotId slot;
+  vector<string_view> args;  // including the command name
+  unsigned num_keys = 0;
+  RESPObj reply;
+};
+
+// Replies to the client with a reply received from another node.
+void SendRespObj(const RESPObj& obj, RedisReplyBuilder* rb) {
+  if (obj.Empty())
+    return rb->SendError("Empty reply from the owning node");
+
+  switch (obj.GetType()) {
+    case RESPObj::Type::INTEGER:
+      return rb->SendLong(*obj.As<int64_t>());
+    case RESPObj::Type::DOUBLE:
+      return rb->SendDouble(*obj.As<double>());
+    case RESPObj::Type::STRING:
+      return rb->SendBulkString(*obj.As<string_view>());
+    case RESPObj::Type::NIL:
+      return rb->SendNull();
+    case RESPObj::Type::REPLY_STATUS:
+      return rb->SendSimpleString(*obj.As<string_view>());
+    case RESPObj::Type::ERROR: {
+      string_view err = *obj.As<string_view>();
+      return rb->SendError(absl::StrCat("-", err), err.substr(0, err.find(' ')));
+    }
+    case RESPObj::Type::ARRAY:
+    case RESPObj::Type::SET:
+    case RESPObj::Type::MAP: {
+      // Coordinator connections speak RESP2, so maps and sets are not expected here. If they
+      // do arrive they are relayed as flat arrays.
+      RESPArray arr = *obj.As<RESPArray>();
+      RedisReplyBuilder::ReplyScope scope(rb);
+      rb->StartArray(arr.Size());
+      for (size_t i = 0; i < arr.Size(); ++i)
+        SendRespObj(arr[i], rb);
+      return;
+    }
+  }
+  rb->SendError(absl::StrCat("Unsupported reply type ", static_cast<int>(obj.GetType())));
+}
+
+void MergeReplies(MergeKind merge, absl::Span<SubCommand> subs,
+                  const vector<pair<uint32_t, uint32_t>>& key_order, RedisReplyBuilder* rb) {
+  for (const auto& sub : subs) {
+    if (sub.reply.Empty() || sub.reply.GetType() == RESPObj::Type::ERROR)
+      return SendRespObj(sub.reply, rb);
+  }
+
+  switch (merge) {
+    case MergeKind::kArray: {
+      RedisReplyBuilder::ReplyScope scope(rb);
+      rb->StartArray(key_order.size());
+      for (auto [sub_id, pos] : key_order) {
+        auto arr = subs[sub_id].reply.As<RESPArray>();
+        if (arr && pos < arr->Size())
+          SendRespObj((*arr)[pos], rb);
+        else
+          rb->SendNull();
+      }
+      return;
+    }
+    case MergeKind::kSum: {
+      int64_t sum = 0;
+      for (const auto& sub : subs)
+        sum += sub.reply.As<int64_t>().value_or(0);
+      return rb->SendLong(sum);
+    }
+    case MergeKind::kAllOk:
+      return rb->SendOk();
+  }
+}
+
+}  // namespace
+
+bool IsProxyModeEnabled() {
+  return absl::GetFlag(FLAGS_cluster_proxy_mode);
+}
+
+bool CanSplitCrossSlot(string_view name) {
+  return FindSplitSpec(name) != nullptr;
+}
+
+void ProxyCommand(string_view name, const ParsedArgs& tail_args, const KeyIndex& key_index,
+                  RedisReplyBuilder* rb) {
+  auto cluster_config = ClusterConfig::Current();
+  if (!cluster_config)
+    return rb->SendError(kClusterNotConfigured);
+
+  vector<SubCommand> subs;
+  vector<pair<uint32_t, uint32_t>> key_order;  // (sub-command, key position in it) per key
+  const SplitSpec* spec = nullptr;
+
+  UniqueSlotChecker slot_checker;
+  for (string_view key : key_index.Range(tail_args))
+    slot_checker.Add(key);
+
+  if (auto slot = slot_checker.GetUniqueSlotId(); slot) {
+    // All keys belong to one slot, so the command is forwarded as is.
+    auto& sub = subs.emplace_back();
+    sub.slot = *slot;
+    sub.args.push_back(name);
+    sub.args.insert(sub.args.end(), tail_args.begin(), tail_args.end());
+  } else {
+    spec = FindSplitSpec(name);
+    DCHECK(spec) << name;
+
+    // Key commands we split have no arguments besides keys and their values.
+    absl::flat_hash_map<SlotId, uint32_t> slot_to_sub;
+    for (unsigned i : key_index.Range()) {
+      SlotId slot = KeySlot(tail_args[i]);
+      auto [it, inserted] = slot_to_sub.emplace(slot, subs.size());
+      if (inserted) {
+        auto& sub = subs.emplace_back();
+        sub.slot = slot;
+        sub.args.push_back(name);
+      }
+
+      auto& sub = subs[it->second];
+      key_order.emplace_back(it->second, sub.num_keys++);
+      for (unsigned j = i; j < i + key_index.step; ++j)
+        sub.args.push_back(tail_args[j]);
+    }
+  }
+
+  // Sub-commands for the same node are pipelined on the node's coordinator connection. Slots
+  // owned by this node are forwarded as well, which keeps the merge logic in one place.
+  vector<util::fb2::Future<GenericError>> futures;
+  futures.reserve(subs.size());
+  for (auto& sub : subs) {
+    ClusterNodeInfo owner = cluster_config->GetMasterNodeForSlot(sub.slot);
+    futures.push_back(Coordinator::Current().Dispatch(
+        owner.ip, owner.port, Coordinator::EncodeCommand(sub.args),
+        [&sub](RESPObj reply) { sub.reply = std::move(reply); }));
+  }
+
+  GenericError error;
+  for (auto& future : futures) {
+    if (auto ec = future.Get(); ec && !error)
+      error = std::move(ec);
+  }
+  if (error) {
+    VLOG(1) << "Could not proxy " << name << ": " << error.Format();
+    return rb->SendError(absl::StrCat("-TRYAGAIN Could not proxy the command: ", error.Format()));
+  }
+
+  VLOG(2) << "Proxied " << name << " as " << subs.size() << " sub-commands";
+  if (spec == nullptr)
+    return SendRespObj(subs.front().reply, rb);
+  MergeReplies(spec->merge, absl::MakeSpan(subs), key_order, rb);
+}
+
+}  // namespace dfly::cluster
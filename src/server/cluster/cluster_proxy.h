@@ -0,0 +1,33 @@
+// Copyright 2025, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#pragma once
+
+#include <string_view>
+
+#include "facade/facade_types.h"
+#include "server/tx_base.h"
+
+namespace facade {
+class RedisReplyBuilder;
+}  // namespace facade
+
+namespace dfly::cluster {
+
+// Proxy mode lets cluster unaware clients use any node of the cluster. Instead of replying with
+// MOVED, a node forwards commands for slots it does not own to their owners over the Coordinator
+// connections and relays the replies. Multi-key commands that span several slots are split into
+// per-slot sub-commands when their replies can be merged, see CanSplitCrossSlot().
+bool IsProxyModeEnabled();
+
+// Returns true if a cross-slot command `name` can be split into per-slot sub-commands.
+bool CanSplitCrossSlot(std::string_view name);
+
+// Forwards command `name` with `tail_args` to the owners of its keys and sends the reply to `rb`.
+// `key_index` describes the key positions inside `tail_args`. Blocks the calling fiber until
+// all the owners reply.
+void ProxyCommand(std::string_view name, const facade::ParsedArgs& tail_args,
+                  const KeyIndex& key_index, facade::RedisReplyBuilder* rb);
+
+}  // namespace dfly::cluster
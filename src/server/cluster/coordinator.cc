@@ -4,9 +4,12 @@
 
 #include "server/cluster/coordinator.h"
 
+#include <algorithm>
+
 #include "base/flags.h"
 #include "base/logging.h"
 #include "facade/redis_parser.h"
+#include "facade/reply_builder.h"
 #include "facade/socket_utils.h"
 #include "server/cluster/cluster_config.h"
 
@@ -22,21 +25,34 @@ namespace dfly::cluster {
 
 class Coordinator::CrossShardRequest {
  public:
-  CrossShardRequest(std::string cmd, Coordinator::RespCB cb, uint32_t total_shards)
-      : command_(std::move(cmd)), cb_(std::move(cb)), shard_processed_(total_shards) {
+  // `wire_cmd` is sent as is, it must be either RESP encoded or an inline command with CRLF.
+  CrossShardRequest(std::string wire_cmd, Coordinator::RespCB cb, uint32_t total_shards)
+      : command_(std::move(wire_cmd)), cb_(std::move(cb)), shards_left_(total_shards) {
   }
 
-  const std::string& GetCommand() const {
+  const std::string& GetWireCommand() const {
     return command_;
   }
 
-  template <class... Args> void Exec(Args&&... args) {
-    cb_(std::forward<Args>(args)...);
-    if (shard_processed_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+  void Exec(facade::RESPObj resp) {
+    std::lock_guard lk(mu_);
+    if (done_)  // failed by another shard, the caller may not wait for the callbacks anymore
+      return;
+    cb_(std::move(resp));
+    if (--shards_left_ == 0) {
+      done_ = true;
       future_.Resolve(GenericError{});
     }
   }
 
+  // Resolves the future with the error, the callback is not called anymore.
+  void Fail(GenericError err) {
+    std::lock_guard lk(mu_);
+    if (std::exchange(done_, true))
+      return;
+    future_.Resolve(std::move(err));
+  }
+
   util::fb2::Future<GenericError>& GetFuture() {
     return future_;
   }
@@ -45,7 +61,10 @@ class Coordinator::CrossShardRequest {
   std::string command_;
   Coordinator::RespCB cb_;
   util::fb2::Future<GenericError> future_;
-  std::atomic_uint32_t shard_processed_;
+
+  util::fb2::Mutex mu_;  // shards reply from different threads
+  uint32_t shards_left_;
+  bool done_ = false;
 };
 
 class Coordinator::CrossShardClient : public ProtocolClient {
@@ -58,8 +77,9 @@ class Coordinator::CrossShardClient : public ProtocolClient {
     exec_st_.Cancel();
     waker_.notifyAll();
     CloseSocket();
-    send_fb_.Join();
-    resp_fb_.Join();
+    send_fb_.JoinIfNeeded();
+    resp_fb_.JoinIfNeeded();
+    FailAll(GenericError(make_error_code(errc::operation_canceled), "Coordinator shutdown"));
   }
 
   [[nodiscard]] bool Init() {
@@ -79,78 +99,130 @@ class Coordinator::CrossShardClient : public ProtocolClient {
       return false;
     }
 
+    // Mark the connection, so the receiving node never proxies commands it gets through it.
+    if (auto ec = SendCommandAndReadResponse(
+            absl::StrCat("CLIENT SETNAME ", Coordinator::kConnectionName));
+        ec || !CheckRespIsSimpleReply("OK")) {
+      LOG(WARNING) << "Couldn't set coordinator connection name on " << server().Description();
+      exec_st_.ReportError(GenericError(ec, "Couldn't set connection name."));
+      return false;
+    }
+
     ResetParser(RedisParser::Mode::CLIENT);
     send_fb_ = util::fb2::Fiber("CSS_SendFb", &CrossShardClient::SendFb, this);
     resp_fb_ = util::fb2::Fiber("CSS_RespFb", &CrossShardClient::RespFb, this);
     return true;
   }
 
-  void Cancel() {
-    exec_st_.Cancel();
-    ShutdownSocket();
+  // A broken client fails all requests and is replaced by a new connection.
+  bool IsBroken() const {
+    return !exec_st_.IsRunning();
   }
 
   void EnqueueCommand(CrossShardRequestPtr req) {
     {
-      std::lock_guard lk(send_mu_);
-      send_queue_.push(req);
-      ready_to_send_ = true;
-    }
-    {
-      std::lock_guard lk(resp_mu_);
-      resp_queue_.push(req);
-      ready_to_resp_ = true;
+      // Both queues are updated together, so requests are sent and answered in the same order.
+      std::lock_guard lk(mu_);
+      if (!IsBroken()) {
+        send_queue_.push(req);
+        resp_queue_.push(req);
+        ready_to_send_ = true;
+        ready_to_resp_ = true;
+        req = nullptr;
+      }
     }
 
-    waker_.notifyAll();
+    if (req)
+      req->Fail(BrokenError());
+    else
+      waker_.notifyAll();
   }
 
   void SendFb() {
-    while (!exec_st_.IsCancelled()) {
-      waker_.await([this] { return exec_st_.IsCancelled() || ready_to_send_; });
-      if (exec_st_.IsCancelled())
-        return;
-      std::lock_guard lk(send_mu_);
-      while (!send_queue_.empty()) {
-        if (auto ec = ProtocolClient::SendCommand(send_queue_.front()->GetCommand()); ec) {
-          exec_st_.ReportError(GenericError(
-              ec, absl::StrCat("Coordinator could not send command to : ", server().Description(),
-                               "socket state: ", SockInfo())));
-          // TODO reinit connection.
-          break;
+    while (exec_st_.IsRunning()) {
+      waker_.await([this] { return !exec_st_.IsRunning() || ready_to_send_; });
+
+      std::queue<CrossShardRequestPtr> batch;
+      {
+        std::lock_guard lk(mu_);
+        batch.swap(send_queue_);
+        ready_to_send_ = false;
+      }
+
+      for (; !batch.empty() && exec_st_.IsRunning(); batch.pop()) {
+        if (auto ec = Sock()->Write(io::Buffer(batch.front()->GetWireCommand())); ec) {
+          Break(GenericError(ec, absl::StrCat("Coordinator could not send command to ",
+                                              server().Description(),
+                                              ", socket state: ", SockInfo())));
+          return;
         }
-        send_queue_.pop();
+        TouchIoTime();
       }
-      ready_to_send_ = false;
     }
   }
 
   void RespFb() {
-    while (!exec_st_.IsCancelled()) {
-      waker_.await([this] { return exec_st_.IsCancelled() || ready_to_resp_; });
-      if (exec_st_.IsCancelled())
-        return;
-      std::lock_guard lk(resp_mu_);
-      auto timeout = absl::GetFlag(FLAGS_cluster_coordinator_response_timeout_ms);
-      while (!resp_queue_.empty()) {
-        auto resp = TakeRespReply(timeout);
-        if (!resp) {
-          LOG(WARNING) << "Error reading response from " << server().Description() << ": "
-                       << resp.error() << ", socket state: " + SockInfo();
-
-          // TODO make all requests fail in this case.
-          // TODO reinit connection.
-          LOG(FATAL) << "Coordinator RespFb read error, not implemented recovery yet.";
-          break;
+    auto timeout = absl::GetFlag(FLAGS_cluster_coordinator_response_timeout_ms);
+    while (exec_st_.IsRunning()) {
+      waker_.await([this] { return !exec_st_.IsRunning() || ready_to_resp_; });
+
+      CrossShardRequestPtr req;
+      {
+        std::lock_guard lk(mu_);
+        if (resp_queue_.empty()) {
+          ready_to_resp_ = false;
+          continue;
         }
-        resp_queue_.front()->Exec(*resp);
+        req = resp_queue_.front();
+      }
+
+      auto resp = TakeRespReply(timeout);
+      if (!resp) {
+        Break(GenericError(resp.error(), absl::StrCat("Error reading response from ",
+                                                      server().Description(),
+                                                      ", socket state: ", SockInfo())));
+        return;
+      }
+
+      {
+        std::lock_guard lk(mu_);
+        if (resp_queue_.empty())  // failed while reading
+          return;
+        DCHECK(resp_queue_.front() == req);
         resp_queue_.pop();
       }
-      ready_to_resp_ = false;
+      req->Exec(std::move(*resp));
     }
   }
 
  private:
+  GenericError BrokenError() const {
+    GenericError err = exec_st_.GetError();
+    return err ? err
+               : GenericError(make_error_code(errc::connection_aborted),
+                              absl::StrCat("Connection to ", server().Description(), " closed"));
+  }
+
+  // Stops the client after an I/O error, the connection can not be used for the following
+  // requests because their replies would be mismatched.
+  void Break(GenericError err) {
+    exec_st_.ReportError(std::move(err));
+    ShutdownSocket();
+    waker_.notifyAll();
+    FailAll(BrokenError());
+  }
+
+  void FailAll(GenericError err) {
+    std::queue<CrossShardRequestPtr> failed;
+    {
+      std::lock_guard lk(mu_);
+      failed.swap(resp_queue_);  // contains all requests of send_queue_
+      send_queue_ = {};
+    }
+    for (; !failed.empty(); failed.pop())
+      failed.front()->Fail(err);
+  }
+
   ExecutionState exec_st_;
 
   std::queue<std::shared_ptr<CrossShardRequest>> send_queue_;
@@ -160,8 +232,7 @@ class Coordinator::CrossShardClient : public ProtocolClient {
   util::fb2::Fiber resp_fb_;
   util::fb2::EventCount waker_;
 
-  mutable util::fb2::Mutex send_mu_;
-  mutable util::fb2::Mutex resp_mu_;
+  mutable util::fb2::Mutex mu_;
   std::atomic_bool ready_to_send_ = false;
   std::atomic_bool ready_to_resp_ = false;
 };
@@ -173,20 +244,57 @@ Coordinator& Coordinator::Current() {
 
 std::shared_ptr<Coordinator::CrossShardClient> Coordinator::GetClient(const std::string& host,
                                                                       uint16_t port) {
-  for (const auto& client : clients_) {
-    if (client->GetHost() == host && client->GetPort() == port) {
-      return client;
+  auto find_client = [&]() -> std::shared_ptr<CrossShardClient> {
+    for (const auto& client : clients_) {
+      if (client->GetHost() == host && client->GetPort() == port && !client->IsBroken())
+        return client;
     }
+    return nullptr;
+  };
+
+  std::vector<std::shared_ptr<CrossShardClient>> broken;  // destroyed without holding the lock
+  {
+    std::lock_guard lk(clients_mu_);
+    if (auto client = find_client(); client)
+      return client;
+
+    // Replace a broken connection with a new one.
+    auto it = std::partition(clients_.begin(), clients_.end(), [&](const auto& client) {
+      return !(client->GetHost() == host && client->GetPort() == port);
+    });
+    std::move(it, clients_.end(), std::back_inserter(broken));
+    clients_.erase(it, clients_.end());
   }
+
+  // Connecting takes up to --cluster_coordinator_connect_timeout_ms, don't block other nodes.
   auto new_client = std::make_shared<CrossShardClient>(host, port);
-  if (new_client->Init()) {
-    clients_.emplace_back(new_client);
-    return new_client;
-  }
-  return nullptr;
+  if (!new_client->Init())
+    return nullptr;
+
+  std::lock_guard lk(clients_mu_);
+  if (auto client = find_client(); client)  // connected concurrently
+    return client;
+  clients_.emplace_back(new_client);
+  return new_client;
+}
+
+std::string Coordinator::EncodeCommand(const std::vector<std::string_view>& args) {
+  std::string res = absl::StrCat("*", args.size(), "\r\n");
+  for (std::string_view arg : args)
+    absl::StrAppend(&res, "$", arg.size(), "\r\n", arg, "\r\n");
+  return res;
 }
 
 util::fb2::Future<GenericError> Coordinator::DispatchAll(std::string command, RespCB cb) {
+  return DispatchWireCommand(RedisReplyBuilderBase::SerializeCommand(command), std::move(cb));
+}
+
+util::fb2::Future<GenericError> Coordinator::DispatchAll(const std::vector<std::string_view>& args,
+                                                         RespCB cb) {
+  return DispatchWireCommand(EncodeCommand(args), std::move(cb));
+}
+
+util::fb2::Future<GenericError> Coordinator::DispatchWireCommand(std::string command, RespCB cb) {
   auto cluster_config = ClusterConfig::Current();
   if (!cluster_config) {
     VLOG(2) << "No cluster config found for coordinator plan creation.";
@@ -215,13 +323,31 @@ util::fb2::Future<GenericError> Coordinator::DispatchAll(std::string command, Re
     if (!client) {
       VLOG(1) << "Could not get coordinator client for " << shard.master.ip << ":"
               << shard.master.port;
-      cb(RESPObj());  // TODO add error propagation.
-      LOG(FATAL) << "No error processing, not implemented logic yet.";
-      return {};
+      shard_request->Fail(
+          GenericError(make_error_code(errc::host_unreachable),
+                       absl::StrCat("Could not connect to ", shard.master.ip, ":",
+                                    shard.master.port)));
+      break;
     }
     client->EnqueueCommand(shard_request);
   }
   return shard_request->GetFuture();
 }
 
+util::fb2::Future<GenericError> Coordinator::Dispatch(const std::string& host, uint16_t port,
+                                                      std::string resp_command, RespCB cb) {
+  const auto& client = GetClient(host, port);
+  if (!client) {
+    VLOG(1) << "Could not get coordinator client for " << host << ":" << port;
+    util::fb2::Future<GenericError> res;
+    res.Resolve(GenericError(make_error_code(errc::host_unreachable),
+                             absl::StrCat("Could not connect to ", host, ":", port)));
+    return res;
+  }
+
+  auto request = std::make_shared<CrossShardRequest>(std::move(resp_command), std::move(cb), 1);
+  client->EnqueueCommand(request);
+  return request->GetFuture();
+}
+
 }  // namespace dfly::cluster
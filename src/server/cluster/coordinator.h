@@ -6,6 +6,7 @@
 #include "server/cluster/cluster_defs.h"
 #include "server/protocol_client.h"
 #include "util/fibers/future.h"
+#include "util/fibers/synchronization.h"
 
 namespace dfly::cluster {
 
@@ -14,15 +15,37 @@ namespace dfly::cluster {
 // It can be used to exeute commands on all shards or specific shards.
 class Coordinator {
  public:
-  using RespCB = std::function<void(const facade::RESPObj&)>;  // TODO add error.
+  // The reply is passed by value, so callbacks that need it after returning can take ownership.
+  using RespCB = std::function<void(facade::RESPObj)>;  // TODO add error.
+
+  // Name set on coordinator connections, so receiving nodes can tell them apart from clients.
+  static constexpr std::string_view kConnectionName = "dfly_coordinator";
 
   static Coordinator& Current();
   [[nodiscard]] util::fb2::Future<GenericError> DispatchAll(std::string command, RespCB cb);
 
+  // Same as above, but the arguments are RESP encoded, so they may contain spaces and binary data.
+  [[nodiscard]] util::fb2::Future<GenericError> DispatchAll(
+      const std::vector<std::string_view>& args, RespCB cb);
+
+  // Encodes a command as a RESP array of bulk strings.
+  static std::string EncodeCommand(const std::vector<std::string_view>& args);
+
+  // Sends a RESP encoded command to a single node. Requests to the same node share one connection
+  // and are pipelined on it, replies are delivered in order. If the connection fails or a reply
+  // times out, the pending requests resolve with an error and the next request reconnects.
+  [[nodiscard]] util::fb2::Future<GenericError> Dispatch(const std::string& host, uint16_t port,
+                                                         std::string resp_command, RespCB cb);
+
   void Shutdown() {
     // TODO add proper shutdown logic. We need to prevent new clients creation. Maybe we need to
     // wait destroying of existing clients.
-    clients_.clear();
+    std::vector<std::shared_ptr<CrossShardClient>> clients;
+    {
+      std::lock_guard lk(clients_mu_);
+      clients.swap(clients_);
+    }
+    clients.clear();  // fails the pending requests, outside of the lock
   }
 
  private:
@@ -31,6 +54,9 @@ class Coordinator {
   class CrossShardRequest;
   using CrossShardRequestPtr = std::shared_ptr<Coordinator::CrossShardRequest>;
   std::shared_ptr<CrossShardClient> GetClient(const std::string& host, uint16_t port);
+  util::fb2::Future<GenericError> DispatchWireCommand(std::string command, RespCB cb);
+
+  util::fb2::Mutex clients_mu_;  // Coordinator is shared by all threads.
   std::vector<std::shared_ptr<CrossShardClient>> clients_;
 };
 
@@ -18,6 +18,7 @@
 #include "server/journal/serializer.h"
 #include "server/journal/tx_executor.h"
 #include "server/main_service.h"
+#include "server/rdb_load.h"
 #include "util/fibers/synchronization.h"
 
 namespace rng = std::ranges;
@@ -43,6 +44,7 @@ class ClusterShardMigration {
       : source_shard_id_(shard_id),
         is_finished_(false),
         socket_(nullptr),
+        service_(service),
         executor_(service),
         in_migration_(in_migration),
         bc_(bc) {
@@ -89,6 +91,10 @@ class ClusterShardMigration {
         break;
       }
 
+      // Journal changes and the finalization apply on top of the entries of the loaded batches.
+      if (tx_data.opcode != journal::Op::RDB_BLOB && !FinishRdbBlobs(cntx))
+        break;
+
       while (tx_data.opcode == journal::Op::LSN) {
         VLOG(2) << "Attempt to finalize flow " << source_shard_id_ << " attempt " << tx_data.lsn;
         last_attempt_.store(tx_data.lsn);
@@ -117,7 +123,9 @@ class ClusterShardMigration {
       if (tx_data.opcode == journal::Op::PING) {
         // TODO check about ping logic
       } else {
-        auto err = ExecuteTx(std::move(tx_data), cntx);
+        auto err = tx_data.opcode == journal::Op::RDB_BLOB
+                       ? LoadRdbBlob(tx_data.command.Front(), cntx)
+                       : ExecuteTx(std::move(tx_data), cntx);
         // Break incoming slot migration if command reported OOM
         if (err == std::errc::not_enough_memory) {
           cntx->ReportError(std::string{kIncomingMigrationOOM});
@@ -134,6 +142,7 @@ class ClusterShardMigration {
       }
     }
 
+    FinishRdbBlobs(cntx);
     VLOG(2) << "Flow " << source_shard_id_ << " canceled";
     bc_->Dec();  // we should provide ability to join the flow
   }
@@ -164,6 +173,49 @@ class ClusterShardMigration {
   }
 
  private:
+  // Loads a batch of entries that the source serialized in the native format.
+  std::error_code LoadRdbBlob(std::string_view blob, ExecutionState* cntx) {
+    if (!cntx->IsRunning()) {
+      return {};
+    }
+
+    if (!loader_) {
+      loader_ = std::make_unique<RdbLoader>(service_, &load_context_);
+      // Slots are owned by the target only once the migration finishes.
+      loader_->SetLoadUnownedSlots(true);
+      loader_->SetOverrideExistingKeys(true);
+      loader_->SetJournalLoadedKeys(true);
+    }
+
+    io::BytesSource source{io::Buffer(blob)};
+    return HandleLoadError(loader_->LoadBatch(&source), cntx);
+  }
+
+  // Waits for the entries of the loaded batches, returns false if the flow must stop.
+  bool FinishRdbBlobs(ExecutionState* cntx) {
+    if (!loader_)
+      return true;
+    if (HandleLoadError(loader_->FinishBatches(), cntx) == errc::not_enough_memory) {
+      cntx->ReportError(std::string{kIncomingMigrationOOM});
+      in_migration_->ReportFatalError(std::string{kIncomingMigrationOOM});
+      return false;
+    }
+    return true;
+  }
+
+  std::error_code HandleLoadError(std::error_code ec, ExecutionState* cntx) {
+    if (ec == RdbError(rdb::errc::out_of_memory)) {
+      return make_error_code(errc::not_enough_memory);
+    }
+    if (ec) {
+      std::string error = absl::StrCat("Failed loading migrated entries: ", ec.message());
+      LOG(ERROR) << error;
+      cntx->ReportError(error);
+      in_migration_->ReportError(error);
+    }
+    return {};
+  }
+
   std::error_code ExecuteTx(TransactionData&& tx_data, ExecutionState* cntx) {
     if (!cntx->IsRunning()) {
       return {};
@@ -189,7 +241,10 @@ class ClusterShardMigration {
   util::fb2::Mutex mu_;
   bool is_finished_ ABSL_GUARDED_BY(mu_);
   util::FiberSocketBase* socket_ ABSL_GUARDED_BY(mu_);
+  Service* service_;
   JournalExecutor executor_;
+  RdbLoadContext load_context_;
+  std::unique_ptr<RdbLoader> loader_;  // created with the first native batch
   IncomingSlotMigration* in_migration_;
   util::fb2::BlockingCounter bc_;
   atomic_long last_attempt_{-1};
@@ -24,6 +24,10 @@ ABSL_FLAG(int, slot_migration_connection_timeout_ms, 2000,
           "Connection creating timeout for migration operations");
 ABSL_FLAG(int, migration_finalization_timeout_ms, 30000,
           "Timeout for migration finalization operation");
+ABSL_FLAG(bool, migration_native_serialization, true,
+          "If true, slot migrations send entries in the native snapshot format, which the target "
+          "loads directly into its shards, if the target supports it. Otherwise they are sent as "
+          "RESTORE commands.");
 
 using namespace std;
 using namespace facade;
@@ -68,7 +72,10 @@ class OutgoingMigration::SliceSlotMigration : private ProtocolClient {
 
     ResetParser(RedisParser::Mode::CLIENT);
 
-    std::string cmd = absl::StrCat("DFLYMIGRATE FLOW ", node_id, " ", shard_id);
+    // Targets that do not support the native format ignore the RDB argument and reply OK.
+    bool native = absl::GetFlag(FLAGS_migration_native_serialization);
+    std::string cmd =
+        absl::StrCat("DFLYMIGRATE FLOW ", node_id, " ", shard_id, native ? " RDB" : "");
     VLOG(1) << "cmd: " << cmd;
 
     if (auto ec = SendCommandAndReadResponse(cmd); ec) {
@@ -76,7 +83,9 @@ class OutgoingMigration::SliceSlotMigration : private ProtocolClient {
       return;
     }
 
-    if (!CheckRespIsSimpleReply("OK")) {
+    if (native && CheckRespIsSimpleReply("RDB")) {
+      streamer_.EnableNativeSerialization();
+    } else if (!CheckRespIsSimpleReply("OK")) {
       exec_st_.ReportError(absl::StrCat("Incorrect response for FLOW cmd: ",
                                         ToSV(LastResponseArgs().front().GetBuf())));
       return;
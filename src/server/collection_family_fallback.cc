@@ -31,6 +31,11 @@ StringMap* HSetFamily::ConvertToStrMap(uint8_t* lp) {
   return nullptr;
 }
 
+StringMap* HSetFamily::PromoteToStrMap(uint8_t* lp, size_t extra) {
+  Fail();
+  return nullptr;
+}
+
 void* SetFamily::ConvertToStrSet(const intset* is, size_t expected_len) {
   Fail();
   return nullptr;
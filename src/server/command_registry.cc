@@ -198,6 +198,7 @@ CommandId CommandId::Clone(const std::string_view name) const {
   CommandId cloned =
       CommandId{name.data(), opt_mask_, arity_, first_key_, last_key_, acl_categories_};
   cloned.handler_ = handler_;
+  cloned.batch_handler_ = batch_handler_;
   cloned.opt_mask_ = opt_mask_ | CO::HIDDEN;
   cloned.acl_categories_ = acl_categories_;
   cloned.interleave_step_ = interleave_step_;
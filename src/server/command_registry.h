@@ -6,6 +6,7 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/functional/function_ref.h>
 #include <absl/types/span.h>
 
 #include <functional>
@@ -114,6 +115,13 @@ class CommandId : public facade::CommandId {
       fu2::function_base<true, true, fu2::capacity_default, false, false,
                          std::optional<facade::ErrorReply>(const facade::ParsedArgs&) const>;
 
+  // Handles a group of consecutive pipelined calls of the command: prepares work shared by all
+  // of them and calls `run`, which executes the calls one by one as usual. The calls see
+  // `batch_id` in ConnectionState::batch_id, so the prepared work can be tagged with it.
+  using BatchHandler = fu2::function_base<true, true, fu2::capacity_default, false, false,
+                                          void(absl::Span<const facade::ParsedArgs>, uint64_t,
+                                               absl::FunctionRef<void()>) const>;
+
   // Returns the invoke time in usec.
   void Invoke(const facade::ParsedArgs& args, CommandContext* cmd_cntx) const {
     handler_(facade::CmdArgParser{args}, cmd_cntx);
@@ -122,6 +130,15 @@ class CommandId : public facade::CommandId {
   // Returns error if validation failed, otherwise nullopt
   std::optional<facade::ErrorReply> Validate(const facade::ParsedArgs& args) const;
 
+  bool HasBatchHandler() const {
+    return bool(batch_handler_);
+  }
+
+  void InvokeBatch(absl::Span<const facade::ParsedArgs> batch, uint64_t batch_id,
+                   absl::FunctionRef<void()> run) const {
+    batch_handler_(batch, batch_id, run);
+  }
+
   bool IsTransactional() const;
 
   bool IsMultiTransactional() const;
@@ -171,6 +188,11 @@ class CommandId : public facade::CommandId {
     return std::move(*this);
   }
 
+  CommandId&& SetBatchHandler(BatchHandler f) && {
+    batch_handler_ = std::move(f);
+    return std::move(*this);
+  }
+
   bool is_multi_key() const {
     return (last_key_ != first_key_) || (opt_mask_ & CO::VARIADIC_KEYS);
   }
@@ -316,6 +338,7 @@ class CommandId : public facade::CommandId {
   std::unique_ptr<StatsCell[]> command_stats_;
   Handler handler_;
   ArgValidator validator_;
+  BatchHandler batch_handler_;
   MoveOnly<hdr_histogram*> latency_histogram_;  // Histogram for command latency in usec
 };
 
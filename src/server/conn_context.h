@@ -294,6 +294,10 @@ struct ConnectionState {
  public:
   DbIndex db_index = 0;
 
+  // Id of the pipelined batch whose calls run now, 0 outside of batches. See
+  // CommandId::BatchHandler.
+  uint64_t batch_id = 0;
+
   ExecInfo exec_info;
   ReplicationInfo replication_info;
 
@@ -481,6 +481,7 @@ auto DbSlice::GetStats() const -> Stats {
   }
   auto co_stats = CompactObj::GetStatsThreadLocal();
   s.small_string_bytes = co_stats.small_string_bytes;
+  s.key_prefix_saved_bytes = co_stats.key_prefix_saved_bytes;
   s.events.huff_encode_total = co_stats.huff_encode_total;
   s.events.huff_encode_success = co_stats.huff_encode_success;
 
@@ -863,6 +864,18 @@ void DbSlice::ActivateDb(DbIndex db_ind) {
   CreateDb(db_ind);
 }
 
+void DbSlice::ReserveForLoad(DbIndex db_ind, size_t num_keys) {
+  ActivateDb(db_ind);
+  DbTable& db = *db_arr_[db_ind];
+  db.load_reserved_keys += num_keys;
+
+  ssize_t table_before = db.prime.mem_usage();
+  db.prime.Reserve(max(db.load_reserved_keys, db.prime.size() + num_keys));
+  ssize_t table_increase = db.prime.mem_usage() - table_before;
+  memory_budget_ -= table_increase;
+  table_memory_ += table_increase;
+}
+
 void DbSlice::Del(Context cntx, Iterator it, DbTable* db_table, bool async) {
   CHECK(IsValid(it));
 
@@ -1011,6 +1024,12 @@ util::fb2::Fiber DbSlice::FlushDbIndexes(const std::vector<DbIndex>& indexes) {
     InvalidateDbWatches(index);
     flush_db_arr[index] = std::move(db_arr_[index]);
 
+    // Flushed keys are not logged, so a delta snapshot can not be based on the previous one.
+    if (deletion_log_) {
+      deletion_log_->valid = false;
+      deletion_log_->keys = {};
+    }
+
     CreateDb(index);
     std::swap(db_arr_[index]->trans_locks, flush_db_arr[index]->trans_locks);
   }
@@ -1096,6 +1115,37 @@ bool DbSlice::RemoveExpire(DbIndex db_ind, const Iterator& main_it) {
   return true;
 }
 
+int64_t DbSlice::HuffmanReencode(DbIndex db_ind, PrimeIterator it) {
+  auto& db = *db_arr_[db_ind];
+  string tmp;
+  int64_t saved = 0;
+
+  PrimeKey& key = it->first;
+  if (!key.IsInline()) {
+    ssize_t old_malloc = static_cast<ssize_t>(key.MallocUsed());
+    if (int64_t delta = key.HuffmanReencode(); delta != 0) {
+      string_view key_str = key.GetSlice(&tmp);
+      if (key.IsInline()) {
+        ++db.stats.inline_keys;
+        AccountObjectMemory(key_str, OBJ_KEY, -old_malloc, &db);
+      } else {
+        AccountObjectMemory(key_str, OBJ_KEY, delta, &db);
+      }
+      saved -= delta;
+    }
+  }
+
+  PrimeValue& pv = it->second;
+  if (pv.ObjType() == OBJ_STRING && !pv.IsExternal() && !pv.HasStashPending()) {
+    if (int64_t delta = pv.HuffmanReencode(); delta != 0) {
+      AccountObjectMemory(key.GetSlice(&tmp), OBJ_STRING, delta, &db);
+      saved -= delta;
+    }
+  }
+
+  return saved;
+}
+
 bool DbSlice::SetMCFlag(DbIndex db_ind, const PrimeKey& key, uint32_t flag) {
   auto& db = *db_arr_[db_ind];
   string scratch;
@@ -1250,6 +1300,103 @@ OpResult<DbSlice::ItAndUpdater> DbSlice::AddOrUpdate(const Context& cntx, string
   return AddOrUpdateInternal(cntx, key, std::move(obj), expire_at_ms, true);
 }
 
+OpResult<size_t> DbSlice::AddBulk(const Context& cntx, absl::Span<BulkEntry> entries,
+                                  BulkAddedCb cb) {
+  DCHECK(IsDbValid(cntx.db_index));
+
+  // Change listeners must observe every bucket before it changes, tiered storage may need to
+  // reclaim memory before each insertion and cache mode evicts, so these take the regular path.
+  if (!change_cb_.empty() || IsCacheMode() || owner_->tiered_storage()) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+      BulkEntry& entry = entries[i];
+      auto res = AddOrUpdate(cntx, entry.key, std::move(entry.value), entry.expire_at_ms);
+      RETURN_ON_BAD_STATUS(res);
+      res->post_updater.Run();
+      cb(i, res->it, res->is_new);
+    }
+    return entries.size();
+  }
+
+  DbTable& db = *db_arr_[cntx.db_index];
+
+  // Same as in AddOrFindInternal, memory limits apply only if we are not loading or replicating.
+  bool apply_memory_limit =
+      !owner_->IsReplica() && !(ServerState::tlocal()->gstate() == GlobalState::LOADING);
+  if (apply_memory_limit && memory_budget_ < 0) {
+    LOG_EVERY_T(WARNING, 1) << "AddBulk: over limit, budget: " << memory_budget_;
+    events_.insertion_rejections++;
+    return OpStatus::OUT_OF_MEMORY;
+  }
+
+  ssize_t soft_budget_limit =
+      (0.3 * max_memory_limit.load(memory_order_relaxed)) / shard_set->size();
+  PrimeEvictionPolicy evp{cntx, false, 0, soft_budget_limit, this, apply_memory_limit};
+
+  // All entries of the batch are inserted at the same logical time.
+  const uint64_t version = NextVersion();
+  size_t inserted = 0;
+
+  auto update_stats = absl::MakeCleanup([&] {
+    events_.mutations += inserted;
+    entries_count_ += inserted;
+    events_.garbage_collected = db.prime.garbage_collected();
+    events_.stash_unloaded = db.prime.stash_unloaded();
+  });
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    BulkEntry& entry = entries[i];
+    DCHECK_EQ(entry.key_hash, CompactObj::HashCode(entry.key));
+
+    ssize_t table_before = db.prime.mem_usage();
+    pair<PrimeIterator, bool> res;
+    try {
+      res = db.prime.InsertHashed(entry.key, PrimeValue{}, entry.key_hash, evp);
+    } catch (bad_alloc& e) {
+      LOG_EVERY_T(WARNING, 1) << "AddBulk: InsertHashed failed, budget: " << memory_budget_;
+      events_.insertion_rejections++;
+      return OpStatus::OUT_OF_MEMORY;
+    }
+
+    // The key exists and may need to expire first, let the regular path handle it.
+    if (!res.second) {
+      auto op_res = AddOrUpdate(cntx, entry.key, std::move(entry.value), entry.expire_at_ms);
+      RETURN_ON_BAD_STATUS(op_res);
+      op_res->post_updater.Run();
+      cb(i, op_res->it, op_res->is_new);
+      continue;
+    }
+
+    ssize_t table_increase = db.prime.mem_usage() - table_before;
+    memory_budget_ -= table_increase;
+    table_memory_ += table_increase;
+    ++inserted;
+
+    PrimeIterator it = res.first;
+    if (it->first.IsInline()) {
+      ++db.stats.inline_keys;
+    } else {
+      AccountObjectMemory(entry.key, OBJ_KEY, it->first.MallocUsed(), &db);
+    }
+
+    it->second = std::move(entry.value);
+    AccountObjectMemory(entry.key, it->second.ObjType(), it->second.MallocUsed(), &db);
+    it.SetVersion(version);
+
+    Iterator db_it(it, StringOrView::FromView(entry.key));
+    if (entry.expire_at_ms)
+      AddExpire(cntx.db_index, db_it, entry.expire_at_ms);
+
+    if (db.slots_stats)
+      db.slots_stats[KeySlot(entry.key)].key_count += 1;
+
+    // Notifies watchers and tracking clients, like on any other update.
+    PostUpdate(cntx.db_index, entry.key);
+    cb(i, db_it, true);
+  }
+
+  return entries.size();
+}
+
 size_t DbSlice::DbSize(DbIndex db_ind) const {
   DCHECK_LT(db_ind, db_array_size());
 
@@ -1456,6 +1603,12 @@ void DbSlice::RegisterOnChange(ChangeConsumerInterface* consumer) {
   change_cb_.emplace_back(consumer);
 }
 
+void DbSlice::StartDeletionLog(uint64_t base_version, size_t max_keys) {
+  deletion_log_ = std::make_unique<DeletionLog>();
+  deletion_log_->base_version = base_version;
+  deletion_log_->max_keys = max_keys;
+}
+
 bool DbSlice::UnregisterOnChange(ChangeConsumerInterface* consumer) {
   change_cb_latch_.Wait();
   auto it = std::find(change_cb_.begin(), change_cb_.end(), consumer);
@@ -1966,6 +2119,16 @@ void DbSlice::PerformDeletionAtomic(const Iterator& del_it, DbTable* table, bool
     table->slots_stats[sid].key_count -= 1;
   }
 
+  if (deletion_log_ && deletion_log_->valid) {
+    if (deletion_log_->keys.size() < deletion_log_->max_keys) {
+      deletion_log_->keys.emplace(table->index, del_it.key());
+    } else {
+      VLOG(1) << "Deletion log overflow, the next snapshot can not be a delta";
+      deletion_log_->valid = false;
+      deletion_log_->keys = {};
+    }
+  }
+
   table->prime.Erase(del_it.GetInnerIt());
 
   // Note, currently we do not shrink our tables upon deletion.
@@ -2037,7 +2200,8 @@ void DbSlice::CallChangeCallbacks(DbIndex id, const ChangeReq& cr) const {
 // 3. there are no other journal consumers
 // 4. the snapshot did not reach the bucket yet
 bool DbSlice::IsOmittableWrite(const Context& cntx, const ChangeReq& req) {
-  if (!journal_omit_redundant_writes_)
+  // Delta snapshots rely on every write bumping the bucket version.
+  if (!journal_omit_redundant_writes_ || deletion_log_)
     return false;
 
   bool omit_update = false;
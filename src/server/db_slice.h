@@ -6,6 +6,8 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/functional/function_ref.h>
+#include <absl/types/span.h>
 
 #include <atomic>
 #include <limits>
@@ -212,6 +214,7 @@ class DbSlice {
     std::vector<DbStats> db_stats;
     SliceEvents events;
     size_t small_string_bytes = 0;
+    size_t key_prefix_saved_bytes = 0;
   };
 
   using Context = DbContext;
@@ -305,6 +308,25 @@ class DbSlice {
   OpResult<ItAndUpdater> AddNew(const Context& cntx, std::string_view key, PrimeValue obj,
                                 uint64_t expire_at_ms);
 
+  // An entry of AddBulk().
+  struct BulkEntry {
+    std::string_view key;
+    uint64_t key_hash = 0;  // CompactObj::HashCode(key), usually computed off the shard thread
+    PrimeValue value;
+    uint64_t expire_at_ms = 0;  // 0 means no expiry
+  };
+
+  // Called with the index of every added entry, before the following one is inserted.
+  using BulkAddedCb = absl::FunctionRef<void(size_t index, const Iterator& it, bool is_new)>;
+
+  // Bulk-insert path for loaders and migrations. Adds the entries to the table of cntx.db_index
+  // and overwrites existing keys, like AddOrUpdate. If there are no change listeners, new keys are
+  // inserted with their precomputed hashes, without evictions, memory reclamation or key sampling.
+  // Slice counters are updated once per batch. Otherwise falls back to AddOrUpdate for every entry.
+  // Returns the number of added entries, or OUT_OF_MEMORY if an entry did not fit into memory,
+  // in which case the following entries are not added.
+  OpResult<size_t> AddBulk(const Context& cntx, absl::Span<BulkEntry> entries, BulkAddedCb cb);
+
   // Update entry expiration. Return expiration timepoint in abs milliseconds, or -1 if the entry
   // already expired and was deleted;
   facade::OpResult<int64_t> UpdateExpire(const Context& cntx, Iterator prime_it,
@@ -316,6 +338,10 @@ class DbSlice {
   // Removes expiry from a key. Returns true if expiry existed and was removed.
   bool RemoveExpire(DbIndex db_ind, const Iterator& main_it);
 
+  // Re-encodes the key and the string value of the entry if they were stored before
+  // the huffman tables of their domains were installed. Returns the number of bytes saved.
+  int64_t HuffmanReencode(DbIndex db_ind, PrimeIterator it);
+
   // Returns false if no action was taken, true if the mc flag was set or removed.
   bool SetMCFlag(DbIndex db_ind, const PrimeKey& key, uint32_t flag);
 
@@ -324,6 +350,10 @@ class DbSlice {
   // Creates a database with index `db_ind`. If such database exists does nothing.
   void ActivateDb(DbIndex db_ind);
 
+  // Grows the table of db_ind up front for the keys that a loader is going to add, so that it does
+  // not double its directory on the way. Hints of concurrent loaders add up.
+  void ReserveForLoad(DbIndex db_ind, size_t num_keys);
+
   // Deletes the iterator. The iterator must be valid.
   // Context argument is used only for document removal and it just needs
   // timestamp field. Last argument, db_table, is optional and is used only in FlushSlotsCb.
@@ -432,6 +462,28 @@ class DbSlice {
   // Call registered callbacks with version less than upper_bound.
   void FlushChangeToEarlierCallbacks(DbIndex db_ind, Iterator it, uint64_t upper_bound);
 
+  // Keys deleted since the snapshot with version base_version. Kept while incremental snapshots
+  // are enabled, the next delta snapshot writes them as tombstones.
+  struct DeletionLog {
+    uint64_t base_version = 0;
+    size_t max_keys = 0;
+    bool valid = true;  // false if the log overflowed or a database was flushed
+    absl::flat_hash_set<std::pair<DbIndex, std::string>> keys;
+  };
+
+  // Starts a new deletion log on top of the snapshot with base_version.
+  void StartDeletionLog(uint64_t base_version, size_t max_keys);
+
+  // Stops logging and returns the current log.
+  std::unique_ptr<DeletionLog> TakeDeletionLog() {
+    return std::move(deletion_log_);
+  }
+
+  // Whether a delta snapshot can be taken on top of the last snapshot.
+  bool HasValidDeletionLog() const {
+    return deletion_log_ && deletion_log_->valid;
+  }
+
   struct DeleteExpiredStats {
     uint32_t deleted = 0;                 // number of deleted items due to expiry.
     uint32_t deleted_bytes = 0;           // total bytes of deleted items.
@@ -659,6 +711,8 @@ class DbSlice {
 
   bool journal_omit_redundant_writes_ = true;
 
+  std::unique_ptr<DeletionLog> deletion_log_;
+
   struct Hash {
     size_t operator()(const facade::ConnectionRef& c) const {
       return std::hash<uint32_t>()(c.GetClientId());
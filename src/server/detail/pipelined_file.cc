@@ -0,0 +1,329 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/detail/pipelined_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "base/logging.h"
+#include "util/fibers/proactor_base.h"
+
+namespace dfly::detail {
+
+using namespace std;
+using namespace util;
+using nonstd::make_unexpected;
+
+namespace {
+
+// Cloud clients are stack hungry, run their calls on a dedicated stack.
+constexpr size_t kCloudFiberStack = 64 * 1024;
+
+// Uploads the parts in order through a sequential write file.
+class SequentialUploader : public PartUploader {
+ public:
+  explicit SequentialUploader(io::WriteFile* file) : file_(file) {
+  }
+
+  error_code UploadPart(unsigned part_num, string data) final {
+    return file_->Write(io::Buffer(data));
+  }
+
+  error_code Finish(bool abort) final {
+    return file_->Close();
+  }
+
+ private:
+  unique_ptr<io::WriteFile> file_;
+};
+
+// Reads a sequential read file, which supports only reads that continue the previous one.
+class SequentialReader : public RangeReader {
+ public:
+  explicit SequentialReader(io::ReadonlyFile* file) : file_(file) {
+  }
+
+  io::Result<size_t> ReadRange(size_t offset, io::MutableBytes dest) final {
+    return file_->Read(offset, dest);
+  }
+
+  size_t Size() const final {
+    return file_->Size();
+  }
+
+  int Handle() const final {
+    return file_->Handle();
+  }
+
+  error_code Close() final {
+    return file_->Close();
+  }
+
+ private:
+  unique_ptr<io::ReadonlyFile> file_;
+};
+
+}  // namespace
+
+WriteBehindFile::WriteBehindFile(io::WriteFile* file, size_t part_size, unsigned max_pending)
+    : io::WriteFile(file->create_file_name()),
+      uploader_(new SequentialUploader(file)),
+      part_size_(max<size_t>(part_size, 1)),
+      streams_(1),
+      max_pending_(max(max_pending, 1u)) {
+}
+
+WriteBehindFile::WriteBehindFile(PartUploader* uploader, string_view name, size_t part_size,
+                                 unsigned max_pending, unsigned streams)
+    : io::WriteFile(name),
+      uploader_(uploader),
+      part_size_(max<size_t>(part_size, 1)),
+      streams_(max(streams, 1u)),
+      max_pending_(max(max_pending, streams_)) {
+}
+
+WriteBehindFile::~WriteBehindFile() {
+  {
+    lock_guard lk(mu_);
+    parts_.clear();
+  }
+  StopUploads();
+  if (!finished_)
+    uploader_->Finish(true);
+}
+
+io::Result<size_t> WriteBehindFile::WriteSome(const iovec* v, uint32_t len) {
+  size_t total = 0;
+  for (uint32_t i = 0; i < len; ++i) {
+    const char* src = static_cast<const char*>(v[i].iov_base);
+    size_t left = v[i].iov_len;
+    while (left > 0) {
+      size_t chunk = min(left, part_size_ - current_.size());
+      current_.append(src, chunk);
+      src += chunk;
+      left -= chunk;
+      if (current_.size() == part_size_)
+        EnqueuePart();
+    }
+    total += v[i].iov_len;
+  }
+
+  lock_guard lk(mu_);
+  if (ec_)
+    return make_unexpected(ec_);
+  return total;
+}
+
+void WriteBehindFile::EnqueuePart() {
+  for (size_t i = upload_fbs_.size(); i < streams_; ++i) {
+    upload_fbs_.push_back(fb2::ProactorBase::me()->LaunchFiber(
+        fb2::Launch::post, boost::context::fixedsize_stack{kCloudFiberStack}, "cloud_upload",
+        [this] { UploadFb(); }));
+  }
+
+  unique_lock lk(mu_);
+  // Backpressure: the serializer waits while max_pending_ parts are queued or uploaded.
+  cv_.wait(lk, [&] { return parts_.size() + uploading_ < max_pending_ || ec_; });
+  if (ec_) {
+    current_.clear();
+    return;
+  }
+  parts_.emplace_back(next_part_++, std::move(current_));
+  current_.clear();
+  lk.unlock();
+  cv_.notify_all();
+}
+
+void WriteBehindFile::UploadFb() {
+  while (true) {
+    pair<unsigned, string> part;
+    {
+      unique_lock lk(mu_);
+      cv_.wait(lk, [&] { return !parts_.empty() || closing_; });
+      if (parts_.empty())
+        break;
+      part = std::move(parts_.front());
+      parts_.pop_front();
+      uploading_++;
+    }
+
+    error_code ec = uploader_->UploadPart(part.first, std::move(part.second));
+
+    {
+      lock_guard lk(mu_);
+      uploading_--;
+      if (ec && !ec_) {
+        VLOG(1) << "Failed uploading " << create_file_name_ << ": " << ec.message();
+        ec_ = ec;
+        parts_.clear();
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
+void WriteBehindFile::StopUploads() {
+  {
+    lock_guard lk(mu_);
+    closing_ = true;
+  }
+  cv_.notify_all();
+  for (auto& fb : upload_fbs_)
+    fb.JoinIfNeeded();
+  upload_fbs_.clear();
+}
+
+error_code WriteBehindFile::Close() {
+  // An empty object still has one part
+  if (!current_.empty() || next_part_ == 1)
+    EnqueuePart();
+  StopUploads();
+
+  finished_ = true;
+  error_code finish_ec = uploader_->Finish(bool(ec_));
+  return ec_ ? ec_ : finish_ec;
+}
+
+ReadAheadFile::ReadAheadFile(io::ReadonlyFile* file, size_t block_size, unsigned depth)
+    : ReadAheadFile(new SequentialReader(file), block_size, depth, 1) {
+}
+
+ReadAheadFile::ReadAheadFile(RangeReader* reader, size_t block_size, unsigned depth,
+                             unsigned streams)
+    : reader_(reader),
+      block_size_(max<size_t>(block_size, 1)),
+      depth_(max({depth, streams, 1u})),
+      // Without a known size the object is read sequentially until the end.
+      streams_(reader->Size() ? max(streams, 1u) : 1u),
+      num_blocks_(reader->Size() ? (reader->Size() + block_size_ - 1) / block_size_ : SIZE_MAX) {
+}
+
+ReadAheadFile::~ReadAheadFile() {
+  StopFetching();
+}
+
+void ReadAheadFile::StopFetching() {
+  {
+    lock_guard lk(mu_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& fb : fetch_fbs_)
+    fb.JoinIfNeeded();
+  fetch_fbs_.clear();
+}
+
+void ReadAheadFile::FetchFb() {
+  while (true) {
+    size_t idx;
+    {
+      unique_lock lk(mu_);
+      cv_.wait(lk, [&] {
+        return next_block_ < first_block_ + depth_ || next_block_ >= num_blocks_ || stopping_ ||
+               ec_;
+      });
+      if (stopping_ || ec_ || next_block_ >= num_blocks_)
+        break;
+      idx = next_block_++;
+      blocks_.emplace_back();
+    }
+
+    // The wrapped reader may return short reads, fill the whole block.
+    const size_t offset = idx * block_size_;
+    const size_t size = reader_->Size();
+    string block(size ? min(block_size_, size - offset) : block_size_, '\0');
+    size_t filled = 0;
+    error_code ec;
+    bool eof = false;
+    while (filled < block.size()) {
+      io::MutableBytes dest{reinterpret_cast<uint8_t*>(block.data()) + filled,
+                            block.size() - filled};
+      io::Result<size_t> res = reader_->ReadRange(offset + filled, dest);
+      if (!res) {
+        ec = res.error();
+        break;
+      }
+      if (*res == 0) {
+        // A truncated object is an error, unless its size is unknown
+        if (size)
+          ec = make_error_code(errc::io_error);
+        eof = true;
+        break;
+      }
+      filled += *res;
+    }
+
+    {
+      lock_guard lk(mu_);
+      if (ec) {
+        ec_ = ec;
+      } else {
+        block.resize(filled);
+        blocks_[idx - first_block_] = std::move(block);
+        if (eof)
+          num_blocks_ = idx + 1;
+      }
+    }
+    cv_.notify_all();
+  }
+}
+
+io::Result<size_t> ReadAheadFile::Read(size_t offset, const iovec* v, uint32_t len) {
+  if (offset != read_offset_) {
+    LOG(DFATAL) << "Non sequential read at " << offset << ", expected " << read_offset_;
+    return make_unexpected(make_error_code(errc::invalid_argument));
+  }
+
+  for (size_t i = fetch_fbs_.size(); i < min<size_t>(streams_, num_blocks_); ++i) {
+    fetch_fbs_.push_back(fb2::ProactorBase::me()->LaunchFiber(
+        fb2::Launch::post, boost::context::fixedsize_stack{kCloudFiberStack}, "cloud_read_ahead",
+        [this] { FetchFb(); }));
+  }
+
+  auto front_ready = [&] { return !blocks_.empty() && blocks_.front(); };
+  unique_lock lk(mu_);
+  cv_.wait(lk, [&] { return front_ready() || first_block_ >= num_blocks_ || ec_; });
+  if (!front_ready()) {
+    if (ec_)
+      return make_unexpected(ec_);
+    return 0;
+  }
+
+  // Copy the fetched bytes, returning a short read once the fetched blocks are exhausted.
+  size_t copied = 0;
+  bool released = false;
+  for (uint32_t i = 0; i < len && front_ready(); ++i) {
+    uint8_t* dest = static_cast<uint8_t*>(v[i].iov_base);
+    size_t dest_pos = 0;
+    while (dest_pos < v[i].iov_len && front_ready()) {
+      const string& block = *blocks_.front();
+      size_t chunk = min(v[i].iov_len - dest_pos, block.size() - front_pos_);
+      memcpy(dest + dest_pos, block.data() + front_pos_, chunk);
+      dest_pos += chunk;
+      front_pos_ += chunk;
+      if (front_pos_ == block.size()) {
+        blocks_.pop_front();
+        first_block_++;
+        front_pos_ = 0;
+        released = true;
+      }
+    }
+    copied += dest_pos;
+  }
+  lk.unlock();
+
+  if (released)
+    cv_.notify_all();
+  read_offset_ += copied;
+  return copied;
+}
+
+error_code ReadAheadFile::Close() {
+  StopFetching();
+  return reader_->Close();
+}
+
+}  // namespace dfly::detail
@@ -0,0 +1,147 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "io/file.h"
+#include "io/io.h"
+#include "util/fibers/fibers.h"
+#include "util/fibers/synchronization.h"
+
+namespace dfly::detail {
+
+// Uploads the parts of a cloud object, e.g. with an S3 multipart upload. Parts are numbered
+// from 1, all but the last one have the same size. UploadPart is called for several parts at
+// once from fibers of the same thread, unless the uploader is used with a single stream.
+class PartUploader {
+ public:
+  virtual ~PartUploader() = default;
+
+  virtual std::error_code UploadPart(unsigned part_num, std::string data) = 0;
+
+  // Called once after all parts were uploaded, or with abort after a failed upload or when the
+  // file is destroyed without Close().
+  virtual std::error_code Finish(bool abort) = 0;
+};
+
+// Reads byte ranges of a cloud object, e.g. with ranged GET requests. ReadRange is called for
+// several ranges at once from fibers of the same thread, unless the reader is used with a single
+// stream, which reads the object sequentially.
+class RangeReader {
+ public:
+  virtual ~RangeReader() = default;
+
+  // Reads up to dest.size() bytes at offset, a short read is not an error.
+  virtual io::Result<size_t> ReadRange(size_t offset, io::MutableBytes dest) = 0;
+
+  // 0 if unknown, then the object is read with a single stream until the end.
+  virtual size_t Size() const = 0;
+
+  virtual int Handle() const {
+    return -1;
+  }
+
+  virtual std::error_code Close() {
+    return {};
+  }
+};
+
+// Wraps a cloud write file or uploader and decouples the snapshot serialization from the upload.
+// Written bytes are accumulated into parts of part_size bytes, and `streams` background fibers
+// upload them while up to max_pending parts wait in the queue or are uploaded. WriteSome blocks
+// only when the queue is full. Upload errors are returned by the following WriteSome or Close
+// calls, destroying the file without Close() aborts the upload. Takes ownership over the wrapped
+// file or uploader.
+class WriteBehindFile : public io::WriteFile {
+ public:
+  // Uploads the parts through the sequential file with a single stream.
+  WriteBehindFile(io::WriteFile* file, size_t part_size, unsigned max_pending);
+
+  WriteBehindFile(PartUploader* uploader, std::string_view name, size_t part_size,
+                  unsigned max_pending, unsigned streams);
+  ~WriteBehindFile() override;
+
+  io::Result<size_t> WriteSome(const iovec* v, uint32_t len) final;
+
+  // Uploads the remaining parts and finishes the upload.
+  std::error_code Close() final;
+
+ private:
+  void EnqueuePart();
+  void UploadFb();
+  void StopUploads();
+
+  std::unique_ptr<PartUploader> uploader_;
+  const size_t part_size_;
+  const unsigned streams_;
+  const unsigned max_pending_;
+
+  std::string current_;  // the part that is being filled
+  unsigned next_part_ = 1;
+  std::deque<std::pair<unsigned, std::string>> parts_;
+  unsigned uploading_ = 0;  // number of parts that the upload fibers write
+  bool closing_ = false;
+  bool finished_ = false;  // uploader_->Finish() was called
+  std::error_code ec_;
+
+  util::fb2::Mutex mu_;
+  util::fb2::CondVarAny cv_;
+  std::vector<util::fb2::Fiber> upload_fbs_;
+};
+
+// Wraps a cloud read file or range reader and reads ahead of the consumer. `streams` background
+// fibers fetch blocks of block_size bytes, keeping up to depth blocks buffered, so that the loader
+// parses a block while the following ones are downloaded. Supports only sequential reads, as done
+// by io::FileSource. Takes ownership over the wrapped file or reader.
+class ReadAheadFile : public io::ReadonlyFile {
+ public:
+  // Reads the sequential file with a single stream.
+  ReadAheadFile(io::ReadonlyFile* file, size_t block_size, unsigned depth);
+
+  ReadAheadFile(RangeReader* reader, size_t block_size, unsigned depth, unsigned streams);
+  ~ReadAheadFile() override;
+
+  io::Result<size_t> Read(size_t offset, const iovec* v, uint32_t len) final;
+
+  std::error_code Close() final;
+
+  size_t Size() const final {
+    return reader_->Size();
+  }
+
+  int Handle() const final {
+    return reader_->Handle();
+  }
+
+ private:
+  void StopFetching();
+  void FetchFb();
+
+  std::unique_ptr<RangeReader> reader_;
+  const size_t block_size_;
+  const unsigned depth_;
+  const unsigned streams_;
+  size_t num_blocks_;  // SIZE_MAX until the end of an object without a known size is read
+
+  // Blocks starting with first_block_, empty until fetched
+  std::deque<std::optional<std::string>> blocks_;
+  size_t first_block_ = 0;
+  size_t next_block_ = 0;    // index of the next block to fetch
+  size_t front_pos_ = 0;     // consumed bytes of the first block
+  size_t read_offset_ = 0;   // file offset of the next byte returned by Read
+  bool stopping_ = false;
+  std::error_code ec_;
+
+  util::fb2::Mutex mu_;
+  util::fb2::CondVarAny cv_;
+  std::vector<util::fb2::Fiber> fetch_fbs_;
+};
+
+}  // namespace dfly::detail
@@ -0,0 +1,288 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/detail/pipelined_file.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/gtest.h"
+#include "base/logging.h"
+#include "util/fibers/fibers.h"
+#include "util/fibers/pool.h"
+
+namespace dfly::detail {
+
+using namespace std;
+using namespace util;
+
+namespace {
+
+// Collects the written parts in memory and emulates the latency of an upload.
+class MemWriteFile : public io::WriteFile {
+ public:
+  MemWriteFile(vector<string>* parts, bool* closed, unsigned fail_at = UINT32_MAX)
+      : io::WriteFile("mem"), parts_(parts), closed_(closed), fail_at_(fail_at) {
+  }
+
+  io::Result<size_t> WriteSome(const iovec* v, uint32_t len) final {
+    ThisFiber::SleepFor(1ms);
+    if (parts_->size() == fail_at_)
+      return nonstd::make_unexpected(make_error_code(errc::io_error));
+
+    string part;
+    for (uint32_t i = 0; i < len; ++i)
+      part.append(static_cast<const char*>(v[i].iov_base), v[i].iov_len);
+    parts_->push_back(std::move(part));
+    return parts_->back().size();
+  }
+
+  error_code Close() final {
+    *closed_ = true;
+    return {};
+  }
+
+ private:
+  vector<string>* parts_;
+  bool* closed_;
+  unsigned fail_at_;
+};
+
+// Serves sequential reads of the given data with short reads of at most max_read bytes.
+class MemReadFile : public io::ReadonlyFile {
+ public:
+  MemReadFile(string data, size_t max_read) : data_(std::move(data)), max_read_(max_read) {
+  }
+
+  io::Result<size_t> Read(size_t offset, const iovec* v, uint32_t len) final {
+    ThisFiber::SleepFor(1ms);
+    if (offset > data_.size())
+      return nonstd::make_unexpected(make_error_code(errc::invalid_argument));
+    size_t n = min({v[0].iov_len, max_read_, data_.size() - offset});
+    memcpy(v[0].iov_base, data_.data() + offset, n);
+    return n;
+  }
+
+  error_code Close() final {
+    return {};
+  }
+
+  size_t Size() const final {
+    return data_.size();
+  }
+
+  int Handle() const final {
+    return -1;
+  }
+
+ private:
+  string data_;
+  size_t max_read_;
+};
+
+// Stores the uploaded parts by number, later parts finish first to reorder the uploads.
+class MemPartUploader : public PartUploader {
+ public:
+  MemPartUploader(map<unsigned, string>* parts, unsigned* max_inflight, bool* finished)
+      : parts_(parts), max_inflight_(max_inflight), finished_(finished) {
+  }
+
+  error_code UploadPart(unsigned part_num, string data) final {
+    *max_inflight_ = max(*max_inflight_, ++inflight_);
+    ThisFiber::SleepFor(chrono::milliseconds(1 + (part_num % 3 == 1) * 2));
+    inflight_--;
+    (*parts_)[part_num] = std::move(data);
+    return {};
+  }
+
+  error_code Finish(bool abort) final {
+    *finished_ = !abort;
+    return {};
+  }
+
+ private:
+  map<unsigned, string>* parts_;
+  unsigned* max_inflight_;
+  bool* finished_;
+  unsigned inflight_ = 0;
+};
+
+// Serves ranges of the given data, reads of the first ranges take longer.
+class MemRangeReader : public RangeReader {
+ public:
+  MemRangeReader(string data, unsigned* max_inflight)
+      : data_(std::move(data)), max_inflight_(max_inflight) {
+  }
+
+  io::Result<size_t> ReadRange(size_t offset, io::MutableBytes dest) final {
+    *max_inflight_ = max(*max_inflight_, ++inflight_);
+    ThisFiber::SleepFor(chrono::milliseconds(offset < data_.size() / 2 ? 3 : 1));
+    inflight_--;
+    size_t n = min(dest.size(), data_.size() - offset);
+    memcpy(dest.data(), data_.data() + offset, n);
+    return n;
+  }
+
+  size_t Size() const final {
+    return data_.size();
+  }
+
+ private:
+  string data_;
+  unsigned* max_inflight_;
+  unsigned inflight_ = 0;
+};
+
+string TestData(size_t len) {
+  string res(len, '\0');
+  for (size_t i = 0; i < len; ++i)
+    res[i] = 'a' + i % 26;
+  return res;
+}
+
+}  // namespace
+
+class PipelinedFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pp_.reset(fb2::Pool::Epoll(1));
+    pp_->Run();
+  }
+
+  void TearDown() override {
+    pp_->Stop();
+    pp_.reset();
+  }
+
+  unique_ptr<ProactorPool> pp_;
+};
+
+TEST_F(PipelinedFileTest, WriteBehind) {
+  const string data = TestData(10'000);
+  vector<string> parts;
+  bool closed = false;
+
+  pp_->at(0)->Await([&] {
+    WriteBehindFile file(new MemWriteFile(&parts, &closed), 1024, 2);
+    for (size_t pos = 0; pos < data.size(); pos += 300) {
+      string_view chunk = string_view{data}.substr(pos, 300);
+      ASSERT_FALSE(file.Write(io::Buffer(chunk)));
+    }
+    ASSERT_FALSE(file.Close());
+  });
+
+  EXPECT_TRUE(closed);
+  ASSERT_EQ(parts.size(), 10u);
+  string uploaded;
+  for (size_t i = 0; i < parts.size(); ++i) {
+    if (i + 1 < parts.size())
+      EXPECT_EQ(parts[i].size(), 1024u);
+    uploaded += parts[i];
+  }
+  EXPECT_EQ(uploaded, data);
+}
+
+TEST_F(PipelinedFileTest, WriteBehindError) {
+  const string data = TestData(10'000);
+  vector<string> parts;
+  bool closed = false;
+
+  pp_->at(0)->Await([&] {
+    WriteBehindFile file(new MemWriteFile(&parts, &closed, 2), 1024, 2);
+    error_code ec;
+    for (size_t pos = 0; pos < data.size() && !ec; pos += 300)
+      ec = file.Write(io::Buffer(string_view{data}.substr(pos, 300)));
+    EXPECT_EQ(ec, make_error_code(errc::io_error));
+    EXPECT_EQ(file.Close(), make_error_code(errc::io_error));
+  });
+
+  EXPECT_EQ(parts.size(), 2u);
+}
+
+TEST_F(PipelinedFileTest, ReadAhead) {
+  const string data = TestData(100'000);
+
+  pp_->at(0)->Await([&] {
+    io::FileSource source(new ReadAheadFile(new MemReadFile(data, 700), 4096, 3));
+    string loaded;
+    uint8_t buf[1000];
+    while (true) {
+      io::Result<size_t> res = source.ReadSome(io::MutableBytes{buf, sizeof(buf)});
+      ASSERT_TRUE(res);
+      if (*res == 0)
+        break;
+      loaded.append(reinterpret_cast<char*>(buf), *res);
+    }
+    EXPECT_EQ(loaded, data);
+  });
+}
+
+TEST_F(PipelinedFileTest, WriteBehindStreams) {
+  const string data = TestData(10'000);
+  map<unsigned, string> parts;
+  unsigned max_inflight = 0;
+  bool finished = false;
+
+  pp_->at(0)->Await([&] {
+    WriteBehindFile file(new MemPartUploader(&parts, &max_inflight, &finished), "mem", 1024, 4,
+                         3);
+    for (size_t pos = 0; pos < data.size(); pos += 300)
+      ASSERT_FALSE(file.Write(io::Buffer(string_view{data}.substr(pos, 300))));
+    ASSERT_FALSE(file.Close());
+  });
+
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(max_inflight, 3u);
+  ASSERT_EQ(parts.size(), 10u);
+  string uploaded;
+  unsigned expected_num = 1;
+  for (const auto& [num, part] : parts) {
+    EXPECT_EQ(num, expected_num++);
+    uploaded += part;
+  }
+  EXPECT_EQ(uploaded, data);
+}
+
+TEST_F(PipelinedFileTest, WriteBehindAbort) {
+  const string data = TestData(10'000);
+  map<unsigned, string> parts;
+  unsigned max_inflight = 0;
+  bool finished = true;
+
+  pp_->at(0)->Await([&] {
+    WriteBehindFile file(new MemPartUploader(&parts, &max_inflight, &finished), "mem", 1024, 4,
+                         3);
+    ASSERT_FALSE(file.Write(io::Buffer(data)));
+  });
+
+  EXPECT_FALSE(finished);  // aborted, as the file was not closed
+}
+
+TEST_F(PipelinedFileTest, ReadAheadStreams) {
+  const string data = TestData(100'000);
+  unsigned max_inflight = 0;
+
+  pp_->at(0)->Await([&] {
+    io::FileSource source(new ReadAheadFile(new MemRangeReader(data, &max_inflight), 4096, 4, 4));
+    string loaded;
+    uint8_t buf[1000];
+    while (true) {
+      io::Result<size_t> res = source.ReadSome(io::MutableBytes{buf, sizeof(buf)});
+      ASSERT_TRUE(res);
+      if (*res == 0)
+        break;
+      loaded.append(reinterpret_cast<char*>(buf), *res);
+    }
+    EXPECT_EQ(loaded, data);
+  });
+
+  EXPECT_EQ(max_inflight, 4u);
+}
+
+}  // namespace dfly::detail
@@ -162,8 +162,8 @@ error_code RdbSnapshot::Close() {
   return ec;
 }
 
-void RdbSnapshot::StartInShard(EngineShard* shard) {
-  saver_->StartSnapshotInShard(false, &cntx_, shard);
+void RdbSnapshot::StartInShard(EngineShard* shard, IncrementalMode incremental) {
+  saver_->StartSnapshotInShard(false, &cntx_, shard, incremental);
   started_shards_.fetch_add(1, memory_order_relaxed);
 }
 
@@ -186,6 +186,11 @@ std::optional<SaveInfo> SaveStagesController::Init() {
     return GetSaveInfo();
   }
 
+  if (incremental_ == IncrementalMode::DELTA && !CanSaveDelta()) {
+    LOG(INFO) << "Saving a full snapshot instead of a delta";
+    incremental_ = IncrementalMode::BASE;
+  }
+
   snapshots_.resize(use_dfs_format_ ? shard_set->size() + 1 : 1);
   for (auto& [snapshot, _] : snapshots_)
     snapshot = make_unique<RdbSnapshot>(fq_threadpool_, snapshot_storage_.get());
@@ -301,6 +306,12 @@ void SaveStagesController::SaveDfsSingle(EngineShard* shard, const std::string&
   SaveMode mode = shard == nullptr ? SaveMode::SUMMARY : SaveMode::SINGLE_SHARD;
   bool is_summary = (shard == nullptr);
   auto glob_data = RdbSaver::GetGlobalData(service_, is_summary);
+  if (!is_summary && ServerState::tlocal()->is_master)
+    glob_data.repl_id = service_->server_family().master_replid();
+  if (is_summary && incremental_ == IncrementalMode::DELTA) {
+    for (const string& base : delta_bases_)
+      glob_data.snapshot_bases.push_back(fs::path{base}.filename().string());
+  }
 
   if (auto err = snapshot->Start(mode, filename, glob_data, snapshot_id); err) {
     shared_err_ = err;
@@ -309,7 +320,7 @@ void SaveStagesController::SaveDfsSingle(EngineShard* shard, const std::string&
   }
 
   if (mode == SaveMode::SINGLE_SHARD)
-    snapshot->StartInShard(shard);
+    snapshot->StartInShard(shard, incremental_);
 }
 
 // Save a single rdb file
@@ -425,6 +436,24 @@ GenericError SaveStagesController::BuildFullPath() {
   return {};
 }
 
+bool SaveStagesController::CanSaveDelta() const {
+  fs::path summary = full_path_;
+  SetExtension("summary", ".dfs", &summary);
+  for (const string& base : delta_bases_) {
+    fs::path base_path{base};
+    if (base_path.parent_path() != summary.parent_path() || base_path == summary)
+      return false;
+  }
+
+  atomic_bool valid{true};
+  shard_set->RunBriefInParallel([&valid](EngineShard* shard) {
+    auto& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard->shard_id());
+    if (!db_slice.HasValidDeletionLog())
+      valid.store(false, memory_order_relaxed);
+  });
+  return valid.load(memory_order_relaxed);
+}
+
 void SaveStagesController::SaveBody(unsigned index) {
   CHECK(!use_dfs_format_ || index == shard_set->size());  // used in rdb and df summary file
   if (auto& snapshot = snapshots_[index].first; snapshot && snapshot->HasStarted()) {
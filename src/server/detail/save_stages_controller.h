@@ -37,6 +37,10 @@ struct SaveStagesInputs {
   std::shared_ptr<SnapshotStorage> snapshot_storage_;
   // true if the command that triggered this flow is bgsave. false otherwise.
   bool is_bg_save_;
+  // Incremental mode of a DF save. Deltas are applied on top of delta_bases_ (summary file paths,
+  // the full snapshot first).
+  IncrementalMode incremental_ = IncrementalMode::NONE;
+  std::vector<std::string> delta_bases_;
 };
 
 class RdbSnapshot {
@@ -47,7 +51,7 @@ class RdbSnapshot {
 
   GenericError Start(SaveMode save_mode, const string& path, const RdbSaver::GlobalData& glob_data,
                      const std::string& snapshot_id);
-  void StartInShard(EngineShard* shard);
+  void StartInShard(EngineShard* shard, IncrementalMode incremental = IncrementalMode::NONE);
 
   error_code SaveBody();
   error_code WaitSnapshotInShard(EngineShard* shard);
@@ -104,6 +108,11 @@ struct SaveStagesController : public SaveStagesInputs {
     return is_bg_save_;
   }
 
+  // May differ from the requested mode, see Init().
+  IncrementalMode GetIncrementalMode() const {
+    return incremental_;
+  }
+
  private:
   // In the new version (.dfs) we store a file for every shard and one more summary file.
   // Summary file is always last in snapshots array.
@@ -125,6 +134,10 @@ struct SaveStagesController : public SaveStagesInputs {
   // Build full path: get dir, try creating dirs, get filename with placeholder
   GenericError BuildFullPath();
 
+  // Whether the delta can be saved next to its bases without overwriting them and all shards
+  // logged the keys deleted since the last snapshot.
+  bool CanSaveDelta() const;
+
   void SaveBody(unsigned index);
 
   void CloseCb(unsigned index);
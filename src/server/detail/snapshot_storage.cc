@@ -11,18 +11,23 @@
 #include <absl/strings/strip.h>
 
 #include <algorithm>
+#include <map>
 
 #ifdef WITH_AWS
 #include <aws/core/auth/AWSCredentialsProvider.h>
 #include <aws/s3/S3Client.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
+#include <aws/s3/model/GetObjectRequest.h>
+#include <aws/s3/model/HeadObjectRequest.h>
 #include <aws/s3/model/ListObjectsV2Request.h>
 #include <aws/s3/model/PutObjectRequest.h>
+#include <aws/s3/model/UploadPartRequest.h>
 
 #include "util/aws/aws.h"
 #include "util/aws/credentials_provider_chain.h"
 #include "util/aws/s3_endpoint_provider.h"
-#include "util/aws/s3_read_file.h"
-#include "util/aws/s3_write_file.h"
 #endif
 
 #include "util/cloud/aws/s3_storage.h"
@@ -35,17 +40,38 @@
 
 #include "base/logging.h"
 #include "io/file_util.h"
+#include "server/detail/pipelined_file.h"
 #include "server/engine_shard_set.h"
 #include "strings/escaping.h"
 #include "util/cloud/azure/creds_provider.h"
 #include "util/cloud/azure/storage.h"
 #include "util/fibers/fiber_file.h"
 
+using facade::operator""_MB;
+
 // Selects between the helio-native S3 client (util::cloud::aws) and aws-sdk-cpp.
 // Only meaningful when WITH_AWS is compiled in; otherwise the helio client is used.
 ABSL_FLAG(bool, s3_use_helio_client, true,
           "If true, use helio's native S3 client; if false, use aws-sdk-cpp");
 
+ABSL_FLAG(uint32_t, cloud_upload_parts, 2,
+          "Number of parts of a cloud snapshot file that are queued for a background upload "
+          "while the serialization continues. 0 uploads inline.");
+ABSL_FLAG(size_t, cloud_upload_part_size, 8_MB,
+          "Size of the parts that are queued for the upload of a cloud snapshot file.");
+ABSL_FLAG(uint32_t, cloud_read_ahead_blocks, 2,
+          "Number of blocks of a cloud snapshot file that are downloaded ahead of the loader. "
+          "0 disables the read ahead.");
+ABSL_FLAG(size_t, cloud_read_ahead_block_size, 4_MB,
+          "Size of the blocks that are downloaded ahead of the loader of a cloud snapshot file.");
+ABSL_FLAG(uint32_t, cloud_upload_streams, 4,
+          "Number of parts of a cloud snapshot file that are uploaded concurrently. Used by the "
+          "S3 client with --s3_use_helio_client=false, other clients upload a single stream.");
+ABSL_FLAG(uint32_t, cloud_read_ahead_streams, 4,
+          "Number of ranged requests that download blocks of a cloud snapshot file concurrently. "
+          "Used by the S3 client with --s3_use_helio_client=false, other clients read a single "
+          "stream.");
+
 namespace rng = std::ranges;
 namespace dfly {
 namespace detail {
@@ -194,6 +220,152 @@ string BuildAzurePath(const AzurePath& path) {
   return result;
 }
 
+// Wraps the file so that the upload proceeds in the background.
+io::WriteFile* WithWriteBehind(io::WriteFile* file) {
+  uint32_t parts = absl::GetFlag(FLAGS_cloud_upload_parts);
+  if (parts == 0)
+    return file;
+  return new WriteBehindFile(file, absl::GetFlag(FLAGS_cloud_upload_part_size), parts);
+}
+
+io::ReadonlyFileOrError WithReadAhead(io::ReadonlyFileOrError res) {
+  uint32_t blocks = absl::GetFlag(FLAGS_cloud_read_ahead_blocks);
+  if (!res || blocks == 0)
+    return res;
+  return new ReadAheadFile(*res, absl::GetFlag(FLAGS_cloud_read_ahead_block_size), blocks);
+}
+
+#ifdef WITH_AWS
+
+// S3 calls must run on a fiber with a large enough stack, the upload and read ahead fibers of
+// WriteBehindFile and ReadAheadFile qualify.
+error_code S3Error(string_view op, const Aws::S3::S3Error& err) {
+  LOG(ERROR) << "S3 " << op << " failed: " << err.GetExceptionName() << " " << err.GetMessage();
+  return make_error_code(errc::io_error);
+}
+
+// Uploads the parts of a snapshot file concurrently with an S3 multipart upload.
+class S3MultipartUploader : public PartUploader {
+ public:
+  // S3 rejects smaller parts, except for the last one
+  static constexpr size_t kMinPartSize = 5_MB;
+
+  S3MultipartUploader(string bucket, string key, string upload_id,
+                      shared_ptr<Aws::S3::S3Client> client)
+      : bucket_(std::move(bucket)),
+        key_(std::move(key)),
+        upload_id_(std::move(upload_id)),
+        client_(std::move(client)) {
+  }
+
+  static io::Result<S3MultipartUploader*> Open(string_view bucket, string_view key,
+                                               shared_ptr<Aws::S3::S3Client> client) {
+    Aws::S3::Model::CreateMultipartUploadRequest request;
+    request.SetBucket(string(bucket));
+    request.SetKey(string(key));
+    auto outcome = client->CreateMultipartUpload(request);
+    if (!outcome.IsSuccess())
+      return nonstd::make_unexpected(S3Error("CreateMultipartUpload", outcome.GetError()));
+    return new S3MultipartUploader(string(bucket), string(key), outcome.GetResult().GetUploadId(),
+                                   std::move(client));
+  }
+
+  error_code UploadPart(unsigned part_num, string data) final {
+    Aws::S3::Model::UploadPartRequest request;
+    request.SetBucket(bucket_);
+    request.SetKey(key_);
+    request.SetUploadId(upload_id_);
+    request.SetPartNumber(part_num);
+    request.SetContentLength(data.size());
+    request.SetBody(Aws::MakeShared<Aws::StringStream>("S3MultipartUploader", std::move(data)));
+    auto outcome = client_->UploadPart(request);
+    if (!outcome.IsSuccess())
+      return S3Error("UploadPart", outcome.GetError());
+    etags_[part_num] = outcome.GetResult().GetETag();
+    return {};
+  }
+
+  error_code Finish(bool abort) final {
+    if (abort) {
+      Aws::S3::Model::AbortMultipartUploadRequest request;
+      request.SetBucket(bucket_);
+      request.SetKey(key_);
+      request.SetUploadId(upload_id_);
+      auto outcome = client_->AbortMultipartUpload(request);
+      return outcome.IsSuccess() ? error_code{}
+                                 : S3Error("AbortMultipartUpload", outcome.GetError());
+    }
+
+    // The parts must be listed in ascending order
+    Aws::S3::Model::CompletedMultipartUpload upload;
+    for (const auto& [part_num, etag] : etags_)
+      upload.AddParts(Aws::S3::Model::CompletedPart{}.WithPartNumber(part_num).WithETag(etag));
+
+    Aws::S3::Model::CompleteMultipartUploadRequest request;
+    request.SetBucket(bucket_);
+    request.SetKey(key_);
+    request.SetUploadId(upload_id_);
+    request.SetMultipartUpload(std::move(upload));
+    auto outcome = client_->CompleteMultipartUpload(request);
+    return outcome.IsSuccess() ? error_code{}
+                               : S3Error("CompleteMultipartUpload", outcome.GetError());
+  }
+
+ private:
+  string bucket_, key_, upload_id_;
+  shared_ptr<Aws::S3::S3Client> client_;
+  std::map<unsigned, Aws::String> etags_;
+};
+
+// Downloads blocks of a snapshot file concurrently with ranged GET requests.
+class S3RangeReader : public RangeReader {
+ public:
+  S3RangeReader(string bucket, string key, size_t size, shared_ptr<Aws::S3::S3Client> client)
+      : bucket_(std::move(bucket)), key_(std::move(key)), size_(size), client_(std::move(client)) {
+  }
+
+  static io::Result<S3RangeReader*> Open(string_view bucket, string_view key,
+                                         shared_ptr<Aws::S3::S3Client> client) {
+    Aws::S3::Model::HeadObjectRequest request;
+    request.SetBucket(string(bucket));
+    request.SetKey(string(key));
+    auto outcome = client->HeadObject(request);
+    if (!outcome.IsSuccess())
+      return nonstd::make_unexpected(S3Error("HeadObject", outcome.GetError()));
+    return new S3RangeReader(string(bucket), string(key), outcome.GetResult().GetContentLength(),
+                             std::move(client));
+  }
+
+  io::Result<size_t> ReadRange(size_t offset, io::MutableBytes dest) final {
+    if (offset >= size_ || dest.empty())
+      return 0;
+
+    size_t end = min(offset + dest.size(), size_) - 1;
+    Aws::S3::Model::GetObjectRequest request;
+    request.SetBucket(bucket_);
+    request.SetKey(key_);
+    request.SetRange(absl::StrCat("bytes=", offset, "-", end));
+    auto outcome = client_->GetObject(request);
+    if (!outcome.IsSuccess())
+      return nonstd::make_unexpected(S3Error("GetObject", outcome.GetError()));
+
+    auto& body = outcome.GetResult().GetBody();
+    body.read(reinterpret_cast<char*>(dest.data()), end - offset + 1);
+    return body.gcount();
+  }
+
+  size_t Size() const final {
+    return size_;
+  }
+
+ private:
+  string bucket_, key_;
+  size_t size_;
+  shared_ptr<Aws::S3::S3Client> client_;
+};
+
+#endif
+
 }  // namespace
 
 // Helps to recognize Azure path - used in server_family.cc to initialize AzureSnapshotStorage.
@@ -409,7 +581,7 @@ io::Result<std::pair<io::Sink*, uint8_t>, GenericError> GcsSnapshotStorage::Open
     return nonstd::make_unexpected(GenericError(dest_res.error(), "Could not open file"));
   }
 
-  return std::pair(*dest_res, FileType::CLOUD);
+  return std::pair(WithWriteBehind(*dest_res), FileType::CLOUD);
 }
 
 io::ReadonlyFileOrError GcsSnapshotStorage::OpenReadFile(const std::string& path) {
@@ -424,7 +596,7 @@ io::ReadonlyFileOrError GcsSnapshotStorage::OpenReadFile(const std::string& path
   opts.pool = conn_pool.release();
   opts.pool_owned = true;
 
-  return cloud::OpenReadGcsFile(bucket, key, opts);
+  return WithReadAhead(cloud::OpenReadGcsFile(bucket, key, opts));
 }
 
 io::Result<std::string, GenericError> GcsSnapshotStorage::LoadPath(string_view dir,
@@ -567,7 +739,7 @@ io::Result<std::pair<io::Sink*, uint8_t>, GenericError> AzureSnapshotStorage::Op
     return nonstd::make_unexpected(GenericError(dest_res.error(), "Could not open file"));
   }
 
-  return std::pair(*dest_res, FileType::CLOUD);
+  return std::pair(WithWriteBehind(*dest_res), FileType::CLOUD);
 }
 
 io::ReadonlyFileOrError AzureSnapshotStorage::OpenReadFile(const std::string& path) {
@@ -580,7 +752,7 @@ io::ReadonlyFileOrError AzureSnapshotStorage::OpenReadFile(const std::string& pa
   opts.creds_provider = creds_provider_.get();
   opts.ssl_cntx = ctx_;
 
-  return cloud::azure::OpenReadFile(azure_path->container, azure_path->key, opts);
+  return WithReadAhead(cloud::azure::OpenReadFile(azure_path->container, azure_path->key, opts));
 }
 
 io::Result<std::string, GenericError> AzureSnapshotStorage::LoadPath(string_view dir,
@@ -775,7 +947,7 @@ io::Result<std::pair<io::Sink*, uint8_t>, GenericError> AwsS3SnapshotStorage::Op
       return nonstd::make_unexpected(GenericError(dest_res.error(), "Could not open file"));
     }
 
-    return std::pair<io::Sink*, uint8_t>(*dest_res, FileType::CLOUD);
+    return std::pair<io::Sink*, uint8_t>(WithWriteBehind(*dest_res), FileType::CLOUD);
   }
 
 #ifdef WITH_AWS
@@ -786,14 +958,19 @@ io::Result<std::pair<io::Sink*, uint8_t>, GenericError> AwsS3SnapshotStorage::Op
   io::Result<std::pair<io::Sink*, uint8_t>, GenericError> result;
   auto fb = proactor->LaunchFiber(
       fb2::Launch::post, boost::context::fixedsize_stack{40 * 1024}, "open_s3_write", [&] {
-        io::Result<aws::S3WriteFile> file = aws::S3WriteFile::Open(bucket, key, s3_);
-        if (!file) {
-          result = nonstd::make_unexpected(GenericError(file.error(), "Failed to open write file"));
+        io::Result<S3MultipartUploader*> uploader = S3MultipartUploader::Open(bucket, key, s3_);
+        if (!uploader) {
+          result =
+              nonstd::make_unexpected(GenericError(uploader.error(), "Failed to open write file"));
           return;
         }
 
-        aws::S3WriteFile* f = new aws::S3WriteFile(std::move(*file));
-        result = std::pair<io::Sink*, uint8_t>(f, FileType::CLOUD);
+        size_t part_size = max(absl::GetFlag(FLAGS_cloud_upload_part_size),
+                               S3MultipartUploader::kMinPartSize);
+        auto* file = new WriteBehindFile(*uploader, key, part_size,
+                                         absl::GetFlag(FLAGS_cloud_upload_parts),
+                                         absl::GetFlag(FLAGS_cloud_upload_streams));
+        result = std::pair<io::Sink*, uint8_t>(file, FileType::CLOUD);
       });
   fb.Join();
 
@@ -813,11 +990,21 @@ io::ReadonlyFileOrError AwsS3SnapshotStorage::OpenReadFile(const std::string& pa
     cloud::aws::ReadFileOptions opts;
     opts.creds_provider = &creds_provider_;
     opts.ssl_cntx = ctx_;
-    return cloud::aws::OpenReadFile(bucket, key, opts);
+    return WithReadAhead(cloud::aws::OpenReadFile(bucket, key, opts));
   }
 
 #ifdef WITH_AWS
-  return new aws::S3ReadFile(bucket, key, s3_);
+  io::Result<S3RangeReader*> reader;
+  auto fb = ProactorBase::me()->LaunchFiber(
+      fb2::Launch::post, boost::context::fixedsize_stack{40 * 1024}, "open_s3_read",
+      [&, &bucket = bucket, &key = key] { reader = S3RangeReader::Open(bucket, key, s3_); });
+  fb.Join();
+  if (!reader)
+    return nonstd::make_unexpected(GenericError(reader.error(), "Failed to open read file"));
+
+  return new ReadAheadFile(*reader, absl::GetFlag(FLAGS_cloud_read_ahead_block_size),
+                           absl::GetFlag(FLAGS_cloud_read_ahead_blocks),
+                           absl::GetFlag(FLAGS_cloud_read_ahead_streams));
 #else
   ABSL_UNREACHABLE();
 #endif
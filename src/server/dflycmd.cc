@@ -293,6 +293,7 @@ void DflyCmd::Flow(CmdArgParser parser, CommandContext* cmd_cntx) {
 
   if (parser.HasAtLeast(2)) {
     replica_last_master = {parser.Next<string>(), parser.Next(ParseLsnVec)};
+    replica_last_master->seeded = parser.Check("SEEDED");
   } else if (parser.HasNext()) {
     flow_lsn = parser.Next<LSN>();
   }
@@ -350,8 +351,12 @@ void DflyCmd::Flow(CmdArgParser parser, CommandContext* cmd_cntx) {
                                 replica_last_master->id == sf_->GetLineageId() &&
                                 absl::GetFlag(FLAGS_experimental_cascaded_partial_sync);
 
+    // Skip full sync if the replica was seeded from one of our snapshots with an LSN watermark
+    const bool seeded_match = replica_last_master && replica_last_master->seeded &&
+                              replica_last_master->id == master_id;
+
     // Case for partial sync
-    if (failover_match || cascaded_match) {
+    if (failover_match || cascaded_match || seeded_match) {
       ++ServerState::tlocal()->stats.psync_requests_total;
       const std::vector<LSN>& lsns = replica_last_master->last_journal_LSNs;
 
@@ -469,7 +474,8 @@ void DflyCmd::StartStable(CmdArgParser parser, CommandContext* cmd_cntx) {
         }
       }
 
-      StartStableSyncInThread(flow, &replica_ptr->GetExecState(), shard);
+      StartStableSyncInThread(replica_ptr->GetVersion(), flow, &replica_ptr->GetExecState(),
+                              shard);
     };
     shard_set->RunBlockingInParallel(std::move(cb));
 
@@ -748,14 +754,17 @@ OpStatus DflyCmd::StopFullSyncInThread(FlowInfo* flow, ExecutionState* exec_st,
   return OpStatus::OK;
 }
 
-void DflyCmd::StartStableSyncInThread(FlowInfo* flow, ExecutionState* exec_st, EngineShard* shard) {
+void DflyCmd::StartStableSyncInThread(DflyVersion version, FlowInfo* flow, ExecutionState* exec_st,
+                                      EngineShard* shard) {
   // Create streamer for shard flows.
   DCHECK(shard);
   DCHECK(flow->conn);
 
   LSN partial_lsn = flow->start_partial_sync_at.value_or(0);
-  JournalStreamer::Config config{
-      .should_sent_lsn = true, .init_from_stable_sync = true, .start_partial_sync_at = partial_lsn};
+  JournalStreamer::Config config{.should_sent_lsn = true,
+                                 .init_from_stable_sync = true,
+                                 .start_partial_sync_at = partial_lsn,
+                                 .allow_compression = version >= DflyVersion::VER7};
   flow->streamer.reset(new JournalStreamer(exec_st, config));
   flow->streamer->Start(flow->conn->socket());
 
@@ -312,7 +312,8 @@ class DflyCmd {
   facade::OpStatus StopFullSyncInThread(FlowInfo* flow, ExecutionState* cntx, EngineShard* shard);
 
   // Start stable sync in thread. Called for each flow.
-  void StartStableSyncInThread(FlowInfo* flow, ExecutionState* cntx, EngineShard* shard);
+  void StartStableSyncInThread(DflyVersion version, FlowInfo* flow, ExecutionState* cntx,
+                               EngineShard* shard);
 
   // Get ReplicaInfo by sync_id.
   std::shared_ptr<ReplicaInfo> GetReplicaInfo(uint32_t sync_id) ABSL_LOCKS_EXCLUDED(mu_);
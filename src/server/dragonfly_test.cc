@@ -727,6 +727,69 @@ TEST_F(DflyEngineTest, Bug496) {
   });
 }
 
+TEST_F(DflyEngineTest, AddBulk) {
+  shard_set->Await(0, [] {
+    auto& db = namespaces->GetDefaultNamespace().GetDbSlice(0);
+    DbSlice::Context cntx{&namespaces->GetDefaultNamespace(), 0, GetCurrentTimeMs()};
+    ASSERT_TRUE(db.AddOrUpdate(cntx, "key-1", PrimeValue{"old"}, 0));
+
+    vector<string> keys;
+    for (unsigned i = 0; i < 1000; ++i)
+      keys.push_back(absl::StrCat("key-", i));
+
+    vector<DbSlice::BulkEntry> entries;
+    for (const string& key : keys) {
+      entries.push_back({.key = key,
+                         .key_hash = CompactObj::HashCode(key),
+                         .value = PrimeValue{absl::StrCat("val-", key)},
+                         .expire_at_ms = key == "key-2" ? cntx.time_now_ms + 10000 : 0});
+    }
+    // The same key twice in a batch, the last value wins.
+    entries.push_back({.key = keys[3],
+                       .key_hash = CompactObj::HashCode(keys[3]),
+                       .value = PrimeValue{"last"}});
+
+    size_t new_keys = 0, calls = 0;
+    auto res = db.AddBulk(cntx, absl::MakeSpan(entries),
+                          [&](size_t i, const DbSlice::Iterator& it, bool is_new) {
+                            EXPECT_EQ(i, calls++);
+                            EXPECT_EQ(it.key(), entries[i].key);
+                            new_keys += is_new;
+                          });
+    ASSERT_TRUE(res);
+    EXPECT_EQ(*res, entries.size());
+    EXPECT_EQ(calls, entries.size());
+    EXPECT_EQ(new_keys, 999u);
+    EXPECT_EQ(db.DbSize(0), 1000u);
+
+    auto it = db.FindReadOnly(cntx, "key-1", OBJ_STRING);
+    ASSERT_TRUE(it);
+    EXPECT_EQ((*it)->second.ToString(), "val-key-1");
+    it = db.FindReadOnly(cntx, "key-2", OBJ_STRING);
+    ASSERT_TRUE(it);
+    EXPECT_EQ((*it)->first.GetExpireTime(), cntx.time_now_ms + 10000);
+    it = db.FindReadOnly(cntx, "key-3", OBJ_STRING);
+    ASSERT_TRUE(it);
+    EXPECT_EQ((*it)->second.ToString(), "last");
+  });
+}
+
+TEST_F(DflyEngineTest, ReserveForLoad) {
+  shard_set->Await(0, [] {
+    auto& db = namespaces->GetDefaultNamespace().GetDbSlice(0);
+    auto reserved = [&] {
+      return db.GetDBTable(1)->prime.GetSegmentCount() * PrimeTable::kSegCapacity;
+    };
+
+    // Hints of concurrent loaders add up.
+    db.ReserveForLoad(1, 5000);
+    EXPECT_GE(reserved(), 5000u);
+    db.ReserveForLoad(1, 5000);
+    EXPECT_GE(reserved(), 10000u);
+    EXPECT_EQ(db.DbSize(1), 0u);
+  });
+}
+
 TEST_F(DflyEngineTest, Issue607) {
   // https://github.com/dragonflydb/dragonfly/issues/607
 
@@ -68,6 +68,10 @@ ABSL_FLAG(double, eviction_memory_budget_threshold, 0.1,
           "Eviction starts when the free memory (including RSS memory) drops below "
           "eviction_memory_budget_threshold * max_memory_limit.");
 ABSL_FLAG(bool, background_heartbeat, false, "Whether to run heartbeat as a background fiber");
+ABSL_FLAG(bool, huffman_auto_train, false,
+          "If true, huffman tables trained in the background are installed on all shards "
+          "and existing keys and string values are re-encoded with them. Has no effect for "
+          "domains that already have a table set via --huffman_table.");
 ABSL_DECLARE_FLAG(uint32_t, max_eviction_per_heartbeat);
 
 namespace dfly {
@@ -126,16 +130,22 @@ size_t CalculateHowManyBytesToEvictOnShard(size_t global_memory_limit, size_t gl
 class HuffmanCheckTask {
  public:
   HuffmanCheckTask() {
-    hist_.fill(0);
+    key_hist_.fill(0);
+    val_hist_.fill(0);
   }
 
   int32_t Run(DbSlice* db_slice);
 
  private:
+  static constexpr unsigned kMaxSymbol = 255;
+  using Histogram = array<unsigned, kMaxSymbol + 1>;
+
+  // Returns the exported table if it compresses the histogram well enough.
+  static optional<string> BuildTable(Histogram* hist, string_view domain_name);
+
   PrimeTable::Cursor cursor_;
 
-  static constexpr unsigned kMaxSymbol = 255;
-  array<unsigned, kMaxSymbol + 1> hist_;  // histogram of symbols.
+  Histogram key_hist_, val_hist_;  // histograms of symbols.
   string scratch_;
 };
 
@@ -154,7 +164,7 @@ int32_t HuffmanCheckTask::Run(DbSlice* db_slice) {
       if (!it->first.IsInline()) {
         string_view val = it->first.GetSlice(&scratch_);
         for (unsigned char c : val) {
-          hist_[c]++;
+          key_hist_[c]++;
         }
 
         if (val.size() > 1024) {
@@ -162,6 +172,14 @@ int32_t HuffmanCheckTask::Run(DbSlice* db_slice) {
           string{}.swap(scratch_);          // free memory.
         }
       }
+
+      const PrimeValue& pv = it->second;
+      if (pv.ObjType() == OBJ_STRING && !pv.IsInline() && !pv.IsExternal() &&
+          pv.Size() <= CompactObj::kMaxHuffLen) {
+        for (unsigned char c : pv.GetSlice(&scratch_)) {
+          val_hist_[c]++;
+        }
+      }
     });
     traverses_count++;
   } while (traverses_count < kMaxTraverses && cursor_);
@@ -169,41 +187,116 @@ int32_t HuffmanCheckTask::Run(DbSlice* db_slice) {
   if (cursor_)
     return 4;  // priority to continue later.
 
-  // Finished scanning the table, now normalize the table.
+  string{}.swap(scratch_);
+
+  // Build the huffman tables. Unless auto training is enabled, we output the tables to logs
+  // and just increase the metric counter to signal that we built a table.
+  vector<pair<CompactObj::HuffmanDomain, string>> tables;
+  if (auto bintable = BuildTable(&key_hist_, "keys")) {
+    tables.emplace_back(CompactObj::HUFF_KEYS, std::move(*bintable));
+  }
+  if (auto bintable = BuildTable(&val_hist_, "strings")) {
+    tables.emplace_back(CompactObj::HUFF_STRING_VALUES, std::move(*bintable));
+  }
+  db_slice->shard_owner()->stats().huffman_tables_built += tables.size();
+
+  // Tables can not be replaced once set, so we skip domains that already have one.
+  erase_if(tables, [](const auto& t) { return CompactObj::HasHuffmanTable(t.first); });
+  if (tables.empty() || !GetFlag(FLAGS_huffman_auto_train))
+    return -1;
+
+  // We are running inside an idle task, so we roll out the tables from a separate fiber.
+  fb2::Fiber("huffman_rollout", [tables = std::move(tables)] {
+    shard_set->RunBriefInParallel([&](EngineShard* shard) {
+      for (const auto& [domain, bintable] : tables) {
+        CompactObj::InitHuffmanThreadLocal(domain, bintable);
+      }
+      shard->StartHuffmanReencode();
+    });
+    LOG(INFO) << "Installed " << tables.size() << " trained huffman table(s)";
+  }).Detach();
+
+  return -1;  // task completed.
+}
+
+optional<string> HuffmanCheckTask::BuildTable(Histogram* hist, string_view domain_name) {
+  // Normalize the histogram.
   constexpr unsigned kMaxFreqTotal = static_cast<unsigned>((1U << 31) * 0.9);
-  size_t total_freq = std::accumulate(hist_.begin(), hist_.end(), 0UL);
+  size_t total_freq = std::accumulate(hist->begin(), hist->end(), 0UL);
   if (total_freq == 0)
-    return -1;
+    return nullopt;
 
   // to avoid overflow.
   double scale = total_freq > kMaxFreqTotal ? static_cast<double>(total_freq) / kMaxFreqTotal : 1.0;
   for (unsigned i = 0; i <= kMaxSymbol; i++) {
-    hist_[i] = static_cast<unsigned>(hist_[i] / scale);
-    if (hist_[i] == 0) {
-      hist_[i] = 1;  // Avoid zero frequency symbols.
+    (*hist)[i] = static_cast<unsigned>((*hist)[i] / scale);
+    if ((*hist)[i] == 0) {
+      (*hist)[i] = 1;  // Avoid zero frequency symbols.
     }
   }
 
-  // Build the huffman table. We currently output the table to logs and just increase
-  // the metric counter to signal that we built a table.
-
   HuffmanEncoder huff_enc;
   string error_msg;
-  if (huff_enc.Build(hist_.data(), kMaxSymbol, &error_msg)) {
-    size_t compressed_size = huff_enc.EstimateCompressedSize(hist_.data(), kMaxSymbol);
-    double ratio = double(compressed_size) / total_freq;
-    LOG(INFO) << "Huffman table built, reducing character count from " << total_freq << " to "
-              << compressed_size << ", compression ratio " << ratio;
-    if (ratio < 1.0) {
-      if (auto bintable = huff_enc.Export()) {
-        LOG(INFO) << "Huffman binary table: " << absl::Base64Escape(*bintable);
-        db_slice->shard_owner()->stats().huffman_tables_built++;
-      }
+  if (!huff_enc.Build(hist->data(), kMaxSymbol, &error_msg)) {
+    LOG(WARNING) << "Huffman build failed for " << domain_name << ": " << error_msg;
+    return nullopt;
+  }
+
+  size_t compressed_size = huff_enc.EstimateCompressedSize(hist->data(), kMaxSymbol);
+  double ratio = double(compressed_size) / total_freq;
+  LOG(INFO) << "Huffman table built for " << domain_name << ", reducing character count from "
+            << total_freq << " to " << compressed_size << ", compression ratio " << ratio;
+  if (ratio >= 1.0)
+    return nullopt;
+
+  auto bintable = huff_enc.Export();
+  if (bintable) {
+    LOG(INFO) << "Huffman binary table for " << domain_name << ": "
+              << absl::Base64Escape(*bintable);
+  }
+  return bintable;
+}
+
+// Re-encodes entries of all databases that were stored before the huffman tables were
+// installed. Runs as an idle task, a bounded number of buckets per invocation.
+class HuffmanReencodeTask {
+ public:
+  int32_t Run(DbSlice* db_slice);
+
+ private:
+  DbIndex db_ind_ = 0;
+  PrimeTable::Cursor cursor_;
+  uint64_t saved_bytes_ = 0;
+};
+
+int32_t HuffmanReencodeTask::Run(DbSlice* db_slice) {
+  // Do not mutate entries while a snapshot or a replication flow is traversing the table.
+  if (db_slice->HasRegisteredCallbacks())
+    return 0;  // retry later with the lowest priority.
+
+  constexpr uint32_t kMaxTraverses = 256;
+  uint32_t traverses_count = 0;
+  while (db_ind_ < db_slice->db_array_size()) {
+    if (!db_slice->IsDbValid(db_ind_)) {
+      ++db_ind_;
+      continue;
     }
-  } else {
-    LOG(WARNING) << "Huffman build failed: " << error_msg;
+
+    auto& prime = db_slice->GetDBTable(db_ind_)->prime;
+    do {
+      cursor_ = prime.Traverse(cursor_, [&](PrimeIterator it) {
+        saved_bytes_ += db_slice->HuffmanReencode(db_ind_, it);
+      });
+    } while (++traverses_count < kMaxTraverses && cursor_);
+
+    if (cursor_)
+      return 4;  // priority to continue later.
+    ++db_ind_;
   }
 
+  VLOG(1) << "Huffman re-encoding finished on shard " << db_slice->shard_id() << ", saved "
+          << saved_bytes_ << " bytes";
+  db_slice->shard_owner()->stats().huffman_reencode_saved_bytes += saved_bytes_;
   return -1;  // task completed.
 }
 
@@ -232,7 +325,7 @@ string EngineShard::TxQueueInfo::Format() const {
 }
 
 EngineShard::Stats& EngineShard::Stats::operator+=(const Stats& o) {
-  static_assert(sizeof(Stats) == 136);
+  static_assert(sizeof(Stats) == 144);
 
 #define ADD(x) x += o.x
 
@@ -250,6 +343,7 @@ EngineShard::Stats& EngineShard::Stats::operator+=(const Stats& o) {
   ADD(total_heartbeat_expired_calls);
   ADD(total_migrated_keys);
   ADD(huffman_tables_built);
+  ADD(huffman_reencode_saved_bytes);
   ADD(stream_sequential_accesses);
   ADD(stream_random_accesses);
   ADD(stream_fetch_all_accesses);
@@ -477,6 +571,22 @@ EngineShard::EngineShard(util::ProactorBase* pb, mi_heap_t* heap)
   queue2_.Start(absl::StrCat("l2_queue_", shard_id()));
 }
 
+void EngineShard::StartHuffmanReencode() {
+  if (huffman_reencode_task_id_ != UINT32_MAX)
+    return;
+
+  huffman_reencode_task_id_ = ProactorBase::me()->AddOnIdleTask(
+      [task = HuffmanReencodeTask{}]() mutable {
+        if (!shard_ || !namespaces) {
+          return -1;
+        }
+
+        DbSlice& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard_->shard_id());
+        return task.Run(&db_slice);
+      },
+      "huffman_reencode");
+}
+
 void EngineShard::Shutdown() {
   DVLOG(1) << "EngineShard::Shutdown";
 
@@ -489,6 +599,7 @@ void EngineShard::Shutdown() {
 void EngineShard::StopPeriodicFiber() {
   ProactorBase::me()->RemoveOnIdleTask(defrag_task_id_);
   ProactorBase::me()->RemoveOnIdleTask(huffman_check_task_id_);
+  ProactorBase::me()->RemoveOnIdleTask(huffman_reencode_task_id_);
 
   fiber_heartbeat_periodic_done_.Notify();
   if (fiber_heartbeat_periodic_.IsJoinable()) {
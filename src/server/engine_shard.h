@@ -47,6 +47,9 @@ class EngineShard {
     // how many huffman tables were built successfully in the background
     uint32_t huffman_tables_built = 0;
 
+    // bytes saved by re-encoding entries stored before the huffman tables were installed.
+    uint64_t huffman_reencode_saved_bytes = 0;
+
     // Stream access pattern metrics (per-command, not per-entry).
     uint64_t stream_sequential_accesses = 0;  // head/tail: XADD, XREAD recent, XTRIM, etc.
     uint64_t stream_random_accesses = 0;      // arbitrary-ID lookups: XRANGE partial, XDEL, XCLAIM
@@ -174,6 +177,10 @@ class EngineShard {
 
   void StopPeriodicFiber();
 
+  // Schedules an idle task that re-encodes entries stored before the huffman tables
+  // were installed on this thread.
+  void StartHuffmanReencode();
+
   struct TxQueueItem {
     std::string debug_id_info;
   };
@@ -324,6 +331,7 @@ class EngineShard {
   IntentLock shard_lock_;
 
   uint32_t defrag_task_id_ = UINT32_MAX, huffman_check_task_id_ = UINT32_MAX;
+  uint32_t huffman_reencode_task_id_ = UINT32_MAX;
   EvictionTaskState eviction_state_;  // Used on eviction fiber
   util::fb2::Fiber fiber_heartbeat_periodic_;
   util::fb2::Done fiber_heartbeat_periodic_done_;
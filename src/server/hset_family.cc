@@ -383,7 +383,7 @@ OpStatus OpIncrBy(const OpArgs& op_args, string_view key, string_view field, Inc
       size_t lpb = lpBytes(lp);
 
       if (lpb >= server.max_listpack_map_bytes) {
-        StringMap* sm = HSetFamily::ConvertToStrMap(lp);
+        StringMap* sm = HSetFamily::PromoteToStrMap(lp, 1);
         pv.InitRobj(OBJ_HASH, kEncodingStrMap2, sm);
       }
     }
@@ -585,7 +585,7 @@ OpResult<CbVariant<uint32_t>> OpSet(const OpArgs& op_args, string_view key,
     lp = (uint8_t*)pv.RObjPtr();
 
     if (op_sp.ttl != UINT32_MAX || !IsGoodForListpack(values, lp)) {
-      StringMap* sm = HSetFamily::ConvertToStrMap(lp);
+      StringMap* sm = HSetFamily::PromoteToStrMap(lp, values.size() / 2);
       pv.InitRobj(OBJ_HASH, kEncodingStrMap2, sm);
       lp = nullptr;
     }
@@ -1520,6 +1520,16 @@ StringMap* HSetFamily::ConvertToStrMap(uint8_t* lp) {
   return sm;
 }
 
+StringMap* HSetFamily::PromoteToStrMap(uint8_t* lp, size_t extra) {
+  StringMap* sm = CompactObj::AllocateMR<StringMap>();
+
+  detail::ListpackWrap lw{lp};
+  sm->Reserve(lw.size() + extra);
+  for (const auto [key, value] : lw)
+    sm->AddNew(key, value);
+  return sm;
+}
+
 // returns -1 if no expiry is associated with the field, -3 if no field is found.
 int32_t HSetFamily::FieldExpireTime(const DbContext& db_context, const PrimeValue& pv,
                                     std::string_view field) {
@@ -1624,7 +1634,7 @@ vector<long> HSetFamily::SetFieldsExpireTime(const OpArgs& op_args, uint32_t ttl
   if (pv->Encoding() == kEncodingListPack) {
     // a valid result can never be a listpack, since it doesnt keep ttl
     uint8_t* lp = (uint8_t*)pv->RObjPtr();
-    StringMap* sm = HSetFamily::ConvertToStrMap(lp);
+    StringMap* sm = HSetFamily::PromoteToStrMap(lp, 0);
     pv->InitRobj(OBJ_HASH, kEncodingStrMap2, sm);
   }
 
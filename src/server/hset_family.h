@@ -26,6 +26,10 @@ class HSetFamily {
   // Does not free lp.
   static StringMap* ConvertToStrMap(uint8_t* lp);
 
+  // Like ConvertToStrMap but for listpacks of existing hashes, whose fields are known to be
+  // unique. Reserves room for `extra` fields that are about to be added. Does not free lp.
+  static StringMap* PromoteToStrMap(uint8_t* lp, size_t extra);
+
   static int32_t FieldExpireTime(const DbContext& db_context, const PrimeValue& pv,
                                  std::string_view field);
 
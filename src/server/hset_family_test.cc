@@ -5,17 +5,20 @@
 #include "server/hset_family.h"
 
 #include <absl/cleanup/cleanup.h>
+#include <mimalloc.h>
 
 #include <tuple>
 
 extern "C" {
 #include "redis/listpack.h"
 #include "redis/sds.h"
+#include "redis/zmalloc.h"
 }
 
 #include "base/gtest.h"
 #include "base/logging.h"
 #include "core/detail/gen_utils.h"
+#include "core/string_map.h"
 #include "facade/facade_test.h"
 #include "server/test_utils.h"
 
@@ -1248,4 +1251,38 @@ TEST_F(HSetFamilyTest, ShrinkMemoryAccountingHash) {
   EXPECT_EQ(9, CheckedInt({"HLEN", "h1"}));
 }
 
+// Promotes a listpack hash with `fields` entries into a StringMap and then adds `batch` new fields
+// to it, the way HSET does when a batch does not fit into the listpack anymore.
+static void BM_PromoteListpackHash(benchmark::State& state) {
+  init_zmalloc_threadlocal(mi_heap_get_backing());
+
+  unsigned num_fields = state.range(0);
+  unsigned batch = state.range(1);
+  bool presize = state.range(2);
+
+  uint8_t* lp = lpNew(0);
+  for (unsigned i = 0; i < num_fields; ++i) {
+    string field = absl::StrCat("field", i), value = absl::StrCat("value", i);
+    lp = lpAppend(lp, reinterpret_cast<const uint8_t*>(field.data()), field.size());
+    lp = lpAppend(lp, reinterpret_cast<const uint8_t*>(value.data()), value.size());
+  }
+
+  vector<string> new_fields(batch);
+  for (unsigned i = 0; i < batch; ++i)
+    new_fields[i] = absl::StrCat("new", i);
+
+  while (state.KeepRunning()) {
+    StringMap* sm =
+        presize ? HSetFamily::PromoteToStrMap(lp, batch) : HSetFamily::ConvertToStrMap(lp);
+    for (const auto& f : new_fields)
+      sm->AddOrUpdate(f, f);
+    benchmark::DoNotOptimize(sm);
+    CompactObj::DeleteMR<StringMap>(sm);
+  }
+  lpFree(lp);
+}
+BENCHMARK(BM_PromoteListpackHash)
+    ->ArgNames({"fields", "batch", "presize"})
+    ->ArgsProduct({{32, 128, 512}, {1, 64, 512}, {0, 1}});
+
 }  // namespace dfly
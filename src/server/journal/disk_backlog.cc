@@ -0,0 +1,305 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/journal/disk_backlog.h"
+
+#include <absl/strings/str_cat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "util/fibers/fibers.h"
+
+#ifdef __linux__
+#include "util/fibers/uring_file.h"
+#include "util/fibers/uring_proactor.h"
+#endif
+
+namespace dfly {
+namespace journal {
+
+using namespace std;
+using namespace util;
+using nonstd::make_unexpected;
+
+namespace {
+
+// Every entry is prefixed by its length. Only the offsets of every kIndexStride-th entry are kept
+// in memory, reads skip the entries in between.
+using EntryLen = uint32_t;
+constexpr size_t kIndexStride = 64;
+
+}  // namespace
+
+struct DiskBacklog::Segment {
+  ~Segment() {
+    if (fd >= 0)
+      close(fd);
+  }
+
+  LSN first_lsn = 0;
+  string path;
+  int fd = -1;
+  vector<uint64_t> index;      // file offset of every kIndexStride-th entry
+  size_t num_entries = 0;      // entries appended, including the pending ones
+  size_t durable_entries = 0;  // entries written to the file
+  uint64_t size = 0;           // bytes appended, including the pending ones
+  uint64_t durable_size = 0;   // bytes written to the file
+  string pending;              // appended bytes that were not submitted yet
+  size_t pending_entries = 0;  // entries in pending
+  bool dropped = false;
+};
+
+namespace {
+
+#ifdef __linux__
+
+using fb2::FiberCall;
+using fb2::ProactorBase;
+using fb2::UringProactor;
+
+io::Result<size_t> UringIo(bool write, int fd, uint8_t* buf, size_t len, size_t offset) {
+  auto* proactor = static_cast<UringProactor*>(ProactorBase::me());
+  FiberCall fc(proactor);
+  if (write)
+    fc->PrepWrite(fd, buf, len, offset);
+  else
+    fc->PrepRead(fd, buf, len, offset);
+  FiberCall::IoResult io_res = fc.Get();
+  if (io_res < 0)
+    return make_unexpected(error_code{-io_res, system_category()});
+  return size_t(io_res);
+}
+
+bool IsSupported() {
+  return ProactorBase::me()->GetKind() == ProactorBase::IOURING;
+}
+
+#else
+
+io::Result<size_t> UringIo(bool, int, uint8_t*, size_t, size_t) {
+  return make_unexpected(make_error_code(errc::function_not_supported));
+}
+
+bool IsSupported() {
+  return false;
+}
+
+#endif
+
+// Reads or writes the whole range, retrying on short transfers.
+error_code FullIo(bool write, int fd, uint8_t* buf, size_t len, size_t offset) {
+  while (len > 0) {
+    auto res = UringIo(write, fd, buf, len, offset);
+    if (!res)
+      return res.error();
+    if (*res == 0)
+      return make_error_code(errc::io_error);
+    buf += *res;
+    offset += *res;
+    len -= *res;
+  }
+  return {};
+}
+
+}  // namespace
+
+DiskBacklog::DiskBacklog(string prefix, size_t max_bytes, size_t segment_bytes,
+                         size_t max_pending_bytes)
+    : prefix_(std::move(prefix)),
+      max_bytes_(max_bytes),
+      segment_bytes_(segment_bytes),
+      max_pending_bytes_(max_pending_bytes) {
+}
+
+DiskBacklog::~DiskBacklog() {
+  Reset();
+  fb2::Fiber{std::move(flush_fb_)}.JoinIfNeeded();  // it accesses `this` until its write is done
+}
+
+LSN DiskBacklog::first_lsn() const {
+  DCHECK(!segments_.empty());
+  return segments_.front()->first_lsn;
+}
+
+shared_ptr<DiskBacklog::Segment> DiskBacklog::OpenSegment(LSN first_lsn) {
+  if (!IsSupported()) {
+    LOG_FIRST_N(WARNING, 1) << "Spilling the replication backlog to disk requires io_uring";
+    return nullptr;
+  }
+
+  auto seg = make_shared<Segment>();
+  seg->first_lsn = first_lsn;
+  seg->path = absl::StrCat(prefix_, "-", first_lsn, ".log");
+  seg->fd = open(seg->path.c_str(), O_CREAT | O_RDWR | O_TRUNC | O_CLOEXEC, 0600);
+  if (seg->fd < 0) {
+    LOG_EVERY_T(ERROR, 10) << "Could not open replication backlog segment " << seg->path << ": "
+                           << error_code{errno, system_category()}.message();
+    return nullptr;
+  }
+  VLOG(1) << "Opened replication backlog segment " << seg->path;
+  return seg;
+}
+
+void DiskBacklog::DropFront() {
+  auto& seg = segments_.front();
+  VLOG(1) << "Dropping replication backlog segment " << seg->path;
+  seg->dropped = true;
+  total_bytes_ -= seg->size;
+  pending_bytes_ -= seg->pending.size();
+  unlink(seg->path.c_str());  // the file is closed once in-flight reads and writes finish
+  segments_.pop_front();
+}
+
+void DiskBacklog::Reset() {
+  while (!segments_.empty())
+    DropFront();
+  DCHECK_EQ(total_bytes_, 0u);
+  DCHECK_EQ(pending_bytes_, 0u);
+  flush_ec_.notifyAll();
+}
+
+void DiskBacklog::Append(LSN lsn, string_view data) {
+  if (!segments_.empty() && lsn != next_lsn_) {
+    LOG(DFATAL) << "Non consecutive lsn " << lsn << ", expected " << next_lsn_;
+    Reset();
+  }
+
+  const size_t entry_bytes = sizeof(EntryLen) + data.size();
+  if (pending_bytes_ > 0 && pending_bytes_ + entry_bytes > max_pending_bytes_) {
+    LOG_EVERY_T(WARNING, 10) << "Writing the replication backlog to disk falls behind, "
+                             << "dropping " << total_bytes_ << " bytes of it";
+    Reset();
+  }
+
+  if (segments_.empty() || segments_.back()->size >= segment_bytes_) {
+    auto seg = OpenSegment(lsn);
+    if (!seg) {
+      // Keep the backlog consecutive, it starts over with the next segment we can open.
+      Reset();
+      return;
+    }
+    segments_.push_back(std::move(seg));
+  }
+
+  Segment& seg = *segments_.back();
+  if (seg.num_entries % kIndexStride == 0)
+    seg.index.push_back(seg.size);
+
+  EntryLen len = data.size();
+  seg.pending.append(reinterpret_cast<const char*>(&len), sizeof(len));
+  seg.pending.append(data);
+  seg.pending_entries++;
+  seg.num_entries++;
+  seg.size += entry_bytes;
+  total_bytes_ += entry_bytes;
+  pending_bytes_ += entry_bytes;
+  next_lsn_ = lsn + 1;
+
+  while (total_bytes_ > max_bytes_ && segments_.size() > 1)
+    DropFront();
+
+  if (!flush_active_) {
+    flush_active_ = true;
+    flush_fb_ = fb2::Fiber(fb2::Launch::post, "journal_backlog_flush", [this] { FlushFb(); });
+  }
+}
+
+void DiskBacklog::FlushFb() {
+  while (true) {
+    auto it = find_if(segments_.begin(), segments_.end(),
+                      [](const auto& seg) { return !seg->pending.empty(); });
+    if (it == segments_.end())
+      break;
+
+    // Hold a reference, the segment can be dropped while the write is in flight.
+    shared_ptr<Segment> seg = *it;
+    string buf;
+    buf.swap(seg->pending);
+    size_t entries = std::exchange(seg->pending_entries, 0);
+    pending_bytes_ -= buf.size();
+
+    error_code ec = FullIo(true, seg->fd, reinterpret_cast<uint8_t*>(buf.data()), buf.size(),
+                           seg->durable_size);
+    if (ec) {
+      LOG(ERROR) << "Failed writing replication backlog segment " << seg->path << ": "
+                 << ec.message();
+      if (!seg->dropped)
+        Reset();
+      break;
+    }
+    seg->durable_size += buf.size();
+    seg->durable_entries += entries;
+    flush_ec_.notifyAll();
+  }
+
+  FiberAtomicGuard guard;
+  flush_active_ = false;
+  flush_ec_.notifyAll();
+  flush_fb_.Detach();  // Append starts a new one once needed
+}
+
+io::Result<LSN> DiskBacklog::Read(LSN lsn, size_t max_bytes, ReadCb cb) {
+  if (!Contains(lsn))
+    return make_unexpected(make_error_code(errc::result_out_of_range));
+
+  auto it = upper_bound(segments_.begin(), segments_.end(), lsn,
+                        [](LSN val, const auto& seg) { return val < seg->first_lsn; });
+  DCHECK(it != segments_.begin());
+  shared_ptr<Segment> seg = *(--it);
+  const size_t idx = lsn - seg->first_lsn;
+  DCHECK_LT(idx, seg->num_entries);
+
+  // The entry may still wait for the flush fiber.
+  flush_ec_.await([&] { return seg->dropped || idx < seg->durable_entries; });
+  if (seg->dropped)
+    return make_unexpected(make_error_code(errc::result_out_of_range));
+
+  // Start with the closest indexed entry, the segment is written in whole entries.
+  size_t cur = idx / kIndexStride * kIndexStride;
+  const uint64_t start = seg->index[idx / kIndexStride];
+  const uint64_t end = seg->durable_size;
+
+  // Extends buf by at least `need` bytes, reading max_bytes at once if possible.
+  string buf;
+  auto read_more = [&](size_t need) -> error_code {
+    const uint64_t offset = start + buf.size();
+    const size_t len = min<uint64_t>(max(need, max_bytes), end - offset);
+    if (len < need)
+      return make_error_code(errc::io_error);
+    buf.resize(buf.size() + len);
+    return FullIo(false, seg->fd, reinterpret_cast<uint8_t*>(buf.data() + buf.size() - len), len,
+                  offset);
+  };
+
+  // The file is still open if the segment was dropped meanwhile.
+  size_t pos = 0, read_bytes = 0;
+  for (; start + pos < end; ++cur) {
+    if (buf.size() < pos + sizeof(EntryLen)) {
+      if (error_code ec = read_more(pos + sizeof(EntryLen) - buf.size()); ec)
+        return make_unexpected(ec);
+    }
+    EntryLen len;
+    memcpy(&len, buf.data() + pos, sizeof(len));
+    const size_t entry_bytes = sizeof(len) + len;
+
+    if (cur >= idx) {
+      if (read_bytes > 0 && read_bytes + entry_bytes > max_bytes)
+        break;
+      if (buf.size() < pos + entry_bytes) {
+        if (error_code ec = read_more(pos + entry_bytes - buf.size()); ec)
+          return make_unexpected(ec);
+      }
+      cb(seg->first_lsn + cur, string_view{buf}.substr(pos + sizeof(len), len));
+      read_bytes += entry_bytes;
+    }
+    pos += entry_bytes;
+  }
+  return seg->first_lsn + cur;
+}
+
+}  // namespace journal
+}  // namespace dfly
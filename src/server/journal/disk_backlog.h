@@ -0,0 +1,96 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#pragma once
+
+#include <absl/functional/function_ref.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "io/io.h"
+#include "server/journal/types.h"
+#include "util/fibers/fibers.h"
+#include "util/fibers/synchronization.h"
+
+namespace dfly {
+namespace journal {
+
+// Second tier of the partial sync backlog of a shard. Entries evicted from the in-memory ring
+// buffer of JournalSlice are appended to length prefixed segment files, and a sparse in-memory
+// index keeps the file offset of every kIndexStride-th entry. This allows to serve a partial sync
+// to replicas that lag behind the ring buffer, reading the entries back with large sequential
+// reads.
+//
+// Writes are submitted by a background fiber, so Append() never preempts. If the disk falls
+// behind by more than max_pending_bytes, the backlog starts over instead of buffering more in
+// memory. Requires io_uring; on other platforms the backlog stays empty. Must be used only from
+// the owning shard thread.
+class DiskBacklog {
+ public:
+  // Segment files are named <prefix>-<first lsn>.log. Once the total size exceeds max_bytes,
+  // the oldest segments are removed.
+  DiskBacklog(std::string prefix, size_t max_bytes, size_t segment_bytes,
+              size_t max_pending_bytes);
+  ~DiskBacklog();
+
+  // Appends the entry with the given LSN. LSNs must be consecutive unless the backlog is empty.
+  void Append(LSN lsn, std::string_view data);
+
+  // Drops all entries and removes the segment files.
+  void Reset();
+
+  bool Contains(LSN lsn) const {
+    return !segments_.empty() && first_lsn() <= lsn && lsn < next_lsn_;
+  }
+
+  // Reads consecutive entries starting with lsn, up to max_bytes of them (at least one entry is
+  // read), and passes each of them to cb. Returns the LSN following the last entry
+  // read. Preempts.
+  using ReadCb = absl::FunctionRef<void(LSN, std::string_view)>;
+  io::Result<LSN> Read(LSN lsn, size_t max_bytes, ReadCb cb);
+
+  // Bytes held by the backlog, including the ones that are not yet written to disk.
+  size_t bytes() const {
+    return total_bytes_;
+  }
+
+  size_t segments() const {
+    return segments_.size();
+  }
+
+  // Whether the background fiber still writes appended entries.
+  bool flushing() const {
+    return flush_active_;
+  }
+
+ private:
+  struct Segment;
+
+  LSN first_lsn() const;
+
+  std::shared_ptr<Segment> OpenSegment(LSN first_lsn);
+  void DropFront();
+  void FlushFb();
+
+  std::string prefix_;
+  const size_t max_bytes_;
+  const size_t segment_bytes_;
+  const size_t max_pending_bytes_;
+
+  std::deque<std::shared_ptr<Segment>> segments_;
+  LSN next_lsn_ = 0;
+  size_t total_bytes_ = 0;
+  size_t pending_bytes_ = 0;  // Appended bytes that were not submitted to the disk yet
+
+  bool flush_active_ = false;
+  util::fb2::Fiber flush_fb_;
+  util::fb2::EventCount flush_ec_;
+};
+
+}  // namespace journal
+}  // namespace dfly
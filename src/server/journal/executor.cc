@@ -14,7 +14,10 @@
 #include "facade/reply_capture.h"
 #include "facade/service_interface.h"
 #include "server/main_service.h"
+#include "server/multi_command_squasher.h"
 #include "server/namespaces.h"
+#include "server/server_state.h"
+#include "server/transaction.h"
 
 using namespace std;
 
@@ -28,6 +31,22 @@ template <typename... Ts> void BuildFromParts(cmn::BackedArguments* dest, Ts...
   dest->Assign(raw_parts.begin(), raw_parts.end(), raw_parts.size());
 }
 
+// Collects the errors of squashed commands, which reply only with errors in ONLY_ERR mode.
+class ErrorCollector : public facade::CapturingReplyBuilder {
+ public:
+  explicit ErrorCollector(vector<string>* errors)
+      : CapturingReplyBuilder{facade::ReplyMode::ONLY_ERR}, errors_{errors} {
+  }
+
+  using CapturingReplyBuilder::SendError;
+  void SendError(string_view str, string_view type) override {
+    errors_->emplace_back(str);
+  }
+
+ private:
+  vector<string>* errors_;
+};
+
 }  // namespace
 
 JournalExecutor::JournalExecutor(Service* service)
@@ -54,6 +73,59 @@ facade::DispatchResult JournalExecutor::Execute(DbIndex dbid, journal::ParsedEnt
   return Execute(&cntx_cmd);
 }
 
+size_t JournalExecutor::ExecuteBatch(DbIndex dbid,
+                                     absl::Span<journal::ParsedEntry::CmdData* const> cmds,
+                                     vector<string>* errors) {
+  SelectDb(dbid);
+
+  const CommandRegistry& registry = *service_->mutable_registry();
+  vector<CmdRef> cmd_refs;
+  cmd_refs.reserve(cmds.size());
+  for (auto* cmd : cmds) {
+    auto [cid, tail_args] = registry.FindExtended(facade::ParsedArgs{*cmd});
+    if (cid == nullptr || !cid->IsTransactional() || cid->IsBlocking() || cid->IsExecGroup() ||
+        cid->IsEvalGroup() || (cid->opt_mask() & (CO::ADMIN | CO::GLOBAL_TRANS)))
+      break;
+
+    // Let the regular path report the error.
+    if (service_->VerifyCommandState(*cid, tail_args, conn_context_))
+      break;
+
+    cmd_refs.push_back(CmdRef{cid, tail_args, facade::ReplyMode::ONLY_ERR});
+  }
+
+  if (cmd_refs.size() < 2)
+    return 0;
+
+  if (!exec_cid_)
+    exec_cid_ = registry.Find("EXEC");
+
+  // Same as pipeline squashing: a non atomic multi transaction that only provides the base
+  // for per-shard local transactions, so no keys are locked across the batch.
+  boost::intrusive_ptr<Transaction> tx{new Transaction{exec_cid_}};
+  tx->StartMultiNonAtomic(Transaction::DEFAULT);
+  conn_context_.transaction = tx.get();
+
+  auto* ss = ServerState::tlocal();
+  MultiCommandSquasher::Opts opts;
+  opts.max_squash_size = ss->max_squash_cmd_num;
+  auto cmd_gen = [it = cmd_refs.begin(), end = cmd_refs.end()]() mutable -> CmdRef {
+    return (it == end) ? CmdRef{} : *it++;
+  };
+  ErrorCollector error_collector{errors};
+  auto stats = MultiCommandSquasher::Execute(std::move(cmd_gen), &error_collector, &conn_context_,
+                                             service_, opts);
+  conn_context_.transaction = nullptr;
+  tx->UnlockMulti();
+
+  ss->stats.multi_squash_exec_hop_usec += stats.hop_usec;
+  ss->stats.multi_squash_exec_reply_usec += stats.reply_usec;
+  ss->stats.multi_squash_hops += stats.hops;
+  ss->stats.squashed_commands += stats.squashed_commands;
+
+  return cmd_refs.size();
+}
+
 void JournalExecutor::FlushAll() {
   CommandContext cmd;
   cmd.Init(reply_builder_.get(), &conn_context_);
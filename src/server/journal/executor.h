@@ -30,6 +30,14 @@ class JournalExecutor {
   // Returns the result of Service::DispatchCommand
   facade::DispatchResult Execute(DbIndex dbid, journal::ParsedEntry::CmdData& cmd);
 
+  // Executes a prefix of cmds with MultiCommandSquasher, so that consecutive single shard
+  // commands run in one hop per shard. Stops at the first command that must run through
+  // Execute(), e.g. a blocking, global or scripting command. Returns the number of commands
+  // executed, which is 0 if the prefix is too short to be worth squashing. Error replies of the
+  // executed commands are appended to `errors`.
+  size_t ExecuteBatch(DbIndex dbid, absl::Span<journal::ParsedEntry::CmdData* const> cmds,
+                      std::vector<std::string>* errors);
+
   void FlushAll();  // Execute FLUSHALL.
   void FlushSlots(const cluster::SlotRange& slot_range);
 
@@ -48,6 +56,7 @@ class JournalExecutor {
   ConnectionContext conn_context_;
 
   std::vector<bool> ensured_dbs_;
+  const CommandId* exec_cid_ = nullptr;  // base command of squashed batches
 };
 
 }  // namespace dfly
@@ -64,10 +64,18 @@ bool IsLSNInBuffer(LSN lsn) {
   return journal_slice.IsLSNInBuffer(lsn);
 }
 
+bool IsLSNSpilled(LSN lsn) {
+  return journal_slice.IsLSNSpilled(lsn);
+}
+
 std::string_view GetEntry(LSN lsn) {
   return journal_slice.GetEntry(lsn);
 }
 
+io::Result<LSN> ReadSpilledEntries(LSN lsn, absl::FunctionRef<void(LSN, std::string_view)> cb) {
+  return journal_slice.ReadSpilled(lsn, cb);
+}
+
 uint32_t RegisterConsumer(JournalConsumerInterface* consumer) {
   return journal_slice.RegisterOnChange(consumer);
 }
@@ -97,6 +105,10 @@ size_t LsnBufferBytes() {
   return journal_slice.GetRingBufferBytes();
 }
 
+size_t DiskBacklogBytes() {
+  return journal_slice.GetDiskBacklogBytes();
+}
+
 size_t thread_local DisableFlushGuard::counter_ = 0;
 
 }  // namespace journal
@@ -3,6 +3,9 @@
 //
 
 #pragma once
+#include <absl/functional/function_ref.h>
+
+#include "io/io.h"
 #include "server/journal/types.h"
 #include "util/fibers/detail/fiber_interface.h"
 
@@ -31,8 +34,16 @@ inline bool HasRegisteredCallbacks() {
 
 bool IsLSNInBuffer(LSN lsn);
 
+// Whether the entry was evicted from the in-memory buffer to the disk backlog. Such entries are
+// read with ReadSpilledEntries() instead of GetEntry().
+bool IsLSNSpilled(LSN lsn);
+
 std::string_view GetEntry(LSN lsn);
 
+// Reads a chunk of consecutive spilled entries starting with lsn and passes them to cb.
+// Returns the LSN following the last entry read. Preempts.
+io::Result<LSN> ReadSpilledEntries(LSN lsn, absl::FunctionRef<void(LSN, std::string_view)> cb);
+
 LSN GetLsn();
 uint32_t RegisterConsumer(JournalConsumerInterface* consumer);
 void UnregisterConsumer(uint32_t id);
@@ -42,6 +53,7 @@ void RecordEntry(TxId txid, Op opcode, DbIndex dbid, std::optional<SlotId> slot,
 
 size_t LsnBufferSize();
 size_t LsnBufferBytes();
+size_t DiskBacklogBytes();
 
 void SetFlushMode(bool allow_flush);
 
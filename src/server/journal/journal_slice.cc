@@ -9,6 +9,7 @@
 #include <absl/strings/escaping.h>
 #include <absl/strings/str_cat.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <filesystem>
 
@@ -19,6 +20,17 @@
 
 ABSL_FLAG(uint32_t, shard_repl_backlog_len, 8192,
           "The length of the circular replication log per shard");
+ABSL_FLAG(uint64_t, shard_repl_backlog_disk_max_bytes, 0,
+          "If positive, journal entries evicted from the in-memory replication log are spilled "
+          "to per-shard segment files up to this size, so that replicas lagging further behind "
+          "can still do a partial sync. Requires io_uring");
+ABSL_FLAG(uint64_t, shard_repl_backlog_disk_segment_bytes, 64ULL << 20,
+          "Size of a segment file of the spilled replication log");
+ABSL_FLAG(uint64_t, shard_repl_backlog_disk_max_pending_bytes, 64ULL << 20,
+          "Memory for entries of the spilled replication log that wait to be written. If the "
+          "disk falls further behind, the spilled log is dropped");
+ABSL_FLAG(std::string, shard_repl_backlog_disk_dir, "/tmp/",
+          "Folder for the segment files of the spilled replication log");
 
 namespace dfly {
 namespace journal {
@@ -38,9 +50,36 @@ void JournalSlice::Init() {
 
   ring_buffer_.set_capacity(absl::GetFlag(FLAGS_shard_repl_backlog_len));
   ring_buffer_bytes_ = ring_buffer_.capacity() * sizeof(JournalItem);
+
+  if (uint64_t max_bytes = absl::GetFlag(FLAGS_shard_repl_backlog_disk_max_bytes); max_bytes > 0) {
+    // Segment files of different dragonfly processes on the same host must not collide.
+    string prefix = absl::StrCat(absl::GetFlag(FLAGS_shard_repl_backlog_disk_dir), "journal-",
+                                 getpid(), "-", fb2::ProactorBase::me()->GetPoolIndex());
+    disk_backlog_ = make_unique<DiskBacklog>(
+        std::move(prefix), max_bytes, absl::GetFlag(FLAGS_shard_repl_backlog_disk_segment_bytes),
+        absl::GetFlag(FLAGS_shard_repl_backlog_disk_max_pending_bytes));
+  }
+}
+
+void JournalSlice::ResetRingBuffer() {
+  ring_buffer_.clear();
+  ring_buffer_bytes_ = ring_buffer_.capacity() * sizeof(JournalItem);
+  if (disk_backlog_)
+    disk_backlog_->Reset();
 }
 
 bool JournalSlice::IsLSNInBuffer(LSN lsn) const {
+  return IsLSNInMemory(lsn) || IsLSNSpilled(lsn);
+}
+
+io::Result<LSN> JournalSlice::ReadSpilled(LSN lsn, DiskBacklog::ReadCb cb) {
+  DCHECK(disk_backlog_);
+  // Large sequential reads, the streamer throttles between them.
+  constexpr size_t kReadChunk = 1 << 20;
+  return disk_backlog_->Read(lsn, kReadChunk, cb);
+}
+
+bool JournalSlice::IsLSNInMemory(LSN lsn) const {
   DCHECK(ring_buffer_.capacity() > 0);
 
   if (ring_buffer_.empty()) {
@@ -55,7 +94,7 @@ bool JournalSlice::IsLSNInBuffer(LSN lsn) const {
 }
 
 std::string_view JournalSlice::GetEntry(LSN lsn) const {
-  DCHECK(ring_buffer_.capacity() > 0 && IsLSNInBuffer(lsn));
+  DCHECK(ring_buffer_.capacity() > 0 && IsLSNInMemory(lsn));
 
   auto start = ring_buffer_.front().lsn;
   DCHECK(ring_buffer_[lsn - start].lsn == lsn);
@@ -117,7 +156,11 @@ void JournalSlice::CallOnChange(JournalChangeItem* change_item) {
 
   // We preserve order here. After ConsumeJournalChange there can reordering
   if (ring_buffer_.size() == ring_buffer_.capacity()) {
-    const size_t bytes_removed = ring_buffer_.front().data.capacity();
+    const JournalItem& evicted = ring_buffer_.front();
+    if (disk_backlog_)
+      disk_backlog_->Append(evicted.lsn, evicted.data);
+
+    const size_t bytes_removed = evicted.data.capacity();
     DCHECK_GE(ring_buffer_bytes_, bytes_removed);
     ring_buffer_bytes_ -= bytes_removed;
   }
@@ -9,6 +9,7 @@
 #include <shared_mutex>
 #include <string_view>
 
+#include "server/journal/disk_backlog.h"
 #include "server/journal/types.h"
 #include "util/fibers/synchronization.h"
 
@@ -46,9 +47,19 @@ class JournalSlice {
   }
 
   /// Returns whether the journal entry with this LSN is available
-  /// from the buffer.
+  /// from the buffer, either in memory or spilled to disk.
   bool IsLSNInBuffer(LSN lsn) const;
+
+  /// Returns whether the entry was evicted from the ring buffer to the disk backlog.
+  bool IsLSNSpilled(LSN lsn) const {
+    return disk_backlog_ && disk_backlog_->Contains(lsn);
+  }
+
+  // Must be called only for entries in the ring buffer, i.e. !IsLSNSpilled(lsn).
   std::string_view GetEntry(LSN lsn) const;
+
+  // Reads a chunk of spilled entries starting with lsn, may preempt.
+  io::Result<LSN> ReadSpilled(LSN lsn, DiskBacklog::ReadCb cb);
   // SetFlushMode with allow_flush=false is used to disable preemptions during
   // subsequent calls to AddLogRecord.
   // SetFlushMode with allow_flush=true flushes all log records aggregated
@@ -65,18 +76,22 @@ class JournalSlice {
     return ring_buffer_bytes_;
   }
 
-  void ResetRingBuffer() {
-    ring_buffer_.clear();
-    ring_buffer_bytes_ = ring_buffer_.capacity() * sizeof(JournalItem);
+  size_t GetDiskBacklogBytes() const {
+    return disk_backlog_ ? disk_backlog_->bytes() : 0;
   }
 
+  void ResetRingBuffer();
+
   void SetStartingLSN(LSN lsn) {
     lsn_ = lsn;
   }
 
  private:
   void CallOnChange(JournalChangeItem* item);
+  bool IsLSNInMemory(LSN lsn) const;
+
   boost::circular_buffer<JournalItem> ring_buffer_;
+  std::unique_ptr<DiskBacklog> disk_backlog_;  // older entries evicted from ring_buffer_
 
   mutable util::fb2::SharedMutex cb_mu_;  // to prevent removing callback during call
   std::list<std::pair<uint32_t, JournalConsumerInterface*>> journal_consumers_arr_;
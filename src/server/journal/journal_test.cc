@@ -8,11 +8,14 @@
 #include "base/logging.h"
 #include "core/detail/gen_utils.h"
 #include "server/common.h"
+#include "server/detail/compressor.h"
+#include "server/journal/disk_backlog.h"
 #include "server/journal/pending_buf.h"
 #include "server/journal/serializer.h"
 #include "server/journal/types.h"
 #include "server/serializer_commons.h"
 #include "util/fibers/fibers.h"
+#include "util/fibers/pool.h"
 
 using namespace testing;
 using namespace std;
@@ -108,6 +111,90 @@ TEST(Journal, WriteRead) {
   }
 }
 
+TEST(Journal, WriteReadCompressed) {
+  StoredLists lists{};
+  lists.reserve(100);  // payloads point into the stored lists
+  using Payload = Entry::Payload;
+
+  std::vector<Entry> test_entries;
+  for (unsigned i = 0; i < 100; ++i) {
+    CmdArgList args = StoreList(&lists, absl::StrCat("key", i), string(100, 'v'));
+    test_entries.emplace_back(i, Op::COMMAND, i % 3, nullopt, Payload("SET", args));
+  }
+
+  // Serialize every entry separately, like the journal does.
+  vector<string> serialized;
+  {
+    io::StringSink sink;
+    JournalWriter writer{&sink};
+    size_t offset = 0;
+    for (const auto& entry : test_entries) {
+      writer.Write(entry);
+      serialized.push_back(sink.str().substr(offset));
+      offset = sink.str().size();
+    }
+  }
+
+  // Send the first half as is and the rest in two compressed frames with different codecs.
+  base::IoBuf buf;
+  io::BufSink sink{&buf};
+  JournalWriter writer{&sink};
+  for (unsigned i = 0; i < 50; ++i)
+    sink.Write(io::Buffer(serialized[i]));
+
+  auto lz4 = detail::CompressorImpl::CreateLZ4();
+  auto zstd = detail::CompressorImpl::CreateZstd();
+  for (auto [from, to] : {pair{50u, 75u}, pair{75u, 100u}}) {
+    string batch = absl::StrJoin(serialized.begin() + from, serialized.begin() + to, "");
+    auto* compressor = from == 50 ? lz4.get() : zstd.get();
+    auto res = compressor->Compress(io::Buffer(batch));
+    ASSERT_TRUE(res);
+    ASSERT_LT(res->size(), batch.size());
+    writer.WriteCompressed(from == 50 ? FrameCodec::LZ4 : FrameCodec::ZSTD, batch.size(), *res);
+  }
+
+  io::BufSource source{&buf};
+  JournalReader reader{&source, 0};
+  ParsedEntry res;
+  for (auto& expected : test_entries) {
+    ASSERT_FALSE(reader.ReadEntry(&res));
+    ASSERT_EQ(expected.opcode, res.opcode);
+    ASSERT_EQ(expected.txid, res.txid);
+    ASSERT_EQ(expected.dbid, res.dbid);
+    ASSERT_EQ(ExtractPayload(expected), ExtractPayload(res));
+  }
+  EXPECT_TRUE(reader.ReadEntry(&res));  // end of stream
+}
+
+TEST(Journal, WriteReadRdbBlob) {
+  StoredSlices slices{};
+  using Payload = Entry::Payload;
+  Entry cmd{1, Op::COMMAND, 0, nullopt, Payload("SET", StoreSlice(&slices, "A", "1"))};
+  string blob{"\x00\x01native\xff", 9};
+
+  base::IoBuf buf;
+  io::BufSink sink{&buf};
+  JournalWriter writer{&sink};
+  writer.Write(cmd);
+  writer.WriteRdbBlob(blob);
+  writer.Write(cmd);
+
+  io::BufSource source{&buf};
+  JournalReader reader{&source, 0};
+  ParsedEntry res;
+  ASSERT_FALSE(reader.ReadEntry(&res));
+  EXPECT_EQ(ExtractPayload(cmd), ExtractPayload(res));
+
+  ASSERT_FALSE(reader.ReadEntry(&res));
+  ASSERT_EQ(res.opcode, Op::RDB_BLOB);
+  ASSERT_EQ(res.cmd.size(), 1u);
+  EXPECT_EQ(res.cmd.Front(), blob);
+
+  ASSERT_FALSE(reader.ReadEntry(&res));
+  EXPECT_EQ(res.opcode, Op::COMMAND);
+  EXPECT_EQ(ExtractPayload(cmd), ExtractPayload(res));
+}
+
 TEST(Journal, PendingBuf) {
   PendingBuf pbuf;
 
@@ -225,5 +312,87 @@ TEST(Journal, CircularMemory) {
   LOG(INFO) << "Tmp string capacity: " << tmp.capacity();
 }
 
+class DiskBacklogTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pp_.reset(fb2::Pool::IOUring(16, 1));
+    pp_->Run();
+  }
+
+  void TearDown() override {
+    pp_->Stop();
+    pp_.reset();
+  }
+
+  std::unique_ptr<ProactorPool> pp_;
+};
+
+TEST_F(DiskBacklogTest, AppendRead) {
+  pp_->at(0)->Await([] {
+    // Small segments, so that the entries span several files and the oldest ones are dropped.
+    DiskBacklog backlog{"/tmp/disk_backlog_test", 4096, 1024, 1 << 20};
+    for (LSN lsn = 10; lsn < 1010; ++lsn)
+      backlog.Append(lsn, absl::StrCat("entry-", lsn));
+
+    EXPECT_LE(backlog.bytes(), 4096u);
+    EXPECT_GT(backlog.segments(), 1u);
+    EXPECT_FALSE(backlog.Contains(10));
+    EXPECT_TRUE(backlog.Contains(1009));
+    EXPECT_FALSE(backlog.Contains(1010));
+
+    LSN lsn = 1009;
+    while (backlog.Contains(lsn - 1))
+      --lsn;
+
+    LSN expected = lsn;
+    while (lsn < 1010) {
+      auto res = backlog.Read(lsn, 100, [&](LSN entry_lsn, string_view data) {
+        EXPECT_EQ(entry_lsn, expected);
+        EXPECT_EQ(data, absl::StrCat("entry-", expected));
+        ++expected;
+      });
+      ASSERT_TRUE(res);
+      ASSERT_GT(*res, lsn);
+      lsn = *res;
+    }
+    EXPECT_EQ(expected, 1010u);
+
+    while (backlog.flushing())
+      ThisFiber::SleepFor(std::chrono::milliseconds(1));
+
+    backlog.Reset();
+    EXPECT_EQ(backlog.bytes(), 0u);
+    EXPECT_FALSE(backlog.Contains(1009));
+    EXPECT_FALSE(backlog.Read(1009, 100, [](LSN, string_view) {}));
+  });
+}
+
+TEST_F(DiskBacklogTest, PendingLimit) {
+  pp_->at(0)->Await([] {
+    // Entries of 14 bytes with the length prefix, the flush fiber does not run in between.
+    DiskBacklog backlog{"/tmp/disk_backlog_test", 1 << 20, 1 << 16, 1400};
+    for (LSN lsn = 0; lsn < 250; ++lsn)
+      backlog.Append(lsn, absl::StrCat("entry-", 1000 + lsn));
+
+    // The backlog started over when the pending entries exceeded the limit
+    EXPECT_LE(backlog.bytes(), 1400u);
+    EXPECT_FALSE(backlog.Contains(0));
+    EXPECT_TRUE(backlog.Contains(249));
+
+    EXPECT_TRUE(backlog.Contains(200));
+    EXPECT_FALSE(backlog.Contains(199));
+
+    // Entries after an indexed one are skipped when reading
+    LSN expected = 240;
+    auto res = backlog.Read(expected, 1 << 10, [&](LSN entry_lsn, string_view data) {
+      EXPECT_EQ(entry_lsn, expected++);
+      EXPECT_EQ(data, absl::StrCat("entry-", 1000 + entry_lsn));
+    });
+    ASSERT_TRUE(res);
+    EXPECT_EQ(*res, 250u);
+    EXPECT_EQ(expected, 250u);
+  });
+}
+
 }  // namespace journal
 }  // namespace dfly
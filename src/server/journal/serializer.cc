@@ -9,6 +9,7 @@
 #include "base/logging.h"
 #include "io/io.h"
 #include "io/io_buf.h"
+#include "server/detail/decompress.h"
 #include "server/error.h"
 #include "server/journal/types.h"
 #include "server/main_service.h"
@@ -84,10 +85,27 @@ void JournalWriter::Write(const journal::Entry& entry) {
   };
 }
 
+void JournalWriter::WriteCompressed(journal::FrameCodec codec, size_t raw_size, io::Bytes blob) {
+  Write(uint8_t(journal::Op::COMPRESSED));
+  Write(uint8_t(codec));
+  Write(raw_size);
+  Write(blob.size());
+  sink_->Write(blob);
+}
+
+void JournalWriter::WriteRdbBlob(std::string_view blob) {
+  Write(uint8_t(journal::Op::RDB_BLOB));
+  Write(1u);  // encoded like a command with a single argument
+  Write(blob.size());
+  Write(blob);
+}
+
 JournalReader::JournalReader(io::Source* source, DbIndex dbid)
     : source_{source}, buf_{4096}, dbid_{dbid} {
 }
 
+JournalReader::~JournalReader() = default;
+
 void JournalReader::SetSource(io::Source* source) {
   CHECK_EQ(buf_.InputLen(), 0ULL);
   source_ = source;
@@ -202,6 +220,60 @@ std::error_code JournalReader::ReadCommand(journal::ParsedEntry::CmdData* data)
   return {};
 }
 
+std::error_code JournalReader::ReadCompressedFrame() {
+  uint8_t codec;
+  SET_OR_RETURN(ReadUInt<uint8_t>(), codec);
+
+  size_t raw_size = 0, blob_size = 0;
+  SET_OR_RETURN(ReadUInt<uint64_t>(), raw_size);
+  SET_OR_RETURN(ReadUInt<uint64_t>(), blob_size);
+  if (raw_size == 0 || blob_size == 0)
+    return make_error_code(errc::io_error);
+
+  detail::DecompressImpl* decompressor = nullptr;
+  switch (journal::FrameCodec(codec)) {
+    case journal::FrameCodec::LZ4:
+      if (!lz4_)
+        lz4_ = detail::DecompressImpl::CreateLZ4();
+      decompressor = lz4_.get();
+      break;
+    case journal::FrameCodec::ZSTD:
+      if (!zstd_)
+        zstd_ = detail::DecompressImpl::CreateZstd();
+      decompressor = zstd_.get();
+      break;
+    default:
+      LOG(ERROR) << "Unknown journal frame codec " << int(codec);
+      return make_error_code(errc::io_error);
+  }
+
+  if (auto ec = EnsureRead(blob_size); ec)
+    return ec;
+
+  io::Bytes blob = buf_.InputBuffer().first(blob_size);
+  io::IoBuf* inflated;
+  SET_OR_RETURN(decompressor->Decompress(io::View(blob)), inflated);
+  buf_.ConsumeInput(blob_size);
+
+  // Decompress() terminates the output with an rdb opcode that we do not need here.
+  io::Bytes raw = inflated->InputBuffer();
+  if (raw.size() != raw_size + 1) {
+    inflated->ConsumeInput(raw.size());
+    return make_error_code(errc::io_error);
+  }
+
+  // Put the inflated entries in front of whatever was already read ahead from the source.
+  string read_ahead{io::View(buf_.InputBuffer())};
+  buf_.ConsumeInput(read_ahead.size());
+  buf_.EnsureCapacity(raw_size + read_ahead.size());
+  buf_.WriteAndCommit(raw.data(), raw_size);
+  if (!read_ahead.empty())
+    buf_.WriteAndCommit(read_ahead.data(), read_ahead.size());
+  inflated->ConsumeInput(raw.size());
+
+  return {};
+}
+
 std::error_code JournalReader::ReadEntry(journal::ParsedEntry* dest) {
   uint8_t int_op;
   SET_OR_RETURN(ReadUInt<uint8_t>(), int_op);
@@ -212,6 +284,12 @@ std::error_code JournalReader::ReadEntry(journal::ParsedEntry* dest) {
     return ReadEntry(dest);
   }
 
+  if (opcode == journal::Op::COMPRESSED) {
+    if (auto ec = ReadCompressedFrame(); ec)
+      return ec;
+    return ReadEntry(dest);
+  }
+
   dest->dbid = dbid_;
   dest->opcode = opcode;
   dest->cmd.clear();
@@ -224,6 +302,11 @@ std::error_code JournalReader::ReadEntry(journal::ParsedEntry* dest) {
     return {};
   }
 
+  if (opcode == journal::Op::RDB_BLOB) {
+    dest->txid = 0;
+    return ReadCommand(&dest->cmd);
+  }
+
   SET_OR_RETURN(ReadUInt<uint64_t>(), dest->txid);
   [[maybe_unused]] uint32_t unused;
 
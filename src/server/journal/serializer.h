@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -13,6 +14,10 @@
 
 namespace dfly {
 
+namespace detail {
+class DecompressImpl;
+}  // namespace detail
+
 // JournalWriter serializes journal entries to a sink.
 // It automatically keeps track of the current database index.
 class JournalWriter {
@@ -23,6 +28,14 @@ class JournalWriter {
   void Write(const journal::Entry& entry);
   void Write(uint64_t v);  // Write packed unsigned integer.
 
+  // Write a frame with a compressed batch of already serialized entries. The reader inflates
+  // the frame back into the stream, so the batch must consist of complete entries.
+  void WriteCompressed(journal::FrameCodec codec, size_t raw_size, io::Bytes blob);
+
+  // Write a batch of entries serialized by RdbSerializer and terminated with RDB_OPCODE_EOF.
+  // The reader returns it as an Op::RDB_BLOB entry with the blob as its single argument.
+  void WriteRdbBlob(std::string_view blob);
+
  private:
   void Write(std::string_view sv);  // Write string.
   void Write(const journal::Entry::Payload& payload);
@@ -38,6 +51,7 @@ struct JournalReader {
  public:
   // Initialize start database index.
   JournalReader(io::Source* source, DbIndex dbid);
+  ~JournalReader();
 
   // Overwrite current source and ensure there is no leftover from previous.
   void SetSource(io::Source* source);
@@ -45,6 +59,11 @@ struct JournalReader {
   // Try reading entry from source.
   std::error_code ReadEntry(journal::ParsedEntry* dest);
 
+  // Whether some input was already read from the source and is not consumed yet.
+  bool HasBufferedInput() const {
+    return buf_.InputLen() > 0;
+  }
+
  private:
   // Read from source until buffer contains at least num bytes.
   std::error_code EnsureRead(size_t num);
@@ -58,10 +77,15 @@ struct JournalReader {
   // Read argument array into string buffer.
   std::error_code ReadCommand(journal::ParsedEntry::CmdData* entry);
 
+  // Inflate an Op::COMPRESSED frame in front of the remaining input.
+  std::error_code ReadCompressedFrame();
+
  private:
   io::Source* source_;
   base::IoBuf buf_;
   DbIndex dbid_;
+
+  std::unique_ptr<detail::DecompressImpl> lz4_, zstd_;
 };
 
 }  // namespace dfly
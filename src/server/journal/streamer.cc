@@ -19,6 +19,7 @@
 #include "server/engine_shard.h"
 #include "server/journal/cmd_serializer.h"
 #include "server/journal/serializer.h"
+#include "server/rdb_extensions.h"
 #include "server/rdb_save.h"
 #include "server/server_state.h"
 #include "util/fibers/synchronization.h"
@@ -43,6 +44,13 @@ ABSL_FLAG(float, migration_buckets_cpu_budget, 0.2,
 ABSL_FLAG(uint32_t, replication_dispatch_threshold, 1500,
           "Number of bytes to aggregate before replication");
 
+ABSL_FLAG(std::string, replication_stream_compression, "none",
+          "Compression of the stable sync journal stream: none, lz4 or zstd. "
+          "Used only with replicas that support compressed frames.");
+
+ABSL_FLAG(uint32_t, replication_stream_compression_min_batch, 512,
+          "Batches of journal entries smaller than this are sent uncompressed");
+
 namespace dfly {
 using namespace util;
 using namespace journal;
@@ -58,6 +66,10 @@ uint32_t migration_buckets_serialization_threshold_cached = 100;
 uint32_t migration_buckets_sleep_usec_cached = 100;
 uint32_t replication_dispatch_threshold = 1500;
 uint32_t stalled_writer_base_period_ms = 10;
+uint32_t compression_min_batch_cached = 512;
+
+// Native entries are sent once they accumulate this many bytes.
+constexpr size_t kNativeBatchBytes = 64_KB;
 
 void LogTcpSocketDiagnostics(util::FiberSocketBase* dest) {
   if (!dest) {
@@ -116,6 +128,20 @@ JournalStreamer::JournalStreamer(ExecutionState* cntx, JournalStreamer::Config c
   migration_buckets_sleep_usec_cached = absl::GetFlag(FLAGS_migration_buckets_sleep_usec);
   replication_dispatch_threshold = absl::GetFlag(FLAGS_replication_dispatch_threshold);
   last_async_write_time_ = base::CycleClock::Now();
+
+  if (config_.allow_compression) {
+    compression_min_batch_cached = absl::GetFlag(FLAGS_replication_stream_compression_min_batch);
+    string mode = absl::GetFlag(FLAGS_replication_stream_compression);
+    if (mode == "lz4") {
+      compressor_ = detail::CompressorImpl::CreateLZ4();
+      codec_ = FrameCodec::LZ4;
+    } else if (mode == "zstd") {
+      compressor_ = detail::CompressorImpl::CreateZstd();
+      codec_ = FrameCodec::ZSTD;
+    } else {
+      LOG_IF(WARNING, mode != "none") << "Unknown replication_stream_compression " << mode;
+    }
+  }
 }
 
 JournalStreamer::~JournalStreamer() {
@@ -213,6 +239,24 @@ bool JournalStreamer::MaybePartialStreamLSNs() {
     LOG(INFO) << "Starting partial sync from lsn: " << lsn;
     // The replica sends the LSN of the next entry is wants to receive.
     while (cntx_->IsRunning() && journal::IsLSNInBuffer(lsn)) {
+      if (journal::IsLSNSpilled(lsn)) {
+        // Older entries are read back from the disk backlog in large sequential chunks.
+        auto res = journal::ReadSpilledEntries(lsn, [this](LSN entry_lsn, string_view data) {
+          JournalChangeItem item;
+          item.journal_item.data = data;
+          item.journal_item.lsn = entry_lsn;
+          ConsumeJournalChange(item);
+        });
+        if (!res) {
+          cntx_->ReportError(res.error(), absl::StrCat("Partial sync failed reading entry #", lsn,
+                                                       " from the disk backlog"));
+          return false;
+        }
+        lsn = *res;
+        ThrottleIfNeeded();
+        continue;
+      }
+
       JournalChangeItem item;
       item.journal_item.data = journal::GetEntry(lsn);
       item.journal_item.lsn = lsn;
@@ -291,6 +335,16 @@ void JournalStreamer::AsyncWrite(bool force_send) {
   total_sent_ += in_flight_bytes_;
   last_async_write_time_ = base::CycleClock::Now();
 
+  // in_flight_bytes_ keeps counting the raw journal bytes so that throttling does not depend
+  // on the compression ratio.
+  if (compressor_ && CompressBatch(cur_buf)) {
+    iovec v = IoVec(io::Buffer(compressed_frame_));
+    dest_->AsyncWrite(&v, 1, [this, len = in_flight_bytes_](std::error_code ec) {
+      OnCompletion(ec, len);
+    });
+    return;
+  }
+
   const auto v_size = cur_buf.buf.size();
   absl::InlinedVector<iovec, 8> v(v_size);
 
@@ -303,6 +357,32 @@ void JournalStreamer::AsyncWrite(bool force_send) {
                     [this, len = in_flight_bytes_](std::error_code ec) { OnCompletion(ec, len); });
 }
 
+bool JournalStreamer::CompressBatch(const PendingBuf::Buf& batch) {
+  if (batch.mem_size < compression_min_batch_cached)
+    return false;
+
+  uint64_t start = base::CycleClock::Now();
+  batch_buf_.clear();
+  batch_buf_.reserve(batch.mem_size);
+  for (const auto& str : batch.buf)
+    batch_buf_.append(str);
+
+  auto res = compressor_->Compress(io::Buffer(batch_buf_));
+  bool compressed = res && res->size() < batch_buf_.size();
+  if (compressed) {
+    io::StringSink sink;
+    JournalWriter writer(&sink);
+    writer.WriteCompressed(codec_, batch_buf_.size(), *res);
+    compressed_frame_ = std::move(sink).str();
+  }
+
+  auto& stats = ServerState::tlocal()->stats;
+  stats.repl_stream_compress_usec += base::CycleClock::ToUsec(base::CycleClock::Now() - start);
+  stats.repl_stream_compress_in_bytes += batch_buf_.size();
+  stats.repl_stream_compress_out_bytes += compressed ? compressed_frame_.size() : batch_buf_.size();
+  return compressed;
+}
+
 void JournalStreamer::OnCompletion(std::error_code ec, size_t len) {
   DCHECK_EQ(in_flight_bytes_, len);
 
@@ -428,6 +508,13 @@ RestoreStreamer::RestoreStreamer(DbSlice* slice, cluster::SlotSet slots, Executi
       ServerState::tlocal()->serialization_max_chunk_size);
 }
 
+void RestoreStreamer::EnableNativeSerialization() {
+  native_serializer_ = std::make_unique<RdbSerializer>(GetDefaultCompressionMode());
+  max_native_value_bytes_ = ServerState::tlocal()->serialization_max_chunk_size;
+  if (max_native_value_bytes_ == 0)
+    max_native_value_bytes_ = SIZE_MAX;
+}
+
 void RestoreStreamer::Start(util::FiberSocketBase* dest) {
   if (!cntx_->IsRunning())
     return;
@@ -503,6 +590,7 @@ void RestoreStreamer::Run() {
 
   // Force serialize of all delayed entries.
   ProcessDelayedEntries(true, 0, cntx_);
+  FlushNativeEntries();
 
   VLOG(1) << "RestoreStreamer finished loop of " << my_slots_.ToSlotRanges().ToString()
           << ", shard " << db_slice_->shard_id() << ". Buckets looped " << stats_.buckets_loop;
@@ -512,10 +600,11 @@ void RestoreStreamer::SendFinalize(long attempt) {
   auto base_stats = SerializerBase::GetStats();
   VLOG(1) << "RestoreStreamer LSN of " << my_slots_.ToSlotRanges().ToString() << ", shard "
           << db_slice_->shard_id() << " attempt " << attempt << " with " << stats_.commands
-          << " commands. Buckets looped " << stats_.buckets_loop << ", buckets on_db_update "
-          << base_stats.buckets_on_change << ", buckets skipped " << base_stats.buckets_skipped
-          << ", buckets written " << base_stats.buckets_serialized << ". Keys skipped "
-          << stats_.keys_skipped << ", keys written " << base_stats.keys_serialized
+          << " commands, " << stats_.native_entries << " native entries. Buckets looped "
+          << stats_.buckets_loop << ", buckets on_db_update " << base_stats.buckets_on_change
+          << ", buckets skipped " << base_stats.buckets_skipped << ", buckets written "
+          << base_stats.buckets_serialized << ". Keys skipped " << stats_.keys_skipped
+          << ", keys written " << base_stats.keys_serialized
           << " throttle count: " << throttle_count_
           << ", throttle on db update: " << stats_.throttle_on_db_update
           << ", throttle usec on db update: " << stats_.throttle_usec_on_db_update
@@ -523,6 +612,7 @@ void RestoreStreamer::SendFinalize(long attempt) {
 
   // Drain all pending journal data before sending the finalize marker.
   // At this point client pause is active, so no new entries can arrive.
+  FlushNativeEntries();
   WaitForInflightToComplete(true);
 
   journal::Entry entry(journal::Op::LSN, attempt);
@@ -556,6 +646,26 @@ bool RestoreStreamer::Cancel() {
   return true;
 }
 
+void RestoreStreamer::ConsumeJournalChange(const journal::JournalChangeItem& item) {
+  if (item.slot && ShouldWrite(*item.slot))
+    FlushNativeEntries();
+  JournalStreamer::ConsumeJournalChange(item);
+}
+
+void RestoreStreamer::FlushNativeEntries() {
+  if (!native_serializer_ || native_serializer_->SerializedLen() == 0)
+    return;
+
+  // EOF is appended after the flush, as the loader must not reach it inside a compressed blob.
+  string blob = native_serializer_->Flush(RdbSerializer::FlushState::kFlushEndEntry);
+  blob.push_back(static_cast<char>(RDB_OPCODE_EOF));
+
+  io::StringSink sink;
+  JournalWriter writer{&sink};
+  writer.WriteRdbBlob(blob);
+  Write(std::move(sink).str());
+}
+
 bool RestoreStreamer::ShouldWrite(const journal::JournalChangeItem& item) const {
   if (item.cmd == "FLUSHALL" || item.cmd == "FLUSHDB") {
     // On FLUSH* we restart the migration
@@ -611,6 +721,23 @@ unsigned RestoreStreamer::SerializeBucketLocked(DbIndex db_index, PrimeTable::bu
 
 void RestoreStreamer::SerializeEntryLocked(DbIndex db_index, const PrimeKey& pk,
                                            const PrimeValue& pv, time_t expire, uint32_t mc_flags) {
+  // Big values are still split into several RESTORE commands, so that neither side has to hold
+  // them in a single blob.
+  if (native_serializer_ && pv.MallocUsed() <= max_native_value_bytes_) {
+    io::Result<uint8_t> res = native_serializer_->SaveEntry(pk, pv, expire, mc_flags, db_index);
+    if (!res) {
+      cntx_->ReportError(res.error(), "Failed serializing migrated entry");
+      return;
+    }
+    ++stats_.native_entries;
+    if (native_serializer_->SerializedLen() >= kNativeBatchBytes) {
+      FlushNativeEntries();
+      ThrottleIfNeeded();
+    }
+    return;
+  }
+
+  FlushNativeEntries();
   stats_.commands += cmd_serializer_->SerializeEntry(pk.ToString(), pk, pv, expire);
 }
 
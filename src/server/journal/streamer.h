@@ -6,6 +6,7 @@
 
 #include "base/cycle_clock.h"
 #include "server/cluster/slot_set.h"
+#include "server/detail/compressor.h"
 #include "server/common_types.h"
 #include "server/execution_state.h"
 #include "server/journal/journal.h"
@@ -24,6 +25,8 @@ class JournalStreamer : public journal::JournalConsumerInterface {
     bool should_sent_lsn = false;
     bool init_from_stable_sync = false;
     LSN start_partial_sync_at = 0;
+    // The peer can read Op::COMPRESSED frames.
+    bool allow_compression = false;
   };
 
   JournalStreamer(ExecutionState* cntx, Config config);
@@ -85,6 +88,9 @@ class JournalStreamer : public journal::JournalConsumerInterface {
   void AsyncWrite(bool force_send);
   void OnCompletion(std::error_code ec, size_t len);
 
+  // Compresses the batch into compressed_frame_. Returns false if the batch should be sent as is.
+  bool CompressBatch(const PendingBuf::Buf& batch);
+
   bool IsStalled() const;
 
   util::fb2::Fiber stalled_data_writer_;
@@ -103,17 +109,26 @@ class JournalStreamer : public journal::JournalConsumerInterface {
   LSN last_lsn_writen_ = 0;
   util::fb2::EventCount waker_;
   uint32_t journal_cb_id_{0};
+
+  std::unique_ptr<detail::CompressorImpl> compressor_;
+  journal::FrameCodec codec_ = journal::FrameCodec::LZ4;
+  std::string batch_buf_, compressed_frame_;  // compressed_frame_ is kept until the write completes
 };
 
 class CmdSerializer;
+class RdbSerializer;
 
-// Serializes existing DB as RESTORE commands, and sends updates as regular commands.
+// Serializes existing DB as batches of native RDB entries if enabled, or as RESTORE commands,
+// and sends updates as regular commands.
 // Only handles relevant slots, while ignoring all others.
 class RestoreStreamer : public JournalStreamer, public SerializerBase {
  public:
   RestoreStreamer(DbSlice* slice, cluster::SlotSet slots, ExecutionState* cntx);
   ~RestoreStreamer() override;
 
+  // Sends the entries in the native format, called before Start() if the target supports it.
+  void EnableNativeSerialization();
+
   void Start(util::FiberSocketBase* dest) override;
 
   void Run();
@@ -123,7 +138,13 @@ class RestoreStreamer : public JournalStreamer, public SerializerBase {
 
   void SendFinalize(long attempt);
 
+  // Flushes the serialized entries before the change, so that the target applies it on top.
+  void ConsumeJournalChange(const journal::JournalChangeItem& item) override;
+
  private:
+  // Sends the entries accumulated by native_serializer_ as a single Op::RDB_BLOB journal entry.
+  void FlushNativeEntries();
+
   unsigned SerializeBucketLocked(DbIndex db_index, PrimeTable::bucket_iterator it,
                                  bool on_update) override;
 
@@ -140,12 +161,15 @@ class RestoreStreamer : public JournalStreamer, public SerializerBase {
     uint64_t throttle_usec_on_db_update = 0;
     uint64_t keys_skipped = 0;
     uint64_t commands = 0;
+    uint64_t native_entries = 0;
     uint64_t iter_skips = 0;
   };
 
   cluster::SlotSet my_slots_;
 
   std::unique_ptr<CmdSerializer> cmd_serializer_;
+  std::unique_ptr<RdbSerializer> native_serializer_;  // null if native serialization is disabled
+  size_t max_native_value_bytes_ = 0;  // bigger values are sent as chunked RESTORE commands
 
   Stats stats_;
   base::RealTimeAggregator cpu_aggregator_;
@@ -66,6 +66,7 @@ void TransactionData::AddEntry(journal::ParsedEntry&& entry) {
       return;
     case journal::Op::EXPIRED:
     case journal::Op::COMMAND:
+    case journal::Op::RDB_BLOB:
       command = std::move(entry.cmd);
       dbid = entry.dbid;
       txid = entry.txid;
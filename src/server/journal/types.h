@@ -14,7 +14,18 @@
 namespace dfly {
 namespace journal {
 
-enum class Op : uint8_t { SELECT = 6, EXPIRED = 9 /* sunset*/, COMMAND = 10, PING = 13, LSN = 15 };
+enum class Op : uint8_t {
+  SELECT = 6,
+  EXPIRED = 9 /* sunset*/,
+  COMMAND = 10,
+  PING = 13,
+  LSN = 15,
+  COMPRESSED = 16,  // A compressed batch of serialized entries, see JournalWriter::WriteCompressed.
+  RDB_BLOB = 17     // Entries serialized by RdbSerializer, see JournalWriter::WriteRdbBlob.
+};
+
+// Codecs of Op::COMPRESSED frames.
+enum class FrameCodec : uint8_t { LZ4 = 1, ZSTD = 2 };
 
 struct EntryBase {
   TxId txid;
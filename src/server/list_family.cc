@@ -286,10 +286,15 @@ class ListWrapper {
 
   std::optional<string> At(long index) const {
     return visit(Overload{[&](QList* ql) -> optional<string> {
-                            auto it = ql->GetIterator(index);
-                            if (!it.Valid())
-                              return nullopt;
-                            return it.Get().to_string();
+                            // Iterate does not leave a compressed node decompressed behind.
+                            optional<string> res;
+                            ql->Iterate(
+                                [&res](QList::Entry entry) {
+                                  res = entry.to_string();
+                                  return false;
+                                },
+                                index, index);
+                            return res;
                           },
                           [&](const LP& lp) { return lp.At(index); }},
                  impl_);
@@ -841,7 +846,9 @@ OpStatus OpTrim(const OpArgs& op_args, string_view key, long start, long end) {
   return OpStatus::OK;
 }
 
-OpResult<StringVec> OpRange(const OpArgs& op_args, std::string_view key, long start, long end) {
+// Copies the range into a single contiguous buffer rather than allocating a string per element.
+OpStatus OpRange(const OpArgs& op_args, std::string_view key, long start, long end,
+                 cmn::BackedArguments* dest) {
   auto res = op_args.GetDbSlice().FindReadOnly(op_args.db_cntx, key, OBJ_LIST);
   if (!res)
     return res.status();
@@ -861,18 +868,23 @@ OpResult<StringVec> OpRange(const OpArgs& op_args, std::string_view key, long st
    * The range is empty when start > end or start >= length. */
   if (start > end || start >= llen) {
     /* Out of range start or start > end result in empty list */
-    return StringVec{};
+    return OpStatus::OK;
   }
 
-  StringVec str_vec;
+  char buf[absl::numbers_internal::kFastToBufferSize];
   container_utils::IterateList(
       pv,
-      [&str_vec](container_utils::ContainerEntry ce) {
-        str_vec.emplace_back(ce.ToString());
+      [dest, &buf](container_utils::ContainerEntry ce) {
+        if (ce.IsString()) {
+          dest->PushArg(ce.view());
+        } else {
+          char* next = absl::numbers_internal::FastIntToBuffer(ce.as_long(), buf);
+          dest->PushArg(string_view{buf, size_t(next - buf)});
+        }
         return true;
       },
       start, end);
-  return str_vec;
+  return OpStatus::OK;
 }
 
 void MoveGeneric(string_view src, string_view dest, ListDir src_dir, ListDir dest_dir,
@@ -1439,16 +1451,20 @@ void CmdLRange(CmdArgParser parser, CommandContext* cmd_cntx) {
   auto* rb = static_cast<RedisReplyBuilder*>(cmd_cntx->rb());
   RETURN_ON_PARSE_ERROR(parser, rb);
 
+  cmn::BackedArguments vals;
   auto cb = [&](Transaction* t, EngineShard* shard) {
-    return OpRange(t->GetOpArgs(shard), key, start, end);
+    return OpRange(t->GetOpArgs(shard), key, start, end, &vals);
   };
 
-  auto res = cmd_cntx->tx()->ScheduleSingleHopT(std::move(cb));
-  if (!res && res.status() != OpStatus::KEY_NOTFOUND) {
-    return rb->SendError(res.status());
+  OpStatus status = cmd_cntx->tx()->ScheduleSingleHop(std::move(cb));
+  if (status != OpStatus::OK && status != OpStatus::KEY_NOTFOUND) {
+    return rb->SendError(status);
   }
 
-  rb->SendBulkStrArr(*res);
+  RedisReplyBuilder::ArrayScope scope(rb, vals.size());
+  for (size_t i = 0; i < vals.size(); ++i) {
+    rb->SendBulkString(vals[i]);
+  }
 }
 
 // lrem key 5 foo, will remove foo elements from the list if exists at most 5 times.
@@ -48,6 +48,8 @@ extern "C" {
 #include "server/acl/validator.h"
 #include "server/channel_store.h"
 #include "server/cluster/cluster_family.h"
+#include "server/cluster/cluster_proxy.h"
+#include "server/cluster/coordinator.h"
 #include "server/command_families.h"
 #include "server/dflycmd.h"
 #include "server/error.h"
@@ -122,6 +124,13 @@ ABSL_FLAG(string, huffman_table, "",
           " exported via "
           "DEBUG COMPRESSION EXPORT. if the flag is empty no huffman compression is applied.");
 
+ABSL_FLAG(string, key_prefix_delimiter, "",
+          "If set, key prefixes ending with this character are interned per shard, and keys "
+          "sharing them store a short prefix id instead. Must be a single character.");
+
+ABSL_FLAG(uint32_t, key_prefix_admit_threshold, 64,
+          "Number of keys that must share a prefix before it is interned.");
+
 ABSL_FLAG(bool, jsonpathv2, true,
           "If true uses Dragonfly jsonpath implementation, "
           "otherwise uses legacy jsoncons implementation.");
@@ -704,6 +713,20 @@ void UpdateSchedulerFlagsOnThread() {
                       GetFlag(FLAGS_scheduler_background_warrant));
 }
 
+void SetKeyPrefixDelimiter(const std::string& delimiter) {
+  if (delimiter.empty())
+    return;
+  if (delimiter.size() != 1) {
+    LOG(ERROR) << "key_prefix_delimiter must be a single character, got " << delimiter;
+    return;
+  }
+
+  uint32_t threshold = GetFlag(FLAGS_key_prefix_admit_threshold);
+  shard_set->RunBriefInParallel([&](EngineShard*) {
+    CompactObj::InitKeyPrefixThreadLocal(delimiter[0], threshold);
+  });
+}
+
 void SetHuffmanTable(const std::string& huffman_table) {
   if (huffman_table.empty())
     return;
@@ -1147,6 +1170,7 @@ void Service::Init(util::AcceptServer* acceptor, std::vector<facade::Listener*>
     UpdateSchedulerFlagsOnThread();
   });
   SetHuffmanTable(GetFlag(FLAGS_huffman_table));
+  SetKeyPrefixDelimiter(GetFlag(FLAGS_key_prefix_delimiter));
 
   // Requires that shard_set will be initialized before because server_family_.Init might
   // load the snapshot.
@@ -1297,6 +1321,34 @@ std::optional<facade::ErrorReply> Service::TakenOverSlotError(const CommandId& c
       absl::StrCat("-MOVED ", *keys_slot, " ", redirect.ip, ":", redirect.port), "MOVED"};
 }
 
+// Ownership errors that proxy mode resolves by forwarding the command.
+static bool IsProxiableError(const CommandId& cid, const ErrorReply& err) {
+  if (err.kind == "MOVED")
+    return true;
+  return err.ToSv() == kCrossSlotError && cluster::CanSplitCrossSlot(cid.name());
+}
+
+bool Service::ShouldProxy(const CommandId& cid, const facade::ParsedArgs& args,
+                          const ConnectionContext& dfly_cntx) {
+  if (!IsClusterEnabled() || !cluster::IsProxyModeEnabled())
+    return false;
+
+  // Only plain top level commands are forwarded. Transactions and scripts must run on one node,
+  // blocking and pubsub commands would stall the shared coordinator connections.
+  const auto* conn = dfly_cntx.conn();
+  if (conn == nullptr || dfly_cntx.is_replicating || dfly_cntx.transaction != nullptr ||
+      dfly_cntx.conn_state.script_info || dfly_cntx.conn_state.exec_info.IsCollecting() ||
+      cid.IsBlocking() || cid.IsPubSub() || cid.IsShardedPubSub() || cid.IsExecGroup())
+    return false;
+
+  // Never forward again what was forwarded to us.
+  if (conn->GetName() == cluster::Coordinator::kConnectionName)
+    return false;
+
+  auto err = CheckKeysOwnership(cid, args, dfly_cntx);
+  return err && IsProxiableError(cid, *err);
+}
+
 // Return OK if all keys are allowed to be accessed: either declared in EVAL or
 // transaction is running in global or non-atomic mode.
 optional<ErrorReply> CheckKeysDeclared(const ConnectionState::ScriptInfo& eval_info,
@@ -1451,6 +1503,27 @@ std::optional<ErrorReply> Service::VerifyCommandState(const CommandId& cid,
   return VerifyConnectionAclStatus(&cid, &dfly_cntx, "has no ACL permissions", tail_args);
 }
 
+DispatchResult Service::ProxyCommand(const CommandId& cid, const facade::ParsedArgs& tail_args,
+                                     CommandContext* cmd_cntx) {
+  // The owners run the command with the coordinator credentials, so ACL is verified here.
+  ConnectionContext* dfly_cntx = cmd_cntx->server_conn_cntx();
+  if (auto err = VerifyConnectionAclStatus(&cid, dfly_cntx, "has no ACL permissions", tail_args);
+      err) {
+    cmd_cntx->SendError(*err);
+    return DispatchResult::ERROR;
+  }
+
+  OpResult<KeyIndex> key_index = FindKeys(&cid, tail_args);
+  if (!key_index) {
+    cmd_cntx->SendError(key_index.status());
+    return DispatchResult::ERROR;
+  }
+
+  auto* rb = static_cast<RedisReplyBuilder*>(cmd_cntx->rb());
+  cluster::ProxyCommand(cid.name(), tail_args, *key_index, rb);
+  return DispatchResult::OK;
+}
+
 DispatchResult Service::DispatchCommand(facade::ParsedArgs args, facade::ParsedCommand* parsed_cmd,
                                         facade::AsyncPreference async_pref) {
   DCHECK_NE(0u, shard_set->size()) << "Init was not called";
@@ -1482,23 +1555,27 @@ DispatchResult Service::DispatchCommand(facade::ParsedArgs args, facade::ParsedC
     return DispatchResult::ERROR;
   }
 
+  CommandContext* cmd_cntx = static_cast<CommandContext*>(parsed_cmd);
+  ConnectionContext* dfly_cntx = cmd_cntx->server_conn_cntx();
+
+  // Proxied commands wait for the owning nodes and reply directly, so they always run sync.
+  bool proxy = !parsed_cmd->mc_command() && ShouldProxy(*cid, args_no_cmd, *dfly_cntx);
+  bool supports_async = cid->SupportsAsync() && !proxy;
+
   // Determine if command should run async
   switch (async_pref) {
     case AsyncPreference::ONLY_SYNC:
       break;
     case AsyncPreference::ONLY_ASYNC:
-      if (!cid->SupportsAsync())
+      if (!supports_async)
         return DispatchResult::WOULD_BLOCK;
       [[fallthrough]];
     case AsyncPreference::PREFER_ASYNC:
-      if (cid->SupportsAsync())
+      if (supports_async)
         parsed_cmd->SetDeferredReply();
       break;
   };
 
-  CommandContext* cmd_cntx = static_cast<CommandContext*>(parsed_cmd);
-  ConnectionContext* dfly_cntx = cmd_cntx->server_conn_cntx();
-
   if (dfly_cntx->async_dispatch && cid->IsBlocking()) {
     ++ServerState::tlocal()->stats.blocking_commands_in_pipelines;
     cmd_cntx->conn()->FlushReplies();
@@ -1522,6 +1599,9 @@ DispatchResult Service::DispatchCommand(facade::ParsedArgs args, facade::ParsedC
 
   // Verify command state
   if (auto err = VerifyCommandState(*cid, args_no_cmd, *dfly_cntx); err) {
+    if (proxy && IsProxiableError(*cid, *err))
+      return ProxyCommand(*cid, args_no_cmd, cmd_cntx);
+
     LOG_IF(WARNING, dfly_cntx->replica_conn || !dfly_cntx->conn() /* no owner in replica context */)
         << "VerifyCommandState error: " << err->ToSv();
     if (auto& exec_info = dfly_cntx->conn_state.exec_info; exec_info.IsCollecting())
@@ -1835,6 +1915,7 @@ uint32_t Service::DispatchSquashedBatch(facade::ParsedCommand* first, unsigned c
   ss->stats.multi_squash_exec_reply_usec += stats.reply_usec;
   ss->stats.multi_squash_hops += stats.hops;
   ss->stats.squashed_commands += stats.squashed_commands;
+  ss->stats.batched_commands += stats.batched_commands;
 
   return dispatched;
 }
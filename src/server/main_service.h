@@ -170,6 +170,14 @@ class Service : public facade::ServiceInterface {
                                                        const facade::ParsedArgs& args,
                                                        const ConnectionContext& dfly_cntx);
 
+  // Returns true if the command is mis-routed and can be forwarded to its owners in proxy mode.
+  bool ShouldProxy(const CommandId& cid, const facade::ParsedArgs& args,
+                   const ConnectionContext& dfly_cntx);
+
+  // Forwards a mis-routed command to the nodes owning its keys and replies with their result.
+  facade::DispatchResult ProxyCommand(const CommandId& cid, const facade::ParsedArgs& tail_args,
+                                      CommandContext* cmd_cntx);
+
   void EvalInternal(const EvalArgs& eval_args, Interpreter* interpreter, bool read_only,
                     CommandContext* cmd_cntx);
   void CallSHA(const facade::ParsedArgs& args, std::string_view sha, Interpreter* interpreter,
@@ -200,6 +200,9 @@ void Metrics::Print(uint64_t uptime, const CommandRegistry* registry, DflyCmd* d
   AppendMetricWithoutLabels("cmd_squash_commands_total", "", m.coordinator_stats.squashed_commands,
                             MetricType::COUNTER, &resp->body());
 
+  AppendMetricWithoutLabels("cmd_batch_commands_total", "", m.coordinator_stats.batched_commands,
+                            MetricType::COUNTER, &resp->body());
+
   AppendMetricWithoutLabels("cmd_squash_hop_duration_seconds", "",
                             m.coordinator_stats.multi_squash_exec_hop_usec * 1e-6,
                             MetricType::COUNTER, &resp->body());
@@ -614,6 +617,10 @@ void Metrics::Print(uint64_t uptime, const CommandRegistry* registry, DflyCmd* d
 
   AppendMetricWithoutLabels("huffman_tables_built", "Huffman tables built",
                             m.shard_stats.huffman_tables_built, MetricType::COUNTER, &resp->body());
+  AppendMetricWithoutLabels("huffman_reencode_saved_bytes",
+                            "Bytes saved by re-encoding entries with trained huffman tables",
+                            m.shard_stats.huffman_reencode_saved_bytes, MetricType::COUNTER,
+                            &resp->body());
 
   AppendMetricHeader("list_reads", "List Reads Patterns", MetricType::COUNTER, &resp->body());
   AppendMetricValue("list_reads", m.qlist_stats.total_node_reads, {"type"}, {"total"},
@@ -732,7 +739,7 @@ void Metrics::Merge(const Metrics& src) {
                              sizeof(std::optional<Metrics::ReplicaInfo>) + sizeof(LoadingStats) +
                              sizeof(absl::flat_hash_map<std::string, hdr_histogram*>) +
                              sizeof(InternedStringStats) + sizeof(acl::UserRegistry::AclStats) +
-                             176,  // scalar fields (19 fields) + 4-byte alignment padding
+                             192,  // scalar fields (21 fields) + 4-byte alignment padding
       "Metrics size changed - update Merge() and InitFromThread()");
 
   // Per-db stats / events / small_string_bytes are merged element-wise.
@@ -742,6 +749,7 @@ void Metrics::Merge(const Metrics& src) {
     db_stats[i] += src.db_stats[i];
   events += src.events;
   small_string_bytes += src.small_string_bytes;
+  key_prefix_saved_bytes += src.key_prefix_saved_bytes;
 
   // Aggregate sub-structs.
   shard_stats += src.shard_stats;
@@ -771,6 +779,7 @@ void Metrics::Merge(const Metrics& src) {
   refused_conn_max_clients_reached_count += src.refused_conn_max_clients_reached_count;
   lsn_buffer_size += src.lsn_buffer_size;
   lsn_buffer_bytes += src.lsn_buffer_bytes;
+  lsn_disk_backlog_bytes += src.lsn_disk_backlog_bytes;
 
   // Non-sum reductions.
   tx_queue_len = std::max(tx_queue_len, src.tx_queue_len);
@@ -802,7 +811,7 @@ void Metrics::InitFromThread(Namespace* ns, const CommandRegistry* registry,
                              sizeof(std::optional<Metrics::ReplicaInfo>) + sizeof(LoadingStats) +
                              sizeof(absl::flat_hash_map<std::string, hdr_histogram*>) +
                              sizeof(InternedStringStats) + sizeof(acl::UserRegistry::AclStats) +
-                             176,  // scalar fields (19 fields) + 4-byte alignment padding
+                             192,  // scalar fields (21 fields) + 4-byte alignment padding
       "Metrics size changed - update Merge() and InitFromThread()");
   EngineShard* shard = EngineShard::tlocal();
   ServerState* ss = ServerState::tlocal();
@@ -827,6 +836,7 @@ void Metrics::InitFromThread(Namespace* ns, const CommandRegistry* registry,
     db_stats = slice_stats.db_stats;
     events = slice_stats.events;
     small_string_bytes = slice_stats.small_string_bytes;
+    key_prefix_saved_bytes = slice_stats.key_prefix_saved_bytes;
     shard_stats = shard->stats();
 
     if (shard->tiered_storage()) {
@@ -846,6 +856,7 @@ void Metrics::InitFromThread(Namespace* ns, const CommandRegistry* registry,
     if (shard->journal()) {
       lsn_buffer_size = journal::LsnBufferSize();
       lsn_buffer_bytes = journal::LsnBufferBytes();
+      lsn_disk_backlog_bytes = journal::DiskBacklogBytes();
     }
 
     if (opts.replication_memory)
@@ -85,6 +85,7 @@ struct Metrics {
 
   size_t heap_used_bytes = 0;
   size_t small_string_bytes = 0;
+  size_t key_prefix_saved_bytes = 0;
   uint32_t traverse_ttl_per_sec = 0;
   uint32_t delete_ttl_per_sec = 0;
   uint64_t hoffman_encode_total = 0, hoffman_encode_success = 0;
@@ -106,6 +107,7 @@ struct Metrics {
 
   size_t lsn_buffer_size = 0;
   size_t lsn_buffer_bytes = 0;
+  size_t lsn_disk_backlog_bytes = 0;
 
   // Meaningful only on a master (zero on replicas / no replicas).
   ReplicationMemoryStats replication_stats;
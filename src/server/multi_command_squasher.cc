@@ -69,6 +69,7 @@ MultiCommandSquasher::Stats& MultiCommandSquasher::Stats::operator+=(const Stats
   reply_usec += o.reply_usec;
   hops += o.hops;
   yields += o.yields;
+  batched_commands += o.batched_commands;
 
   return *this;
 }
@@ -202,6 +203,39 @@ bool MultiCommandSquasher::ExecuteStandalone(RedisReplyBuilder* rb, CmdRef cmd)
   return true;
 }
 
+bool MultiCommandSquasher::ExecuteBatch(RedisReplyBuilder* rb, CmdRef first, CmdRef* next) {
+  vector<CmdRef> batch{first};
+  for (*next = cmd_gen_(); next->cid == first.cid && batch.size() < opts_.max_squash_size;
+       *next = cmd_gen_()) {
+    num_commands_++;
+    batch.push_back(*next);
+  }
+
+  if (batch.size() == 1)
+    return ExecuteStandalone(rb, first);
+
+  vector<ParsedArgs> batch_args;
+  batch_args.reserve(batch.size());
+  for (const CmdRef& cmd : batch)
+    batch_args.push_back(cmd.args);
+
+  // Batches of other connections on this thread can run concurrently, ids tell them apart
+  static thread_local uint64_t next_batch_id = 0;
+  uint64_t batch_id = ++next_batch_id;
+
+  bool ok = true;
+  first.cid->InvokeBatch(batch_args, batch_id, [&] {
+    cntx_->conn_state.batch_id = batch_id;
+    for (const CmdRef& cmd : batch) {
+      if (ok = ExecuteStandalone(rb, cmd); !ok)
+        break;
+    }
+    cntx_->conn_state.batch_id = 0;
+  });
+  stats_.batched_commands += batch.size();
+  return ok;
+}
+
 OpStatus MultiCommandSquasher::SquashedHopCb(EngineShard* es, RespVersion resp_v) {
   auto& sinfo = sharded_[es->shard_id()];
   DCHECK(!sinfo.dispatched.empty());
@@ -432,9 +466,10 @@ bool MultiCommandSquasher::ExecuteSquashed(facade::RedisReplyBuilder* rb) {
 void MultiCommandSquasher::Run(RedisReplyBuilder* rb) {
   DVLOG(1) << "Trying to squash commands for transaction " << cntx_->transaction->DebugId();
 
-  for (CmdRef cmd = cmd_gen_(); cmd.IsValid(); cmd = cmd_gen_()) {
+  for (CmdRef cmd = cmd_gen_(); cmd.IsValid();) {
     num_commands_++;
     auto res = TrySquash(cmd);
+    optional<CmdRef> next;  // Set if the following command was already pulled
 
     if (res == SquashResult::NOT_SQUASHED || res == SquashResult::SQUASHED_FULL) {
       if (!ExecuteSquashed(rb))
@@ -442,10 +477,13 @@ void MultiCommandSquasher::Run(RedisReplyBuilder* rb) {
 
       // if the last command was not added - we squash it separately.
       if (res == SquashResult::NOT_SQUASHED) {
-        if (!ExecuteStandalone(rb, cmd))
+        bool ok = cmd.cid->HasBatchHandler() ? ExecuteBatch(rb, cmd, &next.emplace())
+                                             : ExecuteStandalone(rb, cmd);
+        if (!ok)
           break;
       }
     }
+    cmd = next ? *next : cmd_gen_();
   }
 
   ExecuteSquashed(rb);  // Flush leftover
@@ -35,6 +35,7 @@ class MultiCommandSquasher {
     uint32_t reply_usec = 0;         // Total time spent in replies (microseconds)
     uint32_t hops = 0;               // Total number of hops executed
     uint32_t yields = 0;
+    uint32_t batched_commands = 0;  // Commands executed in groups with a batch handler
     Stats& operator+=(const Stats& o);
   };
 
@@ -83,6 +84,10 @@ class MultiCommandSquasher {
   // Execute separate non-squashed cmd. Return false if aborting on error.
   bool ExecuteStandalone(facade::RedisReplyBuilder* rb, CmdRef cmd);
 
+  // Execute `first` together with the directly following calls of the same command through its
+  // batch handler. Stores the first command that was pulled but not executed in `next`.
+  bool ExecuteBatch(facade::RedisReplyBuilder* rb, CmdRef first, CmdRef* next);
+
   // Callback that runs on shards during squashed hop.
   facade::OpStatus SquashedHopCb(EngineShard* es, facade::RespVersion resp_v);
 
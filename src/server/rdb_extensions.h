@@ -63,3 +63,7 @@ constexpr uint8_t RDB_OPCODE_SHARD_DOC_INDEX = 223;
 
 // Used to tag a chunk of serialized data with its stream id
 constexpr uint8_t RDB_OPCODE_TAGGED_CHUNK = 224;
+
+// Tombstone of a key deleted since the base of a delta snapshot. Format: [key]
+// Written before all the entries of the delta, in the database selected by RDB_OPCODE_SELECTDB.
+constexpr uint8_t RDB_OPCODE_DELETED_KEY = 225;
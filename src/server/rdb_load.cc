@@ -20,6 +20,7 @@ extern "C" {
 #include "redis/zmalloc.h"
 }
 #include <absl/cleanup/cleanup.h>
+#include <absl/container/inlined_vector.h>
 #include <absl/numeric/bits.h>
 #include <absl/strings/match.h>
 #include <absl/strings/str_cat.h>
@@ -49,10 +50,12 @@ extern "C" {
 #include "server/family_utils.h"
 #include "server/hset_family.h"
 #include "server/journal/executor.h"
+#include "server/journal/journal.h"
 #include "server/journal/serializer.h"
 #include "server/main_service.h"
 #include "server/namespaces.h"
 #include "server/rdb_extensions.h"
+#include "server/rdb_save.h"
 #include "server/script_mgr.h"
 #include "server/search/doc_index.h"
 #include "server/search/global_hnsw_index.h"
@@ -2308,11 +2311,6 @@ error_code RdbLoader::Load(io::Source* src) {
     mem_buf_->ConsumeInput(9);
   }
 
-  int type;
-
-  /* Key-specific attributes, set by opcodes before the key type. */
-  ObjSettings settings;
-  settings.now = GetCurrentTimeMs();
   size_t keys_loaded = 0;
 
   auto cleanup = absl::Cleanup([&] { FinishLoad(start, &keys_loaded); });
@@ -2322,6 +2320,60 @@ error_code RdbLoader::Load(io::Source* src) {
     GetCurrentDbSlice().IncrLoadInProgress();
   }
 
+  RETURN_ON_ERR(LoadOpcodes(&keys_loaded));
+
+  /* Verify the checksum if RDB version is >= 5 */
+  RETURN_ON_ERR(VerifyChecksum());
+
+  return kOk;
+}
+
+error_code RdbLoader::LoadBatch(io::Source* src) {
+  DCHECK(src);
+  if (!src_) {
+    is_tiered_enabled_ =
+        shard_set->Await(0, [] { return EngineShard::tlocal()->tiered_storage() != nullptr; });
+  }
+
+  // The previous batch was consumed up to its RDB_OPCODE_EOF, nothing is left over.
+  DCHECK_EQ(mem_buf_->InputLen(), 0u);
+  src_ = src;
+
+  if (!batches_pending_) {
+    batches_pending_ = true;
+    batches_start_ = absl::Now();
+    if (EngineShard* es = EngineShard::tlocal(); es) {
+      GetCurrentDbSlice().IncrLoadInProgress();
+    }
+  }
+
+  size_t keys_loaded = keys_loaded_;
+  error_code ec = LoadOpcodes(&keys_loaded);
+  keys_loaded_ = keys_loaded;
+
+  // Shards may fail adding entries of previous batches, e.g. when they run out of memory.
+  if (!ec && stop_early_)
+    ec = *ec_;
+  return ec;
+}
+
+error_code RdbLoader::FinishBatches() {
+  if (!batches_pending_)
+    return {};
+
+  batches_pending_ = false;
+  size_t keys_loaded = keys_loaded_;
+  FinishLoad(batches_start_, &keys_loaded);
+  return stop_early_ ? *ec_ : error_code{};
+}
+
+error_code RdbLoader::LoadOpcodes(size_t* keys_loaded) {
+  int type;
+
+  /* Key-specific attributes, set by opcodes before the key type. */
+  ObjSettings settings;
+  settings.now = GetCurrentTimeMs();
+
   while (!stop_early_.load(memory_order_relaxed)) {
     if (pause_) {
       ThisFiber::SleepFor(100ms);
@@ -2450,10 +2502,7 @@ error_code RdbLoader::Load(io::Source* src) {
       SET_OR_RETURN(LoadLen(nullptr), expires_size);
 
       VLOG(1) << "RESIZEDB: db_size=" << db_size << ", expires_size=" << expires_size;
-
-      // We do not use this information because it is not possible to easily preallocate
-      // dash tables based on this information. Moreover, number of shards can change
-      // between the original shard set and the loading server.
+      ReserveForLoad(cur_db_index_, db_size);
       continue; /* Read next opcode. */
     }
 
@@ -2509,6 +2558,11 @@ error_code RdbLoader::Load(io::Source* src) {
       continue;
     }
 
+    if (type == RDB_OPCODE_DELETED_KEY) {
+      RETURN_ON_ERR(HandleDeletedKey());
+      continue;
+    }
+
     if (type == RDB_OPCODE_TAGGED_CHUNK) {
       ActiveTaggedChunk state;
       SET_OR_RETURN(FetchInt<uint32_t>(), state.stream_id);
@@ -2545,7 +2599,7 @@ error_code RdbLoader::Load(io::Source* src) {
       return RdbError(errc::invalid_rdb_type);
     }
 
-    ++keys_loaded;
+    ++*keys_loaded;
     RETURN_ON_ERR(LoadKeyValPair(type, &settings));
 
     VLOG(2) << "LoadKeyValPair key=" << last_key_loaded_ << " rdb_type=" << type
@@ -2560,12 +2614,20 @@ error_code RdbLoader::Load(io::Source* src) {
     return *ec_;
   }
 
-  /* Verify the checksum if RDB version is >= 5 */
-  RETURN_ON_ERR(VerifyChecksum());
-
   return kOk;
 }
 
+void RdbLoader::ReserveForLoad(DbIndex dbid, size_t num_keys) {
+  if (num_keys == 0)
+    return;
+
+  // Keys of any source shard spread evenly over the shards of this instance.
+  size_t shard_keys = num_keys / shard_set->size() + 1;
+  for (unsigned i = 0; i < shard_set->size(); ++i) {
+    shard_set->Add(i, [dbid, shard_keys] { GetCurrentDbSlice().ReserveForLoad(dbid, shard_keys); });
+  }
+}
+
 void RdbLoader::FinishLoad(absl::Time start_time, size_t* keys_loaded) {
   BlockingCounter bc(shard_set->size());
   for (unsigned i = 0; i < shard_set->size(); ++i) {
@@ -2846,7 +2908,9 @@ error_code RdbLoader::HandleAux() {
   } else if (auxkey == "repl-stream-db") {
     // TODO
   } else if (auxkey == "repl-id") {
-    // TODO
+    repl_id_ = std::move(auxval);
+  } else if (auxkey == "snapshot-base") {
+    snapshot_bases_.push_back(std::move(auxval));
   } else if (auxkey == "repl-offset") {
     // TODO
   } else if (auxkey == "lua") {
@@ -2893,6 +2957,8 @@ error_code RdbLoader::HandleAux() {
     LoadSearchIndexDefFromAux(std::move(auxval));
   } else if (auxkey == "search-synonyms") {
     LoadSearchSynonymsFromAux(std::move(auxval));
+  } else if (auxkey == "search-aggregates") {
+    LoadSearchAggregateFromAux(std::move(auxval));
   } else if (auxkey == "shard-count") {
     uint32_t shard_count;
     if (absl::SimpleAtoi(auxval, &shard_count)) {
@@ -2904,6 +2970,18 @@ error_code RdbLoader::HandleAux() {
     if (absl::SimpleAtoi(auxval, &shard_id)) {
       shard_id_ = shard_id;
     }
+  } else if (auxkey == "shard-lsn") {
+    uint64_t lsn;
+    if (absl::SimpleAtoi(auxval, &lsn)) {
+      shard_lsn_ = lsn;
+    }
+  } else if (auxkey == "db-sizes") {
+    vector<string_view> sizes = absl::StrSplit(auxval, ',');
+    for (DbIndex db_id = 0; db_id < sizes.size() && db_id < GetFlag(FLAGS_dbnum); ++db_id) {
+      size_t db_size;
+      if (absl::SimpleAtoi(sizes[db_id], &db_size))
+        ReserveForLoad(db_id, db_size);
+    }
   } else if (auxkey == "table-mem") {
     size_t mem;
     if (absl::SimpleAtoi(auxval, &mem)) {
@@ -2984,7 +3062,27 @@ void RdbLoaderBase::CopyStreamId(const StreamID& src, struct streamID* dest) {
 
 void RdbLoader::CreateObjectOnShard(const DbContext& db_cntx, const Item* item, DbSlice* db_slice) {
   PrimeValue pv;
-  PrimeValue* pv_ptr = &pv;
+  if (!PrepareObject(db_cntx, item, &pv))
+    return;
+
+  auto op_res = db_slice->AddOrUpdate(db_cntx, item->key, std::move(pv), item->expire_ms);
+  if (!op_res) {
+    LOG(ERROR) << "OOM failed to add key '" << item->key << "' in DB " << db_cntx.db_index;
+    ec_ = RdbError(errc::out_of_memory);
+    stop_early_ = true;
+    return;
+  }
+
+  // Finalize the AutoUpdater before stashing. The stash callback may complete
+  // (e.g. during the SleepFor yield in OnObjectAdded) and transform the PrimeValue to external,
+  // changing MallocUsed(). If the AutoUpdater ran after that, it would compute a
+  // bogus negative memory delta and crash in AccountObjectMemory.
+  op_res->post_updater.Run();
+  OnObjectAdded(db_cntx, item, db_slice, op_res->it.GetInnerIt(), op_res->is_new);
+}
+
+bool RdbLoader::PrepareObject(const DbContext& db_cntx, const Item* item, PrimeValue* pv) {
+  PrimeValue* pv_ptr = pv;
   DbIndex db_ind = db_cntx.db_index;
 
   auto error_msg = [](const auto* item, auto db_ind) {
@@ -3006,7 +3104,7 @@ void RdbLoader::CreateObjectOnShard(const DbContext& db_cntx, const Item* item,
                                 item->val.rdb_type == RDB_TYPE_SET_WITH_EXPIRY;
       if (!is_set_expiry_type && key_is_not_expired) {
         LOG(ERROR) << "Count not to find append key '" << item->key << "' in DB " << db_ind;
-        return;
+        return false;
       }
       config_copy.append = false;
     }
@@ -3016,7 +3114,7 @@ void RdbLoader::CreateObjectOnShard(const DbContext& db_cntx, const Item* item,
     if (ec.value() == errc::value_expired) {
       // hmap and sset values can expire and we ok with it,
       // so we don't set ec_ in this case
-      return;
+      return false;
     }
     ec_ = ec;
     if (ec.value() == errc::empty_key) {
@@ -3026,65 +3124,68 @@ void RdbLoader::CreateObjectOnShard(const DbContext& db_cntx, const Item* item,
       } else {
         LOG(ERROR) << error;
       }
-      return;
+      return false;
     }
     LOG(ERROR) << "Could not load value for key '" << absl::CHexEscape(item->key) << "' in DB "
                << db_ind << " " << item->load_config.chunked << " " << item->load_config.append
                << " " << item->val.rdb_type;
     stop_early_ = true;
-    return;
+    return false;
   }
 
   if (item->load_config.chunked) {
     std::unique_lock lk{now_chunked_mu_};
     if (!now_chunked_.contains(chunked_key))
-      now_chunked_.emplace(chunked_key, make_unique<PrimeValue>(std::move(pv)));
+      now_chunked_.emplace(chunked_key, make_unique<PrimeValue>(std::move(*pv)));
 
     if (!item->load_config.finalize)
-      return;
+      return false;
 
-    pv = std::move(*now_chunked_.extract(chunked_key).mapped());
+    *pv = std::move(*now_chunked_.extract(chunked_key).mapped());
   }
 
   // We need this extra check because we don't return empty_key
-  if (!pv.TagAllowsEmptyValue() && pv.Size() == 0) {
+  if (!pv->TagAllowsEmptyValue() && pv->Size() == 0) {
     LOG(WARNING) << error_msg(item, db_ind);
-    return;
+    return false;
   }
 
   if (item->expire_ms > 0 && db_cntx.time_now_ms >= item->expire_ms) {
     VLOG(2) << "Expire key on load: " << item->key;
-    return;
+    return false;
   }
 
-  auto op_res = db_slice->AddOrUpdate(db_cntx, item->key, std::move(pv), item->expire_ms);
-  if (!op_res) {
-    LOG(ERROR) << "OOM failed to add key '" << item->key << "' in DB " << db_ind;
-    ec_ = RdbError(errc::out_of_memory);
-    stop_early_ = true;
-    return;
-  }
+  return true;
+}
 
-  DbSlice::ItAndUpdater& updater = *op_res;
-  updater.it->first.SetSticky(item->is_sticky);
+void RdbLoader::OnObjectAdded(const DbContext& db_cntx, const Item* item, DbSlice* db_slice,
+                              PrimeIterator it, bool is_new) {
+  DbIndex db_ind = db_cntx.db_index;
+  it->first.SetSticky(item->is_sticky);
   if (item->has_mc_flags) {
-    updater.it->second.SetFlag(true);
-    db_slice->SetMCFlag(db_cntx.db_index, updater.it->first, item->mc_flags);
+    it->second.SetFlag(true);
+    db_slice->SetMCFlag(db_ind, it->first, item->mc_flags);
   }
 
-  if (!override_existing_keys_ && !updater.is_new) {
+  if (!override_existing_keys_ && !is_new) {
     LOG(WARNING) << "RDB has duplicated key '" << item->key << "' in DB " << db_ind << " of type "
-                 << updater.it->second.ObjType();
+                 << it->second.ObjType();
+  }
+
+  if (journal_loaded_keys_ && db_slice->shard_owner()->journal()) {
+    string expire_str = absl::StrCat(item->expire_ms);
+    string dump = RdbSerializer::DumpValue(it->second);
+    absl::InlinedVector<string_view, 6> args(
+        {item->key, expire_str, dump, "REPLACE"sv, "ABSTTL"sv});
+    if (item->is_sticky) {
+      args.push_back("STICK"sv);
+    }
+    journal::RecordEntry(0, journal::Op::COMMAND, db_ind, KeySlot(item->key),
+                         journal::Entry::Payload("RESTORE"sv, ArgSlice{args}));
   }
 
   if (auto* ts = db_slice->shard_owner()->tiered_storage(); ts) {
-    // Finalize the AutoUpdater before stashing. The stash callback may complete
-    // (e.g. during the SleepFor yield below) and transform the PrimeValue to external,
-    // changing MallocUsed(). If the AutoUpdater ran after that, it would compute a
-    // bogus negative memory delta and crash in AccountObjectMemory.
-    auto it = updater.it;
-    updater.post_updater.Run();
-    StashPrimeValue(db_cntx.db_index, item->key, it->first, &it->second, ts, nullptr);
+    StashPrimeValue(db_ind, item->key, it->first, &it->second, ts, nullptr);
 
     // Block, if tiered storage is active, but can't keep up
     while (db_slice->shard_owner()->ShouldThrottleForTiering())
@@ -3097,16 +3198,56 @@ void RdbLoader::LoadItemsBuffer(const ItemsBuf& ib) {
   const uint64_t now_ms = GetCurrentTimeMs();
   Namespace* ns = &namespaces->GetDefaultNamespace();
 
-  for (const auto* item : ib) {
-    DbContext db_cntx{ns, item->db_index, now_ms};
+  // Consecutive items of the same db are added with a single DbSlice::AddBulk call.
+  vector<DbSlice::BulkEntry> entries;
+  vector<const Item*> entry_items;
+  entries.reserve(ib.size());
+  entry_items.reserve(ib.size());
+  DbIndex db_index = ib.empty() ? 0 : ib.front()->db_index;
+
+  auto add_entries = [&] {
+    if (entries.empty())
+      return;
+
+    DbContext db_cntx{ns, db_index, now_ms};
     DbSlice& db_slice = db_cntx.GetDbSlice(es->shard_id());
     DCHECK(!db_slice.IsCacheMode());
-    CreateObjectOnShard(db_cntx, item, &db_slice);
+    auto res = db_slice.AddBulk(db_cntx, absl::MakeSpan(entries),
+                                [&](size_t i, const DbSlice::Iterator& it, bool is_new) {
+                                  OnObjectAdded(db_cntx, entry_items[i], &db_slice,
+                                                it.GetInnerIt(), is_new);
+                                });
+    if (!res) {
+      LOG(ERROR) << "OOM failed to add " << entries.size() << " keys in DB " << db_index;
+      ec_ = RdbError(errc::out_of_memory);
+      stop_early_ = true;
+    }
+    entries.clear();
+    entry_items.clear();
+  };
+
+  for (const auto* item : ib) {
+    if (item->db_index != db_index) {
+      add_entries();
+      db_index = item->db_index;
+    }
+
+    DbContext db_cntx{ns, item->db_index, now_ms};
+    PrimeValue pv;
+    if (PrepareObject(db_cntx, item, &pv)) {
+      entries.push_back({.key = item->key,
+                         .key_hash = item->key_hash,
+                         .value = std::move(pv),
+                         .expire_at_ms = item->expire_ms});
+      entry_items.push_back(item);
+    }
     if (stop_early_) {
       // force all items in ib to move into item_queue_ so they can be cleaned up later.
       break;
     }
   }
+  if (!stop_early_)
+    add_entries();
 
   for (auto* item : ib) {
     item_queue_.Push(item);
@@ -3247,6 +3388,8 @@ io::Result<bool> RdbLoader::ReadAndDispatchObject(int object_type, std::string&
 
   if (finalized) {
     item->key = std::move(key);
+    // Hash the key here rather than on the shard thread.
+    item->key_hash = CompactObj::HashCode(item->key);
   } else {
     item->key = key;
   }
@@ -3392,6 +3535,31 @@ error_code RdbLoader::HandleShardDocIndex() {
   return kOk;
 }
 
+error_code RdbLoader::HandleDeletedKey() {
+  string key;
+  SET_OR_RETURN(FetchGenericString(), key);
+  if (GetFlag(FLAGS_rdb_load_dry_run))
+    return kOk;
+
+  // Keep the order with the entries of the same shard that were read before.
+  const ShardId sid = Shard(key, shard_set->size());
+  auto del_cb = [db_index = cur_db_index_, key = std::move(key)] {
+    DbContext db_cntx{&namespaces->GetDefaultNamespace(), db_index, GetCurrentTimeMs()};
+    DbSlice& db_slice = db_cntx.GetDbSlice(EngineShard::tlocal()->shard_id());
+    auto res = db_slice.FindMutable(db_cntx, key);
+    if (IsValid(res.it))
+      db_slice.DelMutable(db_cntx, std::move(res));
+  };
+
+  if (EngineShard::tlocal() && EngineShard::tlocal()->shard_id() == sid) {
+    del_cb();
+  } else {
+    FlushShardAsync(sid);
+    shard_set->Add(sid, std::move(del_cb));
+  }
+  return kOk;
+}
+
 std::error_code RdbLoader::FinalizeCurrentChunkIfNeeded() {
   if (stop_early_.load(memory_order_relaxed))
     return kOk;
@@ -3481,4 +3649,8 @@ void RdbLoader::LoadSearchSynonymsFromAux(string&& def) {
   load_context_->AddPendingSynonymCommand(std::move(def));
 }
 
+void RdbLoader::LoadSearchAggregateFromAux(string&& def) {
+  load_context_->AddPendingAggregateCommand(std::move(def));
+}
+
 }  // namespace dfly
@@ -11,6 +11,7 @@ extern "C" {
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/time/time.h>
 
 #include "base/mpsc_intrusive_queue.h"
 #include "base/pod_array.h"
@@ -306,6 +307,12 @@ class RdbLoader : protected RdbLoaderBase {
     load_unowned_slots_ = load_unowned;
   }
 
+  // Records every loaded entry to the journal as a RESTORE command, so that replicas of this
+  // instance receive the loaded data.
+  void SetJournalLoadedKeys(bool journal_keys) {
+    journal_loaded_keys_ = journal_keys;
+  }
+
   // Sets shard count of the snapshot being loaded.
   // Does not necessarily match the shard count of the current instance.
   void SetShardCount(uint32_t shard_cnt) {
@@ -314,6 +321,14 @@ class RdbLoader : protected RdbLoaderBase {
 
   std::error_code Load(::io::Source* src);
 
+  // Loads a batch of entries without the RDB header, terminated with RDB_OPCODE_EOF, as streamed
+  // by slot migrations. Can be called repeatedly, every time with the source of the next batch.
+  // The entries may still be in flight to their shards when it returns, see FinishBatches().
+  std::error_code LoadBatch(::io::Source* src);
+
+  // Returns once the entries of the batches loaded so far were added to their shards.
+  std::error_code FinishBatches();
+
   void set_source_limit(size_t n) {
     source_limit_ = n;
   }
@@ -353,6 +368,22 @@ class RdbLoader : protected RdbLoaderBase {
     return journal_offset_;
   }
 
+  // Replication id of the master that produced the snapshot, see "repl-id" aux field.
+  const std::string& repl_id() const {
+    return repl_id_;
+  }
+
+  // Journal LSN of the shard at the moment its file was snapshotted, if the master journal
+  // was active. Together with repl_id() it allows to seed a replica from this snapshot.
+  std::optional<uint64_t> shard_lsn() const {
+    return shard_lsn_;
+  }
+
+  // Summary files of the snapshots a delta snapshot is applied on top of, the full one first.
+  const std::vector<std::string>& snapshot_bases() const {
+    return snapshot_bases_;
+  }
+
   // Set callback for receiving RDB_OPCODE_FULLSYNC_END.
   // This opcode is used by a master instance to notify it finished streaming static data
   // and is ready to switch to stable state sync.
@@ -371,6 +402,7 @@ class RdbLoader : protected RdbLoaderBase {
  private:
   struct Item {
     std::string key;
+    uint64_t key_hash = 0;  // set with the last chunk, see DbSlice::BulkEntry
     OpaqueObj val;
     uint64_t expire_ms;
     std::atomic<Item*> next;
@@ -396,6 +428,9 @@ class RdbLoader : protected RdbLoaderBase {
 
   struct StreamState;
 
+  // The main load loop, reads opcodes until RDB_OPCODE_EOF.
+  std::error_code LoadOpcodes(size_t* keys_loaded);
+
   std::error_code LoadKeyValPair(int type, ObjSettings* settings);
 
   // Loads a continuation tagged chunk. The first chunk has already loaded the key and object type.
@@ -417,10 +452,22 @@ class RdbLoader : protected RdbLoaderBase {
   void FlushShardAsync(ShardId sid);
   void FlushAllShards();
 
+  // Adds the items to the shard in bulk, see DbSlice::AddBulk.
   void LoadItemsBuffer(const ItemsBuf& ib);
 
+  // Sizes the tables of all shards for num_keys keys of the snapshot that are added to dbid.
+  void ReserveForLoad(DbIndex dbid, size_t num_keys);
+
   void CreateObjectOnShard(const DbContext& db_cntx, const Item* item, DbSlice* db_slice);
 
+  // Builds the value of the item. Returns false if the item does not add an entry, i.e. it is
+  // not the last chunk of the object, it has expired or it failed to load.
+  bool PrepareObject(const DbContext& db_cntx, const Item* item, PrimeValue* pv);
+
+  // Applies the item attributes to the added entry and propagates it.
+  void OnObjectAdded(const DbContext& db_cntx, const Item* item, DbSlice* db_slice,
+                     PrimeIterator it, bool is_new);
+
   void LoadScriptFromAux(std::string&& value);
 
   // Load index definition from RESP string describing it in FT.CREATE format,
@@ -430,6 +477,9 @@ class RdbLoader : protected RdbLoaderBase {
   // Load synonyms from RESP string and issue FT.SYNUPDATE call
   void LoadSearchSynonymsFromAux(std::string&& value);
 
+  // Load materialized aggregation from RESP string and issue FT.AGGCREATE call
+  void LoadSearchAggregateFromAux(std::string&& value);
+
   // Restore HNSW vector index graph from serialized node data.
   std::error_code RestoreVectorIndex(std::string_view index_key, std::string_view index_name,
                                      std::string_view field_name, uint64_t elements_number,
@@ -446,6 +496,7 @@ class RdbLoader : protected RdbLoaderBase {
   // locals don't accumulate in Load()'s stack frame.
   std::error_code HandleVectorIndex();
   std::error_code HandleShardDocIndex();
+  std::error_code HandleDeletedKey();
 
   // validates if the current chunk is fully read, resets the state. returns early if stop_early_ is
   // requested.
@@ -455,8 +506,12 @@ class RdbLoader : protected RdbLoaderBase {
   RdbLoadContext* load_context_;
 
   std::string snapshot_id_;
+  std::string repl_id_;
+  std::optional<uint64_t> shard_lsn_;
+  std::vector<std::string> snapshot_bases_;
   bool override_existing_keys_ = false;
   bool load_unowned_slots_ = false;
+  bool journal_loaded_keys_ = false;
   bool rdb_ignore_expiry_;
   const bool deserialize_hnsw_index_;
   uint32_t shard_id_ = UINT32_MAX;
@@ -467,6 +522,8 @@ class RdbLoader : protected RdbLoaderBase {
 
   size_t keys_loaded_ = 0;
   double load_time_ = 0;
+  bool batches_pending_ = false;  // LoadBatch was called since the last FinishBatches
+  absl::Time batches_start_;
 
   DbIndex cur_db_index_ = 0;
   bool pause_ = false;
@@ -243,6 +243,11 @@ void RdbLoadContext::AddPendingSynonymCommand(std::string cmd) {
   pending_synonym_cmds_.push_back(std::move(cmd));
 }
 
+void RdbLoadContext::AddPendingAggregateCommand(std::string cmd) {
+  util::fb2::LockGuard<util::fb2::Mutex> lk(mu_);
+  pending_aggregate_cmds_.push_back(std::move(cmd));
+}
+
 void RdbLoadContext::AddPendingIndexMapping(uint32_t shard_id, PendingIndexMapping mapping) {
   util::fb2::LockGuard<util::fb2::Mutex> lk(mu_);
   pending_index_mappings_[shard_id].emplace_back(std::move(mapping));
@@ -264,6 +269,13 @@ std::vector<std::string> RdbLoadContext::TakePendingSynonymCommands() {
   return result;
 }
 
+std::vector<std::string> RdbLoadContext::TakePendingAggregateCommands() {
+  util::fb2::LockGuard<util::fb2::Mutex> lk(mu_);
+  std::vector<std::string> result;
+  result.swap(pending_aggregate_cmds_);
+  return result;
+}
+
 absl::flat_hash_map<uint32_t, std::vector<PendingIndexMapping>>
 RdbLoadContext::TakePendingIndexMappings() {
   util::fb2::LockGuard<util::fb2::Mutex> lk(mu_);
@@ -303,6 +315,7 @@ void RdbLoadContext::PerformPostLoad(Service* service, bool is_error) {
     return;
 
   std::vector<std::string> synonym_cmds = TakePendingSynonymCommands();
+  std::vector<std::string> aggregate_cmds = TakePendingAggregateCommands();
   auto index_mappings = TakePendingIndexMappings();
   auto pending_nodes = TakePendingHnswNodes();
 
@@ -369,6 +382,12 @@ void RdbLoadContext::PerformPostLoad(Service* service, bool is_error) {
     LoadSearchCommandFromAux(service, std::move(syn_cmd), "FT.SYNUPDATE", "synonym definition");
   }
 
+  // Materialized aggregations are populated once the indices are built
+  for (auto& agg_cmd : aggregate_cmds) {
+    LoadSearchCommandFromAux(service, std::move(agg_cmd), "FT.AGGCREATE",
+                             "aggregation definition");
+  }
+
   // Wait until index building ends (all shards' vector data populated).
   shard_set->RunBlockingInParallel([](EngineShard* es) {
     es->search_indices()->BlockUntilConstructionEnd();
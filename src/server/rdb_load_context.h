@@ -17,7 +17,8 @@ namespace dfly {
 
 class Service;
 
-// Dispatches a search command (FT.CREATE / FT.SYNUPDATE) from a serialized AUX string.
+// Dispatches a search command (FT.CREATE / FT.SYNUPDATE / FT.AGGCREATE) from a serialized AUX
+// string.
 void LoadSearchCommandFromAux(Service* service, std::string&& def, std::string_view command_name,
                               std::string_view error_context, bool add_NX = false);
 
@@ -48,6 +49,7 @@ class RdbLoadContext {
   RdbLoadContext& operator=(const RdbLoadContext&) = delete;
 
   void AddPendingSynonymCommand(std::string cmd);
+  void AddPendingAggregateCommand(std::string cmd);
   void AddPendingIndexMapping(uint32_t shard_id, PendingIndexMapping mapping);
   void AddPendingHnswNodes(PendingHnswNodes nodes);
   void SetMasterShardCount(uint32_t count);
@@ -58,6 +60,7 @@ class RdbLoadContext {
 
  private:
   std::vector<std::string> TakePendingSynonymCommands();
+  std::vector<std::string> TakePendingAggregateCommands();
   absl::flat_hash_map<uint32_t, std::vector<PendingIndexMapping>> TakePendingIndexMappings();
   std::vector<PendingHnswNodes> TakePendingHnswNodes();
 
@@ -74,6 +77,7 @@ class RdbLoadContext {
 
   mutable util::fb2::Mutex mu_;
   std::vector<std::string> pending_synonym_cmds_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::string> pending_aggregate_cmds_ ABSL_GUARDED_BY(mu_);
   absl::flat_hash_map<uint32_t, std::vector<PendingIndexMapping>> pending_index_mappings_
       ABSL_GUARDED_BY(mu_);
   std::vector<PendingHnswNodes> pending_hnsw_nodes_ ABSL_GUARDED_BY(mu_);
@@ -7,6 +7,7 @@
 #include <absl/cleanup/cleanup.h>
 #include <absl/strings/str_cat.h>
 #include <absl/strings/str_format.h>
+#include <absl/strings/str_join.h>
 
 #include <bit>
 #include <queue>
@@ -38,6 +39,7 @@ extern "C" {
 #include "core/topk.h"
 #include "server/engine_shard_set.h"
 #include "server/error.h"
+#include "server/journal/journal.h"
 #include "server/main_service.h"
 #include "server/namespaces.h"
 #include "server/rdb_extensions.h"
@@ -935,6 +937,12 @@ error_code RdbSerializer::SendJournalOffset(uint64_t journal_offset) {
   return WriteRaw(buf);
 }
 
+error_code RdbSerializer::SaveDeletedKey(string_view key, DbIndex dbid) {
+  RETURN_ON_ERR(SelectDb(dbid));
+  RETURN_ON_ERR(WriteOpcode(RDB_OPCODE_DELETED_KEY));
+  return SaveString(key);
+}
+
 error_code RdbSerializer::SaveHNSWEntry(const search::HnswNodeData& node,
                                         absl::Span<uint8_t> tmp_buf) {
   // Binary format using little-endian encoding for efficiency:
@@ -1268,7 +1276,8 @@ class RdbSaver::Impl final : public SliceSnapshot::SnapshotDataConsumerInterface
 
   ~Impl();
 
-  void StartSnapshotting(bool stream_journal, ExecutionState* cntx, EngineShard* shard);
+  void StartSnapshotting(bool stream_journal, ExecutionState* cntx, EngineShard* shard,
+                         IncrementalMode incremental);
 
   void StopSnapshotting(EngineShard* shard);
   void WaitForSnapshottingFinish(EngineShard* shard);
@@ -1437,7 +1446,7 @@ error_code RdbSaver::Impl::WriteRecord(io::Bytes src) {
 }
 
 void RdbSaver::Impl::StartSnapshotting(bool stream_journal, ExecutionState* cntx,
-                                       EngineShard* shard) {
+                                       EngineShard* shard, IncrementalMode incremental) {
   auto& s = GetSnapshot(shard);
   auto& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard->shard_id());
 
@@ -1446,7 +1455,7 @@ void RdbSaver::Impl::StartSnapshotting(bool stream_journal, ExecutionState* cntx
   const auto allow_flush = (save_mode_ != SaveMode::RDB) ? SliceSnapshot::SnapshotFlush::kAllow
                                                          : SliceSnapshot::SnapshotFlush::kDisallow;
 
-  s->Start(stream_journal, allow_flush);
+  s->Start(stream_journal, allow_flush, incremental);
 }
 
 SnapshotPtr RdbSaver::Impl::CreateSliceSnapshot(EngineShard* shard, DbSlice* db_slice,
@@ -1566,12 +1575,14 @@ namespace {
 
 // Collect search index definitions for replication / RDB.
 // search_indices always gets simple "index_name cmd" restore commands.
-// For summary shards, search_synonyms gets synonym group restore commands.
+// For summary shards, search_synonyms and search_aggregates get synonym group and materialized
+// aggregation restore commands.
 // (HNSW graph metadata travels inline with the node data in RDB_OPCODE_VECTOR_INDEX,
 //  so it is not collected here.)
 void CollectSearchIndices([[maybe_unused]] const EngineShard& shard,
                           [[maybe_unused]] StringVec* search_indices,
                           [[maybe_unused]] StringVec* search_synonyms,
+                          [[maybe_unused]] StringVec* search_aggregates,
                           [[maybe_unused]] bool is_summary) {
 #ifdef WITH_SEARCH
   auto* indices = shard.search_indices();
@@ -1595,6 +1606,12 @@ void CollectSearchIndices([[maybe_unused]] const EngineShard& shard,
         search_synonyms->emplace_back(std::move(syn_cmd));
       }
     }
+
+    // Save materialized aggregations
+    for (const auto& [name, group] : index->GetMaterializedAggregates()) {
+      search_aggregates->emplace_back(
+          absl::StrCat(index_name, " ", name, " ", aggregate::GroupParamsToArgs(group)));
+    }
   }
 #endif
 }
@@ -1602,16 +1619,18 @@ void CollectSearchIndices([[maybe_unused]] const EngineShard& shard,
 }  // namespace
 
 RdbSaver::GlobalData RdbSaver::GetGlobalData(const Service* service, bool is_summary) {
-  StringVec script_bodies, search_indices, search_synonyms;
+  StringVec script_bodies, search_indices, search_synonyms, search_aggregates;
   size_t table_mem_result = 0;
 
   if (!is_summary) {
     shard_set->RunBriefInParallel([&](EngineShard* shard) {
       if (shard->shard_id() == 0)
-        CollectSearchIndices(*shard, &search_indices, &search_synonyms, is_summary);
+        CollectSearchIndices(*shard, &search_indices, &search_synonyms, &search_aggregates,
+                             is_summary);
     });
     return RdbSaver::GlobalData{std::move(script_bodies), std::move(search_indices),
-                                std::move(search_synonyms), table_mem_result};
+                                std::move(search_synonyms), std::move(search_aggregates),
+                                table_mem_result};
   }
   {
     // For summary file: collect all global data
@@ -1624,7 +1643,8 @@ RdbSaver::GlobalData RdbSaver::GetGlobalData(const Service* service, bool is_sum
   atomic<size_t> table_mem{0};
   shard_set->RunBriefInParallel([&](EngineShard* shard) {
     if (shard->shard_id() == 0)
-      CollectSearchIndices(*shard, &search_indices, &search_synonyms, is_summary);
+      CollectSearchIndices(*shard, &search_indices, &search_synonyms, &search_aggregates,
+                           is_summary);
 
     auto& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard->shard_id());
     size_t shard_table_mem = 0;
@@ -1638,7 +1658,8 @@ RdbSaver::GlobalData RdbSaver::GetGlobalData(const Service* service, bool is_sum
   });
 
   return RdbSaver::GlobalData{std::move(script_bodies), std::move(search_indices),
-                              std::move(search_synonyms), table_mem.load(memory_order_relaxed)};
+                              std::move(search_synonyms), std::move(search_aggregates),
+                              table_mem.load(memory_order_relaxed)};
 }
 
 void RdbSaver::Impl::FillFreqMap(RdbTypeFreqMap* dest) const {
@@ -1699,12 +1720,19 @@ RdbSaver::~RdbSaver() {
   tlocal->DecommitMemory(ServerState::kAllMemory);
 }
 
-void RdbSaver::StartSnapshotInShard(bool stream_journal, ExecutionState* cntx, EngineShard* shard) {
-  impl_->StartSnapshotting(stream_journal, cntx, shard);
+void RdbSaver::StartSnapshotInShard(bool stream_journal, ExecutionState* cntx, EngineShard* shard,
+                                    IncrementalMode incremental) {
+  // No preemption until the snapshot version is taken, so entries starting from this LSN are
+  // exactly the ones missing from the shard file.
+  if (save_shard_lsn_)
+    shard_lsn_ = journal::GetLsn();
+  impl_->StartSnapshotting(stream_journal, cntx, shard, incremental);
 }
 
 error_code RdbSaver::WaitSnapshotInShard(EngineShard* shard) {
   impl_->WaitForSnapshottingFinish(shard);
+  if (shard_lsn_)
+    RETURN_ON_ERR(SaveAuxFieldStrInt("shard-lsn", *shard_lsn_));
   return SaveEpilog();
 }
 
@@ -1790,17 +1818,42 @@ error_code RdbSaver::SaveAux(const GlobalData& glob_state) {
     for (const string& s : glob_state.search_synonyms)
       RETURN_ON_ERR(impl_->SaveAuxFieldStrStr("search-synonyms", s));
 
+    // Materialized aggregations as well, older versions skip unknown aux fields
+    DCHECK(save_mode_ != SaveMode::SINGLE_SHARD || glob_state.search_aggregates.empty());
+    for (const string& s : glob_state.search_aggregates)
+      RETURN_ON_ERR(impl_->SaveAuxFieldStrStr("search-aggregates", s));
+
     if (save_mode_ == SaveMode::SINGLE_SHARD_WITH_SUMMARY || save_mode_ == SaveMode::SUMMARY) {
       // We save the shard id in the summary file, so that we can restore it later.
       RETURN_ON_ERR(SaveAuxFieldStrInt("shard-count", shard_set->size()));
       RETURN_ON_ERR(SaveAuxFieldStrInt("table-mem", glob_state.table_used_memory));
     }
+
+    // A delta snapshot is loaded on top of its bases, oldest first.
+    DCHECK(save_mode_ == SaveMode::SUMMARY || glob_state.snapshot_bases.empty());
+    for (const string& s : glob_state.snapshot_bases)
+      RETURN_ON_ERR(impl_->SaveAuxFieldStrStr("snapshot-base", s));
+
     if (EngineShard* shard = EngineShard::tlocal(); shard) {
       RETURN_ON_ERR(SaveAuxFieldStrInt("shard-id", shard->shard_id()));
+
+      // Key counts of the dbs, so that the loader can size its tables up front.
+      auto& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard->shard_id());
+      vector<size_t> db_sizes(db_slice.db_array_size());
+      for (DbIndex db_id = 0; db_id < db_sizes.size(); ++db_id)
+        db_sizes[db_id] = db_slice.DbSize(db_id);
+      RETURN_ON_ERR(impl_->SaveAuxFieldStrStr("db-sizes", absl::StrJoin(db_sizes, ",")));
+
+      // The matching "shard-lsn" is taken at the snapshot cut, see StartSnapshotInShard.
+      if (save_mode_ == SaveMode::SINGLE_SHARD && !glob_state.repl_id.empty() &&
+          shard->journal()) {
+        RETURN_ON_ERR(impl_->SaveAuxFieldStrStr("repl-id", glob_state.repl_id));
+        save_shard_lsn_ = true;
+      }
     }
   }
 
-  // TODO: "repl-stream-db", "repl-id", "repl-offset"
+  // TODO: "repl-stream-db", "repl-offset"
   return error_code{};
 }
 
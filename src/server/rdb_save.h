@@ -75,6 +75,13 @@ enum class SaveMode {
 
 enum class CompressionMode : uint8_t { NONE, SINGLE_ENTRY, MULTI_ENTRY_ZSTD, MULTI_ENTRY_LZ4 };
 
+// Incremental DF snapshots of a shard.
+enum class IncrementalMode : uint8_t {
+  NONE,
+  BASE,   // Save all entries and start logging deleted keys for the next delta.
+  DELTA,  // Save only the buckets changed since the previous snapshot and the deleted keys.
+};
+
 CompressionMode GetDefaultCompressionMode();
 
 using StringVec = std::vector<std::string>;
@@ -172,10 +179,14 @@ class RdbSaver {
  public:
   // Global data which doesn't belong to shards and is serialized in header
   struct GlobalData {
-    const StringVec lua_scripts;      // bodies of lua scripts
-    const StringVec search_indices;   // ft.create commands to re-create search indices
-    const StringVec search_synonyms;  // ft.synupdate commands to restore synonyms
-    size_t table_used_memory = 0;     // total memory used by all tables in all shards
+    const StringVec lua_scripts;        // bodies of lua scripts
+    const StringVec search_indices;     // ft.create commands to re-create search indices
+    const StringVec search_synonyms;    // ft.synupdate commands to restore synonyms
+    const StringVec search_aggregates;  // ft.aggcreate commands to restore aggregations
+    size_t table_used_memory = 0;       // total memory used by all tables in all shards
+    std::string repl_id;  // master replid, when set shard files carry their journal LSN watermark
+    // Summary files of the snapshots a delta is applied on top of, starting from the full one.
+    StringVec snapshot_bases;
   };
 
   // single_shard - true means that we run RdbSaver on a single shard and we do not use
@@ -192,7 +203,8 @@ class RdbSaver {
 
   // Initiates the serialization in the shard's thread.
   // cll allows breaking in the middle.
-  void StartSnapshotInShard(bool stream_journal, ExecutionState* cntx, EngineShard* shard);
+  void StartSnapshotInShard(bool stream_journal, ExecutionState* cntx, EngineShard* shard,
+                            IncrementalMode incremental = IncrementalMode::NONE);
 
   // Stops full-sync serialization for replication in the shard's thread.
   std::error_code StopFullSyncInShard(EngineShard* shard);
@@ -249,6 +261,11 @@ class RdbSaver {
   CompressionMode compression_mode_;
   DflyVersion replica_dfly_version_ = DflyVersion::CURRENT_VER;
   std::string snapshot_id_;
+
+  // Journal LSN at the snapshot cut, saved as "shard-lsn" after the data of a shard file that
+  // carries the "repl-id" of its master.
+  bool save_shard_lsn_ = false;
+  std::optional<uint64_t> shard_lsn_;
 };
 
 class RdbSerializer {
@@ -323,6 +340,9 @@ class RdbSerializer {
 
   std::error_code SendJournalOffset(uint64_t journal_offset);
 
+  // Writes a tombstone of a key deleted since the base of a delta snapshot.
+  std::error_code SaveDeletedKey(std::string_view key, DbIndex dbid);
+
   // Save HNSW index entry using provided tmp_buf for serialization to avoid repeated allocations.
   std::error_code SaveHNSWEntry(const search::HnswNodeData& node, absl::Span<uint8_t> tmp_buf);
 
@@ -12,6 +12,8 @@ extern "C" {
 #include <absl/flags/reflection.h>
 #include <mimalloc.h>
 
+#include <filesystem>
+
 #include "base/flags.h"
 #include "base/gtest.h"
 #include "base/logging.h"
@@ -767,6 +769,28 @@ TEST_F(RdbTest, RestoreSearchIndexNameStartingWithColon) {
   EXPECT_THAT(v.front(), IntArg(1));
 }
 
+TEST_F(RdbTest, RestoreMaterializedAggregate) {
+  EXPECT_EQ(Run({"FT.CREATE", "idx", "ON", "HASH", "PREFIX", "1", "doc:", "SCHEMA", "tenant", "TAG",
+                 "amount", "NUMERIC"}),
+            "OK");
+  Run({"HSET", "doc:1", "tenant", "a", "amount", "10"});
+  Run({"HSET", "doc:2", "tenant", "a", "amount", "5"});
+  EXPECT_EQ(Run({"FT.AGGCREATE", "idx", "by_tenant", "GROUPBY", "1", "@tenant", "REDUCE", "COUNT",
+                 "0", "AS", "n", "REDUCE", "SUM", "1", "@amount", "AS", "total"}),
+            "OK");
+
+  EXPECT_EQ(Run({"save", "df"}), "OK");
+  EXPECT_EQ(Run({"debug", "reload"}), "OK");
+
+  auto resp = Run({"FT.AGGREGATE", "idx", "*", "GROUPBY", "1", "@tenant", "REDUCE", "SUM", "1",
+                   "@amount", "AS", "total"});
+  EXPECT_THAT(resp, RespArray(ElementsAre(IntArg(1), RespArray(UnorderedElementsAre(
+                                                         "tenant", "a", "total", "15")))));
+
+  // The aggregation was restored with the index
+  EXPECT_EQ(Run({"FT.AGGDROP", "idx", "by_tenant"}), "OK");
+}
+
 // Parametrized test for RestoreVectorSearchIndexHnsw with varying document counts
 class HnswRestoreTest : public RdbTest, public testing::WithParamInterface<int> {};
 
@@ -1090,6 +1114,47 @@ TEST_F(RdbTest, RDBIgnoreExpiryFlag) {
   EXPECT_EQ(ttl2, -1);
 }
 
+TEST_F(RdbTest, DeltaSnapshot) {
+  absl::FlagSaver fs;
+  SetTestFlag("df_snapshot_delta_chain", "3");
+
+  auto shard_files_size = [](string_view basename) {
+    size_t size = 0;
+    for (unsigned i = 0; i < shard_set->size(); ++i)
+      size += std::filesystem::file_size(absl::StrFormat("%s-%04d.dfs", basename, i));
+    return size;
+  };
+
+  EXPECT_EQ(Run({"debug", "populate", "10000", "key", "100"}), "OK");
+  EXPECT_EQ(Run({"save", "df", "delta_base"}), "OK");
+
+  Run({"set", "key:1", "changed"});
+  Run({"del", "key:2", "key:3"});
+  EXPECT_EQ(Run({"save", "df", "delta_1"}), "OK");
+  EXPECT_LT(shard_files_size("delta_1") * 10, shard_files_size("delta_base"));
+
+  Run({"set", "key:2", "recreated"});
+  Run({"set", "new_key", "val"});
+  Run({"del", "key:1"});
+  EXPECT_EQ(Run({"save", "df", "delta_2"}), "OK");
+
+  Run({"flushall"});
+  EXPECT_EQ(Run({"dfly", "load", "delta_2-summary.dfs"}), "OK");
+  EXPECT_EQ(CheckedInt({"dbsize"}), 10000 - 2 + 1);
+  EXPECT_THAT(Run({"get", "key:1"}), kMatchNil);
+  EXPECT_EQ(Run({"get", "key:2"}), "recreated");
+  EXPECT_THAT(Run({"get", "key:3"}), kMatchNil);
+  EXPECT_EQ(Run({"get", "new_key"}), "val");
+  EXPECT_EQ(CheckedInt({"strlen", "key:4"}), 100);
+
+  // Flushed keys are not logged, so the next snapshot starts a new chain.
+  EXPECT_EQ(Run({"save", "df", "delta_3"}), "OK");
+  EXPECT_GT(shard_files_size("delta_3") * 2, shard_files_size("delta_base"));
+  Run({"set", "key:5", "changed"});
+  EXPECT_EQ(Run({"save", "df", "delta_4"}), "OK");
+  EXPECT_LT(shard_files_size("delta_4") * 10, shard_files_size("delta_3"));
+}
+
 TEST_F(RdbTest, CmsSerialization) {
   Run("cms.initbydim cms 1000 5");
   Run("cms.incrby cms foo 5 bar 3 baz 9");
@@ -71,6 +71,9 @@ ABSL_FLAG(
     "Published by info command for sentinel to pick replica based on score during a failover");
 ABSL_RETIRED_FLAG(bool, experimental_replicaof_v2, true,
                   "Deprecated: ReplicaOfV2 is now the only replication algorithm");
+ABSL_FLAG(uint32_t, replica_apply_batch_size, 32,
+          "Maximum number of consecutive journal records that a stable sync flow applies together "
+          "with squashed hops. 1 applies every record separately.");
 
 namespace dfly {
 
@@ -161,11 +164,11 @@ void Replica::StartMainReplicationFiber(std::optional<LastMasterSyncData> last_m
                         std::move(last_master_sync_data));
 }
 
-void Replica::EnableReplication() {
+void Replica::EnableReplication(std::optional<LastMasterSyncData> last_master_sync_data) {
   VLOG(1) << "Enabling replication";
 
-  state_mask_ = R_ENABLED;                                           // set replica state to enabled
-  sync_fb_ = MakeFiber(&Replica::MainReplicationFb, this, nullopt);  // call replication fiber
+  state_mask_ = R_ENABLED;  // set replica state to enabled
+  sync_fb_ = MakeFiber(&Replica::MainReplicationFb, this, std::move(last_master_sync_data));
 }
 
 std::optional<Replica::LastMasterSyncData> Replica::Stop() {
@@ -417,6 +420,11 @@ std::error_code Replica::HandleCapaDflyResp() {
     master_context_.version = DflyVersion(get<int64_t>(LastResponseArgs()[3].u));
   }
 
+  // Masters starting from VER7 may send compressed journal frames in stable sync once we
+  // announce our version with REPLCONF CLIENT-VERSION. JournalReader inflates them transparently.
+  VLOG_IF(1, master_context_.version >= DflyVersion::VER7)
+      << "Master supports compressed stable sync stream";
+
   // If our master is itself a replica (cascaded), parse lineage id (grandparent id)
   if (LastResponseArgs().size() >= 5) {
     PC_RETURN_ON_BAD_RESPONSE(LastResponseArgs()[4].type == RespExpr::STRING);
@@ -975,7 +983,7 @@ io::Result<bool> DflyShardReplica::StartSyncFlow(
   VLOG(1) << "Sending on flow " << master_context_.master_repl_id << " "
           << master_context_.dfly_session_id << " " << flow_id_ << " lsn: " << lsn.value_or(-1);
 
-  // DFLY FLOW <master_id> <session_id> <flow_id> [lsn] [last_master_id lsn-vec]
+  // DFLY FLOW <master_id> <session_id> <flow_id> [lsn] [last_master_id lsn-vec [SEEDED]]
   std::string cmd = StrCat("DFLY FLOW ", master_context_.master_repl_id, " ",
                            master_context_.dfly_session_id, " ", flow_id_);
   // Try to negotiate a partial sync if possible.
@@ -987,6 +995,8 @@ io::Result<bool> DflyShardReplica::StartSyncFlow(
       absl::GetFlag(FLAGS_replica_partial_sync)) {
     string lsn_str = absl::StrJoin(last_master_data.value().last_journal_LSNs, "-");
     absl::StrAppend(&cmd, " ", last_master_data.value().id, " ", lsn_str);
+    if (last_master_data->seeded)
+      absl::StrAppend(&cmd, " SEEDED");
     VLOG(1) << "Sending last master sync flow " << last_master_data.value().id << " " << lsn_str;
   }
 
@@ -1116,6 +1126,7 @@ void DflyShardReplica::StableSyncDflyReadFb(ExecutionState* cntx) {
   TransactionReader tx_reader{journal_rec_executed_.load(std::memory_order_relaxed) - 1};
 
   acks_fb_ = fb2::Fiber("shard_acks", &DflyShardReplica::StableSyncDflyAcksFb, this, cntx);
+  const size_t batch_limit = absl::GetFlag(FLAGS_replica_apply_batch_size);
   TransactionData tx_data;
   while (tx_reader.NextTxData(&reader, cntx, &tx_data)) {
     DVLOG(3) << "Lsn: " << tx_data.lsn;
@@ -1123,39 +1134,98 @@ void DflyShardReplica::StableSyncDflyReadFb(ExecutionState* cntx) {
     last_io_time_ = TimeSec();
     if (tx_data.opcode == journal::Op::LSN) {
       //  Do nothing
-    } else if (tx_data.opcode == journal::Op::PING) {
-      force_ping_ = true;
-      journal_rec_executed_.fetch_add(1, std::memory_order_relaxed);
-      if (EngineShard::tlocal() && EngineShard::tlocal()->journal()) {
-        // We must register this entry to the journal to allow partial sync
-        // if journal is active.
-        journal::RecordEntry(0, journal::Op::PING, 0, nullopt, {});
-      }
+    } else if (batch_limit > 1 && tx_data.opcode == journal::Op::COMMAND &&
+               !tx_data.IsGlobalCmd()) {
+      // Records without cross-flow ordering are collected while more of them are already
+      // buffered, and applied together.
+      apply_batch_.push_back(std::move(tx_data));
     } else {
-      const bool is_successful = ExecuteTx(std::move(tx_data), cntx);
-      if (is_successful) {
-        // We only increment upon successful execution of the transaction.
-        // The reason for this is that during partial sync we sent this
-        // number as the lsn number to resume from. However, if for example
-        // we increment this when a command fails (because the context
-        // got cancelled, e.g, replication connection broke), we will get
-        // inconsistent data because the replica will resume from the next
-        // lsn of the master and this lsn entry will be lost.
+      // Everything else is ordered after the collected records.
+      ApplyBatch(cntx);
+      if (tx_data.opcode == journal::Op::PING) {
+        force_ping_ = true;
         journal_rec_executed_.fetch_add(1, std::memory_order_relaxed);
-      } else {
-        // We only report DFATAL:
-        // 1. Context is running
-        // 2. We are ACTIVE global state
-        if (cntx->IsRunning() && ((*ServerState::tlocal()).gstate() == GlobalState::ACTIVE)) {
-          LOG(DFATAL) << "ExecuteTx() on replica should be successful.";
+        if (EngineShard::tlocal() && EngineShard::tlocal()->journal()) {
+          // We must register this entry to the journal to allow partial sync
+          // if journal is active.
+          journal::RecordEntry(0, journal::Op::PING, 0, nullopt, {});
         }
+      } else {
+        ApplyTx(std::move(tx_data), cntx);
       }
     }
 
+    // Do not wait for the socket with unapplied records.
+    if (!apply_batch_.empty() &&
+        (apply_batch_.size() >= batch_limit || !reader.HasBufferedInput())) {
+      ApplyBatch(cntx);
+    }
+
     shard_replica_waker_.notifyAll();
   }
 }
 
+void DflyShardReplica::ApplyTx(TransactionData&& tx_data, ExecutionState* cntx) {
+  const bool is_successful = ExecuteTx(std::move(tx_data), cntx);
+  if (is_successful) {
+    // We only increment upon successful execution of the transaction.
+    // The reason for this is that during partial sync we sent this
+    // number as the lsn number to resume from. However, if for example
+    // we increment this when a command fails (because the context
+    // got cancelled, e.g, replication connection broke), we will get
+    // inconsistent data because the replica will resume from the next
+    // lsn of the master and this lsn entry will be lost.
+    journal_rec_executed_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    // We only report DFATAL:
+    // 1. Context is running
+    // 2. We are ACTIVE global state
+    if (cntx->IsRunning() && ((*ServerState::tlocal()).gstate() == GlobalState::ACTIVE)) {
+      LOG(DFATAL) << "ExecuteTx() on replica should be successful.";
+    }
+  }
+}
+
+void DflyShardReplica::ApplyBatch(ExecutionState* cntx) {
+  vector<journal::ParsedEntry::CmdData*> cmds;
+  vector<string> errors;
+  size_t pos = 0;
+  while (pos < apply_batch_.size() && cntx->IsRunning()) {
+    // Squash the run of records that share the db index.
+    DbIndex dbid = apply_batch_[pos].dbid;
+    cmds.clear();
+    for (size_t i = pos; i < apply_batch_.size() && apply_batch_[i].dbid == dbid; ++i)
+      cmds.push_back(&apply_batch_[i].command);
+
+    errors.clear();
+    size_t executed = executor_->ExecuteBatch(dbid, cmds, &errors);
+    if (executed == 0) {
+      // Not squashable, apply the record on its own.
+      ApplyTx(std::move(apply_batch_[pos]), cntx);
+      ++pos;
+      continue;
+    }
+
+    // Squashed commands are not swapped into a command context, so they are still intact here.
+    for (size_t i = 0; i < executed; ++i)
+      facade::Connection::LogReplicaCommand(*cmds[i], dbid);
+
+    // Same as ApplyTx: only OOM fails the dispatch of a record, other errors are just logged.
+    size_t failed = 0;
+    for (const string& error : errors) {
+      LOG_EVERY_T(WARNING, 1) << "Replicated command failed in squashed batch: " << error;
+      failed += error == facade::kOutOfMemory;
+    }
+    if (failed > 0 && cntx->IsRunning() &&
+        ServerState::tlocal()->gstate() == GlobalState::ACTIVE) {
+      LOG(DFATAL) << "ExecuteBatch() on replica should be successful, " << failed << " failed.";
+    }
+    journal_rec_executed_.fetch_add(executed - failed, std::memory_order_relaxed);
+    pos += executed;
+  }
+  apply_batch_.clear();
+}
+
 void Replica::RedisStreamAcksFb() {
   constexpr size_t kAckRecordMaxInterval = 1024;
   std::chrono::duration ack_time_max_interval =
@@ -68,7 +68,7 @@ class Replica : ProtocolClient {
   // Sets the server state to have replication enabled.
   // It is like Start(), but does not attempt to establish
   // a connection right-away, but instead lets MainReplicationFb do the work.
-  void EnableReplication();
+  void EnableReplication(std::optional<LastMasterSyncData> data = std::nullopt);
 
   std::optional<LastMasterSyncData> Stop();  // thread-safe
 
@@ -249,6 +249,13 @@ class DflyShardReplica : public ProtocolClient {
   // or on context cancellation return false.
   bool ExecuteTx(TransactionData&& tx_data, ExecutionState* cntx);
 
+  // Executes a single record and accounts it in journal_rec_executed_.
+  void ApplyTx(TransactionData&& tx_data, ExecutionState* cntx);
+
+  // Applies the records collected in apply_batch_ in order, squashing consecutive single shard
+  // commands into shared hops.
+  void ApplyBatch(ExecutionState* cntx);
+
   uint32_t FlowId() const;
 
   uint64_t JournalExecutedCount() const {
@@ -273,6 +280,9 @@ class DflyShardReplica : public ProtocolClient {
   std::unique_ptr<JournalExecutor> executor_;
   std::unique_ptr<RdbLoader> rdb_loader_;
 
+  // Independent records read by StableSyncDflyReadFb that are not applied yet.
+  std::vector<TransactionData> apply_batch_;
+
   // The master instance has a LSN for each journal record. This counts
   // the number of journal records executed in this flow plus the initial
   // journal offset that we received in the transition from full sync
@@ -36,6 +36,7 @@ struct ReplicaSummary {
 struct LastMasterSyncData {
   std::string id;
   std::vector<LSN> last_journal_LSNs;  // lsn for each master shard.
+  bool seeded = false;                 // loaded from a snapshot of the master on startup
 };
 
 }  // namespace dfly
@@ -4,8 +4,11 @@
 
 #include "server/search/aggregator.h"
 
+#include <absl/strings/str_cat.h>
+
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "base/logging.h"
 #include "server/search/doc_index.h"
@@ -20,19 +23,23 @@ namespace {
 
 using ValuesList = absl::FixedArray<Value>;
 
+// Value of field or monostate if not present. NaN is normalized to monostate so that NaN values
+// group together.
+Value ExtractFieldValue(const DocValues& dv, std::string_view field) {
+  auto it = dv.find(field);
+  if (it == dv.end())
+    return Value{};
+
+  const Value& v = it->second;
+  if (std::holds_alternative<double>(v) && std::isnan(std::get<double>(v)))
+    return Value{};
+  return v;
+}
+
 ValuesList ExtractFieldsValues(const DocValues& dv, absl::Span<const std::string> fields) {
   ValuesList out(fields.size());
-  for (size_t i = 0; i < fields.size(); i++) {
-    auto it = dv.find(fields[i]);
-    if (it != dv.end()) {
-      const Value& v = it->second;
-      // Normalize NaN to monostate so that NaN values group together.
-      if (std::holds_alternative<double>(v) && std::isnan(std::get<double>(v)))
-        out[i] = Value{};
-      else
-        out[i] = v;
-    }
-  }
+  for (size_t i = 0; i < fields.size(); i++)
+    out[i] = ExtractFieldValue(dv, fields[i]);
   return out;
 }
 
@@ -46,6 +53,44 @@ DocValues PackFields(ValuesList values, absl::Span<const std::string> fields) {
 
 const Value kEmptyValue = Value{};
 
+// Reducer state that is used by a reducer function
+enum class StateKind { NONE, SUM, VALUES };
+
+StateKind GetStateKind(ReducerFunc func) {
+  switch (func) {
+    case ReducerFunc::COUNT:
+      return StateKind::NONE;
+    case ReducerFunc::SUM:
+    case ReducerFunc::AVG:
+      return StateKind::SUM;
+    case ReducerFunc::COUNT_DISTINCT:
+    case ReducerFunc::MAX:
+    case ReducerFunc::MIN:
+      return StateKind::VALUES;
+  }
+  return StateKind::NONE;
+}
+
+constexpr size_t kNoState = std::numeric_limits<size_t>::max();
+
+std::string_view ReducerFuncName(ReducerFunc func) {
+  switch (func) {
+    case ReducerFunc::COUNT:
+      return "COUNT";
+    case ReducerFunc::COUNT_DISTINCT:
+      return "COUNT_DISTINCT";
+    case ReducerFunc::SUM:
+      return "SUM";
+    case ReducerFunc::AVG:
+      return "AVG";
+    case ReducerFunc::MAX:
+      return "MAX";
+    case ReducerFunc::MIN:
+      return "MIN";
+  }
+  return "";
+}
+
 }  // namespace
 
 void Aggregator::DoGroup(absl::Span<const std::string> fields, absl::Span<const Reducer> reducers) {
@@ -230,6 +275,210 @@ Reducer::Func FindReducerFunc(ReducerFunc name) {
   return nullptr;
 }
 
+void ReducerState::Update(ReducerFunc func, const Value& value, int delta) {
+  switch (GetStateKind(func)) {
+    case StateKind::NONE:
+      break;
+    case StateKind::SUM:
+      if (std::holds_alternative<double>(value) && std::isfinite(std::get<double>(value))) {
+        sum += delta * std::get<double>(value);
+        count += delta;
+        if (count == 0)
+          sum = 0;  // Drop rounding errors accumulated by removals
+      }
+      break;
+    case StateKind::VALUES:
+      if (delta > 0) {
+        values[value]++;
+      } else if (auto it = values.find(value); it != values.end() && --it->second == 0) {
+        values.erase(it);
+      }
+      break;
+  }
+}
+
+void ReducerState::Merge(const ReducerState& other) {
+  sum += other.sum;
+  count += other.count;
+  for (const auto& [value, docs] : other.values)
+    values[value] += docs;
+}
+
+Value ReducerState::Result(ReducerFunc func, size_t docs) const {
+  // monostate is the smallest value, MIN and MAX skip it like their reducer functions
+  auto first = values.begin();
+  if (first != values.end() && std::holds_alternative<std::monostate>(first->first))
+    ++first;
+
+  switch (func) {
+    case ReducerFunc::COUNT:
+      return static_cast<double>(docs);
+    case ReducerFunc::COUNT_DISTINCT:
+      return static_cast<double>(values.size());
+    case ReducerFunc::SUM:
+      return sum;
+    case ReducerFunc::AVG:
+      return count > 0 ? Value{sum / count} : Value{};
+    case ReducerFunc::MIN:
+      return first != values.end() ? first->first : Value{};
+    case ReducerFunc::MAX:
+      return first != values.end() ? values.rbegin()->first : Value{};
+  }
+  return Value{};
+}
+
+MaterializedAggregate::MaterializedAggregate(GroupParams params) : params_{std::move(params)} {
+}
+
+std::vector<std::string_view> MaterializedAggregate::NeededFields() const {
+  std::vector<std::string_view> out{params_.fields.begin(), params_.fields.end()};
+  for (const auto& reducer : params_.reducers) {
+    if (GetStateKind(reducer.func) != StateKind::NONE)
+      out.push_back(reducer.source_field);
+  }
+  rng::sort(out);
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}
+
+void MaterializedAggregate::Add(const DocValues& doc) {
+  Update(doc, 1);
+}
+
+void MaterializedAggregate::Remove(const DocValues& doc) {
+  Update(doc, -1);
+}
+
+void MaterializedAggregate::Clear() {
+  groups_.clear();
+}
+
+void MaterializedAggregate::Update(const DocValues& doc, int delta) {
+  GroupKey key(params_.fields.size());
+  for (size_t i = 0; i < key.size(); i++)
+    key[i] = ExtractFieldValue(doc, params_.fields[i]);
+
+  auto it = groups_.find(key);
+  if (it == groups_.end()) {
+    if (delta < 0)
+      return;
+    it = groups_.emplace(std::move(key), GroupState{}).first;
+    it->second.reducers.resize(params_.reducers.size());
+  }
+
+  GroupState& group = it->second;
+  for (size_t i = 0; i < params_.reducers.size(); i++) {
+    const auto& reducer = params_.reducers[i];
+    group.reducers[i].Update(reducer.func, ExtractFieldValue(doc, reducer.source_field), delta);
+  }
+
+  group.docs += delta;
+  if (group.docs == 0)
+    groups_.erase(it);
+}
+
+std::optional<std::vector<size_t>> MaterializedAggregate::Match(const GroupParams& query) const {
+  if (query.fields != params_.fields)
+    return std::nullopt;
+
+  std::vector<size_t> out;
+  out.reserve(query.reducers.size());
+  for (const auto& reducer : query.reducers) {
+    StateKind kind = GetStateKind(reducer.func);
+    if (kind == StateKind::NONE) {
+      out.push_back(kNoState);
+      continue;
+    }
+
+    auto it = rng::find_if(params_.reducers, [&](const auto& own) {
+      return GetStateKind(own.func) == kind && own.source_field == reducer.source_field;
+    });
+    if (it == params_.reducers.end())
+      return std::nullopt;
+    out.push_back(it - params_.reducers.begin());
+  }
+  return out;
+}
+
+PartialGroups MaterializedAggregate::Snapshot(const GroupParams& query,
+                                              absl::Span<const size_t> reducers) const {
+  DCHECK_EQ(query.reducers.size(), reducers.size());
+
+  PartialGroups out;
+  out.reserve(groups_.size());
+  for (const auto& [key, group] : groups_) {
+    GroupState state{group.docs, std::vector<ReducerState>(reducers.size())};
+    for (size_t i = 0; i < reducers.size(); i++) {
+      if (reducers[i] == kNoState)
+        continue;
+
+      const ReducerState& own = group.reducers[reducers[i]];
+      ReducerState& copy = state.reducers[i];
+      switch (query.reducers[i].func) {
+        case ReducerFunc::MIN:
+        case ReducerFunc::MAX: {
+          Value value = own.Result(query.reducers[i].func, group.docs);
+          if (!std::holds_alternative<std::monostate>(value))
+            copy.values.emplace(std::move(value), 1);
+          break;
+        }
+        default:
+          copy = own;
+      }
+    }
+    out.emplace_back(key, std::move(state));
+  }
+  return out;
+}
+
+std::vector<DocValues> MergePartialGroups(const GroupParams& query,
+                                          std::vector<PartialGroups> shards) {
+  absl::flat_hash_map<GroupKey, GroupState> groups;
+  for (auto& shard : shards) {
+    for (auto& [key, state] : shard) {
+      auto [it, inserted] = groups.try_emplace(std::move(key));
+      if (inserted) {
+        it->second = std::move(state);
+        continue;
+      }
+
+      it->second.docs += state.docs;
+      for (size_t i = 0; i < state.reducers.size(); i++)
+        it->second.reducers[i].Merge(state.reducers[i]);
+    }
+  }
+
+  std::vector<DocValues> out;
+  out.reserve(groups.size());
+  for (auto& [key, state] : groups) {
+    DocValues doc;
+    for (size_t i = 0; i < query.fields.size(); i++)
+      doc[query.fields[i]] = key[i];
+    for (size_t i = 0; i < query.reducers.size(); i++) {
+      const auto& reducer = query.reducers[i];
+      doc[reducer.result_field] = state.reducers[i].Result(reducer.func, state.docs);
+    }
+    out.push_back(std::move(doc));
+  }
+  return out;
+}
+
+std::string GroupParamsToArgs(const GroupParams& params) {
+  std::string out = absl::StrCat("GROUPBY ", params.fields.size());
+  for (const auto& field : params.fields)
+    absl::StrAppend(&out, " @", field);
+
+  for (const auto& reducer : params.reducers) {
+    absl::StrAppend(&out, " REDUCE ", ReducerFuncName(reducer.func));
+    if (reducer.source_field.empty())
+      absl::StrAppend(&out, " 0");
+    else
+      absl::StrAppend(&out, " 1 @", reducer.source_field);
+    absl::StrAppend(&out, " AS ", reducer.result_field);
+  }
+  return out;
+}
+
 AggregationStep MakeGroupStep(std::vector<std::string> fields, std::vector<Reducer> reducers) {
   return [fields = std::move(fields), reducers = std::move(reducers)](Aggregator* aggregator) {
     aggregator->DoGroup(fields, reducers);
@@ -246,7 +495,17 @@ AggregationStep MakeLimitStep(size_t offset, size_t num) {
 
 void Aggregator::DoFilter(const FilterExprNode& expr) {
   auto& values = result.values;
-  std::erase_if(values, [&](const DocValues& doc) { return !IsTruthy(EvalFilterExpr(expr, doc)); });
+  std::vector<bool> keep = EvalFilterExprMask(expr, values);
+
+  size_t kept = 0;
+  for (size_t i = 0; i < values.size(); i++) {
+    if (!keep[i])
+      continue;
+    if (kept != i)
+      values[kept] = std::move(values[i]);
+    kept++;
+  }
+  values.resize(kept);
 }
 
 std::variant<AggregationStep, std::string> MakeFilterStep(std::string_view raw_expr) {
@@ -267,9 +526,10 @@ std::variant<AggregationStep, std::string> MakeApplyStep(std::string_view raw_ex
 
   auto shared = std::shared_ptr<FilterExprNode>(std::get<FilterExpr>(std::move(parsed)).release());
   return AggregationStep{[shared, alias = std::move(alias)](Aggregator* agg) {
-    for (auto& doc : agg->result.values) {
-      doc[alias] = EvalFilterExpr(*shared, doc);
-    }
+    auto& values = agg->result.values;
+    std::vector<Value> results = EvalFilterExprBatch(*shared, values);
+    for (size_t i = 0; i < values.size(); i++)
+      values[i][alias] = std::move(results[i]);
     agg->result.fields_to_print.insert(alias);
   }};
 }
@@ -4,10 +4,12 @@
 
 #pragma once
 
+#include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
 #include <absl/types/span.h>
 
+#include <optional>
 #include <string>
 #include <variant>
 #include <vector>
@@ -113,6 +115,88 @@ enum class ReducerFunc { COUNT, COUNT_DISTINCT, SUM, AVG, MAX, MIN };
 // Find reducer function by uppercase name (COUNT, MAX, etc...), empty functor if not found
 Reducer::Func FindReducerFunc(ReducerFunc name);
 
+// GROUPBY fields with REDUCE steps as parsed, used to match materialized aggregations
+struct GroupParams {
+  struct ReducerParams {
+    ReducerFunc func;
+    std::string source_field, result_field;
+  };
+
+  std::vector<std::string> fields;
+  std::vector<ReducerParams> reducers;
+};
+
+// Reducer state of a single group that can be updated incrementally and merged across shards
+struct ReducerState {
+  // Add (delta = 1) or remove (delta = -1) the value of a document
+  void Update(ReducerFunc func, const Value& value, int delta);
+  void Merge(const ReducerState& other);
+
+  // Same result as the reducer function applied to all values of the group
+  Value Result(ReducerFunc func, size_t docs) const;
+
+  // SUM, AVG: sum and count of finite numeric values
+  double sum = 0;
+  size_t count = 0;
+
+  // MIN, MAX, COUNT_DISTINCT: number of documents per value, NaN is stored as monostate
+  absl::btree_map<Value, size_t> values;
+};
+
+struct GroupState {
+  size_t docs = 0;
+  std::vector<ReducerState> reducers;
+};
+
+using GroupKey = std::vector<Value>;
+
+// Groups of a single shard, reducer states are ordered as reducers of the query
+using PartialGroups = std::vector<std::pair<GroupKey, GroupState>>;
+
+// GROUPBY with reducers over all documents of an index, kept up to date as documents are added
+// and removed, so that repeated aggregations don't have to load every document.
+class MaterializedAggregate {
+ public:
+  explicit MaterializedAggregate(GroupParams params);
+
+  const GroupParams& params() const {
+    return params_;
+  }
+
+  // Group fields and reducer sources, documents passed to Add and Remove must contain them
+  std::vector<std::string_view> NeededFields() const;
+
+  void Add(const DocValues& doc);
+  void Remove(const DocValues& doc);
+  void Clear();
+
+  // Map reducers of `query` to reducers of this aggregation, nullopt if it can't answer `query`.
+  // COUNT is always answered, AVG and SUM as well as MIN, MAX and COUNT_DISTINCT share states.
+  std::optional<std::vector<size_t>> Match(const GroupParams& query) const;
+
+  // States of all groups with reducers picked by Match(). MIN and MAX states keep only the
+  // extreme value, so the result size depends on the number of groups and distinct values only.
+  PartialGroups Snapshot(const GroupParams& query, absl::Span<const size_t> reducers) const;
+
+  size_t NumGroups() const {
+    return groups_.size();
+  }
+
+ private:
+  void Update(const DocValues& doc, int delta);
+
+  GroupParams params_;
+  absl::flat_hash_map<GroupKey, GroupState> groups_;
+};
+
+// Merge groups of all shards and apply reducers of `query`. The result is the same as that of
+// the GROUPBY step over all documents.
+std::vector<DocValues> MergePartialGroups(const GroupParams& query,
+                                          std::vector<PartialGroups> shards);
+
+// Arguments of `params` starting with GROUPBY as FT.AGGCREATE takes them
+std::string GroupParamsToArgs(const GroupParams& params);
+
 // Make `GROUPBY [fields...]`  with REDUCE step
 AggregationStep MakeGroupStep(std::vector<std::string> fields, std::vector<Reducer> reducers);
 
@@ -4,6 +4,7 @@
 
 #include "server/search/aggregator.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "base/gtest.h"
@@ -110,4 +111,66 @@ TEST(AggregatorTest, GroupWithReduce) {
   EXPECT_EQ(result.values[1].at("distinct-null"), Value{(double)1});
 }
 
+// Materialized aggregations split over shards give the same groups as GROUPBY over the
+// remaining documents, after some of them were removed
+TEST(AggregatorTest, MaterializedMatchesGroup) {
+  using RF = ReducerFunc;
+  GroupParams params{{"tag"},
+                     {{RF::COUNT, "", "count"},
+                      {RF::SUM, "i", "sum"},
+                      {RF::MAX, "i", "max"},
+                      {RF::COUNT_DISTINCT, "s", "distinct"}}};
+
+  // Query reducers are answered by states of registered ones with the same source
+  GroupParams query = params;
+  query.reducers.push_back({RF::AVG, "i", "avg"});
+  query.reducers.push_back({RF::MIN, "i", "min"});
+  query.reducers.push_back({RF::MIN, "s", "min-s"});
+
+  std::vector<DocValues> docs;
+  for (size_t i = 0; i < 200; i++) {
+    DocValues doc{{"tag", std::to_string(i % 7)}, {"s", std::to_string(i % 5)}};
+    if (i % 3 != 0)
+      doc["i"] = double(i % 11);
+    if (i % 13 == 0)
+      doc["i"] = std::nan("");
+    docs.push_back(std::move(doc));
+  }
+
+  std::vector<MaterializedAggregate> shards(3, MaterializedAggregate{params});
+  for (size_t i = 0; i < docs.size(); i++)
+    shards[i % shards.size()].Add(docs[i]);
+
+  // Remove every fourth document
+  std::vector<DocValues> remaining;
+  for (size_t i = 0; i < docs.size(); i++) {
+    if (i % 4 == 0)
+      shards[i % shards.size()].Remove(docs[i]);
+    else
+      remaining.push_back(docs[i]);
+  }
+
+  EXPECT_FALSE(shards[0].Match(GroupParams{{"other"}, {}}));
+  EXPECT_FALSE(shards[0].Match(GroupParams{{"tag"}, {{RF::SUM, "s", "sum-s"}}}));
+
+  std::vector<PartialGroups> partials;
+  for (const auto& shard : shards) {
+    auto reducers = shard.Match(query);
+    ASSERT_TRUE(reducers);
+    partials.push_back(shard.Snapshot(query, *reducers));
+  }
+  auto merged = MergePartialGroups(query, std::move(partials));
+
+  std::vector<Reducer> reducers;
+  for (const auto& reducer : query.reducers)
+    reducers.push_back({reducer.source_field, reducer.result_field, FindReducerFunc(reducer.func)});
+  StepsList steps = {MakeGroupStep(query.fields, std::move(reducers))};
+  auto expected = Process(remaining, {}, steps).values;
+
+  auto by_tag = [](const DocValues& l, const DocValues& r) { return l.at("tag") < r.at("tag"); };
+  std::sort(merged.begin(), merged.end(), by_tag);
+  std::sort(expected.begin(), expected.end(), by_tag);
+  EXPECT_EQ(merged, expected);
+}
+
 }  // namespace dfly::aggregate
@@ -0,0 +1,305 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/search/disk_vector_store.h"
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+
+#include "base/flags.h"
+#include "base/logging.h"
+#include "strings/human_readable.h"
+#include "util/fibers/synchronization.h"
+
+#ifdef WITH_TIERING
+#include "server/tiering/common.h"
+#include "server/tiering/disk_storage.h"
+#include "util/fibers/proactor_base.h"
+#endif
+
+ABSL_FLAG(strings::MemoryBytesFlag, search_disk_vectors_max_file_size, 64ULL << 30,
+          "Maximum size of a file with full precision vectors of a DISK vector index, per index "
+          "field and shard. Files are created next to the tiered storage files.");
+
+ABSL_DECLARE_FLAG(std::string, tiered_prefix);
+
+namespace dfly {
+
+using namespace std;
+
+#ifdef WITH_TIERING
+
+namespace {
+
+using namespace tiering::literals;
+using search::DocId;
+using tiering::DiskSegment;
+
+// Vectors are appended to blocks of about kBlockSize bytes. A block is written to disk once it is
+// full and freed once all its vectors are removed. A single vector is read with the pages it
+// spans, all reads of a query are issued together.
+constexpr size_t kBlockSize = 64_KB;
+
+class DiskVectorStore : public search::VectorStore {
+ public:
+  explicit DiskVectorStore(size_t vector_size)
+      : vector_size_{vector_size},
+        slots_per_block_{max<size_t>(1, kBlockSize / vector_size)},
+        block_bytes_{(slots_per_block_ * vector_size + tiering::kPageSize - 1) /
+                     tiering::kPageSize * tiering::kPageSize},
+        storage_{absl::GetFlag(FLAGS_search_disk_vectors_max_file_size)} {
+  }
+
+  ~DiskVectorStore() override {
+    if (opened_)
+      storage_.Close();  // waits for pending stashes, their callbacks access blocks_
+  }
+
+  error_code Open(string_view path) {
+    error_code ec = storage_.Open(path);
+    opened_ = !ec;
+    return ec;
+  }
+
+  void Add(DocId id, const void* vector) override;
+  void Remove(DocId id) override;
+  void Fetch(absl::Span<const DocId> ids, absl::FunctionRef<void(DocId, const void*)> cb) override;
+
+ private:
+  struct Block {
+    DiskSegment segment;  // Valid once written to disk
+    string bytes;         // Contents until written to disk
+    uint32_t used = 0;    // Number of slots filled so far
+    uint32_t live = 0;    // Number of vectors that were not removed
+    bool stashing = false;
+  };
+
+  struct Location {
+    uint32_t block, slot;
+  };
+
+  uint32_t AllocateBlock();
+  void ReleaseBlock(uint32_t block_id);
+
+  // Write full blocks that are still in memory. Blocks stay in memory if the file has to grow.
+  void StashFullBlocks();
+  void OnStashed(uint32_t block_id, DiskSegment segment, error_code ec);
+
+  // Mark segment as free, deferred while reads are in flight as they could read reused space
+  void FreeSegment(DiskSegment segment);
+
+  const size_t vector_size_, slots_per_block_, block_bytes_;
+
+  tiering::DiskStorage storage_;
+  bool opened_ = false;  // Close() works only after a successful Open()
+  vector<Block> blocks_;
+  vector<uint32_t> free_blocks_;
+  optional<uint32_t> open_block_;   // Block that new vectors are appended to
+  vector<uint32_t> full_blocks_;    // Full blocks waiting to be written to disk
+  absl::flat_hash_map<DocId, Location> locations_;
+
+  unsigned reads_in_flight_ = 0;
+  vector<DiskSegment> deferred_frees_;
+};
+
+uint32_t DiskVectorStore::AllocateBlock() {
+  uint32_t block_id;
+  if (free_blocks_.empty()) {
+    block_id = blocks_.size();
+    blocks_.emplace_back();
+  } else {
+    block_id = free_blocks_.back();
+    free_blocks_.pop_back();
+  }
+  blocks_[block_id].bytes.reserve(block_bytes_);
+  return block_id;
+}
+
+void DiskVectorStore::ReleaseBlock(uint32_t block_id) {
+  blocks_[block_id] = Block{};
+  free_blocks_.push_back(block_id);
+}
+
+void DiskVectorStore::Add(DocId id, const void* vector) {
+  Remove(id);
+
+  if (!open_block_)
+    open_block_ = AllocateBlock();
+
+  Block& block = blocks_[*open_block_];
+  locations_[id] = {*open_block_, block.used++};
+  block.live++;
+  block.bytes.append(static_cast<const char*>(vector), vector_size_);
+
+  if (block.used == slots_per_block_) {
+    block.bytes.resize(block_bytes_);
+    full_blocks_.push_back(*open_block_);
+    open_block_.reset();
+    StashFullBlocks();
+  }
+}
+
+void DiskVectorStore::Remove(DocId id) {
+  auto it = locations_.find(id);
+  if (it == locations_.end())
+    return;
+
+  uint32_t block_id = it->second.block;
+  locations_.erase(it);
+
+  Block& block = blocks_[block_id];
+  if (--block.live > 0 || open_block_ == block_id || block.stashing)
+    return;  // Stashed blocks are released by OnStashed
+
+  if (block.bytes.empty()) {
+    FreeSegment(block.segment);
+  } else if (auto it = find(full_blocks_.begin(), full_blocks_.end(), block_id);
+             it != full_blocks_.end()) {
+    full_blocks_.erase(it);
+  }
+  ReleaseBlock(block_id);
+}
+
+void DiskVectorStore::StashFullBlocks() {
+  while (!full_blocks_.empty()) {
+    uint32_t block_id = full_blocks_.back();
+    auto prepared = storage_.PrepareStash(block_bytes_);
+    if (!prepared) {
+      VLOG(1) << "Could not stash vectors: " << prepared.error().message();
+      return;  // Retry with the next full block or query
+    }
+
+    auto [offset, buf] = *prepared;
+    memcpy(buf.bytes.data(), blocks_[block_id].bytes.data(), block_bytes_);
+    blocks_[block_id].stashing = true;
+    full_blocks_.pop_back();
+
+    DiskSegment segment{offset, block_bytes_};
+    storage_.Stash(segment, buf, [this, block_id, segment](error_code ec) {
+      OnStashed(block_id, segment, ec);
+    });
+  }
+}
+
+void DiskVectorStore::OnStashed(uint32_t block_id, DiskSegment segment, error_code ec) {
+  Block& block = blocks_[block_id];
+  block.stashing = false;
+
+  if (ec) {  // DiskStorage already freed the segment, keep the block in memory and retry later
+    LOG_EVERY_T(ERROR, 1) << "Failed to stash vectors: " << ec.message();
+    if (block.live == 0)
+      ReleaseBlock(block_id);
+    else
+      full_blocks_.push_back(block_id);
+    return;
+  }
+
+  if (block.live == 0) {
+    FreeSegment(segment);
+    ReleaseBlock(block_id);
+    return;
+  }
+
+  block.segment = segment;
+  string{}.swap(block.bytes);
+}
+
+void DiskVectorStore::FreeSegment(DiskSegment segment) {
+  if (reads_in_flight_ > 0)
+    deferred_frees_.push_back(segment);
+  else
+    storage_.MarkAsFree(segment);
+}
+
+void DiskVectorStore::Fetch(absl::Span<const DocId> ids,
+                            absl::FunctionRef<void(DocId, const void*)> cb) {
+  StashFullBlocks();
+
+  struct Read {
+    DocId id;
+    DiskSegment pages;  // Pages that contain the vector
+    size_t skip;        // Offset of the vector in the pages
+    string vector;      // Empty if reading failed
+  };
+  vector<Read> reads;
+
+  for (DocId id : ids) {
+    auto it = locations_.find(id);
+    if (it == locations_.end())
+      continue;
+
+    const Block& block = blocks_[it->second.block];
+    size_t offset = it->second.slot * vector_size_;
+    if (!block.bytes.empty()) {
+      cb(id, block.bytes.data() + offset);
+      continue;
+    }
+
+    // Vectors can cross page boundaries, so the range is aligned on both ends
+    size_t start = block.segment.offset + offset;
+    size_t first_page = start / tiering::kPageSize * tiering::kPageSize;
+    auto pages = DiskSegment{first_page, start + vector_size_ - first_page}.ContainingPages();
+    reads.push_back({id, pages, start - first_page, {}});
+  }
+
+  if (reads.empty())
+    return;
+
+  // Blocks can be removed while the fiber waits, so the results are copied into `reads`
+  util::fb2::BlockingCounter bc{unsigned(reads.size())};
+  reads_in_flight_++;
+  for (Read& read : reads) {
+    storage_.Read(read.pages, [this, &read, bc](io::Result<string_view> res) mutable {
+      if (res)
+        read.vector.assign(res->substr(read.skip, vector_size_));
+      else
+        LOG_EVERY_T(ERROR, 1) << "Failed to read vector: " << res.error().message();
+      bc->Dec();
+    });
+  }
+  bc->Wait();
+
+  if (--reads_in_flight_ == 0) {
+    for (DiskSegment segment : deferred_frees_)
+      storage_.MarkAsFree(segment);
+    deferred_frees_.clear();
+  }
+
+  for (const Read& read : reads) {
+    if (!read.vector.empty())
+      cb(read.id, read.vector.data());
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<search::VectorStore> OpenDiskVectorStore(size_t vector_size) {
+  string prefix = absl::GetFlag(FLAGS_tiered_prefix);
+  auto* proactor = util::fb2::ProactorBase::me();
+  if (prefix.empty() || proactor->GetKind() != util::fb2::ProactorBase::IOURING)
+    return nullptr;
+
+  // Files are unique per store and removed when it is closed
+  thread_local unsigned store_counter = 0;
+  string path = absl::StrCat(prefix, "-", absl::Dec(proactor->GetPoolIndex(), absl::kZeroPad4),
+                             "-vec", store_counter++, ".dts");
+
+  auto store = make_unique<DiskVectorStore>(vector_size);
+  if (auto ec = store->Open(path); ec) {
+    LOG(ERROR) << "Could not open " << path << " for DISK vector index, keeping vectors in "
+               << "memory: " << ec.message();
+    return nullptr;
+  }
+  return store;
+}
+
+#else
+
+std::unique_ptr<search::VectorStore> OpenDiskVectorStore(size_t vector_size) {
+  return nullptr;
+}
+
+#endif
+
+}  // namespace dfly
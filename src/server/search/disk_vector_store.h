@@ -0,0 +1,18 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#pragma once
+
+#include <memory>
+
+#include "core/search/indices.h"
+
+namespace dfly {
+
+// Opens a store that keeps the full precision vectors of a DISK vector index in a file of the
+// tiered storage directory, using the tiering DiskStorage. Must be called on a shard thread.
+// Returns nullptr if tiered storage is not configured, the index keeps vectors in memory then.
+std::unique_ptr<search::VectorStore> OpenDiskVectorStore(size_t vector_size);
+
+}  // namespace dfly
@@ -0,0 +1,107 @@
+// Copyright 2026, DragonflyDB authors.  All rights reserved.
+// See LICENSE for licensing terms.
+//
+
+#include "server/search/disk_vector_store.h"
+
+#include <absl/flags/reflection.h>
+
+#include <map>
+
+#include "base/flags.h"
+#include "base/gtest.h"
+#include "base/logging.h"
+#include "server/tiering/test_common.h"
+#include "util/fibers/fibers.h"
+
+ABSL_DECLARE_FLAG(std::string, tiered_prefix);
+
+namespace dfly {
+
+using namespace std;
+using namespace util;
+using search::DocId;
+
+// Vectors of 4KB fill blocks of 16 vectors, so that they are written to disk quickly.
+constexpr size_t kVectorSize = 4096;
+
+class DiskVectorStoreTest : public tiering::PoolTestBase {
+ protected:
+  static string Vector(DocId id, char gen) {
+    return string(kVectorSize, char('a' + (id + gen) % 26));
+  }
+
+  // Fetches ids and returns the vectors found.
+  static map<DocId, string> Fetch(search::VectorStore* store, const vector<DocId>& ids) {
+    map<DocId, string> res;
+    store->Fetch(ids, [&](DocId id, const void* vec) {
+      res[id].assign(static_cast<const char*>(vec), kVectorSize);
+    });
+    return res;
+  }
+
+  absl::FlagSaver fs_;
+};
+
+TEST_F(DiskVectorStoreTest, AddFetchRemove) {
+  absl::SetFlag(&FLAGS_tiered_prefix, "disk_vector_store_test");
+
+  pp_->at(0)->Await([] {
+    auto store = OpenDiskVectorStore(kVectorSize);
+    ASSERT_TRUE(store);
+
+    vector<DocId> ids;
+    for (DocId id = 0; id < 64; id++) {
+      store->Add(id, Vector(id, 0).data());
+      ids.push_back(id);
+    }
+
+    // The first fetch writes the full blocks, the following one reads them from disk
+    for (unsigned i = 0; i < 2; i++) {
+      auto res = Fetch(store.get(), ids);
+      ASSERT_EQ(res.size(), ids.size());
+      for (DocId id : ids)
+        EXPECT_EQ(res[id], Vector(id, 0)) << id;
+      ThisFiber::SleepFor(20ms);
+    }
+
+    // Remove the first block while it is read, its space must be freed only after the read
+    vector<DocId> first_block(ids.begin(), ids.begin() + 16);
+    map<DocId, string> in_flight;
+    fb2::Fiber reader{[&] { in_flight = Fetch(store.get(), first_block); }};
+    ThisFiber::Yield();
+    for (DocId id : first_block)
+      store->Remove(id);
+
+    // Re-add the recycled ids with other vectors, they reuse the freed space once written
+    for (DocId id : first_block)
+      store->Add(id, Vector(id, 1).data());
+    reader.Join();
+
+    ASSERT_EQ(in_flight.size(), first_block.size());
+    for (DocId id : first_block)
+      EXPECT_EQ(in_flight[id], Vector(id, 0)) << id;
+
+    for (unsigned i = 0; i < 2; i++) {
+      auto res = Fetch(store.get(), ids);
+      ASSERT_EQ(res.size(), ids.size());
+      for (DocId id : ids)
+        EXPECT_EQ(res[id], Vector(id, id < 16 ? 1 : 0)) << id;
+      ThisFiber::SleepFor(20ms);
+    }
+
+    // Removed vectors are not returned
+    for (DocId id = 16; id < 32; id++)
+      store->Remove(id);
+    EXPECT_TRUE(Fetch(store.get(), {16, 20, 31}).empty());
+  });
+}
+
+TEST_F(DiskVectorStoreTest, OpenFailure) {
+  absl::SetFlag(&FLAGS_tiered_prefix, "/non-existing-dir/disk_vector_store_test");
+
+  // Vectors are kept in memory then
+  pp_->at(0)->Await([] { EXPECT_FALSE(OpenDiskVectorStore(kVectorSize)); });
+}
+
+}  // namespace dfly
@@ -479,6 +479,87 @@ void JsonAccessor::RemoveFieldFromCache(string_view field) {
 thread_local absl::flat_hash_map<std::string, std::unique_ptr<JsonAccessor::JsonPathContainer>>
     JsonAccessor::path_cache_;
 
+SnapshotAccessor::SnapshotAccessor(const BaseAccessor& doc, const search::Schema& schema) {
+  auto copy = [](optional<StringList> list) -> Strings {
+    if (!list)
+      return nullopt;
+    return vector<string>(list->begin(), list->end());
+  };
+
+  // Capture only what the indices of each field type read
+  for (const auto& [fident, field] : schema.fields) {
+    FieldValues& values = fields_[fident];
+    bool sortable = field.flags & search::SchemaField::SORTABLE;
+    switch (field.type) {
+      case search::SchemaField::TEXT:
+        values.strings = copy(doc.GetStrings(fident));
+        if (sortable)
+          values.tags = copy(doc.GetTags(fident));
+        break;
+      case search::SchemaField::TAG:
+        values.tags = copy(doc.GetTags(fident));
+        break;
+      case search::SchemaField::NUMERIC:
+        values.numbers = doc.GetNumbers(fident);
+        break;
+      case search::SchemaField::GEO:
+        values.strings = copy(doc.GetStrings(fident));
+        break;
+      case search::SchemaField::VECTOR:
+        break;
+    }
+  }
+
+  // Text indices pick the stemmer by the language field
+  if (!schema.language_field.empty())
+    fields_[schema.language_field].strings = copy(doc.GetStrings(schema.language_field));
+}
+
+const SnapshotAccessor::FieldValues* SnapshotAccessor::Find(string_view field) const {
+  auto it = fields_.find(field);
+  return it != fields_.end() ? &it->second : nullptr;
+}
+
+optional<SnapshotAccessor::StringList> SnapshotAccessor::GetStrings(string_view field) const {
+  const FieldValues* values = Find(field);
+  if (!values || !values->strings)
+    return nullopt;
+  return StringList(values->strings->begin(), values->strings->end());
+}
+
+optional<SnapshotAccessor::VectorInfo> SnapshotAccessor::GetVector(
+    string_view field, size_t dim, search::VectorDataType dtype) const {
+  return nullopt;
+}
+
+optional<SnapshotAccessor::NumsList> SnapshotAccessor::GetNumbers(string_view field) const {
+  const FieldValues* values = Find(field);
+  return values ? values->numbers : nullopt;
+}
+
+optional<SnapshotAccessor::StringList> SnapshotAccessor::GetTags(string_view field) const {
+  const FieldValues* values = Find(field);
+  if (!values || !values->tags)
+    return nullopt;
+  return StringList(values->tags->begin(), values->tags->end());
+}
+
+size_t SnapshotAccessor::MemoryUsage() const {
+  auto strings_size = [](const Strings& strings) {
+    size_t size = 0;
+    for (size_t i = 0; strings && i < strings->size(); i++)
+      size += sizeof(string) + (*strings)[i].size();
+    return size;
+  };
+
+  size_t mem = sizeof(*this);
+  for (const auto& [field, values] : fields_) {
+    mem += sizeof(field) + field.size() + sizeof(values);
+    mem += strings_size(values.strings) + strings_size(values.tags);
+  }
+  return mem;
+}
+
 unique_ptr<BaseAccessor> GetAccessor(const DbContext& db_cntx, const PrimeValue& pv,
                                      std::string_view cleanup_key) {
   DCHECK(pv.ObjType() == OBJ_HASH || pv.ObjType() == OBJ_JSON);
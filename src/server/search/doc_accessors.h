@@ -112,6 +112,31 @@ struct JsonAccessor : public BaseAccessor {
       path_cache_;
 };
 
+// Copy of the field values that indices read to remove a document, so that its indexed version can
+// be removed after the document was overwritten. Vector indices don't read values on removal.
+struct SnapshotAccessor : public search::DocumentAccessor {
+  SnapshotAccessor(const BaseAccessor& doc, const search::Schema& schema);
+
+  std::optional<StringList> GetStrings(std::string_view field) const override;
+  std::optional<VectorInfo> GetVector(std::string_view field, size_t dim,
+                                      search::VectorDataType dtype) const override;
+  std::optional<NumsList> GetNumbers(std::string_view field) const override;
+  std::optional<StringList> GetTags(std::string_view field) const override;
+
+  size_t MemoryUsage() const;  // approximate
+
+ private:
+  using Strings = std::optional<std::vector<std::string>>;
+  struct FieldValues {
+    Strings strings, tags;
+    std::optional<NumsList> numbers;
+  };
+
+  const FieldValues* Find(std::string_view field) const;
+
+  absl::flat_hash_map<std::string, FieldValues> fields_;
+};
+
 // Get accessor for value
 // If cleanup_key is non-empty, the returned StringMapAccessor (if any) will
 // delete the DB key in its destructor when the hash has become empty.
@@ -5,6 +5,7 @@
 #include "server/search/doc_index.h"
 
 #include <absl/strings/str_join.h>
+#include <absl/time/clock.h>
 
 #include <functional>
 #include <memory>
@@ -12,6 +13,8 @@
 #include <ranges>
 
 #include "absl/strings/str_cat.h"
+#include "base/cycle_clock.h"
+#include "base/flags.h"
 #include "base/logging.h"
 #include "core/overloaded.h"
 #include "core/search/ast_expr.h"
@@ -21,12 +24,25 @@
 #include "server/db_slice.h"
 #include "server/engine_shard_set.h"
 #include "server/family_utils.h"
+#include "server/search/disk_vector_store.h"
 #include "server/search/doc_accessors.h"
 #include "server/search/global_hnsw_index.h"
 #include "server/search/index_builder.h"
 #include "server/server_state.h"
 #include "util/fibers/fibers.h"
 
+ABSL_FLAG(bool, search_async_indexing, false,
+          "If true, writes to indexed documents only queue them for a background fiber of each "
+          "index, that adds them to the index in batches. Queries see the latest writes only with "
+          "the WAITINDEXED option, otherwise an overwritten or deleted document is found by the "
+          "values it had before, except by HNSW vector search.");
+
+ABSL_FLAG(uint32_t, search_async_indexing_max_queued, 100000,
+          "Maximum number of documents queued by --search_async_indexing per index and shard. "
+          "Writes beyond it are indexed right away.");
+
+ABSL_DECLARE_FLAG(uint32_t, search_indexing_budget_usec);
+
 namespace rng = std::ranges;
 
 namespace dfly {
@@ -230,6 +246,11 @@ string DocIndexInfo::BuildRestoreCommand() const {
                             params.capacity, " M ", params.hnsw_m, " EF_CONSTRUCTION ",
                             params.hnsw_ef_construction, " EF_RUNTIME ", params.hnsw_ef_runtime,
                             " EPSILON ", params.hnsw_epsilon);
+          } else if (params.use_disk) {
+            absl::StrAppend(out, " DISK 14 TYPE ", search::VectorDataTypeToString(params.data_type),
+                            " DIM ", params.dim, " DISTANCE_METRIC ", sim, " INITIAL_CAP ",
+                            params.capacity, " M ", params.hnsw_m, " EF_CONSTRUCTION ",
+                            params.hnsw_ef_construction, " EF_RUNTIME ", params.hnsw_ef_runtime);
           } else {
             absl::StrAppend(out, " FLAT 8 TYPE ", search::VectorDataTypeToString(params.data_type),
                             " DIM ", params.dim, " DISTANCE_METRIC ", sim, " INITIAL_CAP ",
@@ -408,6 +429,8 @@ ShardDocIndex::ShardDocIndex(shared_ptr<const DocIndex> index)
 
 ShardDocIndex::~ShardDocIndex() {
   CancelBuilder();
+  StopIndexer();
+  util::fb2::Fiber{std::move(aggregate_populator_)}.JoinIfNeeded();
 }
 
 void ShardDocIndex::Rebuild(const OpArgs& op_args, PMR_NS::memory_resource* mr, bool is_restored) {
@@ -427,17 +450,44 @@ void ShardDocIndex::Rebuild(const OpArgs& op_args, PMR_NS::memory_resource* mr,
     hnsw_state_ = HnswState::kRestoring;
   }
 
+  // New indices are built from the current documents
+  for (const auto& [_, stale] : stale_docs_)
+    queued_bytes_ -= stale.values_bytes;
+  stale_docs_.clear();
+
   indices_.emplace(base_->schema, base_->options, mr, &synonyms_);
+  InitDiskVectorStores();
+
+  // A new build adds every document with AddDoc, which updates the aggregations along. Restored
+  // documents are added to indices directly, so they are populated after the build.
+  for (auto& [_, state] : materialized_aggregates_) {
+    state.aggregate.Clear();
+    state.populated = is_restored ? 0 : MaterializedState::kPopulated;
+  }
 
   // Create builder and start indexing
   builder_ = std::make_unique<search::IndexBuilder>(this);
-  builder_->Start(op_args, is_restored, [this] {
+  builder_->Start(op_args, is_restored, [this, db_cntx = op_args.db_cntx] {
     VLOG(1) << "Indexed " << key_index_.Size()
             << " docs on prefixes: " << absl::StrJoin(base_->prefixes, ", ");
     builder_.reset();
+    StartAggregatePopulator(db_cntx);
   });
 }
 
+void ShardDocIndex::InitDiskVectorStores() {
+  for (const auto& [field_ident, field_info] : base_->schema.fields) {
+    auto* index = dynamic_cast<search::CompressedVectorIndex*>(indices_->GetIndex(field_ident));
+    if (!index)
+      continue;
+
+    // Without tiered storage the index keeps full precision vectors in memory
+    const auto& vparams = std::get<search::SchemaField::VectorParams>(field_info.special_params);
+    if (auto store = OpenDiskVectorStore(vparams.dim * search::ElementSize(vparams.data_type)))
+      index->SetStore(std::move(store));
+  }
+}
+
 void ShardDocIndex::CancelBuilder() {
   if (builder_) {
     builder_->Cancel();
@@ -445,6 +495,113 @@ void ShardDocIndex::CancelBuilder() {
   }
 }
 
+// Approximate memory of a queued key besides its characters: the set node and the queue entry
+constexpr size_t kQueuedDocOverhead = sizeof(string) + sizeof(void*) * 2 + sizeof(string_view);
+
+bool ShardDocIndex::QueueDoc(string_view key, const DbContext& db_cntx) {
+  // Same conditions as in AddDoc
+  if (!indices_ || db_cntx.db_index != 0)
+    return true;
+
+  if (queued_keys_.contains(key))  // the indexer reads the latest value anyway
+    return true;
+
+  if (queued_docs_.size() >= absl::GetFlag(FLAGS_search_async_indexing_max_queued))
+    return false;
+
+  auto [it, _] = queued_keys_.emplace(key);
+  queued_docs_.push_back(*it);
+  queued_bytes_ += key.size() + kQueuedDocOverhead;
+
+  if (!indexer_.IsJoinable() && !stop_indexer_)
+    indexer_ = util::fb2::Fiber{[this, db_cntx] { IndexerLoop(db_cntx); }};
+  return true;
+}
+
+bool ShardDocIndex::DeferRemoval(string_view key, DocId id, const DbContext& db_cntx,
+                                 const PrimeValue& pv) {
+  if (!QueueDoc(key, db_cntx))
+    return false;
+
+  string_view queued_key = *queued_keys_.find(key);
+  if (stale_docs_.contains(queued_key))  // an earlier write captured the indexed version
+    return true;
+
+  auto accessor = GetAccessor(db_cntx, pv);
+  auto values = make_unique<SnapshotAccessor>(*accessor, base_->schema);
+  size_t values_bytes = values->MemoryUsage();
+  StaleDoc stale{id, std::move(values), values_bytes, {}};
+  for (const auto& [name, state] : materialized_aggregates_) {
+    if (id < state.populated) {
+      auto fields = state.aggregate.NeededFields();
+      stale.aggregate_values[name] = LoadAggregateValues(id, *accessor, fields);
+    }
+  }
+
+  queued_bytes_ += stale.values_bytes;
+  stale_docs_.emplace(queued_key, std::move(stale));
+  return true;
+}
+
+void ShardDocIndex::RemoveStaleDoc(const StaleDoc& stale) {
+  for (const auto& [name, values] : stale.aggregate_values) {
+    auto it = materialized_aggregates_.find(name);
+    if (it != materialized_aggregates_.end() && stale.id < it->second.populated)
+      it->second.aggregate.Remove(values);
+  }
+  key_index_.Remove(stale.id);
+  indices_->Remove(stale.id, *stale.values);
+  queued_bytes_ -= stale.values_bytes;
+}
+
+void ShardDocIndex::IndexQueuedDocs(const OpArgs& op_args) {
+  IndexQueuedDocs(op_args, numeric_limits<uint64_t>::max());
+}
+
+void ShardDocIndex::IndexerLoop(DbContext db_cntx) {
+  uint64_t budget_usec = absl::GetFlag(FLAGS_search_indexing_budget_usec);
+  while (!stop_indexer_ && !queued_docs_.empty()) {
+    db_cntx.time_now_ms = GetCurrentTimeMs();
+    IndexQueuedDocs(OpArgs{EngineShard::tlocal(), nullptr, db_cntx}, budget_usec);
+    util::ThisFiber::Yield();
+  }
+
+  util::FiberAtomicGuard guard{};
+  indexer_.Detach();  // QueueDoc starts a new one once needed
+}
+
+void ShardDocIndex::IndexQueuedDocs(const OpArgs& op_args, uint64_t budget_usec) {
+  // Look up keys in the table directly like the builder does, as it is not a write to them
+  DbTable* table = op_args.GetDbSlice().GetDBTable(op_args.db_cntx.db_index);
+
+  while (!queued_docs_.empty()) {
+    auto node = queued_keys_.extract(queued_docs_.front());
+    queued_docs_.pop_front();
+    const string& key = node.value();
+    queued_bytes_ -= key.size() + kQueuedDocOverhead;
+
+    // The version indexed before the write is replaced only now
+    if (auto stale = stale_docs_.extract(string_view{key}); !stale.empty())
+      RemoveStaleDoc(stale.mapped());
+
+    // Documents that were deleted or already added inline are skipped
+    auto it = table->prime.Find(string_view{key});
+    if (IsValid(it) && Matches(key, it->second.ObjType())) {
+      PrimeValue& pv = it->second;
+      if (auto doc_id = AddDoc(key, op_args.db_cntx, pv); doc_id)
+        AddDocToGlobalVectorIndex(*doc_id, op_args.db_cntx, &pv);
+    }
+
+    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > budget_usec)
+      break;
+  }
+}
+
+void ShardDocIndex::StopIndexer() {
+  stop_indexer_ = true;
+  util::fb2::Fiber{std::move(indexer_)}.JoinIfNeeded();  // steal and wait for finish
+}
+
 void ShardDocIndex::RebuildForGroup(const OpArgs& op_args, const std::string_view& group_id,
                                     const std::vector<std::string_view>& terms) {
   if (!indices_)
@@ -494,6 +651,127 @@ void ShardDocIndex::RebuildForGroup(const OpArgs& op_args, const std::string_vie
   update_indices(false);
 }
 
+void ShardDocIndex::AddMaterializedAggregate(const OpArgs& op_args, std::string_view name,
+                                             aggregate::GroupParams params) {
+  materialized_aggregates_.insert_or_assign(std::string{name},
+                                            MaterializedState{std::move(params)});
+
+  // Otherwise started once the index is built
+  if (indices_ && !builder_)
+    StartAggregatePopulator(op_args.db_cntx);
+}
+
+bool ShardDocIndex::DropMaterializedAggregate(std::string_view name) {
+  return materialized_aggregates_.erase(name) > 0;
+}
+
+std::vector<std::pair<std::string, aggregate::GroupParams>>
+ShardDocIndex::GetMaterializedAggregates() const {
+  std::vector<std::pair<std::string, aggregate::GroupParams>> out;
+  out.reserve(materialized_aggregates_.size());
+  for (const auto& [name, state] : materialized_aggregates_)
+    out.emplace_back(name, state.aggregate.params());
+  return out;
+}
+
+std::optional<aggregate::PartialGroups> ShardDocIndex::SnapshotMaterializedAggregate(
+    const aggregate::GroupParams& query) const {
+  if (!indices_ || builder_)
+    return std::nullopt;
+
+  for (const auto& [_, state] : materialized_aggregates_) {
+    if (state.populated != MaterializedState::kPopulated)
+      continue;
+    if (auto reducers = state.aggregate.Match(query); reducers)
+      return state.aggregate.Snapshot(query, *reducers);
+  }
+  return std::nullopt;
+}
+
+aggregate::DocValues ShardDocIndex::LoadAggregateValues(
+    DocId id, const BaseAccessor& accessor, absl::Span<const std::string_view> fields) const {
+  aggregate::DocValues out;
+  vector<FieldReference> basic_fields;
+  for (string_view name : fields) {
+    string_view fident = base_->schema.LookupAlias(name);
+    if (IsSortableField(fident, base_->schema))
+      out[name] = indices_->GetSortIndexValue(id, fident);
+    else
+      basic_fields.emplace_back(fident, name);
+  }
+
+  SearchDocData loaded = accessor.Serialize(base_->schema, basic_fields);
+  out.insert(make_move_iterator(loaded.begin()), make_move_iterator(loaded.end()));
+  return out;
+}
+
+void ShardDocIndex::UpdateMaterializedAggregates(DocId id, const BaseAccessor& accessor,
+                                                 bool add) {
+  for (auto& [_, state] : materialized_aggregates_) {
+    if (id >= state.populated)
+      continue;
+
+    auto values = LoadAggregateValues(id, accessor, state.aggregate.NeededFields());
+    if (add)
+      state.aggregate.Add(values);
+    else
+      state.aggregate.Remove(values);
+  }
+}
+
+void ShardDocIndex::StartAggregatePopulator(const DbContext& db_cntx) {
+  bool pending = rng::any_of(materialized_aggregates_, [](const auto& item) {
+    return item.second.populated != MaterializedState::kPopulated;
+  });
+  if (pending && !aggregate_populator_.IsJoinable() && !stop_indexer_) {
+    aggregate_populator_ = util::fb2::Fiber{util::fb2::Launch::post, "aggregate_populator",
+                                            [this, db_cntx] { AggregatePopulatorLoop(db_cntx); }};
+  }
+}
+
+void ShardDocIndex::AggregatePopulatorLoop(DbContext db_cntx) {
+  uint64_t budget_usec = absl::GetFlag(FLAGS_search_indexing_budget_usec);
+
+  // A rebuild starts populating again once it is done
+  while (!stop_indexer_ && !builder_) {
+    db_cntx.time_now_ms = GetCurrentTimeMs();
+    OpArgs op_args{EngineShard::tlocal(), nullptr, db_cntx};
+    bool pending = false;
+    for (auto& [_, state] : materialized_aggregates_) {
+      if (state.populated == MaterializedState::kPopulated)
+        continue;
+      PopulateMaterializedAggregate(op_args, budget_usec, &state);
+      pending |= state.populated != MaterializedState::kPopulated;
+    }
+
+    if (!pending)
+      break;
+    util::ThisFiber::Yield();
+  }
+
+  util::FiberAtomicGuard guard{};
+  aggregate_populator_.Detach();  // StartAggregatePopulator starts a new one once needed
+}
+
+void ShardDocIndex::PopulateMaterializedAggregate(const OpArgs& op_args, uint64_t budget_usec,
+                                                  MaterializedState* state) const {
+  // Documents aren't added while this runs, so all are added once `end` is reached
+  auto fields = state->aggregate.NeededFields();
+  DocId end = key_index_.IdBound();
+  while (state->populated < end) {
+    // Loading can expire the document, its removal is skipped as it is not added yet. Stale
+    // documents are added with their new values once their key is indexed.
+    DocId id = state->populated;
+    if (auto entry = LoadEntry(id, op_args); entry && !stale_docs_.contains(entry->first))
+      state->aggregate.Add(LoadAggregateValues(id, *entry->second, fields));
+    state->populated = id + 1;
+
+    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > budget_usec)
+      return;
+  }
+  state->populated = MaterializedState::kPopulated;
+}
+
 std::optional<ShardDocIndex::DocId> ShardDocIndex::GetDocId(std::string_view key,
                                                             const DbContext& db_cntx) {
   if (!indices_)
@@ -526,11 +804,20 @@ std::optional<ShardDocIndex::DocId> ShardDocIndex::AddDoc(string_view key, const
     return std::nullopt;
   }
 
+  UpdateMaterializedAggregates(id, *accessor, true);
   return id;
 }
 
 void ShardDocIndex::RemoveDoc(DocId id, const DbContext& db_cntx, const PrimeValue& pv) {
+  // pv was already overwritten after the indexed version was captured
+  if (auto it = stale_docs_.find(key_index_.Get(id)); it != stale_docs_.end()) {
+    RemoveStaleDoc(it->second);
+    stale_docs_.erase(it);
+    return;
+  }
+
   auto accessor = GetAccessor(db_cntx, pv);
+  UpdateMaterializedAggregates(id, *accessor, false);
   key_index_.Remove(id);
   indices_->Remove(id, *accessor);
 }
@@ -546,6 +833,15 @@ bool HnswShardIndex::Add(search::GlobalDocId id, const BaseAccessor& doc) {
   return global_index_->Add(id, doc, field_ident_);
 }
 
+bool HnswShardIndex::Collect(search::GlobalDocId id, const BaseAccessor& doc,
+                             search::HnswBatch* batch) const {
+  return global_index_->Collect(id, doc, field_ident_, batch);
+}
+
+void HnswShardIndex::AddBatch(const search::HnswBatch& batch, size_t num_helpers) {
+  global_index_->AddBatch(batch, num_helpers);
+}
+
 void HnswShardIndex::Remove(search::GlobalDocId id) {
   global_index_->Remove(id);
 }
@@ -614,6 +910,36 @@ void ShardDocIndex::AddDocToGlobalVectorIndex(ShardDocIndex::DocId doc_id, const
   }
 }
 
+void ShardDocIndex::CollectDocForGlobalVectorIndex(ShardDocIndex::DocId doc_id,
+                                                   const DbContext& db_cntx, PrimeValue* pv,
+                                                   absl::Span<search::HnswBatch> batches) {
+  if (hnsw_state_ != HnswState::kBuilding) {
+    std::string_view key = key_index_.Get(doc_id);
+    pending_vector_updates_.emplace(key);
+    return;
+  }
+
+  DCHECK_EQ(batches.size(), hnsw_shard_indices_.size());
+  auto accessor = GetAccessor(db_cntx, *pv);
+  GlobalDocId global_id = search::CreateGlobalDocId(EngineShard::tlocal()->shard_id(), doc_id);
+
+  for (size_t i = 0; i < hnsw_shard_indices_.size(); i++) {
+    auto& hnsw = hnsw_shard_indices_[i];
+    if (hnsw.Collect(global_id, *accessor, &batches[i]) && !hnsw.IsVectorCopied()) {
+      pv->SetOmitDefrag(true);
+    }
+  }
+}
+
+void ShardDocIndex::AddGlobalVectorBatches(absl::Span<search::HnswBatch> batches,
+                                           size_t num_helpers) {
+  DCHECK_EQ(batches.size(), hnsw_shard_indices_.size());
+  for (size_t i = 0; i < hnsw_shard_indices_.size(); i++) {
+    hnsw_shard_indices_[i].AddBatch(batches[i], num_helpers);
+    batches[i].clear();
+  }
+}
+
 void ShardDocIndex::RemoveDocFromGlobalVectorIndex(
     ShardDocIndex::DocId doc_id, const DbContext& db_cntx, PrimeValue& pv,
     absl::Span<const std::string_view> modified_fields, FieldExtractionCache* cache) {
@@ -893,7 +1219,20 @@ SearchResult ShardDocIndex::Search(const OpArgs& op_args, const SearchParams& pa
       !params.sort_option && !knn_sort_option && !is_knn_prefilter && !sort_by_text_score;
   size_t id_cutoff_limit = can_cut ? limit : numeric_limits<size_t>::max();
 
-  auto result = search_algo->Search(&*indices_, id_cutoff_limit, global_stats);
+  // SORTBY on a sortable field can be applied while searching by walking its sort index
+  optional<search::SortIndexScan> sort_scan;
+  if (params.sort_option && !knn_sort_option && !is_knn_prefilter && !sort_by_text_score &&
+      limit > 0) {
+    const auto& so = *params.sort_option;
+    if (auto fident = so.field.Identifier(base_->schema, false);
+        IsSortableField(fident, base_->schema)) {
+      sort_scan = search::SortIndexScan{indices_->GetSortIndex(fident), limit,
+                                        so.order == SortOrder::DESC};
+    }
+  }
+
+  auto result = search_algo->Search(&*indices_, id_cutoff_limit, global_stats,
+                                    sort_scan ? &*sort_scan : nullptr);
   if (!result.error.empty())
     return {facade::ErrorReply(std::move(result.error))};
 
@@ -925,10 +1264,19 @@ SearchResult ShardDocIndex::Search(const OpArgs& op_args, const SearchParams& pa
   vector<search::SortableValue> sort_scores;
   if (params.sort_option && !skip_sort) {
     const auto& so = *params.sort_option;
+    const bool desc = so.order == SortOrder::DESC;
     auto fident = so.field.Identifier(base_->schema, false);
-    if (IsSortableField(fident, base_->schema)) {
+    auto sort_start = absl::Now();
+    size_t num_ids = result.ids.size();
+    string_view strategy = "load_heap";  // values are loaded from the documents
+
+    if (result.sort_values) {
+      strategy = "index_scan";
+      sort_scores = std::move(*result.sort_values);
+    } else if (IsSortableField(fident, base_->schema)) {
       auto* idx = indices_->GetSortIndex(fident);
-      sort_scores = idx->Sort(&result.ids, limit, so.order == SortOrder::DESC);
+      strategy = "heap";
+      sort_scores = idx->Sort(&result.ids, limit, desc);
     } else {
       sort_scores = KeepTopKSorted(&result.ids, limit, so, op_args);
       // KeepTopKSorted only fills the first sort_scores.size() entries of result.ids;
@@ -938,6 +1286,17 @@ SearchResult ShardDocIndex::Search(const OpArgs& op_args, const SearchParams& pa
       if (params.ShouldReturnAllFields())
         return_fields.push_back(so.field);
     }
+
+    if (result.profile) {
+      // The index scan recorded its event while searching
+      auto& event = result.profile->sort;
+      if (!event) {
+        event = search::AlgorithmProfile::ProfileEvent{
+            "", size_t(absl::ToInt64Microseconds(absl::Now() - sort_start)), 0, num_ids};
+      }
+      event->descr =
+          absl::StrCat("Sort{", so.field.Name(), ",", desc ? "desc" : "asc", ",", strategy, "}");
+    }
   }
 
   // Re-rank by (score, key) so per-shard top-K matches what a global merge
@@ -1248,7 +1607,7 @@ ShardDocIndex::FieldsValuesPerDocId ShardDocIndex::LoadKeysData(
 }
 
 size_t ShardDocIndex::GetNonPmrMemoryUsage() const {
-  size_t mem = 0;
+  size_t mem = queued_bytes_;
   if (indices_)
     mem += indices_->GetNonPmrMemoryUsage();
   return mem;
@@ -1258,7 +1617,8 @@ DocIndexInfo ShardDocIndex::GetInfo() const {
   return {.base_index = *base_,
           .num_docs = key_index_.Size(),
           .indexing = bool(builder_),
-          .percent_indexed = bool(builder_) ? 0.5f : 1.0f,  // no estimation for now
+          .percent_indexed = bool(builder_) ? builder_->Progress() : 1.0f,
+          .pending_docs = queued_docs_.size(),
           .hnsw_metadata = nullopt};
 }
 
@@ -1377,8 +1737,12 @@ vector<string> ShardDocIndices::GetIndexNames() const {
 
 void ShardDocIndices::AddDoc(string_view key, const DbContext& db_cntx, PrimeValue* pv) {
   DCHECK(IsIndexedKeyType(*pv));
+  bool async = absl::GetFlag(FLAGS_search_async_indexing);
   for (auto& [index_name, index] : indices_) {
     if (index->Matches(key, pv->ObjType())) {
+      if (async && index->QueueDoc(key, db_cntx))
+        continue;
+
       std::optional<search::DocId> doc_id = index->AddDoc(key, db_cntx, *pv);
       if (doc_id) {
         index->AddDocToGlobalVectorIndex(*doc_id, db_cntx, pv);
@@ -1395,12 +1759,16 @@ void ShardDocIndices::RemoveDoc(string_view key, const DbContext& db_cntx, Prime
   // each sds entry is extracted once and shared via shared_ptr across all indices.
   FieldExtractionCache extraction_cache;
 
+  bool async = absl::GetFlag(FLAGS_search_async_indexing);
   for (auto& [index_name, index] : indices_) {
     if (index->Matches(key, pv.ObjType())) {
       std::optional<search::DocId> doc_id = index->GetDocId(key, db_cntx);
       if (doc_id) {
         index->RemoveDocFromGlobalVectorIndex(*doc_id, db_cntx, pv, modified_fields,
                                               &extraction_cache);
+        if (async && index->DeferRemoval(key, *doc_id, db_cntx, pv))
+          continue;
+
         index->RemoveDoc(*doc_id, db_cntx, pv);
       }
     }
@@ -1415,11 +1783,14 @@ size_t ShardDocIndices::GetUsedMemory() const {
 }
 
 SearchStats ShardDocIndices::GetStats() const {
-  size_t total_entries = 0;
-  for (const auto& [_, index] : indices_)
-    total_entries += index->GetInfo().num_docs;
+  size_t total_entries = 0, pending_docs = 0;
+  for (const auto& [_, index] : indices_) {
+    DocIndexInfo info = index->GetInfo();
+    total_entries += info.num_docs;
+    pending_docs += info.pending_docs;
+  }
 
-  return {GetUsedMemory(), indices_.size(), total_entries};
+  return {GetUsedMemory(), indices_.size(), total_entries, pending_docs};
 }
 
 search::DefragmentResult ShardDocIndices::Defragment(PageUsage* page_usage) {
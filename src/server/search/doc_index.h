@@ -6,8 +6,11 @@
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/container/flat_hash_set.h>
+#include <absl/container/node_hash_set.h>
 
 #include <cstdint>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
@@ -25,6 +28,7 @@
 #include "server/search/index_join.h"
 #include "server/stats.h"
 #include "server/table.h"
+#include "util/fibers/fibers.h"
 
 namespace dfly {
 
@@ -171,6 +175,8 @@ struct SearchParams {
   std::optional<search::ScorerSpec> scorer;  // SCORER parameter (null = not set); carries the
                                              // BM25STD.TANH factor when applicable
 
+  bool wait_indexed = false;  // WAITINDEXED: index documents queued by async indexing first
+
   bool ShouldReturnAllFields() const {
     return !return_fields.has_value();
   }
@@ -234,10 +240,15 @@ struct AggregateParams {
   std::optional<std::vector<FieldReference>> load_fields;
   std::vector<aggregate::AggregationStep> steps;
 
+  // Set if the first step is GROUPBY, as it can be answered by materialized aggregations
+  std::optional<aggregate::GroupParams> leading_group;
+
   bool add_scores = false;                   // ADDSCORES flag
   std::optional<search::ScorerSpec> scorer;  // SCORER parameter (null = not set); carries the
                                              // BM25STD.TANH factor when applicable
 
+  bool wait_indexed = false;  // WAITINDEXED: index documents queued by async indexing first
+
   // Set only for multi-shard scoring queries; not owned.
   const search::GlobalScoringStats* global_scoring_stats = nullptr;
 };
@@ -266,6 +277,9 @@ struct DocIndexInfo {
   bool indexing = false;
   float percent_indexed = 1;
 
+  // Documents written with --search_async_indexing that are not indexed yet
+  size_t pending_docs = 0;
+
   // HNSW metadata for vector index (if present)
   // TODO: move to schema
   std::optional<search::HnswIndexMetadata> hnsw_metadata = std::nullopt;
@@ -289,6 +303,11 @@ class HnswShardIndex {
 
   bool Add(search::GlobalDocId id, const BaseAccessor& doc);
 
+  // Collect the vector of `doc` for AddBatch instead of adding it right away.
+  bool Collect(search::GlobalDocId id, const BaseAccessor& doc, search::HnswBatch* batch) const;
+
+  void AddBatch(const search::HnswBatch& batch, size_t num_helpers);
+
   void Remove(search::GlobalDocId id);
 
   // Update vector data for an existing HNSW node (used during restoration).
@@ -368,6 +387,11 @@ class ShardDocIndex {
     std::optional<DocId> Find(std::string_view key) const;
     size_t Size() const;
 
+    // All valid ids are below it
+    DocId IdBound() const {
+      return last_id_;
+    }
+
     const TrackedIdsMap& GetDocKeysMap() const {
       return ids_;
     }
@@ -442,6 +466,19 @@ class ShardDocIndex {
 
   void RemoveDoc(DocId id, const DbContext& db_cntx, const PrimeValue& pv);
 
+  // Queue document for the background indexer instead of adding it right away. Returns false if
+  // the queue is full, then the caller has to add it.
+  bool QueueDoc(std::string_view key, const DbContext& db_cntx);
+
+  // Keep the indexed version of a document that is about to be overwritten or deleted until the
+  // background indexer handles its key. The values needed to remove it are captured from `pv`.
+  // Returns false if the queue is full, then the caller has to remove it right away.
+  bool DeferRemoval(std::string_view key, DocId id, const DbContext& db_cntx,
+                    const PrimeValue& pv);
+
+  // Add all queued documents right away, so that a query sees all preceding writes
+  void IndexQueuedDocs(const OpArgs& op_args);
+
   DocIndexInfo GetInfo() const;
 
   // Direct access to the underlying DocIndex (schema, prefixes, type). Prefer this over
@@ -462,6 +499,22 @@ class ShardDocIndex {
     return synonyms_;
   }
 
+  // Register a materialized aggregation over all documents of this shard, replacing one with the
+  // same name. Fields must be part of the schema. It is populated by a background fiber.
+  void AddMaterializedAggregate(const OpArgs& op_args, std::string_view name,
+                                aggregate::GroupParams params);
+
+  // Return true if it existed
+  bool DropMaterializedAggregate(std::string_view name);
+
+  // Definitions of materialized aggregations by name
+  std::vector<std::pair<std::string, aggregate::GroupParams>> GetMaterializedAggregates() const;
+
+  // Groups of a materialized aggregation that can answer `query`. Returns nullopt if there is
+  // none or it is still being populated.
+  std::optional<aggregate::PartialGroups> SnapshotMaterializedAggregate(
+      const aggregate::GroupParams& query) const;
+
   // Rebuild indices only for documents containing terms from the updated synonym group
   void RebuildForGroup(const OpArgs& op_args, const std::string_view& group_id,
                        const std::vector<std::string_view>& terms);
@@ -475,6 +528,14 @@ class ShardDocIndex {
   void AddDocToGlobalVectorIndex(ShardDocIndex::DocId doc_id, const DbContext& db_cntx,
                                  PrimeValue* pv);
 
+  // Same as AddDocToGlobalVectorIndex, but collects vectors into `batches`, one per HNSW field,
+  // for AddGlobalVectorBatches. The batches must be added before yielding.
+  void CollectDocForGlobalVectorIndex(ShardDocIndex::DocId doc_id, const DbContext& db_cntx,
+                                      PrimeValue* pv, absl::Span<search::HnswBatch> batches);
+
+  // Add and clear batches filled by CollectDocForGlobalVectorIndex.
+  void AddGlobalVectorBatches(absl::Span<search::HnswBatch> batches, size_t num_helpers);
+
   // Remove doc from all HNSW indices. When hnsw_state_ != kBuilding, the remove
   // is buffered in pending_vector_updates_ and old sds entries are preserved so
   // HNSW pointers remain valid until the buffer is drained.
@@ -537,6 +598,16 @@ class ShardDocIndex {
   size_t GetNonPmrMemoryUsage() const;
 
  private:
+  struct MaterializedState {
+    static constexpr DocId kPopulated = std::numeric_limits<DocId>::max();
+
+    explicit MaterializedState(aggregate::GroupParams params) : aggregate{std::move(params)} {
+    }
+
+    aggregate::MaterializedAggregate aggregate;
+    DocId populated = 0;  // ids below it were added, kPopulated once all were
+  };
+
   // Common doc-loading loop used by SearchForAggregator and LoadHnswRangeDocsForAggregator.
   // Loads, serializes, and (optionally) injects the YIELD_DISTANCE_AS alias for each doc.
   std::vector<SearchDocData> LoadDocEntriesWithScores(
@@ -547,9 +618,39 @@ class ShardDocIndex {
   // Clears internal data. Traverses all matching documents and assigns ids.
   void Rebuild(const OpArgs& op_args, PMR_NS::memory_resource* mr, bool is_restored = false);
 
+  // Move full precision vectors of DISK vector fields to disk if tiered storage is configured
+  void InitDiskVectorStores();
+
   // Cancel builder if in progress
   void CancelBuilder();
 
+  // Add queued documents in slices of --search_indexing_budget_usec until none are left
+  void IndexerLoop(DbContext db_cntx);
+
+  // Add queued documents until the fiber has run for `budget_usec`
+  void IndexQueuedDocs(const OpArgs& op_args, uint64_t budget_usec);
+
+  // Stop indexer and wait for it to finish, queued documents are kept
+  void StopIndexer();
+
+  // Load values of fields (by alias) the same way as FT.AGGREGATE does. Sortable fields are read
+  // from sort indices, so the document must be present in indices_.
+  aggregate::DocValues LoadAggregateValues(DocId id, const BaseAccessor& accessor,
+                                           absl::Span<const std::string_view> fields) const;
+
+  // Add or remove document in all materialized aggregations that contain its id range
+  void UpdateMaterializedAggregates(DocId id, const BaseAccessor& accessor, bool add);
+
+  // Start aggregate_populator_ if some materialized aggregation is not populated yet
+  void StartAggregatePopulator(const DbContext& db_cntx);
+
+  // Populate materialized aggregations in slices of --search_indexing_budget_usec
+  void AggregatePopulatorLoop(DbContext db_cntx);
+
+  // Add documents to the aggregation until the fiber has run for `budget_usec`
+  void PopulateMaterializedAggregate(const OpArgs& op_args, uint64_t budget_usec,
+                                     MaterializedState* state) const;
+
   using LoadedEntry = std::pair<std::string_view, std::unique_ptr<BaseAccessor>>;
   std::optional<LoadedEntry> LoadEntry(search::DocId id, const OpArgs& op_args) const;
 
@@ -570,8 +671,35 @@ class ShardDocIndex {
   DocKeyIndex key_index_;
   Synonyms synonyms_;
 
+  // Materialized aggregations contain the documents with ids below `populated`, which only
+  // grows. AddDoc and RemoveDoc update that range, aggregate_populator_ adds the rest.
+  absl::flat_hash_map<std::string, MaterializedState> materialized_aggregates_;
+  util::fb2::Fiber aggregate_populator_;
+
   std::unique_ptr<search::IndexBuilder> builder_;
 
+  // Indexed version of a document written with async indexing, removed once its key is indexed
+  struct StaleDoc {
+    DocId id;
+    std::unique_ptr<search::DocumentAccessor> values;  // field values it was indexed with
+    size_t values_bytes;
+
+    // Values it was added to materialized aggregations with, by aggregation name
+    absl::flat_hash_map<std::string, aggregate::DocValues> aggregate_values;
+  };
+
+  void RemoveStaleDoc(const StaleDoc& stale);
+
+  // Keys of documents written with async indexing, drained by indexer_ in write order.
+  // queued_keys_ owns the keys and deduplicates them, stale_docs_ refers to them.
+  // queued_bytes_ is the memory usage of both.
+  absl::node_hash_set<std::string> queued_keys_;
+  std::deque<std::string_view> queued_docs_;
+  absl::flat_hash_map<std::string_view, StaleDoc> stale_docs_;
+  size_t queued_bytes_ = 0;
+  util::fb2::Fiber indexer_;
+  bool stop_indexer_ = false;
+
   // Per-shard HNSW wrappers, one per indexed vector field.
   std::vector<HnswShardIndex> hnsw_shard_indices_;
 
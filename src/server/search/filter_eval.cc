@@ -4,6 +4,9 @@
 
 #include "server/search/filter_eval.h"
 
+#include <absl/container/flat_hash_map.h>
+
+#include <algorithm>
 #include <cmath>
 #include <variant>
 #include <vector>
@@ -172,10 +175,354 @@ Value EvalNode(const FilterExprNode& node, const DocValues& doc) {
   return std::visit(EvalVisitor{doc}, static_cast<const FilterExprVariant&>(node));
 }
 
+// Batch evaluation
+
+// Documents are evaluated in batches of this size, so columns of a batch stay in cache
+constexpr size_t kEvalBatchSize = 1024;
+
+const Value kNullValue{};
+
+// Values of an expression for all documents of a batch. Numbers are kept in plain arrays with a
+// null mask, so that arithmetic and comparisons run in simple loops that compilers vectorize.
+struct Column {
+  enum Kind : uint8_t {
+    NUMERIC,   // nums, null where valid is 0
+    VALUES,    // values
+    REFS,      // refs to values of the documents, nullptr for missing fields
+    CONSTANT,  // values[0] for all documents
+  };
+
+  static Column Numeric(size_t size, double num = 0.0, bool valid = false) {
+    Column col;
+    col.nums.assign(size, num);
+    col.valid.assign(size, valid);
+    return col;
+  }
+
+  static Column Constant(Value value) {
+    Column col{CONSTANT};
+    col.values.push_back(std::move(value));
+    return col;
+  }
+
+  // Keeps function results numeric if they are all numbers or null
+  static Column FromValues(std::vector<Value> values);
+
+  // Value of document i, numbers are materialized into scratch
+  const Value& At(size_t i, Value* scratch) const {
+    switch (kind) {
+      case NUMERIC:
+        *scratch = valid[i] ? Value{nums[i]} : Value{};
+        return *scratch;
+      case VALUES:
+        return values[i];
+      case REFS:
+        return refs[i] ? *refs[i] : kNullValue;
+      case CONSTANT:
+        return values[0];
+    }
+    return kNullValue;
+  }
+
+  bool Truthy(size_t i) const {
+    if (kind == NUMERIC)
+      return valid[i] && nums[i] != 0.0 && !std::isnan(nums[i]);
+    Value scratch;
+    return IsTruthy(At(i, &scratch));
+  }
+
+  Value Take(size_t i) {
+    if (kind == VALUES)
+      return std::move(values[i]);
+    Value scratch;
+    const Value& v = At(i, &scratch);
+    return &v == &scratch ? std::move(scratch) : v;
+  }
+
+  Kind kind = NUMERIC;
+  std::vector<double> nums;
+  std::vector<uint8_t> valid;
+  std::vector<Value> values;
+  std::vector<const Value*> refs;
+};
+
+Column Column::FromValues(std::vector<Value> values) {
+  bool numeric = std::all_of(values.begin(), values.end(), [](const Value& v) {
+    return !std::holds_alternative<std::string>(v);
+  });
+  if (!numeric) {
+    Column col{VALUES};
+    col.values = std::move(values);
+    return col;
+  }
+
+  Column col = Numeric(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    if (const double* d = std::get_if<double>(&values[i])) {
+      col.nums[i] = *d;
+      col.valid[i] = 1;
+    }
+  }
+  return col;
+}
+
+// Only doubles are numbers for arithmetic, everything else becomes null like in EvalArith
+Column ToNumeric(Column col, size_t size) {
+  if (col.kind == Column::NUMERIC)
+    return col;
+
+  Column res = Column::Numeric(size);
+  Value scratch;
+  for (size_t i = 0; i < size; i++) {
+    if (const double* d = std::get_if<double>(&col.At(i, &scratch))) {
+      res.nums[i] = *d;
+      res.valid[i] = 1;
+    }
+  }
+  return res;
+}
+
+template <typename Cmp>
+void CompareNumbers(Cmp cmp, const Column& lhs, const Column& rhs, Column* res) {
+  for (size_t i = 0; i < res->nums.size(); i++)
+    res->nums[i] = cmp(lhs.nums[i], rhs.nums[i]) ? 1.0 : 0.0;
+}
+
+template <typename Op>
+void ApplyNumbers(Op op, const Column& lhs, const Column& rhs, Column* res) {
+  for (size_t i = 0; i < res->nums.size(); i++)
+    res->nums[i] = op(lhs.nums[i], rhs.nums[i]);
+}
+
+// Same semantics as EvalVisitor, but evaluates each node for a whole batch of documents
+struct BatchEvalVisitor {
+  absl::Span<const DocValues> docs;
+  absl::flat_hash_map<std::string_view, Column> fields;  // Fields already looked up in docs
+
+  Column Eval(const FilterExprNode& node) {
+    return std::visit(*this, static_cast<const FilterExprVariant&>(node));
+  }
+
+  Column operator()(const FieldRef& n) {
+    auto [it, inserted] = fields.try_emplace(n.name);
+    if (inserted)
+      it->second = LoadField(n.name);
+    return it->second;
+  }
+
+  Column LoadField(const std::string& name) const {
+    Column col = Column::Numeric(docs.size());
+    col.refs.resize(docs.size());
+    bool numeric = true;
+    for (size_t i = 0; i < docs.size(); i++) {
+      auto it = docs[i].find(name);
+      if (it == docs[i].end())
+        continue;
+
+      col.refs[i] = &it->second;
+      if (const double* d = std::get_if<double>(&it->second)) {
+        col.nums[i] = *d;
+        col.valid[i] = 1;
+      } else {
+        numeric = false;
+      }
+    }
+
+    if (numeric) {
+      col.refs.clear();
+    } else {
+      col.kind = Column::REFS;
+      col.nums.clear();
+      col.valid.clear();
+    }
+    return col;
+  }
+
+  Column operator()(const NumLiteral& n) {
+    return Column::Numeric(docs.size(), n.value, true);
+  }
+
+  Column operator()(const StrLiteral& n) {
+    return Column::Constant(n.value);
+  }
+
+  Column operator()(const NullLiteral& /*n*/) {
+    return Column::Numeric(docs.size());
+  }
+
+  Column operator()(const CmpExpr& n) {
+    Column lhs = Eval(*n.lhs), rhs = Eval(*n.rhs);
+    Column res = Column::Numeric(docs.size(), 0.0, true);
+
+    if (lhs.kind != Column::NUMERIC || rhs.kind != Column::NUMERIC) {
+      Value lhs_scratch, rhs_scratch;
+      for (size_t i = 0; i < docs.size(); i++) {
+        Value v = EvalCmp(n.op, lhs.At(i, &lhs_scratch), rhs.At(i, &rhs_scratch));
+        res.nums[i] = std::get<double>(v);
+      }
+      return res;
+    }
+
+    switch (n.op) {
+      case CmpOp::EQ:
+        CompareNumbers(std::equal_to<>{}, lhs, rhs, &res);
+        break;
+      case CmpOp::NEQ:
+        CompareNumbers(std::not_equal_to<>{}, lhs, rhs, &res);
+        break;
+      case CmpOp::LT:
+        CompareNumbers(std::less<>{}, lhs, rhs, &res);
+        break;
+      case CmpOp::LTE:
+        CompareNumbers(std::less_equal<>{}, lhs, rhs, &res);
+        break;
+      case CmpOp::GT:
+        CompareNumbers(std::greater<>{}, lhs, rhs, &res);
+        break;
+      case CmpOp::GTE:
+        CompareNumbers(std::greater_equal<>{}, lhs, rhs, &res);
+        break;
+    }
+
+    // Fix up rows with nulls: NULL vs NULL is like equal numbers, NULL vs number is mixed types
+    double both_null = std::get<double>(EvalCmp(n.op, kNullValue, kNullValue));
+    double one_null = std::get<double>(EvalCmp(n.op, kNullValue, Value{0.0}));
+    for (size_t i = 0; i < docs.size(); i++) {
+      if (!(lhs.valid[i] & rhs.valid[i]))
+        res.nums[i] = (lhs.valid[i] | rhs.valid[i]) ? one_null : both_null;
+    }
+    return res;
+  }
+
+  Column operator()(const ArithExpr& n) {
+    Column lhs = ToNumeric(Eval(*n.lhs), docs.size());
+    Column rhs = ToNumeric(Eval(*n.rhs), docs.size());
+    Column res = Column::Numeric(docs.size());
+    for (size_t i = 0; i < docs.size(); i++)
+      res.valid[i] = lhs.valid[i] & rhs.valid[i];
+
+    switch (n.op) {
+      case ArithOp::ADD:
+        ApplyNumbers(std::plus<>{}, lhs, rhs, &res);
+        break;
+      case ArithOp::SUB:
+        ApplyNumbers(std::minus<>{}, lhs, rhs, &res);
+        break;
+      case ArithOp::MUL:
+        ApplyNumbers(std::multiplies<>{}, lhs, rhs, &res);
+        break;
+      case ArithOp::DIV:
+        ApplyNumbers(std::divides<>{}, lhs, rhs, &res);
+        break;
+      case ArithOp::MOD:
+        ApplyNumbers([](double l, double r) { return std::fmod(l, r); }, lhs, rhs, &res);
+        break;
+      case ArithOp::POW:
+        ApplyNumbers([](double l, double r) { return std::pow(l, r); }, lhs, rhs, &res);
+        break;
+    }
+
+    // Division by zero is null
+    if (n.op == ArithOp::DIV || n.op == ArithOp::MOD) {
+      for (size_t i = 0; i < docs.size(); i++)
+        res.valid[i] &= rhs.nums[i] != 0.0;
+    }
+    return res;
+  }
+
+  Column operator()(const LogicExpr& n) {
+    // Both sides are evaluated for all documents, functions have no side effects
+    Column lhs = Eval(*n.lhs), rhs = Eval(*n.rhs);
+    Column res = Column::Numeric(docs.size(), 0.0, true);
+    for (size_t i = 0; i < docs.size(); i++) {
+      bool l = lhs.Truthy(i), r = rhs.Truthy(i);
+      res.nums[i] = (n.op == LogicOp::AND ? l && r : l || r) ? 1.0 : 0.0;
+    }
+    return res;
+  }
+
+  Column operator()(const NotExpr& n) {
+    Column operand = Eval(*n.operand);
+    Column res = Column::Numeric(docs.size(), 0.0, true);
+    for (size_t i = 0; i < docs.size(); i++)
+      res.nums[i] = operand.Truthy(i) ? 0.0 : 1.0;
+    return res;
+  }
+
+  Column operator()(const NegateExpr& n) {
+    Column res = ToNumeric(Eval(*n.operand), docs.size());
+    for (double& num : res.nums)
+      num = -num;
+    return res;
+  }
+
+  Column operator()(const FuncCallExpr& n) {
+    const FuncImpl* fn = FindFilterFunction(n.name);
+    if (!fn)
+      return Column::Numeric(docs.size());  // unknown function -> null
+
+    std::vector<Column> args;
+    args.reserve(n.args.size());
+    for (const auto& arg : n.args)
+      args.push_back(Eval(*arg));
+
+    // Math functions are applied to numeric columns directly, nulls stay null
+    if (args.size() == 1 && args[0].kind == Column::NUMERIC) {
+      if (NumericFuncImpl num_fn = FindNumericFilterFunction(n.name); num_fn) {
+        for (double& num : args[0].nums)
+          num = num_fn(num);
+        return std::move(args[0]);
+      }
+    }
+
+    std::vector<Value> arg_vals(args.size());
+    std::vector<Value> results(docs.size());
+    Value scratch;
+    for (size_t i = 0; i < docs.size(); i++) {
+      for (size_t j = 0; j < args.size(); j++)
+        arg_vals[j] = args[j].At(i, &scratch);
+      results[i] = (*fn)(arg_vals);
+    }
+    return Column::FromValues(std::move(results));
+  }
+};
+
+// Calls f with the result column and size of each batch of docs
+template <typename F>
+void EvalBatches(const FilterExprNode& node, absl::Span<const DocValues> docs, F&& f) {
+  for (size_t start = 0; start < docs.size(); start += kEvalBatchSize) {
+    auto batch = docs.subspan(start, kEvalBatchSize);
+    Column col = BatchEvalVisitor{batch}.Eval(node);
+    f(&col, batch.size());
+  }
+}
+
 }  // namespace
 
 Value EvalFilterExpr(const FilterExprNode& node, const DocValues& doc) {
   return EvalNode(node, doc);
 }
 
+std::vector<Value> EvalFilterExprBatch(const FilterExprNode& node,
+                                       absl::Span<const DocValues> docs) {
+  std::vector<Value> results;
+  results.reserve(docs.size());
+  EvalBatches(node, docs, [&](Column* col, size_t size) {
+    for (size_t i = 0; i < size; i++)
+      results.push_back(col->Take(i));
+  });
+  return results;
+}
+
+std::vector<bool> EvalFilterExprMask(const FilterExprNode& node,
+                                     absl::Span<const DocValues> docs) {
+  std::vector<bool> mask;
+  mask.reserve(docs.size());
+  EvalBatches(node, docs, [&](Column* col, size_t size) {
+    for (size_t i = 0; i < size; i++)
+      mask.push_back(col->Truthy(i));
+  });
+  return mask;
+}
+
 }  // namespace dfly::aggregate
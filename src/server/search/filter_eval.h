@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <absl/types/span.h>
+
+#include <vector>
+
 #include "server/search/aggregator.h"
 #include "server/search/filter_expr.h"
 
@@ -20,4 +24,13 @@ bool IsTruthy(const Value& v);
 // filtering purposes.
 Value EvalFilterExpr(const FilterExprNode& node, const DocValues& doc);
 
+// Evaluate the expression against all documents, with the same results as EvalFilterExpr per
+// document. Documents are processed in batches, each AST node is evaluated for a whole batch at
+// once and numeric values are kept in plain arrays.
+std::vector<Value> EvalFilterExprBatch(const FilterExprNode& node,
+                                       absl::Span<const DocValues> docs);
+
+// Same as EvalFilterExprBatch, but returns IsTruthy() of each result.
+std::vector<bool> EvalFilterExprMask(const FilterExprNode& node, absl::Span<const DocValues> docs);
+
 }  // namespace dfly::aggregate
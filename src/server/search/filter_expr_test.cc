@@ -2,8 +2,11 @@
 // See LICENSE for licensing terms.
 //
 
+#include <benchmark/benchmark.h>
+
 #include <cmath>
 #include <limits>
+#include <random>
 
 #include "base/gtest.h"
 #include "server/search/aggregator.h"
@@ -640,6 +643,57 @@ TEST(FilterExprTest, FuncParseTime) {
   EXPECT_EQ(Eval("parsetime('2026', NULL)", doc), Value{});
 }
 
+// Batch evaluation: same results as evaluating each document on its own
+
+// Documents with numeric, string, mixed and missing fields
+std::vector<DocValues> MixedDocs(size_t num) {
+  std::default_random_engine rnd{42};
+  std::vector<DocValues> docs(num);
+  for (auto& doc : docs) {
+    if (rnd() % 4)
+      doc["a"] = double(int(rnd() % 7) - 3);
+    if (rnd() % 4)
+      doc["b"] = (rnd() % 5) * 0.5;
+    if (rnd() % 2)
+      doc["s"] = rnd() % 2 ? "abc"s : ""s;
+    if (rnd() % 3)
+      doc["m"] = rnd() % 2 ? Value{double(rnd() % 3)} : Value{"2"s};
+  }
+  return docs;
+}
+
+TEST(FilterExprTest, BatchMatchesRowEval) {
+  // More than one batch, with a partial last batch
+  auto docs = MixedDocs(2500);
+  for (std::string_view expr : {
+           "@a", "@s", "@m", "@missing", "NULL", "'abc'",
+           "@a + @b * 2", "@a / @b", "@a % @b", "@a ^ 2", "-@a", "-@s", "@m + 1",
+           "@a == @b", "@a != NULL", "@missing == NULL", "@s < 'b'", "@m >= 1", "@s == @a",
+           "@a > 0 && @s", "@b || @m", "!@a", "!(@a < 1 || @s == '')",
+           "abs(@a)", "sqrt(@a)", "log(@b)", "floor(@m)", "exists(@a)", "upper(@s)",
+           "strlen(@s) + @a", "to_number(@m) * 2", "nosuchfn(@a)", "abs(@a, @b)",
+       }) {
+    auto parsed = ParseFilterExpr(expr);
+    ASSERT_TRUE(std::holds_alternative<FilterExpr>(parsed)) << expr;
+    const auto& node = *std::get<FilterExpr>(parsed);
+
+    auto batch = EvalFilterExprBatch(node, docs);
+    auto mask = EvalFilterExprMask(node, docs);
+    ASSERT_EQ(batch.size(), docs.size());
+    ASSERT_EQ(mask.size(), docs.size());
+    for (size_t i = 0; i < docs.size(); i++) {
+      Value expected = EvalFilterExpr(node, docs[i]);
+      if (const double* d = std::get_if<double>(&expected); d && std::isnan(*d)) {
+        ASSERT_TRUE(std::holds_alternative<double>(batch[i])) << expr << " " << i;
+        EXPECT_TRUE(std::isnan(std::get<double>(batch[i]))) << expr << " " << i;
+      } else {
+        ASSERT_EQ(batch[i], expected) << expr << " " << i;
+      }
+      ASSERT_EQ(mask[i], IsTruthy(expected)) << expr << " " << i;
+    }
+  }
+}
+
 // MakeFilterStep (pipeline integration)
 
 TEST(FilterExprTest, FilterStepParseError) {
@@ -919,4 +973,28 @@ TEST(FilterExprTest, GroupByNaNGroupsTogether) {
   ASSERT_EQ(result.values.size(), 2);
 }
 
+// Compares evaluating FILTER expressions document by document (0) and in batches (1)
+static void BM_FilterExpr(benchmark::State& state) {
+  std::vector<DocValues> docs(100'000);
+  for (size_t i = 0; i < docs.size(); i++)
+    docs[i] = DocValues{{"a", double(i % 100)}, {"b", double(i % 7)}, {"s", "abc"s}};
+
+  auto parsed = ParseFilterExpr("@a * 2 + @b > 50 && abs(@b - 3) < 2 && @s != ''");
+  const auto& node = *std::get<FilterExpr>(parsed);
+
+  bool batch = state.range(0);
+  while (state.KeepRunning()) {
+    size_t kept = 0;
+    if (batch) {
+      for (bool keep : EvalFilterExprMask(node, docs))
+        kept += keep;
+    } else {
+      for (const auto& doc : docs)
+        kept += IsTruthy(EvalFilterExpr(node, doc));
+    }
+    benchmark::DoNotOptimize(kept);
+  }
+}
+BENCHMARK(BM_FilterExpr)->ArgNames({"batch"})->Arg(0)->Arg(1);
+
 }  // namespace dfly::aggregate
@@ -546,6 +546,20 @@ const absl::flat_hash_map<std::string, FuncImpl>& Registry() {
   return kRegistry;
 }
 
+const absl::flat_hash_map<std::string, NumericFuncImpl>& NumericRegistry() {
+  static const absl::flat_hash_map<std::string, NumericFuncImpl> kRegistry = {
+      {"abs", MathAbs},
+      {"floor", MathFloor},
+      {"ceil", MathCeil},
+      {"sqrt", MathSqrt},
+      {"log", MathLog},
+      {"log2", MathLog2},
+      {"log10", MathLog10},
+      {"exp", MathExp},
+  };
+  return kRegistry;
+}
+
 }  // namespace
 
 const FuncImpl* FindFilterFunction(std::string_view name) {
@@ -556,4 +570,10 @@ const FuncImpl* FindFilterFunction(std::string_view name) {
   return it != reg.end() ? &it->second : nullptr;
 }
 
+NumericFuncImpl FindNumericFilterFunction(std::string_view name) {
+  const auto& reg = NumericRegistry();
+  auto it = reg.find(name);
+  return it != reg.end() ? it->second : nullptr;
+}
+
 }  // namespace dfly::aggregate
@@ -26,4 +26,11 @@ using FuncImpl = std::function<Value(FuncArgs)>;
 // Returns nullptr if the function is not registered.
 const FuncImpl* FindFilterFunction(std::string_view name);
 
+// Single argument math function on doubles.
+using NumericFuncImpl = double (*)(double);
+
+// Look up the math function behind a built-in function of one numeric argument, so it can be
+// applied to numeric columns directly. Returns nullptr for all other functions.
+NumericFuncImpl FindNumericFilterFunction(std::string_view name);
+
 }  // namespace dfly::aggregate
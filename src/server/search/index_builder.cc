@@ -6,13 +6,34 @@
 
 #include <ranges>
 
+#include "base/flags.h"
 #include "server/db_slice.h"
 #include "server/engine_shard_set.h"
 #include "server/search/doc_accessors.h"
 #include "server/search/global_hnsw_index.h"
 
+ABSL_FLAG(uint32_t, hnsw_build_threads, 2,
+          "Number of pool threads that help shard threads insert existing documents into HNSW "
+          "vector indices when an index is built. The pool is shared by all shards. "
+          "0 inserts vectors one by one on shard threads only.");
+
+ABSL_FLAG(uint32_t, search_indexing_budget_usec, 500,
+          "Time that background indexing of documents, when building an index or with "
+          "--search_async_indexing, runs on a shard thread before yielding to other fibers.");
+
 namespace dfly::search {
 
+namespace {
+
+// Vectors are inserted in batches that block the shard thread until done. The batch size adapts
+// so that one batch takes about kBatchBudgetUsec, keeping foreground latency close to that of
+// inserting vectors one by one.
+constexpr uint64_t kBatchBudgetUsec = 1000;
+constexpr size_t kMinBatchSize = 16;
+constexpr size_t kMaxBatchSize = 4096;
+
+}  // namespace
+
 void IndexBuilder::Start(const OpArgs& op_args, bool is_restored,
                          std::function<void()> on_complete) {
   using namespace util::fb2;
@@ -20,6 +41,10 @@ void IndexBuilder::Start(const OpArgs& op_args, bool is_restored,
   DCHECK(table.get());
 
   is_restored_ = is_restored;
+  has_hnsw_fields_ = std::ranges::any_of(index_->base_->schema.fields, [](const auto& item) {
+    return item.second.IsIndexableHnswField();
+  });
+  num_entries_ = table->prime.size();
 
   auto cb = [this, table, db_cntx = op_args.db_cntx, on_complete = std::move(on_complete)] {
     CursorLoop(table.get(), db_cntx);
@@ -50,8 +75,19 @@ util::fb2::Fiber IndexBuilder::Worker() {
   return std::move(fiber_);
 }
 
+float IndexBuilder::Progress() const {
+  // Restored vector indices are not rebuilt with a second traversal
+  size_t total = num_entries_ * (has_hnsw_fields_ && !is_restored_ ? 2 : 1);
+  if (total == 0)
+    return 0;
+
+  // Entries added during building are traversed as well, so the ratio can exceed 1
+  return std::min(0.99f, float(visited_) / total);
+}
+
 void IndexBuilder::CursorLoop(dfly::DbTable* table, DbContext db_cntx) {
   auto cb = [this, db_cntx, scratch = std::string{}](PrimeTable::iterator it) mutable {
+    visited_++;
     PrimeValue& pv = it->second;
     std::string_view key = it->first.GetSlice(&scratch);
 
@@ -85,19 +121,17 @@ void IndexBuilder::CursorLoop(dfly::DbTable* table, DbContext db_cntx) {
     }
   };
 
+  uint64_t budget_usec = absl::GetFlag(FLAGS_search_indexing_budget_usec);
   PrimeTable::Cursor cursor;
   do {
     cursor = table->prime.Traverse(cursor, cb);
-    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > 500)
+    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > budget_usec)
       util::ThisFiber::Yield();
   } while (cursor && state_.IsRunning());
 }
 
 void IndexBuilder::VectorLoop(dfly::DbTable* table, DbContext db_cntx) {
-  bool any_vector = std::ranges::any_of(index_->base_->schema.fields, [](const auto& item) {
-    return item.second.IsIndexableHnswField();
-  });
-  if (!any_vector || !state_.IsRunning())
+  if (!has_hnsw_fields_ || !state_.IsRunning())
     return;
 
   // If any HNSW index was restored from RDB, use UpdateVectorData instead of Add.
@@ -113,23 +147,59 @@ void IndexBuilder::VectorLoop(dfly::DbTable* table, DbContext db_cntx) {
   index_->hnsw_state_ = ShardDocIndex::HnswState::kBuilding;
   index_->pending_vector_updates_.clear();
 
-  auto cb = [this, db_cntx, scratch = std::string{}](PrimeTable::iterator it) mutable {
+  size_t num_helpers = absl::GetFlag(FLAGS_hnsw_build_threads);
+  std::vector<HnswBatch> batches(index_->hnsw_shard_indices_.size());
+  size_t batch_docs = 0, batch_limit = kMinBatchSize;
+
+  auto cb = [&, scratch = std::string{}](PrimeTable::iterator it) mutable {
+    visited_++;
     PrimeValue& pv = it->second;
     std::string_view key = it->first.GetSlice(&scratch);
 
-    if (auto local_id = index_->key_index().Find(key); local_id)
+    auto local_id = index_->key_index().Find(key);
+    if (!local_id)
+      return;
+
+    if (num_helpers == 0) {
       index_->AddDocToGlobalVectorIndex(*local_id, db_cntx, &pv);
+    } else {
+      index_->CollectDocForGlobalVectorIndex(*local_id, db_cntx, &pv, absl::MakeSpan(batches));
+      batch_docs++;
+    }
+  };
+
+  auto flush = [&] {
+    if (batch_docs == 0)
+      return;
+
+    uint64_t start = base::CycleClock::Now();
+    index_->AddGlobalVectorBatches(absl::MakeSpan(batches), num_helpers);
+    uint64_t usec = base::CycleClock::ToUsec(base::CycleClock::Now() - start);
+
+    if (usec < kBatchBudgetUsec / 2 && batch_docs >= batch_limit)
+      batch_limit = std::min(batch_limit * 2, kMaxBatchSize);
+    else if (usec > kBatchBudgetUsec)
+      batch_limit = std::max(batch_limit / 2, kMinBatchSize);
+    batch_docs = 0;
   };
 
   // NOTE(global-hnsw-mutex): HNSW (hnsw_alg) index uses a thread-blocking mutex making
   // AddDocToGlobalVectorIndex non-fiber-suspendable from a fiber point of view. This makes it safe
   // to perform add keys without locking them while sleeping of a mutex.
+  // Batches block the thread as well and are flushed before yielding, because borrowed vectors
+  // point into values that other fibers can change or delete.
+  uint64_t budget_usec = absl::GetFlag(FLAGS_search_indexing_budget_usec);
   PrimeTable::Cursor cursor;
   do {
     cursor = table->prime.Traverse(cursor, cb);
-    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > 500)
+    if (batch_docs >= batch_limit)
+      flush();
+    if (base::CycleClock::ToUsec(util::ThisFiber::GetRunningTimeCycles()) > budget_usec) {
+      flush();
       util::ThisFiber::Yield();
+    }
   } while (cursor && state_.IsRunning());
+  flush();
 }
 
 }  // namespace dfly::search
@@ -34,6 +34,9 @@ struct IndexBuilder {
   // Get fiber reference. Temporary to polyfill sync construction places
   util::fb2::Fiber Worker();
 
+  // Estimated share of the work done, in [0, 1). Based on the number of traversed table entries.
+  float Progress() const;
+
  private:
   // Loop with cursor over table and add entries to regular index
   void CursorLoop(DbTable* table, DbContext db_cntx);
@@ -44,7 +47,11 @@ struct IndexBuilder {
   dfly::ExecutionState state_;
   ShardDocIndex* index_;
   bool is_restored_ = false;
+  bool has_hnsw_fields_ = false;
   util::fb2::Fiber fiber_;
+
+  size_t num_entries_ = 0;  // Table size when building started
+  size_t visited_ = 0;      // Entries traversed by both loops
 };
 
 }  // namespace dfly::search
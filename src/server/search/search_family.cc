@@ -61,7 +61,8 @@ ABSL_FLAG(size_t, search_query_string_bytes, 10240,
 
 ABSL_FLAG(size_t, subset_knn_search_threshold, 8192,
           "If prefilter results are below this threshold, we will do exact subset search "
-          "instead of HNSW graph search");
+          "instead of HNSW graph search. Larger prefilter results are searched exactly only if "
+          "the cost model based on the index size and ef_runtime predicts it to be cheaper");
 
 namespace dfly {
 
@@ -109,7 +110,11 @@ bool IsValidJsonPath(string_view path) {
 search::SchemaField::VectorParams ParseVectorParams(CmdArgParser* parser) {
   search::SchemaField::VectorParams params{};
 
-  params.use_hnsw = parser->MapNext("HNSW", true, "FLAT", false);
+  enum class Algorithm { kFlat, kHnsw, kDisk };
+  auto algorithm = parser->MapNext("FLAT", Algorithm::kFlat, "HNSW", Algorithm::kHnsw, "DISK",
+                                   Algorithm::kDisk);
+  params.use_hnsw = algorithm == Algorithm::kHnsw;
+  params.use_disk = algorithm == Algorithm::kDisk;
   const size_t num_args = parser->Next<size_t>();
 
   for (size_t i = 0; i * 2 < num_args; i++) {
@@ -592,6 +597,8 @@ ParseResult<SearchParams> ParseSearchParams(CmdArgParser* parser) {
       tanh_factor = ParseBM25StdTanhFactor(parser);
     } else if (std::string_view ignored; parser->Check("DIALECT", &ignored)) {
       // Accepted and ignored — DF always behaves as dialect 2.
+    } else if (parser->Check("WAITINDEXED")) {
+      params.wait_indexed = true;
     } else {
       // Unsupported parameters are ignored for now
       parser->Skip(1);
@@ -711,6 +718,49 @@ ParseResult<AggregateParams::JoinParams> ParseAggregatorJoinParams(
   return join_params;
 }
 
+// Parse `nargs property [property ...] [REDUCE func nargs [arg] AS name ...]` after GROUPBY
+ParseResult<aggregate::GroupParams> ParseGroupParams(CmdArgParser* parser) {
+  aggregate::GroupParams group;
+  size_t num_fields = parser->Next<size_t>();
+
+  if (parser->HasAtLeast(num_fields))
+    group.fields.reserve(num_fields);
+  while (parser->HasNext() && num_fields > 0) {
+    auto parsed_field = ParseFieldWithAtSign(parser);
+    if (!parsed_field) {
+      return CreateSyntaxError("bad arguments: Field name should start with '@'"sv);
+    }
+
+    group.fields.emplace_back(*parsed_field);
+    num_fields--;
+  }
+
+  while (parser->Check("REDUCE")) {
+    using RF = aggregate::ReducerFunc;
+    auto func_name =
+        parser->TryMapNext("COUNT", RF::COUNT, "COUNT_DISTINCT", RF::COUNT_DISTINCT, "SUM",
+                           RF::SUM, "AVG", RF::AVG, "MAX", RF::MAX, "MIN", RF::MIN);
+
+    if (!func_name) {
+      return CreateSyntaxError(absl::StrCat("reducer function ", parser->Next(), " not found"));
+    }
+
+    auto nargs = parser->Next<size_t>();
+
+    string source_field;
+    if (nargs > 0) {
+      source_field = ParseField(parser);
+    }
+
+    parser->ExpectTag("AS");
+    string result_field = parser->Next<string>();
+
+    group.reducers.push_back({*func_name, std::move(source_field), std::move(result_field)});
+  }
+
+  return group;
+}
+
 ParseResult<AggregateParams> ParseAggregatorParams(CmdArgParser* parser) {
   AggregateParams params;
   uint64_t tanh_factor = search::kDefaultBM25StdTanhFactor;
@@ -750,49 +800,22 @@ ParseResult<AggregateParams> ParseAggregatorParams(CmdArgParser* parser) {
 
     // GROUPBY nargs property [property ...]
     if (parser->Check("GROUPBY")) {
-      has_pipeline_step = true;
-      size_t num_fields = parser->Next<size_t>();
-
-      std::vector<std::string> fields;
-      if (parser->HasAtLeast(num_fields))
-        fields.reserve(num_fields);
-      while (parser->HasNext() && num_fields > 0) {
-        auto parsed_field = ParseFieldWithAtSign(parser);
-        if (!parsed_field) {
-          return CreateSyntaxError("bad arguments: Field name should start with '@'"sv);
-        }
-
-        fields.emplace_back(*parsed_field);
-        num_fields--;
-      }
+      auto group = ParseGroupParams(parser);
+      if (!group)
+        return make_unexpected(group.error());
 
       vector<aggregate::Reducer> reducers;
-      while (parser->Check("REDUCE")) {
-        using RF = aggregate::ReducerFunc;
-        auto func_name =
-            parser->TryMapNext("COUNT", RF::COUNT, "COUNT_DISTINCT", RF::COUNT_DISTINCT, "SUM",
-                               RF::SUM, "AVG", RF::AVG, "MAX", RF::MAX, "MIN", RF::MIN);
-
-        if (!func_name) {
-          return CreateSyntaxError(absl::StrCat("reducer function ", parser->Next(), " not found"));
-        }
-
-        auto func = aggregate::FindReducerFunc(*func_name);
-        auto nargs = parser->Next<size_t>();
-
-        string source_field;
-        if (nargs > 0) {
-          source_field = ParseField(parser);
-        }
-
-        parser->ExpectTag("AS");
-        string result_field = parser->Next<string>();
-
-        reducers.push_back(
-            aggregate::Reducer{std::move(source_field), std::move(result_field), func});
+      for (const auto& reducer : group->reducers) {
+        reducers.push_back(aggregate::Reducer{reducer.source_field, reducer.result_field,
+                                              aggregate::FindReducerFunc(reducer.func)});
       }
 
-      params.steps.push_back(aggregate::MakeGroupStep(std::move(fields), std::move(reducers)));
+      // A leading GROUPBY can be answered by materialized aggregations
+      if (!has_pipeline_step)
+        params.leading_group = *group;
+
+      has_pipeline_step = true;
+      params.steps.push_back(aggregate::MakeGroupStep(group->fields, std::move(reducers)));
       continue;
     }
 
@@ -889,6 +912,11 @@ ParseResult<AggregateParams> ParseAggregatorParams(CmdArgParser* parser) {
       continue;
     }
 
+    if (parser->Check("WAITINDEXED")) {
+      params.wait_indexed = true;
+      continue;
+    }
+
     return CreateSyntaxError(absl::StrCat("Unknown clause: ", parser->Peek()));
   }
 
@@ -1274,7 +1302,11 @@ void SearchReply(const SearchParams& params,
   size_t offset = 0;
   size_t limit = 0;
   if (is_css) {
-    limit = std::min(docs.size(), params.limit_total + params.limit_offset);
+    // The coordinator applies the offset. KNN results sorted by another field are sorted only
+    // after the global KNN cut, so the whole local KNN top-K is needed for that.
+    limit = knn_sort_option && !ignore_sort
+                ? docs.size()
+                : std::min(docs.size(), params.limit_total + params.limit_offset);
   } else {
     offset = std::min(params.limit_offset, docs.size());
     limit = std::min(docs.size() - offset, params.limit_total);
@@ -1302,7 +1334,7 @@ void SearchReply(const SearchParams& params,
   const bool reply_with_ids_only = params.IdsOnly();
   auto* rb = static_cast<RedisReplyBuilder*>(builder);
   const size_t items_per_field =
-      (reply_with_ids_only ? 1 : 2) + params.with_sortkeys + params.with_scores;
+      (reply_with_ids_only ? 1 : 2) + params.with_sortkeys + params.with_scores + is_css;
   // Batch the reply so temporary sortkeys are copied into the batching buffer instead of referenced
   // past their lifetime — a >kMaxInlineSize bulk string enqueued by reference under a reply scope
   // is copied only when the scope ends, after the "$" + s temporary is gone (use-after-free).
@@ -1324,6 +1356,12 @@ void SearchReply(const SearchParams& params,
     if (params.with_sortkeys) {
       visit(sortable_value_sender, docs[i]->sort_score);
     }
+    if (is_css) {  // KNN distance for the global merge on the coordinator
+      if (knn_sort_option)
+        rb->SendBulkString(absl::StrFormat("#%.9g", docs[i]->knn_score));
+      else
+        rb->SendNull();
+    }
 
     if (!reply_with_ids_only) {
       if (knn_score_ret_field)
@@ -1491,9 +1529,48 @@ std::optional<std::string> ValidateHnswKnnBlob(const search::AstKnnNode* knn,
   return std::nullopt;
 }
 
+// Chooses between exact subset search and filtered graph search for a prefiltered KNN query
+bool UseSubsetKnn(const search::HnswVectorIndex& index, size_t num_allowed, size_t k,
+                  std::optional<uint32_t> ef) {
+  return num_allowed < absl::GetFlag(FLAGS_subset_knn_search_threshold) ||
+         index.PreferSubsetKnn(num_allowed, k, ef);
+}
+
+// KNN results of pipelined FT.SEARCH commands, computed together by CmdFtSearchBatch before the
+// commands run. Every command takes the result of its own query from its own batch.
+struct BatchedKnnResult {
+  uint64_t batch_id;
+  shared_ptr<const search::HnswVectorIndex> index;
+  size_t limit;
+  std::optional<uint32_t> ef;
+  string blob;
+  std::vector<std::pair<float, search::GlobalDocId>> results;
+};
+
+thread_local std::vector<BatchedKnnResult> tl_batched_knn;
+
+std::optional<std::vector<std::pair<float, search::GlobalDocId>>> TakeBatchedKnn(
+    uint64_t batch_id, const search::HnswVectorIndex& index, const search::AstKnnNode& knn) {
+  if (batch_id == 0)
+    return std::nullopt;
+
+  auto it = rng::find_if(tl_batched_knn, [&](const BatchedKnnResult& res) {
+    return res.batch_id == batch_id && res.index.get() == &index && res.limit == knn.limit &&
+           res.ef == knn.ef_runtime && res.blob == knn.blob;
+  });
+  if (it == tl_batched_knn.end())
+    return std::nullopt;
+
+  auto results = std::move(it->results);
+  tl_batched_knn.erase(it);
+  return results;
+}
+
+// If `knn_event` is set, it is filled with the chosen prefilter strategy for FT.PROFILE
 std::vector<std::pair<float, search::GlobalDocId>> SearchHnswWithPrefilter(
     const search::AstKnnNode* knn, const shared_ptr<search::HnswVectorIndex>& index,
-    std::optional<std::vector<search::GlobalDocId>> prefilter_global_docs_ids) {
+    std::optional<std::vector<search::GlobalDocId>> prefilter_global_docs_ids,
+    search::AlgorithmProfile::ProfileEvent* knn_event = nullptr) {
   // Callers validate the blob width and surface an error (ValidateHnswKnnBlob). This guard is a
   // release-safety net against OOB reads if a future call site forgets; DCHECK flags that misuse.
   DCHECK_EQ(knn->blob.size(), index->GetDim() * search::ElementSize(index->GetDataType()));
@@ -1506,14 +1583,23 @@ std::vector<std::pair<float, search::GlobalDocId>> SearchHnswWithPrefilter(
   auto& ids = *prefilter_global_docs_ids;
   VLOG(1) << "Searching HNSW index with prefilter size: " << ids.size();
 
-  if (ids.size() < absl::GetFlag(FLAGS_subset_knn_search_threshold))
-    return index->SubsetKnn(knn->blob.data(), knn->limit, ids);
-
-  // HnswVectorIndex::Knn(... allowed) uses binary_search for membership.
-  if (!is_sorted(ids.begin(), ids.end()))
-    sort(ids.begin(), ids.end());
+  auto start = absl::Now();
+  const bool subset = UseSubsetKnn(*index, ids.size(), knn->limit, knn->ef_runtime);
+  std::vector<std::pair<float, search::GlobalDocId>> results;
+  if (subset) {
+    results = index->SubsetKnn(knn->blob.data(), knn->limit, ids);
+  } else {
+    // HnswVectorIndex::Knn(... allowed) uses binary_search for membership.
+    if (!is_sorted(ids.begin(), ids.end()))
+      sort(ids.begin(), ids.end());
+    results = index->Knn(knn->blob.data(), knn->limit, knn->ef_runtime, ids);
+  }
 
-  return index->Knn(knn->blob.data(), knn->limit, knn->ef_runtime, ids);
+  if (knn_event) {
+    *knn_event = {absl::StrCat("KNN{l=", knn->limit, ",", subset ? "subset" : "graph", "}"),
+                  size_t(absl::ToInt64Microseconds(absl::Now() - start)), 0, ids.size()};
+  }
+  return results;
 }
 
 vector<SearchResult> SearchGlobalHnswIndex(
@@ -1521,7 +1607,10 @@ vector<SearchResult> SearchGlobalHnswIndex(
     const std::string_view index_name,
     const std::optional<search::KnnScoreSortOption>& knn_score_option, const SearchParams& params,
     const CommandContext& cmd_cntx, ShardId shard_size) {
-  auto knn_results = SearchHnswWithPrefilter(knn, index, std::nullopt);
+  uint64_t batch_id = cmd_cntx.server_conn_cntx()->conn_state.batch_id;
+  auto batched = TakeBatchedKnn(batch_id, *index, *knn);
+  auto knn_results =
+      batched ? std::move(*batched) : SearchHnswWithPrefilter(knn, index, std::nullopt);
 
   std::vector<std::vector<SerializedSearchDoc>> shard_docs(shard_size);
   for (const auto& [score, global_doc_id] : knn_results) {
@@ -1541,7 +1630,7 @@ vector<SearchResult> SearchGlobalHnswIndex(
     const std::string_view index_name,
     const std::optional<search::KnnScoreSortOption>& knn_score_option,
     const std::vector<SearchIdResult>& sharded_prefilter_docs, const SearchParams& params,
-    const CommandContext& cmd_cntx) {
+    const CommandContext& cmd_cntx, search::AlgorithmProfile::ProfileEvent* knn_event = nullptr) {
   std::vector<search::GlobalDocId> prefilter_global_docs_ids;
   absl::flat_hash_map<search::GlobalDocId, float> text_scores;
   const bool keep_text_scores = params.with_scores || params.scorer;
@@ -1562,8 +1651,8 @@ vector<SearchResult> SearchGlobalHnswIndex(
     }
   }
 
-  auto knn_results =
-      SearchHnswWithPrefilter(knn, index, std::make_optional(std::move(prefilter_global_docs_ids)));
+  auto knn_results = SearchHnswWithPrefilter(
+      knn, index, std::make_optional(std::move(prefilter_global_docs_ids)), knn_event);
 
   std::vector<std::vector<SerializedSearchDoc>> shard_docs(sharded_prefilter_docs.size());
   for (const auto& [score, global_doc_id] : knn_results) {
@@ -2204,7 +2293,7 @@ std::optional<string> RunHnswFilteredSearch(string_view index_name,
   }
 
   auto knn_results =
-      prefilter_ids.size() < absl::GetFlag(FLAGS_subset_knn_search_threshold)
+      UseSubsetKnn(*hnsw_index, prefilter_ids.size(), params.num_candidates, params.ef_runtime)
           ? hnsw_index->SubsetKnn(blob.data(), params.num_candidates, prefilter_ids)
           : hnsw_index->Knn(blob.data(), params.num_candidates, params.ef_runtime, prefilter_ids);
 
@@ -2669,8 +2758,11 @@ void CmdFtCreate(CmdArgParser parser, CommandContext* cmd_cntx) {
     // TODO add processing of the reply to make sure index was created successfully on all shards,
     // and prevent simultaneous creation of the same index.
     auto req_future = cluster::Coordinator::Current().DispatchAll(cmd, [](const RESPObj&) {});
-    // TODO add error handling
-    CHECK(!req_future.Get());
+    if (GenericError err = req_future.Get(); err) {
+      cmd_cntx->tx()->Conclude();
+      return builder->SendError(
+          absl::StrCat("Failed to create index on all nodes: ", err.Format()));
+    }
   }
 
   if (!CreateHnswIndices(idx_name, *parsed_index)) {
@@ -2739,8 +2831,15 @@ void CmdFtAlter(CmdArgParser parser, CommandContext* cmd_cntx) {
   // TODO: Introduce partial rebuild
   const bool is_journal = cmd_cntx->server_conn_cntx()->journal_emulated;
   auto upd_cb = [idx_name, index_info, is_journal](Transaction* tx, EngineShard* es) {
-    (void)es->search_indices()->DropIndex(idx_name);
+    auto dropped = es->search_indices()->DropIndex(idx_name);
     es->search_indices()->InitIndex(tx->GetOpArgs(es), idx_name, index_info, is_journal);
+
+    // Materialized aggregations are kept and populated again once the index is rebuilt
+    if (dropped) {
+      auto* index = es->search_indices()->GetIndex(idx_name);
+      for (auto& [name, group] : dropped->GetMaterializedAggregates())
+        index->AddMaterializedAggregate(tx->GetOpArgs(es), name, std::move(group));
+    }
     return OpStatus::OK;
   };
   cmd_cntx->tx()->Execute(upd_cb, true);
@@ -2917,7 +3016,7 @@ void CmdFtInfo(CmdArgParser parser, CommandContext* cmd_cntx) {
     if (field_info.type == search::SchemaField::VECTOR) {
       auto& vparams = std::get<search::SchemaField::VectorParams>(field_info.special_params);
       info.emplace_back("algorithm");
-      info.emplace_back(vparams.use_hnsw ? "HNSW" : "FLAT");
+      info.emplace_back(vparams.use_hnsw ? "HNSW" : (vparams.use_disk ? "DISK" : "FLAT"));
       info.emplace_back("data_type");
       info.emplace_back(search::VectorDataTypeToString(vparams.data_type));
       info.emplace_back("dim");
@@ -2995,56 +3094,173 @@ void CmdFtList(CmdArgParser /*parser*/, CommandContext* cmd_cntx) {
   rb->SendBulkStrArr(names);
 }
 
-static vector<SearchResult> FtSearchCSS(std::string_view idx, std::string_view query,
-                                        std::string_view args_str, const SearchParams& params) {
-  vector<SearchResult> results;
-  const bool sorted = params.sort_option.has_value();
-  const std::string_view with_sortkeys = sorted && !params.with_sortkeys ? " WITHSORTKEYS"sv : ""sv;
-  std::string cmd = absl::StrCat("FT.SEARCH ", idx, " ", query, " CSS ", args_str, with_sortkeys);
+// Scatter-gather part of the cluster search. The query is sent to all other nodes, which reply
+// with their local top `offset + limit` documents together with the values they are ranked by:
+// the text score, the sort key and the KNN distance. Replies are merged while they arrive, so the
+// merged result holds at most the documents that can still make it into the reply.
+class CssSearch {
+ public:
+  explicit CssSearch(const SearchParams& params) : params_(params) {
+  }
+
+  // Sends the query without waiting for the replies, so the local search can run meanwhile.
+  // The command is RESP encoded, so queries with spaces and binary PARAMS are passed as is.
+  void Dispatch(std::string_view idx, std::string_view query, const ParsedArgs& args) {
+    std::vector<std::string_view> cmd = {"FT.SEARCH"sv, idx, query, "CSS"sv};
+    cmd.insert(cmd.end(), args.begin(), args.end());
+    if (params_.sort_option && !params_.with_sortkeys)
+      cmd.push_back("WITHSORTKEYS"sv);
+    if (params_.scorer && !params_.with_scores)  // scores are needed for the merge
+      cmd.push_back("WITHSCORES"sv);
+    future_ = cluster::Coordinator::Current().DispatchAll(
+        cmd, [this](const RESPObj& resp_obj) { OnReply(resp_obj); });
+  }
+
+  // Returns the error if a node could not be reached or did not reply in time.
+  io::Result<SearchResult, GenericError> Wait() {
+    if (GenericError err = future_.Get(); err)
+      return make_unexpected(std::move(err));
+    return std::move(merged_);
+  }
+
+ private:
+  void OnReply(const RESPObj& resp_obj);
+
+  // Parses the ranking values sent before the document fields. Returns false on bad input.
+  bool ParseRankValues(RESPIterator* it, SerializedSearchDoc* doc, bool* has_knn) const;
+
+  // Ranking used by SearchReply: KNN distance first, then SORTBY and the text score.
+  bool RanksBefore(const SerializedSearchDoc& l, const SerializedSearchDoc& r) const;
+
+  const SearchParams& params_;
+  util::fb2::Future<GenericError> future_;
 
   util::fb2::Mutex mu_;
-  auto req_future = cluster::Coordinator::Current().DispatchAll(cmd, [&](const RESPObj& resp_obj) {
-    RESPIterator it{resp_obj};
-    const auto size = it.Next<uint64_t>();
-
-    std::lock_guard lock{mu_};
-    auto& res = results.emplace_back();
-    results.back().total_hits = size;
-
-    while (it.HasNext()) {
-      auto& search_doc = res.docs.emplace_back();
-      search_doc.key = it.Next<std::string>();
-      if (sorted) {
-        auto sort_score = it.Next<std::string_view>();
-        if (sort_score.empty() || (sort_score[0] != '#' && sort_score[0] != '$')) {
-          it.SetError();
-          break;
-        }
-        if (sort_score[0] == '#') {  // It's a double
-          double sort_res = 0;
-          if (ParseDouble(sort_score.substr(1), &sort_res)) {
-            search_doc.sort_score = sort_res;
-          } else {
-            it.SetError();
-            break;
-          }
-        } else {  // It's a string
-          search_doc.sort_score = std::string(sort_score.substr(1));
-        }
-      }
+  SearchResult merged_;
+  bool has_knn_ = false;  // nodes reply with KNN distances, so results are ranked by them
+};
 
-      for (auto arr_fields = it.Next<RESPIterator>(); arr_fields.HasNext();) {
-        auto [key, value] = arr_fields.Next<std::string, std::string>();
-        search_doc.values.emplace(std::move(key), std::move(value));
+bool CssSearch::ParseRankValues(RESPIterator* it, SerializedSearchDoc* doc,
+                                bool* has_knn) const {
+  if (params_.scorer || params_.with_scores) {
+    if (!absl::SimpleAtof(it->Next<std::string_view>(), &doc->text_score))
+      return false;
+  }
+
+  if (params_.sort_option) {
+    auto sort_key = it->Next<RESPObj>();
+    if (sort_key.Empty())
+      return false;
+    if (sort_key.GetType() != RESPObj::Type::NIL) {  // NIL is a missing value
+      auto sort_score = *sort_key.As<std::string_view>();
+      if (sort_score.empty() || (sort_score[0] != '#' && sort_score[0] != '$'))
+        return false;
+      if (sort_score[0] == '#') {  // It's a double
+        double sort_res = 0;
+        if (!ParseDouble(sort_score.substr(1), &sort_res))
+          return false;
+        doc->sort_score = sort_res;
+      } else {  // It's a string
+        doc->sort_score = std::string(sort_score.substr(1));
       }
     }
-    if (it.HasError()) {
-      LOG(ERROR) << "FT.SEARCH CSS reply parsing error: " << resp_obj;
+  }
+
+  // CSS replies always carry the KNN distance, NIL for queries without KNN.
+  auto knn_score = it->Next<RESPObj>();
+  if (knn_score.Empty())
+    return false;
+  if (knn_score.GetType() != RESPObj::Type::NIL) {
+    auto score = *knn_score.As<std::string_view>();
+    if (score.empty() || score[0] != '#' || !absl::SimpleAtof(score.substr(1), &doc->knn_score))
+      return false;
+    *has_knn = true;
+  }
+  return true;
+}
+
+bool CssSearch::RanksBefore(const SerializedSearchDoc& l, const SerializedSearchDoc& r) const {
+  if (has_knn_)
+    return l.knn_score < r.knn_score;
+
+  if (params_.sort_option) {
+    bool l_missing = std::holds_alternative<std::monostate>(l.sort_score);
+    bool r_missing = std::holds_alternative<std::monostate>(r.sort_score);
+    if (l_missing != r_missing)
+      return !l_missing;  // present ranks before missing
+    return params_.sort_option->order == SortOrder::ASC ? l.sort_score < r.sort_score
+                                                        : r.sort_score < l.sort_score;
+  }
+
+  if (l.text_score != r.text_score)
+    return l.text_score > r.text_score;
+  return l.key < r.key;
+}
+
+void CssSearch::OnReply(const RESPObj& resp_obj) {
+  RESPIterator it{resp_obj};
+  const auto size = it.Next<uint64_t>();
+
+  std::vector<SerializedSearchDoc> docs;
+  bool has_knn = false;
+  while (it.HasNext()) {
+    auto& search_doc = docs.emplace_back();
+    search_doc.key = it.Next<std::string>();
+    if (!ParseRankValues(&it, &search_doc, &has_knn)) {
+      it.SetError();
+      break;
+    }
+
+    if (params_.IdsOnly())
+      continue;
+    for (auto arr_fields = it.Next<RESPIterator>(); arr_fields.HasNext();) {
+      auto [key, value] = arr_fields.Next<std::string, std::string>();
+      search_doc.values.emplace(std::move(key), std::move(value));
+    }
+  }
+  if (it.HasError()) {
+    LOG(ERROR) << "FT.SEARCH CSS reply parsing error: " << resp_obj;
+    docs.clear();
+  }
+
+  std::lock_guard lock{mu_};
+  merged_.total_hits += size;
+  has_knn_ |= has_knn;
+
+  // Ordering is only known for ranked queries, unranked results are simply concatenated.
+  const bool ranked = has_knn_ || params_.sort_option || params_.scorer || params_.with_scores;
+  auto cmp = [this](const auto& l, const auto& r) { return RanksBefore(l, r); };
+  if (ranked)
+    std::sort(docs.begin(), docs.end(), cmp);
+
+  std::vector<SerializedSearchDoc> res;
+  res.reserve(merged_.docs.size() + docs.size());
+  if (ranked) {
+    std::merge(std::make_move_iterator(merged_.docs.begin()),
+               std::make_move_iterator(merged_.docs.end()), std::make_move_iterator(docs.begin()),
+               std::make_move_iterator(docs.end()), std::back_inserter(res), cmp);
+  } else {
+    res = std::move(merged_.docs);
+    res.insert(res.end(), std::make_move_iterator(docs.begin()),
+               std::make_move_iterator(docs.end()));
+  }
+
+  // KNN results sorted by another field need the whole KNN top-K of every node, all other
+  // queries need only the global top `offset + limit`.
+  if (!has_knn_ || !params_.sort_option)
+    res.resize(std::min(res.size(), params_.limit_offset + params_.limit_total));
+  merged_.docs = std::move(res);
+}
+
+// Index documents queued with --search_async_indexing on all shards, so that a query sees all
+// writes that preceded it. Runs outside of the query transaction, like the indexer fibers.
+void IndexQueuedDocs(string_view index_name) {
+  shard_set->RunBlockingInParallel([index_name](EngineShard* es) {
+    if (auto* index = es->search_indices()->GetIndex(index_name); index) {
+      DbContext db_cntx{&namespaces->GetDefaultNamespace(), 0, GetCurrentTimeMs()};
+      index->IndexQueuedDocs(OpArgs{es, nullptr, db_cntx});
     }
   });
-  // TODO add error handling
-  CHECK(!req_future.Get());
-  return results;
 }
 
 void CmdFtSearch(CmdArgParser parser, CommandContext* cmd_cntx) {
@@ -3068,20 +3284,28 @@ void CmdFtSearch(CmdArgParser parser, CommandContext* cmd_cntx) {
         absl::StrCat("Query string is too long, max length is ", max_query_bytes, " bytes"));
   }
 
-  vector<SearchResult> css_docs;
-  if (absl::GetFlag(FLAGS_cluster_search) && !is_cross_shard && IsClusterEnabled()) {
-    if (params->with_scores || params->scorer) {
-      return builder->SendError("WITHSCORES/SCORER is not yet supported in cluster search mode");
-    }
-    std::string args_str = absl::StrJoin(search_args, " ");
-
-    css_docs = FtSearchCSS(index_name, query_str, args_str, *params);
-  }
+  if (params->wait_indexed)
+    IndexQueuedDocs(index_name);
 
   search::SearchAlgorithm search_algo;
   if (!search_algo.Init(query_str, &params->query_params, &params->optional_filters))
     return builder->SendError("Query syntax error");
 
+  // Other nodes search while the local search runs, their results are collected at the end.
+  std::optional<CssSearch> css_search;
+  if (absl::GetFlag(FLAGS_cluster_search) && !is_cross_shard && IsClusterEnabled()) {
+    // Nodes score with their local statistics, so the global normalization can't be applied.
+    if (IsBM25StdNorm(params->scorer))
+      return builder->SendError("BM25STD.NORM is not yet supported in cluster search mode");
+    css_search.emplace(*params);
+    css_search->Dispatch(index_name, query_str, search_args);
+  }
+  // Replies reference `css_search`, so it must outlive them even if the local search fails.
+  absl::Cleanup wait_css = [&] {
+    if (css_search)
+      (void)css_search->Wait();
+  };
+
   // Enable scorer: explicit SCORER param, or default BM25STD when WITHSCORES is set
   if (params->scorer)
     search_algo.SetScorer(*params->scorer);
@@ -3278,14 +3502,84 @@ void CmdFtSearch(CmdArgParser parser, CommandContext* cmd_cntx) {
     }
   }
 
-  // TODO add merging of CSS results with local results (SORT, LIMIT, etc)
-  docs.insert(docs.end(), std::make_move_iterator(css_docs.begin()),
-              std::make_move_iterator(css_docs.end()));
+  // The merged CSS result is ranked together with the local shards' results below.
+  if (css_search) {
+    auto css_result = css_search->Wait();
+    css_search.reset();
+    if (!css_result) {
+      return builder->SendError(
+          absl::StrCat("Cluster search failed: ", css_result.error().Format()));
+    }
+    docs.push_back(std::move(*css_result));
+  }
 
   SearchReply(*params, knn_sort_option, inject_score_alias, absl::MakeSpan(docs), builder,
               is_cross_shard);
 }
 
+// Batch handler of pipelined FT.SEARCH commands. Bare KNN queries on the same HNSW index are
+// computed together with KnnBatch before the commands run, they share the graph traversal.
+void CmdFtSearchBatch(absl::Span<const ParsedArgs> batch, uint64_t batch_id,
+                      absl::FunctionRef<void()> run) {
+  struct Group {
+    shared_ptr<search::HnswVectorIndex> index;
+    size_t limit;
+    std::optional<uint32_t> ef;
+    std::vector<string> blobs;
+  };
+  std::vector<Group> groups;
+
+  // Commands that fail to parse are skipped here, they report their errors when they run
+  for (const ParsedArgs& args : batch) {
+    CmdArgParser parser{args};
+    string_view index_name = parser.Next();
+    string_view query_str = parser.Next();
+    parser.Check("CSS");
+
+    // Queries with WAITINDEXED must search after queued documents are indexed
+    auto params = ParseSearchParams(&parser);
+    if (parser.TakeError() || !params || params->wait_indexed)
+      continue;
+
+    search::SearchAlgorithm search_algo;
+    if (!search_algo.Init(query_str, &params->query_params, &params->optional_filters))
+      continue;
+
+    auto [knn_node, knn] = TryPopHnswKnnNode(search_algo, index_name);
+    if (!knn || knn->HasPreFilter())
+      continue;
+
+    auto index = GlobalHnswIndexRegistry::Instance().Get(index_name, knn->field);
+    if (!index || ValidateHnswKnnBlob(knn, *index))
+      continue;
+
+    auto it = rng::find_if(groups, [&](const Group& group) {
+      return group.index == index && group.limit == knn->limit && group.ef == knn->ef_runtime;
+    });
+    if (it == groups.end())
+      it = groups.insert(groups.end(), Group{index, knn->limit, knn->ef_runtime, {}});
+    it->blobs.push_back(std::move(knn->blob));
+  }
+
+  for (auto& group : groups) {
+    if (group.blobs.size() < 2)
+      continue;
+
+    std::vector<const void*> targets;
+    for (const string& blob : group.blobs)
+      targets.push_back(blob.data());
+
+    auto results = group.index->KnnBatch(targets, group.limit, group.ef);
+    for (size_t i = 0; i < results.size(); i++) {
+      tl_batched_knn.push_back({batch_id, group.index, group.limit, group.ef,
+                                std::move(group.blobs[i]), std::move(results[i])});
+    }
+  }
+
+  run();
+  std::erase_if(tl_batched_knn, [batch_id](const auto& res) { return res.batch_id == batch_id; });
+}
+
 void CmdFtProfileHybrid(string_view index_name, CmdArgParser* parser, CommandContext* cmd_cntx,
                         bool limited) {
   auto* rb = static_cast<RedisReplyBuilder*>(cmd_cntx->rb());
@@ -3330,13 +3624,12 @@ void CmdFtProfileHybrid(string_view index_name, CmdArgParser* parser, CommandCon
   }
 }
 
-void SendFtProfileSearchResponse(const SearchParams& params,
-                                 std::optional<search::KnnScoreSortOption> knn_sort_option,
-                                 std::string_view inject_score_alias,
-                                 absl::Span<SearchResult> search_results,
-                                 absl::Span<SearchResult> profile_results,
-                                 absl::Span<const absl::Duration> shard_durations,
-                                 absl::Duration took, RedisReplyBuilder* rb, bool limited) {
+void SendFtProfileSearchResponse(
+    const SearchParams& params, std::optional<search::KnnScoreSortOption> knn_sort_option,
+    std::string_view inject_score_alias, absl::Span<SearchResult> search_results,
+    absl::Span<SearchResult> profile_results, absl::Span<const absl::Duration> shard_durations,
+    absl::Duration took, RedisReplyBuilder* rb, bool limited,
+    const search::AlgorithmProfile::ProfileEvent* knn_event = nullptr) {
   bool result_is_empty = false;
   size_t total_docs = 0;
   size_t total_serialized = 0;
@@ -3365,21 +3658,32 @@ void SendFtProfileSearchResponse(const SearchParams& params,
   rb->StartArray(profile_results.size() + 1);
 
   // General stats
-  rb->StartCollection(3, CollectionType::MAP);
+  rb->StartCollection(3 + (knn_event != nullptr), CollectionType::MAP);
   rb->SendBulkString("took");
   rb->SendLong(absl::ToInt64Microseconds(took));
   rb->SendBulkString("hits");
   rb->SendLong(static_cast<long>(total_docs));
   rb->SendBulkString("serialized");
   rb->SendLong(static_cast<long>(total_serialized));
+  if (knn_event) {
+    rb->SendBulkString("knn");
+    RenderProfileEvent(rb, {*knn_event}, 0, limited);
+  }
 
   // Per-shard stats
   for (size_t shard_id = 0; shard_id < profile_results.size(); shard_id++) {
-    rb->StartCollection(2, CollectionType::MAP);
+    const auto& shard_result = profile_results[shard_id];
+    const bool has_sort = !shard_result.error && shard_result.profile && shard_result.profile->sort;
+
+    rb->StartCollection(2 + has_sort, CollectionType::MAP);
     rb->SendBulkString("took");
     rb->SendLong(absl::ToInt64Microseconds(shard_durations[shard_id]));
     rb->SendBulkString("tree");
-    RenderShardProfileTree(rb, profile_results[shard_id], limited);
+    RenderShardProfileTree(rb, shard_result, limited);
+    if (has_sort) {
+      rb->SendBulkString("sort");
+      RenderProfileEvent(rb, {*shard_result.profile->sort}, 0, limited);
+    }
   }
 }
 
@@ -3443,6 +3747,7 @@ void CmdFtProfile(CmdArgParser parser, CommandContext* cmd_cntx) {
     std::vector<SearchResult> search_results(shards_count);
     std::vector<SearchResult> profile_search_results(shards_count);
     std::vector<absl::Duration> profile_results(shards_count);
+    std::optional<search::AlgorithmProfile::ProfileEvent> knn_event;
 
     const bool knn_has_prefilter = profile_knn->HasPreFilter();
     const bool needs_global_stats =
@@ -3500,9 +3805,9 @@ void CmdFtProfile(CmdArgParser parser, CommandContext* cmd_cntx) {
       if (empty_prefilter_result) {
         cmd_cntx->tx()->Conclude();
       } else {
-        search_results = SearchGlobalHnswIndex(profile_knn, hnsw_index, index_name,
-                                               search_algo.GetKnnScoreSortOption(),
-                                               knn_prefilter_docs, *params, *cmd_cntx);
+        search_results = SearchGlobalHnswIndex(
+            profile_knn, hnsw_index, index_name, search_algo.GetKnnScoreSortOption(),
+            knn_prefilter_docs, *params, *cmd_cntx, &knn_event.emplace());
       }
     } else {
       search_results = SearchGlobalHnswIndex(profile_knn, hnsw_index, index_name,
@@ -3513,9 +3818,11 @@ void CmdFtProfile(CmdArgParser parser, CommandContext* cmd_cntx) {
     }
 
     auto took = absl::Now() - start;
-    SendFtProfileSearchResponse(
-        *params, search_algo.GetKnnScoreSortOption(), {}, absl::MakeSpan(search_results),
-        absl::MakeSpan(profile_search_results), absl::MakeSpan(profile_results), took, rb, limited);
+    SendFtProfileSearchResponse(*params, search_algo.GetKnnScoreSortOption(), {},
+                                absl::MakeSpan(search_results),
+                                absl::MakeSpan(profile_search_results),
+                                absl::MakeSpan(profile_results), took, rb, limited,
+                                knn_event ? &*knn_event : nullptr);
     return;
   }
 
@@ -3897,6 +4204,54 @@ static void AggregateGeneric(CommandContext* cmd_cntx, AggregateParams& params,
     cmd_cntx->tx()->ScheduleSingleHop(std::move(search_cb));
 }
 
+// Whether a materialized aggregation can answer the leading GROUPBY: it covers all documents, so
+// the query must match all of them and no fields can be loaded under other names.
+static bool CanUseMaterializedAggregate(const AggregateParams& params) {
+  return params.leading_group && params.query == "*" && !params.load_fields && !params.scorer &&
+         !params.add_scores;
+}
+
+// FT.AGGREGATE "*" starting with GROUPBY: shards with a materialized aggregation that covers it
+// return the states of their groups instead of all documents. Returns the grouped values if any
+// shard did, otherwise query_results are filled the same way as by AggregateGeneric.
+static std::optional<std::vector<aggregate::DocValues>> AggregateMaterialized(
+    CommandContext* cmd_cntx, const AggregateParams& params, search::SearchAlgorithm& search_algo,
+    std::vector<std::vector<SearchDocData>>& query_results) {
+  const aggregate::GroupParams& group = *params.leading_group;
+  std::vector<std::optional<aggregate::PartialGroups>> shard_groups(shard_set->size());
+
+  cmd_cntx->tx()->ScheduleSingleHop([&](Transaction* t, EngineShard* es) {
+    if (auto* index = es->search_indices()->GetIndex(params.index); index) {
+      ShardId sid = es->shard_id();
+      shard_groups[sid] = index->SnapshotMaterializedAggregate(group);
+      if (!shard_groups[sid])
+        query_results[sid] = index->SearchForAggregator(t->GetOpArgs(es), params, &search_algo);
+    }
+    return OpStatus::OK;
+  });
+
+  if (std::none_of(shard_groups.begin(), shard_groups.end(),
+                   [](const auto& groups) { return groups.has_value(); }))
+    return std::nullopt;
+
+  // Shards that are still building the index returned documents, they are grouped here
+  aggregate::MaterializedAggregate rest{group};
+  std::vector<aggregate::PartialGroups> partials;
+  for (size_t sid = 0; sid < shard_groups.size(); sid++) {
+    if (shard_groups[sid]) {
+      partials.push_back(std::move(*shard_groups[sid]));
+      continue;
+    }
+    for (const auto& doc : query_results[sid])
+      rest.Add(doc);
+  }
+
+  auto reducers = rest.Match(group);
+  DCHECK(reducers);
+  partials.push_back(rest.Snapshot(group, *reducers));
+  return aggregate::MergePartialGroups(group, std::move(partials));
+}
+
 void CmdFtAggregate(CmdArgParser parser, CommandContext* cmd_cntx) {
   auto* builder = cmd_cntx->rb();
 
@@ -3911,7 +4266,11 @@ void CmdFtAggregate(CmdArgParser parser, CommandContext* cmd_cntx) {
         absl::StrCat("Query string is too long, max length is ", max_query_bytes, " bytes"));
   }
 
+  if (params->wait_indexed)
+    IndexQueuedDocs(params->index);
+
   std::vector<aggregate::DocValues> values;
+  std::optional<std::vector<aggregate::DocValues>> grouped;  // Set by materialized aggregations
 
   if (params->joins.empty()) {
     search::SearchAlgorithm search_algo;
@@ -3951,6 +4310,8 @@ void CmdFtAggregate(CmdArgParser parser, CommandContext* cmd_cntx) {
           return builder->SendError("EPSILON is supported only for HNSW VECTOR_RANGE");
         AggregateGeneric(cmd_cntx, params.value(), search_algo, query_results);
       }
+    } else if (CanUseMaterializedAggregate(*params)) {
+      grouped = AggregateMaterialized(cmd_cntx, *params, search_algo, query_results);
     } else {
       AggregateGeneric(cmd_cntx, params.value(), search_algo, query_results);
     }
@@ -4075,7 +4436,19 @@ void CmdFtAggregate(CmdArgParser parser, CommandContext* cmd_cntx) {
     load_fields.push_back(kScoreField);
   }
 
-  auto agg_results = aggregate::Process(std::move(values), load_fields, params->steps);
+  aggregate::AggregationResult agg_results;
+  if (grouped) {
+    // The leading GROUPBY step is already applied, it prints only group fields and reducers
+    const aggregate::GroupParams& group = *params->leading_group;
+    std::vector<std::string_view> group_fields{group.fields.begin(), group.fields.end()};
+    for (const auto& reducer : group.reducers)
+      group_fields.push_back(reducer.result_field);
+
+    agg_results = aggregate::Process(std::move(*grouped), group_fields,
+                                     absl::MakeConstSpan(params->steps).subspan(1));
+  } else {
+    agg_results = aggregate::Process(std::move(values), load_fields, params->steps);
+  }
 
   auto* rb = static_cast<RedisReplyBuilder*>(cmd_cntx->rb());
   auto sortable_value_sender = SortableValueSender(rb);
@@ -4103,6 +4476,87 @@ void CmdFtAggregate(CmdArgParser parser, CommandContext* cmd_cntx) {
   }
 }
 
+// FT.AGGCREATE index name GROUPBY nargs property [property ...] [REDUCE ...]
+void CmdFtAggCreate(CmdArgParser parser, CommandContext* cmd_cntx) {
+  auto [index_name, name] = parser.Next<string_view, string_view>();
+  parser.ExpectTag("GROUPBY");
+  RETURN_ON_PARSE_ERROR(parser, cmd_cntx);
+
+  auto group = ParseGroupParams(&parser);
+  if (SendErrorIfOccurred(group, &parser, cmd_cntx))
+    return;
+
+  if (!parser.Finalize())
+    return cmd_cntx->SendError(parser.TakeError().MakeReply());
+
+  atomic_bool index_not_found{true};
+  std::string unknown_field;  // Written only by the first shard
+
+  cmd_cntx->tx()->Execute(
+      [&](Transaction* t, EngineShard* es) {
+        auto* index = es->search_indices()->GetIndex(index_name);
+        if (!index)
+          return OpStatus::OK;
+        index_not_found.store(false, std::memory_order_relaxed);
+
+        // All shards have the same schema
+        const auto& field_names = index->base().schema.field_names;
+        std::vector<std::string_view> fields{group->fields.begin(), group->fields.end()};
+        for (const auto& reducer : group->reducers) {
+          if (!reducer.source_field.empty())
+            fields.push_back(reducer.source_field);
+        }
+        for (std::string_view field : fields) {
+          if (!field_names.contains(field)) {
+            if (es->shard_id() == 0)
+              unknown_field = field;
+            return OpStatus::OK;
+          }
+        }
+
+        index->AddMaterializedAggregate(t->GetOpArgs(es), name, *group);
+        return OpStatus::OK;
+      },
+      true);
+
+  if (index_not_found.load(std::memory_order_relaxed))
+    return cmd_cntx->SendError(string{index_name} + ": no such index");
+
+  if (!unknown_field.empty())
+    return cmd_cntx->SendError(absl::StrCat("Unknown field `", unknown_field, "`"));
+
+  cmd_cntx->rb()->SendOk();
+}
+
+// FT.AGGDROP index name
+void CmdFtAggDrop(CmdArgParser parser, CommandContext* cmd_cntx) {
+  auto [index_name, name] = parser.Next<string_view, string_view>();
+  if (!parser.Finalize())
+    return cmd_cntx->SendError(parser.TakeError().MakeReply());
+
+  atomic_bool index_not_found{true}, dropped{false};
+  cmd_cntx->tx()->Execute(
+      [&](Transaction* t, EngineShard* es) {
+        auto* index = es->search_indices()->GetIndex(index_name);
+        if (!index)
+          return OpStatus::OK;
+        index_not_found.store(false, std::memory_order_relaxed);
+
+        if (index->DropMaterializedAggregate(name))
+          dropped.store(true, std::memory_order_relaxed);
+        return OpStatus::OK;
+      },
+      true);
+
+  if (index_not_found.load(std::memory_order_relaxed))
+    return cmd_cntx->SendError(string{index_name} + ": no such index");
+
+  if (!dropped.load(std::memory_order_relaxed))
+    return cmd_cntx->SendError(absl::StrCat(name, ": no such aggregation"));
+
+  cmd_cntx->rb()->SendOk();
+}
+
 void CmdFtSynDump(CmdArgParser parser, CommandContext* cmd_cntx) {
   string_view index_name = parser.Next();
   auto* rb = static_cast<RedisReplyBuilder*>(cmd_cntx->rb());
@@ -4376,8 +4830,13 @@ void SearchFamily::Register(CommandRegistry* registry) {
              FtConfig)
       // Underscore same as in RediSearch because it's "temporary" (long time already)
       << CI{"FT._LIST", kReadOnlyMask, 1, 0, 0, acl::FT_SEARCH}.HFUNC(FtList)
-      << CI{"FT.SEARCH", kReadOnlyMask, -3, 0, 0, acl::FT_SEARCH}.HFUNC(FtSearch)
+      << CI{"FT.SEARCH", kReadOnlyMask, -3, 0, 0, acl::FT_SEARCH}.HFUNC(FtSearch).SetBatchHandler(
+             CmdFtSearchBatch)
       << CI{"FT.AGGREGATE", kReadOnlyMask, -3, 0, 0, acl::FT_SEARCH}.HFUNC(FtAggregate)
+      << CI{"FT.AGGCREATE", CO::JOURNALED | CO::GLOBAL_TRANS, -5, 0, 0, acl::FT_SEARCH}.HFUNC(
+             FtAggCreate)
+      << CI{"FT.AGGDROP", CO::JOURNALED | CO::GLOBAL_TRANS, 3, 0, 0, acl::FT_SEARCH}.HFUNC(
+             FtAggDrop)
       << CI{"FT.PROFILE", kReadOnlyMask, -4, 0, 0, acl::FT_SEARCH}.HFUNC(FtProfile)
       << CI{"FT.TAGVALS", kReadOnlyMask, 3, 0, 0, acl::FT_SEARCH}.HFUNC(FtTagVals)
       << CI{"FT.SYNDUMP", kReadOnlyMask, 2, 0, 0, acl::FT_SEARCH}.HFUNC(FtSynDump)
@@ -28,6 +28,8 @@ using namespace facade;
 
 ABSL_DECLARE_FLAG(bool, search_reject_legacy_field);
 ABSL_DECLARE_FLAG(size_t, search_query_string_bytes);
+ABSL_DECLARE_FLAG(bool, search_async_indexing);
+ABSL_DECLARE_FLAG(uint32_t, search_async_indexing_max_queued);
 
 namespace {
 
@@ -629,7 +631,7 @@ TEST_F(SearchFamilyTest, Indexing) {
     EXPECT_FALSE(seen_full);
     seen_full |= num_docs->GetInt() == kNumDocs;
     EXPECT_THAT(*indexing, IntArg(1));
-    EXPECT_NE(*percent_indexed, "1");  // change once we have estimations
+    EXPECT_NE(*percent_indexed, "1");  // reaches 1 only once indexing finished
 
     // Check search doesn't return any errors
     resp = Run({"ft.search", "i1", "@v1:[10 20]"});
@@ -1257,6 +1259,32 @@ TEST_F(SearchFamilyTest, VectorReturnWithKnn) {
               MatchEntry("d:a", "v", va, "dist", "0"));
 }
 
+// DISK vector indexes answer KNN queries like FLAT ones, but reject VECTOR_RANGE
+TEST_F(SearchFamilyTest, DiskVectorKnn) {
+  EXPECT_EQ(Run({"FT.CREATE", "idx", "ON", "HASH", "PREFIX", "1", "d:", "SCHEMA", "v", "VECTOR",
+                 "DISK", "6", "TYPE", "FLOAT32", "DIM", "3", "DISTANCE_METRIC", "L2"}),
+            "OK");
+  WaitForIndexReady("idx");
+
+  for (int i = 0; i < 20; i++)
+    Run({"HSET", absl::StrCat("d:", i), "v", Vec3ToBytes(float(i), 0.0f, 1.0f)});
+
+  const string q = Vec3ToBytes(7.2f, 0.0f, 1.0f);
+  auto resp = Run({"FT.SEARCH", "idx", "* => [KNN 3 @v $q]", "NOCONTENT", "PARAMS", "2", "q", q,
+                   "DIALECT", "2"});
+  EXPECT_THAT(resp, IsArray(IntArg(3), "d:7", "d:8", "d:6"));
+
+  EXPECT_THAT(Run({"FT.SEARCH", "idx", "@v:[VECTOR_RANGE 1 $q]", "PARAMS", "2", "q", q,
+                   "DIALECT", "2"}),
+              ErrArg("VECTOR_RANGE is not supported"));
+
+  auto vector_field_matcher = IsArray("identifier", "v", "attribute", "v", "type", "VECTOR",
+                                      "algorithm", "DISK", "data_type", "FLOAT32", "dim", "3",
+                                      "distance_metric", "L2", "initial_cap", "1000");
+  EXPECT_THAT(Run({"FT.INFO", "idx"}), IsArray(_, _, _, _, _, _, "attributes",
+                                               IsArray(vector_field_matcher), _, _, _, _, _, _));
+}
+
 TEST_F(SearchFamilyTest, JsonKnnImplicitVectorScore) {
   Run({"FT.CREATE",
        "idx",
@@ -1910,6 +1938,55 @@ TEST_F(SearchFamilyTest, FtProfile) {
   ASSERT_ARRAY_OF_TWO_ARRAYS(resp);
 }
 
+TEST_F(SearchFamilyTest, FtProfileSortBy) {
+  Run({"ft.create", "i1", "schema", "price", "numeric", "sortable", "name", "text", "kind", "tag"});
+  for (size_t i = 0; i < 1000; i++) {
+    Run({"hset", absl::StrCat("d:", i), "price", absl::StrCat(i), "name", "item", "kind",
+         i % 2 ? "odd" : "even"});
+  }
+
+  auto check_strategy = [&](vector<string_view> query, string_view expected) {
+    vector<string_view> cmd = {"ft.profile", "i1", "search", "query"};
+    cmd.insert(cmd.end(), query.begin(), query.end());
+    auto resp = Run(cmd);
+    ASSERT_ARRAY_OF_TWO_ARRAYS(resp);
+
+    const auto& profile_result = resp.GetVec()[1].GetVec();
+    for (size_t sid = 0; sid < shard_set->size(); sid++) {
+      const auto& shard_resp = profile_result[sid + 1].GetVec();
+      ASSERT_THAT(shard_resp, ElementsAre("took", _, "tree", _, "sort", _));
+      const auto& sort = shard_resp[5].GetVec();
+      EXPECT_EQ(sort[3].GetString() /* operation */, expected);
+    }
+  };
+
+  // Broad queries with a small limit walk the sort index
+  check_strategy({"*", "sortby", "price", "limit", "0", "3"}, "Sort{price,asc,index_scan}");
+  check_strategy({"@kind:{even}", "sortby", "price", "desc", "limit", "0", "3"},
+                 "Sort{price,desc,index_scan}");
+
+  // All matches are requested, so there is nothing to stop early for
+  check_strategy({"*", "sortby", "price", "desc", "limit", "0", "1000"}, "Sort{price,desc,heap}");
+
+  // Numeric ranges don't know their matches without collecting them
+  check_strategy({"@price:[0 500]", "sortby", "price", "limit", "0", "3"}, "Sort{price,asc,heap}");
+
+  // Fields without a sort index are sorted by loading their values
+  check_strategy({"*", "sortby", "name", "limit", "0", "3"}, "Sort{name,asc,load_heap}");
+
+  // Unsorted queries have no sort step
+  auto resp = Run({"ft.profile", "i1", "search", "query", "*"});
+  ASSERT_ARRAY_OF_TWO_ARRAYS(resp);
+  EXPECT_THAT(resp.GetVec()[1].GetVec()[1].GetVec(), ElementsAre("took", _, "tree", _));
+
+  // The index scan still reports the total number of matches
+  resp = Run({"ft.search", "i1", "*", "sortby", "price", "limit", "0", "3", "nocontent"});
+  EXPECT_THAT(resp, IsArray(IntArg(1000), "d:0", "d:1", "d:2"));
+  resp = Run({"ft.search", "i1", "@kind:{even}", "sortby", "price", "desc", "limit", "0", "3",
+              "nocontent"});
+  EXPECT_THAT(resp, IsArray(IntArg(500), "d:998", "d:996", "d:994"));
+}
+
 TEST_F(SearchFamilyTest, FtProfileInvalidQuery) {
   Run({"json.set", "j1", ".", R"({"id":"1"})"});
   Run({"ft.create", "i1", "on", "json", "schema", "$.id", "as", "id", "tag"});
@@ -2056,6 +2133,67 @@ TEST_F(SearchFamilyTest, AggregateGroupBy) {
                         IsMap("foo_total", "10", "word", "item1", "text", "\"first key\"")));
 }
 
+TEST_F(SearchFamilyTest, MaterializedAggregate) {
+  auto resp = Run({"ft.create", "i1", "ON", "HASH", "PREFIX", "1", "doc:", "SCHEMA", "tenant",
+                   "TAG", "amount", "NUMERIC", "SORTABLE", "region", "TAG"});
+  EXPECT_EQ(resp, "OK");
+
+  Run({"hset", "doc:1", "tenant", "a", "amount", "10", "region", "eu"});
+  Run({"hset", "doc:2", "tenant", "b", "amount", "20", "region", "us"});
+  Run({"hset", "doc:3", "tenant", "a", "amount", "30", "region", "us"});
+  Run({"hset", "doc:4", "tenant", "c", "region", "eu"});
+
+  resp = Run({"ft.aggcreate", "i1", "by_tenant", "GROUPBY", "1", "@tenant", "REDUCE", "COUNT", "0",
+              "AS", "count", "REDUCE", "SUM", "1", "@amount", "AS", "total", "REDUCE", "MAX", "1",
+              "@amount", "AS", "max", "REDUCE", "COUNT_DISTINCT", "1", "@region", "AS", "regions"});
+  EXPECT_EQ(resp, "OK");
+
+  // Reducers are matched by function and source, AVG and MIN are answered from SUM and MAX states
+  auto query = [this] {
+    return Run({"ft.aggregate", "i1", "*", "GROUPBY", "1", "@tenant", "REDUCE", "COUNT", "0", "AS",
+                "n", "REDUCE", "AVG", "1", "@amount", "AS", "avg", "REDUCE", "MIN", "1", "@amount",
+                "AS", "min", "REDUCE", "COUNT_DISTINCT", "1", "@region", "AS", "regions"});
+  };
+  EXPECT_THAT(query(), IsUnordArrayWithSize(
+                           IsMap("tenant", "a", "n", "2", "avg", "20", "min", "10", "regions", "2"),
+                           IsMap("tenant", "b", "n", "1", "avg", "20", "min", "20", "regions", "1"),
+                           IsMap("tenant", "c", "n", "1", "regions", "1")));
+
+  // Updates and deletions are applied incrementally
+  Run({"hset", "doc:1", "tenant", "b"});
+  Run({"del", "doc:2"});
+  Run({"hset", "doc:5", "tenant", "c", "amount", "5", "region", "us"});
+  EXPECT_THAT(query(), IsUnordArrayWithSize(
+                           IsMap("tenant", "a", "n", "1", "avg", "30", "min", "30", "regions", "1"),
+                           IsMap("tenant", "b", "n", "1", "avg", "10", "min", "10", "regions", "1"),
+                           IsMap("tenant", "c", "n", "2", "avg", "5", "min", "5", "regions", "2")));
+
+  // Following steps are applied to the groups
+  resp = Run({"ft.aggregate", "i1", "*", "GROUPBY", "1", "@tenant", "REDUCE", "SUM", "1", "@amount",
+              "AS", "total", "SORTBY", "2", "@total", "DESC", "LIMIT", "0", "2"});
+  EXPECT_THAT(resp, IsArray(_, IsMap("tenant", "a", "total", "30"),
+                            IsMap("tenant", "b", "total", "10")));
+
+  // Not covered queries are still answered by loading documents
+  resp = Run({"ft.aggregate", "i1", "*", "GROUPBY", "1", "@region", "REDUCE", "COUNT", "0", "AS",
+              "n"});
+  EXPECT_THAT(resp, IsUnordArrayWithSize(IsMap("region", "eu", "n", "2"),
+                                         IsMap("region", "us", "n", "2")));
+
+  // Aggregations are kept when the index is altered
+  EXPECT_EQ(Run({"ft.alter", "i1", "SCHEMA", "ADD", "note", "TEXT"}), "OK");
+  EXPECT_THAT(query(), IsUnordArrayWithSize(_, _, _));
+
+  resp = Run({"ft.aggcreate", "i1", "bad", "GROUPBY", "1", "@missing"});
+  EXPECT_THAT(resp, ErrArg("Unknown field `missing`"));
+  resp = Run({"ft.aggcreate", "i2", "bad", "GROUPBY", "1", "@tenant"});
+  EXPECT_THAT(resp, ErrArg("i2: no such index"));
+
+  EXPECT_EQ(Run({"ft.aggdrop", "i1", "by_tenant"}), "OK");
+  EXPECT_THAT(Run({"ft.aggdrop", "i1", "by_tenant"}), ErrArg("by_tenant: no such aggregation"));
+  EXPECT_THAT(query(), IsUnordArrayWithSize(_, _, _));
+}
+
 TEST_F(SearchFamilyTest, JsonAggregateGroupBy) {
   auto resp =
       Run({"FT.CREATE", "json_index", "ON", "JSON", "SCHEMA", "$.name", "AS", "name", "TEXT",
@@ -5095,8 +5233,13 @@ TEST_F(SearchFamilyTest, FtProfileSearchFilteredKnnHnsw) {
                            string{search_result[3].GetString()}};
   EXPECT_THAT(tied_docs, UnorderedElementsAre("doc7", "doc9"));
 
+  // 15 prefiltered docs are cheaper to compare directly than to find in the graph
   const auto& stats = resp.GetVec()[1].GetVec()[0].GetVec();
-  EXPECT_THAT(stats, ElementsAre("took", _, "hits", IntArg(3), "serialized", IntArg(3)));
+  ASSERT_THAT(stats,
+              ElementsAre("took", _, "hits", IntArg(3), "serialized", IntArg(3), "knn", _));
+  const auto& knn = stats[7].GetVec();
+  EXPECT_EQ(knn[3].GetString() /* operation */, "KNN{l=3,subset}");
+  EXPECT_THAT(knn[7] /* processed */, IntArg(15));
 }
 
 TEST_F(SearchFamilyTest, FtProfileSearchHnswVectorRange) {
@@ -9798,4 +9941,39 @@ TEST_F(SearchFamilyTest, FtProfileTreeIsNested) {
   }
 }
 
+TEST_F(SearchFamilyTest, AsyncIndexing) {
+  absl::FlagSaver fs;
+  absl::SetFlag(&FLAGS_search_async_indexing, true);
+
+  EXPECT_EQ(Run({"ft.create", "i1", "SCHEMA", "word", "TAG", "foo", "NUMERIC"}), "OK");
+  for (unsigned i = 0; i < 10; i++)
+    Run({"hset", absl::StrCat("d:", i), "word", i % 2 ? "odd" : "even", "foo", to_string(i)});
+
+  EXPECT_THAT(Run({"ft.search", "i1", "@word:{odd}", "WAITINDEXED"}),
+              AreDocIds("d:1", "d:3", "d:5", "d:7", "d:9"));
+  EXPECT_EQ(GetMetrics().search_stats.num_pending_docs, 0u);
+
+  // An updated document stays indexed with its old values until the indexer runs
+  Run({"hset", "d:1", "word", "even"});
+  auto resp = Run({"ft.search", "i1", "@word:{odd|even}", "nocontent"});
+  ASSERT_THAT(resp, ArrLen(11));
+  EXPECT_THAT(resp.GetVec()[0], IntArg(10));
+
+  Run({"del", "d:3"});
+  EXPECT_THAT(Run({"ft.search", "i1", "@word:{odd}", "WAITINDEXED"}),
+              AreDocIds("d:5", "d:7", "d:9"));
+  EXPECT_EQ(GetMetrics().search_stats.num_pending_docs, 0u);
+
+  resp = Run({"ft.aggregate", "i1", "*", "WAITINDEXED", "GROUPBY", "1", "@word", "REDUCE",
+              "COUNT", "0", "AS", "count"});
+  EXPECT_THAT(resp, IsUnordArrayWithSize(IsMap("word", "even", "count", "6"),
+                                         IsMap("word", "odd", "count", "3")));
+
+  // Writes are indexed right away once the queue is full
+  absl::SetFlag(&FLAGS_search_async_indexing_max_queued, 0u);
+  Run({"hset", "d:1", "word", "odd"});
+  EXPECT_THAT(Run({"ft.search", "i1", "@word:{odd}"}), AreDocIds("d:1", "d:5", "d:7", "d:9"));
+  EXPECT_EQ(GetMetrics().search_stats.num_pending_docs, 0u);
+}
+
 }  // namespace dfly
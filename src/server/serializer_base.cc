@@ -206,8 +206,16 @@ bool SerializerBase::ProcessBucket(DbIndex db_index, PrimeTable::bucket_iterator
   if (it.GetVersion() >= snapshot_version_)
     return ProcessBucket(db_index, it, on_update);  // for the false path
 
+  const uint64_t bucket_version = it.GetVersion();
+
   // We call it before SerializeBucketLocked because it dchecks on bucket version.
   it.SetVersion(snapshot_version_);
+
+  // Delta snapshots skip the buckets that did not change since the base snapshot.
+  if (delta_base_version_ > 0 && bucket_version <= delta_base_version_) {
+    stats_.buckets_skipped++;
+    return false;
+  }
   BucketDependencies::Increment(it.bucket_address());
 
   stats_.keys_serialized += SerializeBucketLocked(db_index, it, on_update);
@@ -221,6 +221,10 @@ class SerializerBase : public BucketDependencies,
 
   Stats stats_;
 
+  // Set for delta snapshots: buckets with versions up to it did not change since the base
+  // snapshot and are only stamped, not serialized.
+  uint64_t delta_base_version_ = 0;
+
   // Guards output stream (serializer) to not be used from multiple fibers
   // as buffered changes can be flushed amid writing a value (logical stream)
   detail::OptionalMutex<ThreadLocalMutex> stream_mu_;
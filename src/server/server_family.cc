@@ -121,6 +121,11 @@ ABSL_FLAG(CronExprFlag, snapshot_cron, {},
           "cron expression for the time to save a snapshot, crontab style");
 ABSL_FLAG(bool, df_snapshot_format, true,
           "if true, save in dragonfly-specific snapshotting format");
+ABSL_FLAG(uint32_t, df_snapshot_delta_chain, 0,
+          "Number of delta snapshots saved on top of a full DF snapshot before the next full one. "
+          "A delta holds only the entries changed since the previous DF snapshot and the keys "
+          "deleted meanwhile. It must be saved with a different file name in the same directory "
+          "and loading it replays its base snapshots. 0 disables incremental snapshots.");
 ABSL_FLAG(int, epoll_file_threads, 0,
           "thread size for file workers when running in epoll mode, default is hardware concurrent "
           "threads");
@@ -162,6 +167,13 @@ ABSL_FLAG(bool, keep_legacy_memory_metrics, false, "legacy metrics format");
 // TODO deprecate when flipped in production
 ABSL_FLAG(bool, replicaof_no_one_start_journal, true,
           "when set, preserves journal offsets after REPLICAOF NO ONE");
+ABSL_FLAG(bool, snapshot_lsn_watermark, false,
+          "If true, starts the journal on startup so that DF snapshots of a master record a "
+          "per-shard LSN watermark. Replicas seeded from such a snapshot fetch only the journal "
+          "suffix from the master, which must still hold it (see --shard_repl_backlog_len)");
+ABSL_FLAG(bool, replicaof_seed_from_snapshot, false,
+          "If true together with --replicaof, loads the snapshot from --dir/--dbfilename first "
+          "and resumes replication from its LSN watermark instead of a full sync");
 
 ABSL_DECLARE_FLAG(int32_t, port);
 ABSL_DECLARE_FLAG(bool, cache_mode);
@@ -987,6 +999,16 @@ void SendSaveHelp(RedisReplyBuilder* rb, bool is_bgsave) {
   rb->SendSimpleStrArr(help_arr);
 }
 
+// Number of key writes on all shards, to detect writes after a snapshot was loaded.
+size_t KeyspaceMutations() {
+  atomic_size_t mutations = 0;
+  shard_set->RunBriefInParallel([&](EngineShard* shard) {
+    auto& db_slice = namespaces->GetDefaultNamespace().GetDbSlice(shard->shard_id());
+    mutations.fetch_add(db_slice.GetStats().events.mutations, memory_order_relaxed);
+  });
+  return mutations.load();
+}
+
 }  // namespace
 
 bool ValidateServerTlsFlags() {
@@ -1258,10 +1280,24 @@ void ServerFamily::Init(util::AcceptServer* acceptor, std::vector<facade::Listen
     snapshot_storage_ = std::make_shared<detail::FileSnapshotStorage>(nullptr);
   }
 
+  if (GetFlag(FLAGS_snapshot_lsn_watermark)) {
+    shard_set->RunBriefInParallel([](EngineShard*) { journal::StartInThread(); });
+  }
+
   // check for '--replicaof' before loading anything
   if (ReplicaOfFlag flag = GetFlag(FLAGS_replicaof); flag.has_value()) {
-    service_.proactor_pool().GetNextProactor()->Await(
-        [this, &flag]() { this->Replicate(flag.host, flag.port); });
+    if (GetFlag(FLAGS_replicaof_seed_from_snapshot)) {
+      // Seeded full sync: load the local snapshot and ask the master only for the journal
+      // entries written after it was taken.
+      {
+        util::fb2::LockGuard lk(replicaof_mu_);
+        seed_on_load_ = true;
+      }
+      LoadFromSnapshot([this, flag] { this->Replicate(flag.host, flag.port); });
+    } else {
+      service_.proactor_pool().GetNextProactor()->Await(
+          [this, &flag]() { this->Replicate(flag.host, flag.port); });
+    }
   } else {  // load from snapshot only if --replicaof is empty
     LoadFromSnapshot();
   }
@@ -1279,7 +1315,7 @@ void ServerFamily::Init(util::AcceptServer* acceptor, std::vector<facade::Listen
   create_snapshot_schedule_fb();
 }
 
-void ServerFamily::LoadFromSnapshot() {
+void ServerFamily::LoadFromSnapshot(std::function<void()> on_loaded) {
   {
     util::fb2::LockGuard lk{loading_stats_mu_};
     loading_stats_.restore_count++;
@@ -1292,18 +1328,25 @@ void ServerFamily::LoadFromSnapshot() {
     const std::string& load_path = *load_path_result;
     if (!load_path.empty()) {
       auto future = Load(load_path, LoadExistingKeys::kFail);
-      load_fiber_ = service_.proactor_pool().GetNextProactor()->LaunchFiber([future]() mutable {
-        // Wait for load to finish in a dedicated fiber.
-        // Failure to load on start causes Dragonfly to exit with an error code.
-        if (!future.has_value() || future->Get()) {
-          // Error was already printed to log at this point.
-          exit(1);
-        }
-      });
+      load_fiber_ = service_.proactor_pool().GetNextProactor()->LaunchFiber(
+          [future, on_loaded = std::move(on_loaded)]() mutable {
+            // Wait for load to finish in a dedicated fiber.
+            // Failure to load on start causes Dragonfly to exit with an error code.
+            if (!future.has_value() || future->Get()) {
+              // Error was already printed to log at this point.
+              exit(1);
+            }
+            if (on_loaded)
+              on_loaded();
+          });
+    } else if (on_loaded) {
+      service_.proactor_pool().GetNextProactor()->Await(std::move(on_loaded));
     }
   } else {
     if (std::error_code(load_path_result.error()) == std::errc::no_such_file_or_directory) {
       LOG(WARNING) << "Load snapshot: No snapshot found";
+      if (on_loaded)
+        service_.proactor_pool().GetNextProactor()->Await(std::move(on_loaded));
     } else {
       loading_stats_mu_.lock();
       loading_stats_.failed_restore_count++;
@@ -1404,6 +1447,38 @@ void ServerFamily::UpdateMemoryGlobalStats() {
 struct AggregateLoadResult {
   AggregateError first_error;
   std::atomic<size_t> keys_read;
+
+  // Per-shard journal watermarks of the loaded files, indexed by the master shard id.
+  fb2::Mutex mu;
+  std::string repl_id;
+  std::vector<std::optional<LSN>> shard_lsns;
+  bool seedable = true;
+
+  void AddWatermark(string_view file_repl_id, uint32_t shard_id, std::optional<LSN> lsn) {
+    util::fb2::LockGuard lk(mu);
+    if (!lsn || shard_id >= shard_lsns.size() || (!repl_id.empty() && repl_id != file_repl_id)) {
+      seedable = false;
+      return;
+    }
+    repl_id = file_repl_id;
+    shard_lsns[shard_id] = lsn;
+  }
+
+  // Returns the sync data that lets a replica continue from the loaded snapshot, if every
+  // shard file carried a watermark of the same master.
+  std::optional<LastMasterSyncData> SeedData() {
+    util::fb2::LockGuard lk(mu);
+    if (!seedable || repl_id.empty())
+      return std::nullopt;
+
+    LastMasterSyncData data{repl_id, {}, true};
+    for (const auto& lsn : shard_lsns) {
+      if (!lsn)
+        return std::nullopt;
+      data.last_journal_LSNs.push_back(*lsn);
+    }
+    return data;
+  }
 };
 
 void ServerFamily::FlushAll(Namespace* ns) {
@@ -1460,9 +1535,6 @@ std::optional<fb2::Future<GenericError>> ServerFamily::Load(const std::string& p
 
   LOG(INFO) << "Loading " << path;
 
-  vector<fb2::Fiber> load_fibers;
-  load_fibers.reserve(paths.size());
-
   LoadOptions load_opts;
   auto load_context = std::make_unique<RdbLoadContext>();
   if (absl::EndsWith(path, "summary.dfs")) {
@@ -1474,41 +1546,89 @@ std::optional<fb2::Future<GenericError>> ServerFamily::Load(const std::string& p
       return immediate(load_ec);
   }
 
+  // A delta snapshot is loaded on top of its bases, oldest first. Only the summary of the newest
+  // snapshot is loaded, and the shard files of all of them. Later files override the keys.
+  struct LoadStep {
+    vector<string> files;
+    LoadOptions opts;
+    LoadExistingKeys existing_keys;
+  };
+  vector<LoadStep> steps;
+  for (const string& base : load_opts.snapshot_bases) {
+    string base_path = std::filesystem::path{path}.replace_filename(base).string();
+    auto base_files = storage->ExpandSnapshot(base_path);
+    if (!base_files) {
+      LOG(ERROR) << "Failed to load base snapshot: " << base_files.error().Format();
+      return immediate(base_files.error());
+    }
+    LoadOptions base_opts;
+    base_opts.shard_count = load_opts.shard_count;
+    steps.push_back({std::move(*base_files), std::move(base_opts),
+                     steps.empty() ? existing_keys : LoadExistingKeys::kOverride});
+  }
+  steps.push_back(
+      {paths, load_opts, steps.empty() ? existing_keys : LoadExistingKeys::kOverride});
+
   auto aggregated_result = std::make_shared<AggregateLoadResult>();
+  aggregated_result->shard_lsns.resize(
+      std::count_if(paths.begin(), paths.end(),
+                    [](const string& file) { return !absl::EndsWith(file, "summary.dfs"); }));
+  // Appending to existing data can not be continued from the snapshot watermark.
+  aggregated_result->seedable = existing_keys == LoadExistingKeys::kFail;
 
-  for (const auto& file : paths) {
-    // we have already read summary so we skip it now
-    if (absl::EndsWith(file, "summary.dfs"))
-      continue;
+  bool arm_seed = false;
+  {
+    util::fb2::LockGuard lk(replicaof_mu_);
+    seed_sync_data_.reset();
+    arm_seed = std::exchange(seed_on_load_, false);
+  }
 
-    // For single file, choose thread that does not handle shards if possible.
-    // This will balance out the CPU during the load.
-    ProactorBase* proactor;
-    if (paths.size() == 1 && shard_count() < pool.size()) {
-      proactor = pool.at(shard_count());
-    } else {
-      proactor = pool.GetNextProactor();
-    }
+  auto launch_step = [this, pool = &pool, aggregated_result, load_context = load_context.get(),
+                      storage](const LoadStep& step) {
+    vector<fb2::Fiber> load_fibers;
+    load_fibers.reserve(step.files.size());
+    for (const auto& file : step.files) {
+      // we have already read summary so we skip it now
+      if (absl::EndsWith(file, "summary.dfs"))
+        continue;
 
-    auto load_func = [file, existing_keys, load_opts, aggregated_result,
-                      load_context = load_context.get(), storage, this]() mutable {
-      error_code load_ec = LoadRdb(file, existing_keys, &load_opts, load_context, storage.get());
-      if (load_ec) {
-        aggregated_result->first_error = load_ec;
+      // For single file, choose thread that does not handle shards if possible.
+      // This will balance out the CPU during the load.
+      ProactorBase* proactor;
+      if (step.files.size() == 1 && shard_count() < pool->size()) {
+        proactor = pool->at(shard_count());
       } else {
-        aggregated_result->keys_read.fetch_add(load_opts.num_loaded_keys, memory_order_relaxed);
+        proactor = pool->GetNextProactor();
       }
-    };
-    load_fibers.push_back(proactor->LaunchFiber(std::move(load_func)));
-  }
+
+      auto load_func = [file, existing_keys = step.existing_keys, load_opts = step.opts,
+                        aggregated_result, load_context, storage, this]() mutable {
+        error_code load_ec = LoadRdb(file, existing_keys, &load_opts, load_context, storage.get());
+        if (load_ec) {
+          aggregated_result->first_error = load_ec;
+        } else {
+          aggregated_result->keys_read.fetch_add(load_opts.num_loaded_keys,
+                                                 memory_order_relaxed);
+          aggregated_result->AddWatermark(load_opts.repl_id, load_opts.shard_id,
+                                          load_opts.shard_lsn);
+        }
+      };
+      load_fibers.push_back(proactor->LaunchFiber(std::move(load_func)));
+    }
+    return load_fibers;
+  };
 
   fb2::Future<GenericError> future;
 
   // Run fiber that empties the channel and sets ec_promise.
-  auto load_join_func = [this, aggregated_result, load_fibers = std::move(load_fibers),
+  auto load_join_func = [this, aggregated_result, arm_seed, steps = std::move(steps),
+                         launch_step = std::move(launch_step),
                          load_context = std::move(load_context), storage, future]() mutable {
-    for (auto& fiber : load_fibers) {
-      fiber.Join();
+    for (const LoadStep& step : steps) {
+      for (auto& fiber : launch_step(step))
+        fiber.Join();
+      if (aggregated_result->first_error)
+        break;
     }
 
     if (aggregated_result->first_error) {
@@ -1518,6 +1638,15 @@ std::optional<fb2::Future<GenericError>> ServerFamily::Load(const std::string& p
       load_context->PerformPostLoad(&service_);
       LOG(INFO) << "Load finished, num keys read: " << aggregated_result->keys_read;
 
+      if (auto seed = arm_seed ? aggregated_result->SeedData() : nullopt; seed) {
+        LOG(INFO) << "Loaded snapshot of master " << seed->id << " at LSNs "
+                  << absl::StrJoin(seed->last_journal_LSNs, "-");
+        size_t mutations = KeyspaceMutations();
+        util::fb2::LockGuard lk(replicaof_mu_);
+        seed_sync_data_ = std::move(seed);
+        seed_mutations_ = mutations;
+      }
+
       // Loaded data bypasses the journal, so force replicas into full sync.
       dfly_cmd_->CancelReplicas();
       shard_set->RunBriefInParallel([](EngineShard* shard) {
@@ -1605,6 +1734,10 @@ std::error_code ServerFamily::LoadRdb(const std::string& rdb_file, LoadExistingK
       load_opts->num_loaded_keys = loader.keys_loaded();
       load_opts->snapshot_id = loader.GetSnapshotId();
       load_opts->shard_count = loader.shard_count();
+      load_opts->repl_id = loader.repl_id();
+      load_opts->shard_id = loader.shard_id();
+      load_opts->shard_lsn = loader.shard_lsn();
+      load_opts->snapshot_bases = loader.snapshot_bases();
     }
   });
 
@@ -1807,9 +1940,23 @@ GenericError ServerFamily::DoSaveCheckAndStart(const SaveCmdOptions& save_cmd_op
                                 ? snapshot_storage_
                                 : CreateCloudSnapshotStorage(save_cmd_opts.cloud_uri);
 
+    IncrementalMode incremental = IncrementalMode::NONE;
+    vector<string> delta_bases;
+    if (uint32_t chain = absl::GetFlag(FLAGS_df_snapshot_delta_chain);
+        chain > 0 && save_cmd_opts.new_version) {
+      // delta_chain_ holds the full snapshot followed by its deltas.
+      if (!delta_chain_.empty() && delta_chain_.size() <= chain) {
+        incremental = IncrementalMode::DELTA;
+        delta_bases = delta_chain_;
+      } else {
+        incremental = IncrementalMode::BASE;
+      }
+    }
+
     controller = make_shared<SaveStagesController>(detail::SaveStagesInputs{
         save_cmd_opts.new_version, save_cmd_opts.cloud_uri, save_cmd_opts.basename, trans,
-        &service_, fq_threadpool_.get(), snapshot_storage, opts.bg_save});
+        &service_, fq_threadpool_.get(), snapshot_storage, opts.bg_save, incremental,
+        std::move(delta_bases)});
     save_controller_ = controller;
   }
 
@@ -1865,6 +2012,15 @@ GenericError ServerFamily::WaitUntilSaveFinished(Transaction* trans, bool ignore
     if (save_controller_ == controller) {
       save_info = save_controller_->Finalize();
       is_bg_save = save_controller_->IsBgSave();
+
+      // Any failure breaks the chain of incremental snapshots, starting it over.
+      if (auto incremental = save_controller_->GetIncrementalMode();
+          incremental != IncrementalMode::NONE) {
+        if (save_info.error || incremental == IncrementalMode::BASE)
+          delta_chain_.clear();
+        if (!save_info.error)
+          delta_chain_.push_back(save_info.file_name);
+      }
       save_controller_.reset();
     } else {
       // Another save has started. The old one is already finalized by the new one.
@@ -1917,6 +2073,11 @@ void ServerFamily::Drakarys(Transaction* transaction, DbIndex db_ind, bool wait)
   VLOG(2) << "Drakarys start db=" << db_ind << " wait=" << wait
           << " rss=" << HumanReadableNumBytes(rss_mem_current.load(std::memory_order_relaxed));
 
+  {
+    util::fb2::LockGuard lk(replicaof_mu_);
+    seed_sync_data_.reset();
+  }
+
   vector<fb2::Fiber> fibers(shard_set->size());
   transaction->Execute(
       [db_ind, &fibers](Transaction* t, EngineShard* shard) {
@@ -2711,6 +2872,7 @@ string ServerFamily::FormatInfoMetrics(const Metrics& m, std::string_view sectio
     append("num_entries", total.key_count);
     append("inline_keys", total.inline_keys);
     append("small_string_bytes", m.small_string_bytes);
+    append("key_prefix_saved_bytes", m.key_prefix_saved_bytes);
     append("pipeline_cache_bytes", m.facade_stats.conn_stats.pipeline_cmd_cache_bytes);
     append("dispatch_queue_bytes", m.facade_stats.conn_stats.dispatch_queue_bytes);
     append("pipeline_queue_bytes", m.facade_stats.conn_stats.pipeline_queue_bytes);
@@ -2724,6 +2886,7 @@ string ServerFamily::FormatInfoMetrics(const Metrics& m, std::string_view sectio
            m.facade_stats.reply_stats.squashing_current_reply_size.load(memory_order_relaxed));
     append("psync_buffer_size", m.lsn_buffer_size);
     append("psync_buffer_bytes", m.lsn_buffer_bytes);
+    append("psync_disk_backlog_bytes", m.lsn_disk_backlog_bytes);
 
     if (GetFlag(FLAGS_cache_mode)) {
       append("cache_mode", "cache");
@@ -2762,6 +2925,7 @@ string ServerFamily::FormatInfoMetrics(const Metrics& m, std::string_view sectio
     append("batch_read_commands_bytes", m.coordinator_stats.batch_read_commands_bytes);
     append("batch_write_commands_bytes", m.coordinator_stats.batch_write_commands_bytes);
     append("rw_throttle_batches_total", m.coordinator_stats.rw_throttle_batches_total);
+    append("batched_commands_total", m.coordinator_stats.batched_commands);
     append("pipelined_latency_usec", conn_stats.pipelined_cmd_latency);
     append("total_net_input_bytes", conn_stats.io_read_bytes);
     append("connection_migrations", conn_stats.num_migrations);
@@ -2771,6 +2935,9 @@ string ServerFamily::FormatInfoMetrics(const Metrics& m, std::string_view sectio
     append("rdb_save_count", m.coordinator_stats.rdb_save_count);
     append("big_value_preemptions", m.coordinator_stats.big_value_preemptions);
     append("compressed_blobs", m.coordinator_stats.compressed_blobs);
+    append("repl_stream_compress_in_bytes", m.coordinator_stats.repl_stream_compress_in_bytes);
+    append("repl_stream_compress_out_bytes", m.coordinator_stats.repl_stream_compress_out_bytes);
+    append("repl_stream_compress_usec", m.coordinator_stats.repl_stream_compress_usec);
     append("instantaneous_input_kbps", -1);
     append("instantaneous_output_kbps", -1);
     append("rejected_connections", -1);
@@ -3039,6 +3206,7 @@ string ServerFamily::FormatInfoMetrics(const Metrics& m, std::string_view sectio
     append("search_memory", m.search_stats.used_memory);
     append("search_num_indices", m.search_stats.num_indices);
     append("search_num_entries", m.search_stats.num_entries);
+    append("search_num_pending_docs", m.search_stats.num_pending_docs);
   }
 #endif
 
@@ -3322,6 +3490,15 @@ void ServerFamily::ReplicaOf(CmdArgParser parser, CommandContext* cmd_cntx) {
   ReplicaOfInternal(parser.UnparsedArgs(), cmd_cntx, ActionOnConnectionFail::kReturnOnError);
 }
 
+std::optional<Replica::LastMasterSyncData> ServerFamily::TakeSeedSyncData() {
+  auto seed = std::exchange(seed_sync_data_, std::nullopt);
+  if (seed && KeyspaceMutations() != seed_mutations_) {
+    LOG(WARNING) << "Keys were written after loading the snapshot, full sync is required";
+    return std::nullopt;
+  }
+  return seed;
+}
+
 void ServerFamily::Replicate(string_view host, string_view port) {
   StringVec replicaof_params{string(host), string(port)};
 
@@ -3399,9 +3576,11 @@ void ServerFamily::ReplicaOfInternal(facade::ParsedArgs args, CommandContext* cm
     case ActionOnConnectionFail::kReturnOnError:
       ec = new_replica->Start();
       break;
-    case ActionOnConnectionFail::kContinueReplication:
-      new_replica->EnableReplication();
+    case ActionOnConnectionFail::kContinueReplication: {
+      util::fb2::LockGuard lk(replicaof_mu_);
+      new_replica->EnableReplication(TakeSeedSyncData());
       break;
+    }
   };
 
   if (ec || new_replica->IsContextCancelled()) {
@@ -3417,6 +3596,8 @@ void ServerFamily::ReplicaOfInternal(facade::ParsedArgs args, CommandContext* cm
   std::optional<Replica::LastMasterSyncData> last_master_data;
   if (replica_)
     last_master_data = replica_->Stop();
+  else
+    last_master_data = TakeSeedSyncData();
 
   StopAllClusterReplicas();
 
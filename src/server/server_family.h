@@ -265,7 +265,9 @@ class ServerFamily {
 
   bool HasPrivilegedInterface();
   void JoinSnapshotSchedule();
-  void LoadFromSnapshot() ABSL_LOCKS_EXCLUDED(loading_stats_mu_);
+  // on_loaded is invoked on a proactor thread once the snapshot (if any) is loaded.
+  void LoadFromSnapshot(std::function<void()> on_loaded = {})
+      ABSL_LOCKS_EXCLUDED(loading_stats_mu_);
 
   uint32_t shard_count() const {
     return shard_set->size();
@@ -312,10 +314,22 @@ class ServerFamily {
 
   void ReplicaOfNoOne(SinkReplyBuilder* builder) ABSL_LOCKS_EXCLUDED(replicaof_mu_);
 
+  // Returns seed_sync_data_ and clears it. Returns nullopt if keys were written since the load.
+  std::optional<LastMasterSyncData> TakeSeedSyncData()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(replicaof_mu_);
+
   struct LoadOptions {
     std::string snapshot_id;
     uint32_t shard_count = 0;      // Shard count of the snapshot being loaded.
     uint64_t num_loaded_keys = 0;  // Number of keys loaded.
+
+    // Journal watermark of a shard file, see RdbLoader::shard_lsn().
+    std::string repl_id;
+    uint32_t shard_id = UINT32_MAX;
+    std::optional<LSN> shard_lsn;
+
+    // Snapshots a delta is loaded on top of, see RdbLoader::snapshot_bases().
+    std::vector<std::string> snapshot_bases;
   };
 
   // Updates LoadOptions if successful. If snapshot_id and shard_count are passed in,
@@ -372,12 +386,22 @@ class ServerFamily {
 
   std::string master_replid_;
   std::optional<LastMasterSyncData> last_master_data_;
+  // Journal watermark of the snapshot loaded on startup with --replicaof_seed_from_snapshot.
+  // Consumed by the next REPLICAOF so that only the journal suffix is requested. Dropped by
+  // flushes, loads and local writes, as the data does not match the watermark anymore.
+  std::optional<LastMasterSyncData> seed_sync_data_ ABSL_GUARDED_BY(replicaof_mu_);
+  size_t seed_mutations_ ABSL_GUARDED_BY(replicaof_mu_) = 0;  // Keyspace mutations after load
+  bool seed_on_load_ ABSL_GUARDED_BY(replicaof_mu_) = false;  // Arm the seed on the next load
 
   time_t start_time_ = 0;  // in seconds, epoch time.
 
   ThreadSafeSaveInfo thread_safe_save_info_;
   std::shared_ptr<detail::SaveStagesController> save_controller_ ABSL_GUARDED_BY(save_mu_);
 
+  // Summary files of the last full DF snapshot and the deltas saved on top of it, that the next
+  // delta snapshot is based on. Empty if the next DF snapshot must be a full one.
+  std::vector<std::string> delta_chain_ ABSL_GUARDED_BY(save_mu_);
+
   // Used to override save on shutdown behavior that is usually set
   // be --dbfilename.
   bool save_on_shutdown_{true};
@@ -58,7 +58,7 @@ ServerState::Stats::Stats(unsigned num_shards)
 }
 
 ServerState::Stats& ServerState::Stats::Add(const ServerState::Stats& other) {
-  static_assert(sizeof(Stats) == 30 * 8, "Stats size mismatch");
+  static_assert(sizeof(Stats) == 34 * 8, "Stats size mismatch");
 
 #define ADD(x) this->x += (other.x)
 
@@ -76,6 +76,7 @@ ServerState::Stats& ServerState::Stats::Add(const ServerState::Stats& other) {
   ADD(multi_squash_exec_hop_usec);
   ADD(multi_squash_exec_reply_usec);
   ADD(squashed_commands);
+  ADD(batched_commands);
   ADD(blocking_commands_in_pipelines);
   ADD(blocked_on_interpreter);
   ADD(rdb_save_usec);
@@ -83,6 +84,9 @@ ServerState::Stats& ServerState::Stats::Add(const ServerState::Stats& other) {
 
   ADD(big_value_preemptions);
   ADD(compressed_blobs);
+  ADD(repl_stream_compress_in_bytes);
+  ADD(repl_stream_compress_out_bytes);
+  ADD(repl_stream_compress_usec);
 
   ADD(oom_error_cmd_cnt);
   ADD(conn_timeout_events);
@@ -122,6 +122,7 @@ class ServerState {  // public struct - to allow initialization.
     uint64_t multi_squash_exec_hop_usec = 0;
     uint64_t multi_squash_exec_reply_usec = 0;
     uint64_t squashed_commands = 0;
+    uint64_t batched_commands = 0;  // Pipelined commands executed with a batch handler
     uint64_t blocking_commands_in_pipelines = 0;
     uint64_t blocked_on_interpreter = 0;
 
@@ -131,6 +132,11 @@ class ServerState {  // public struct - to allow initialization.
     uint64_t big_value_preemptions = 0;
     uint64_t compressed_blobs = 0;
 
+    // Compression of the stable sync journal stream. in/out bytes give the compression ratio.
+    uint64_t repl_stream_compress_in_bytes = 0;
+    uint64_t repl_stream_compress_out_bytes = 0;
+    uint64_t repl_stream_compress_usec = 0;
+
     // Number of times we rejected command dispatch due to OOM condition.
     uint64_t oom_error_cmd_cnt = 0;
     uint32_t conn_timeout_events = 0;
@@ -4,6 +4,8 @@
 
 #include "server/set_family.h"
 
+#include <numeric>
+
 #include "server/family_utils.h"
 
 extern "C" {
@@ -53,6 +55,10 @@ auto EntriesRange(const NewEntries& entries) {
 
 constexpr uint32_t kMaxIntSetEntries = 256;
 
+// Per-shard intersections up to this size are shipped to the coordinator as is. Larger ones are
+// intersected by filtering the members of the smallest one on the other shards.
+constexpr uint32_t kInterShipLimit = 1024;
+
 bool IsDenseEncoding(const CompactObj& co) {
   return co.Encoding() == kEncodingStrMap2;
 }
@@ -175,6 +181,10 @@ struct StringSetWrapper {
     return VisitSet(obj_, [member](auto* s) { return s->Contains(member); });
   }
 
+  void ContainsMany(absl::Span<const string_view> members, bool* found) const {
+    VisitSet(obj_, [&](auto* s) { s->ContainsMany(members, found); });
+  }
+
   void* obj() const {
     return obj_;
   }
@@ -262,6 +272,17 @@ bool IsInSet(const DbContext& db_context, const SetType& st, string_view member)
   }
 }
 
+// Batched version of IsInSet: found[i] is set to whether members[i] is in the set.
+void IsInSetMany(const DbContext& db_context, const SetType& st,
+                 absl::Span<const string_view> members, bool* found) {
+  if (st.second == kEncodingIntSet) {
+    for (size_t i = 0; i < members.size(); ++i)
+      found[i] = IsInSet(db_context, st, members[i]);
+  } else {
+    StringSetWrapper(st, db_context).ContainsMany(members, found);
+  }
+}
+
 // returns -3 if member is not found, -1 if no ttl is associated with this member.
 int32_t GetExpiry(const DbContext& db_context, const SetType& st, string_view member) {
   if (st.second == kEncodingIntSet) {
@@ -568,6 +589,7 @@ OpResult<uint32_t> OpAdd(const OpArgs& op_args, std::string_view key, const NewE
   if (co.Encoding() == kEncodingIntSet) {
     intset* is = (intset*)co.RObjPtr();
     bool success = true;
+    size_t vals_left = visit([](auto& c) { return c.size(); }, vals);
 
     for (auto val : vals_it) {
       bool added = false;
@@ -577,7 +599,8 @@ OpResult<uint32_t> OpAdd(const OpArgs& op_args, std::string_view key, const NewE
       if (!success) {
         co.SetRObjPtr(is);
 
-        void* ss = SetFamily::ConvertToStrSet(is, intsetLen(is));
+        // Pre-size the set for the members that are yet to be added by this command.
+        void* ss = SetFamily::ConvertToStrSet(is, intsetLen(is) + vals_left);
         if (!ss) {
           return OpStatus::OUT_OF_MEMORY;
         }
@@ -586,6 +609,7 @@ OpResult<uint32_t> OpAdd(const OpArgs& op_args, std::string_view key, const NewE
         co.InitRobj(OBJ_SET, kEncodingStrMap2, ss);
         break;
       }
+      --vals_left;
     }
 
     if (success)
@@ -627,7 +651,8 @@ OpResult<uint32_t> OpAddEx(const OpArgs& op_args, string_view key, uint32_t ttl_
     // Update stats and trigger any handle the old value if needed.
     if (co.Encoding() == kEncodingIntSet) {
       intset* is = (intset*)co.RObjPtr();
-      void* ss = SetFamily::ConvertToStrSet(is, intsetLen(is));
+      size_t vals_size = visit([](auto& c) { return c.size(); }, vals);
+      void* ss = SetFamily::ConvertToStrSet(is, intsetLen(is) + vals_size);
       if (!ss) {
         return OpStatus::OUT_OF_MEMORY;
       }
@@ -937,6 +962,166 @@ OpResult<StringVec> OpInter(const Transaction* t, EngineShard* es, bool remove_f
   return result;
 }
 
+// Returns an upper bound for the size of the intersection of the sets that belong to this shard.
+OpResult<uint32_t> OpInterBound(const Transaction* t, EngineShard* es, bool remove_first) {
+  auto& db_slice = t->GetDbSlice(es->shard_id());
+  ShardArgs args = t->GetShardArgs(es->shard_id());
+  auto it = args.begin();
+  if (remove_first) {
+    ++it;
+  }
+  DCHECK(it != args.end());
+
+  OpStatus status = OpStatus::OK;
+  uint32_t bound = UINT32_MAX;
+  for (; it != args.end(); ++it) {
+    auto find_res = db_slice.FindReadOnly(t->GetDbContext(), *it, OBJ_SET);
+    if (!find_res) {
+      if (status == OpStatus::OK || status == OpStatus::KEY_NOTFOUND ||
+          find_res.status() != OpStatus::KEY_NOTFOUND) {
+        status = find_res.status();
+      }
+      continue;
+    }
+    const PrimeValue& pv = find_res.value()->second;
+    bound = std::min(bound, SetTypeLen(t->GetDbContext(), {pv.RObjPtr(), pv.Encoding()}));
+  }
+
+  if (status != OpStatus::OK)
+    return status;
+  return bound;
+}
+
+// Returns the indices of candidates that are members of all the sets of this shard.
+// Candidates are checked in batches so that lookups into the same set are pipelined.
+vector<uint32_t> OpInterFilter(const Transaction* t, EngineShard* es, bool remove_first,
+                               const StringVec& candidates) {
+  auto& db_slice = t->GetDbSlice(es->shard_id());
+  const DbContext& db_cntx = t->GetDbContext();
+  ShardArgs args = t->GetShardArgs(es->shard_id());
+  auto it = args.begin();
+  if (remove_first) {
+    ++it;
+  }
+
+  vector<uint32_t> alive(candidates.size());
+  std::iota(alive.begin(), alive.end(), 0);
+
+  string_view batch[StringSet::kMaxBatchLen];
+  bool found[StringSet::kMaxBatchLen];
+  for (; it != args.end() && !alive.empty(); ++it) {
+    auto find_res = db_slice.FindReadOnly(db_cntx, *it, OBJ_SET);
+    if (!find_res) {
+      // The set could have been emptied by lazy per-member expiry since the previous hop.
+      alive.clear();
+      break;
+    }
+
+    const PrimeValue& pv = find_res.value()->second;
+    SetType st{pv.RObjPtr(), pv.Encoding()};
+    size_t kept = 0;
+    for (size_t i = 0; i < alive.size(); i += StringSet::kMaxBatchLen) {
+      size_t len = std::min<size_t>(StringSet::kMaxBatchLen, alive.size() - i);
+      for (size_t j = 0; j < len; ++j)
+        batch[j] = candidates[alive[i + j]];
+
+      IsInSetMany(db_cntx, st, absl::MakeConstSpan(batch, len), found);
+      for (size_t j = 0; j < len; ++j) {
+        if (found[j])
+          alive[kept++] = alive[i + j];
+      }
+    }
+    alive.resize(kept);
+    SetFamily::DeleteSetIfEmpty(db_slice, db_cntx, *it, pv);
+  }
+
+  return alive;
+}
+
+// Intersects sets spread over multiple shards without moving all of them to the coordinator.
+// The first hop estimates the size of every per-shard intersection and materializes the small
+// ones. If all of them are small, they are merged on the coordinator. Otherwise the smallest
+// per-shard intersection is used as a candidate list that the other shards filter in one more
+// hop. If dest_shard is set, the first key of that shard is skipped. The transaction is not
+// concluded. The returned views point into result_set.
+OpResult<SvArray> InterMultiHop(Transaction* tx, optional<ShardId> dest_shard,
+                                ResultStringVec* result_set) {
+  vector<OpResult<uint32_t>> bounds(result_set->size(), OpStatus::SKIPPED);
+
+  auto bound_cb = [&](Transaction* t, EngineShard* shard) {
+    ShardId sid = shard->shard_id();
+    bool remove_first = sid == dest_shard;
+    if (remove_first && t->GetShardArgs(sid).Size() == 1)
+      return OpStatus::OK;
+
+    bounds[sid] = OpInterBound(t, shard, remove_first);
+    if (!bounds[sid])
+      (*result_set)[sid] = bounds[sid].status();
+    else if (*bounds[sid] <= kInterShipLimit)
+      (*result_set)[sid] = OpInter(t, shard, remove_first);
+    return OpStatus::OK;
+  };
+  tx->Execute(std::move(bound_cb), false);
+
+  unsigned shard_cnt = 0;
+  bool all_shipped = true;
+  optional<ShardId> seed;
+  for (ShardId sid = 0; sid < bounds.size(); ++sid) {
+    if (bounds[sid].status() == OpStatus::SKIPPED)
+      continue;
+    if (!bounds[sid])
+      return InterResultVec(*result_set, 0);  // Handles errors and missing keys.
+
+    ++shard_cnt;
+    all_shipped &= (*result_set)[sid].status() != OpStatus::SKIPPED;
+    if (!seed || *bounds[sid] < *bounds[*seed])
+      seed = sid;
+  }
+
+  if (all_shipped)
+    return InterResultVec(*result_set, shard_cnt);
+
+  OpResult<StringVec>& candidates = (*result_set)[*seed];
+  if (candidates.status() == OpStatus::SKIPPED) {
+    auto seed_cb = [&](Transaction* t, EngineShard* shard) {
+      if (shard->shard_id() == *seed)
+        candidates = OpInter(t, shard, shard->shard_id() == dest_shard);
+      return OpStatus::OK;
+    };
+    tx->Execute(std::move(seed_cb), false);
+  }
+
+  if (!candidates) {
+    if (candidates.status() == OpStatus::KEY_NOTFOUND)
+      return SvArray{};
+    return candidates.status();
+  }
+  if (candidates->empty() || shard_cnt == 1)
+    return SvArray{candidates->begin(), candidates->end()};
+
+  vector<vector<uint32_t>> alive(result_set->size());
+  auto filter_cb = [&](Transaction* t, EngineShard* shard) {
+    ShardId sid = shard->shard_id();
+    if (sid != *seed && bounds[sid])
+      alive[sid] = OpInterFilter(t, shard, sid == dest_shard, *candidates);
+    return OpStatus::OK;
+  };
+  tx->Execute(std::move(filter_cb), false);
+
+  vector<uint16_t> hits(candidates->size(), 0);
+  for (const auto& indices : alive) {
+    for (uint32_t index : indices)
+      ++hits[index];
+  }
+
+  SvArray result;
+  for (size_t i = 0; i < hits.size(); ++i) {
+    if (hits[i] == shard_cnt - 1)
+      result.emplace_back((*candidates)[i]);
+  }
+  return result;
+}
+
 OpStatus OpRandMember(const OpArgs& op_args, std::string_view key, int count,
                       cmn::BackedArguments* dest) {
   auto& db_slice = op_args.GetDbSlice();
@@ -1435,23 +1620,8 @@ void CmdSInterStore(CmdArgParser parser, CommandContext* cmd_cntx) {
   ResultStringVec result_set(shard_set->size(), OpStatus::SKIPPED);
   string_view dest_key = parser.Next();
   ShardId dest_shard = Shard(dest_key, result_set.size());
-  atomic_uint32_t inter_shard_cnt{0};
-
-  auto inter_cb = [&](Transaction* t, EngineShard* shard) {
-    ShardArgs largs = t->GetShardArgs(shard->shard_id());
-    if (shard->shard_id() == dest_shard) {
-      CHECK_EQ(largs.Front(), dest_key);
-      if (largs.Size() == 1)
-        return OpStatus::OK;
-    }
-    inter_shard_cnt.fetch_add(1, memory_order_relaxed);
-    result_set[shard->shard_id()] = OpInter(t, shard, shard->shard_id() == dest_shard);
-    return OpStatus::OK;
-  };
-
-  cmd_cntx->tx()->Execute(std::move(inter_cb), false);
 
-  OpResult<SvArray> result = InterResultVec(result_set, inter_shard_cnt.load(memory_order_relaxed));
+  OpResult<SvArray> result = InterMultiHop(cmd_cntx->tx(), dest_shard, &result_set);
   if (!result) {
     cmd_cntx->tx()->Conclude();
     cmd_cntx->SendError(result.status());
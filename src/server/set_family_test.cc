@@ -132,6 +132,32 @@ TEST_F(SetFamilyTest, SInter) {
   EXPECT_THAT(Run({"sinter"}), ErrArg("wrong number of arguments"));
 }
 
+// Large per-shard intersections are filtered on the other shards instead of being shipped.
+TEST_F(SetFamilyTest, SInterStoreLarge) {
+  vector<string> a{"sadd", "a"}, b{"sadd", "b"}, c{"sadd", "c"};
+  for (size_t i = 0; i < 5000; i++) {
+    a.push_back(absl::StrCat("m", i));
+    if (i % 2 == 0)
+      b.push_back(absl::StrCat("m", i));
+    if (i % 3 == 0)
+      c.push_back(absl::StrCat("m", i));
+  }
+  Run(absl::MakeSpan(a));
+  Run(absl::MakeSpan(b));
+  Run(absl::MakeSpan(c));
+
+  EXPECT_THAT(Run({"sinterstore", "d", "a", "b", "c"}), IntArg(834));
+  EXPECT_THAT(Run({"scard", "d"}), IntArg(834));
+  EXPECT_THAT(Run({"sismember", "d", "m4998"}), IntArg(1));
+  EXPECT_THAT(Run({"sismember", "d", "m4996"}), IntArg(0));
+
+  EXPECT_THAT(Run({"sinterstore", "d", "a", "b", "nokey"}), IntArg(0));
+  EXPECT_EQ(0, CheckedInt({"exists", "d"}));
+
+  Run({"set", "str", "foo"});
+  EXPECT_THAT(Run({"sinterstore", "d", "a", "b", "str"}), ErrArg("WRONGTYPE"));
+}
+
 TEST_F(SetFamilyTest, SInterCard) {
   Run({"sadd", "s1", "2", "b", "1", "a"});
   Run({"sadd", "s2", "3", "c", "2", "b"});
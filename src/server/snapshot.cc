@@ -35,6 +35,9 @@ ABSL_FLAG(strings::MemoryBytesFlag, snapshot_egress_limit_bytes, 0,
 ABSL_FLAG(bool, serialize_hnsw_index, false, "Serialize HNSW vector index graph structure");
 ABSL_FLAG(bool, serialization_tagged_chunks, true,
           "Allow serializer output to be split into tagged chunks and reassembled by receiver");
+ABSL_FLAG(uint64_t, snapshot_delta_max_deleted_keys, 1'000'000,
+          "Maximal number of deleted keys a shard logs for the next delta snapshot. If more keys "
+          "are deleted, the next snapshot is a full one.");
 
 namespace dfly {
 
@@ -84,12 +87,30 @@ bool SliceSnapshot::IsSnaphotInProgress() {
   return !tl_slice_snapshots.empty();
 }
 
-void SliceSnapshot::Start(bool stream_journal, SnapshotFlush allow_flush) {
+void SliceSnapshot::Start(bool stream_journal, SnapshotFlush allow_flush,
+                          IncrementalMode incremental) {
   DCHECK(!snapshot_fb_.IsJoinable());
 
   use_background_mode_ = absl::GetFlag(FLAGS_background_snapshotting);
   SerializerBase::RegisterChangeListener(stream_journal);
 
+  if (incremental == IncrementalMode::DELTA) {
+    deletion_log_ = db_slice_->TakeDeletionLog();
+    if (deletion_log_ && deletion_log_->valid) {
+      delta_base_version_ = deletion_log_->base_version;
+    } else {
+      deletion_log_.reset();
+      base_cntx_->ReportError(make_error_code(errc::state_not_recoverable),
+                              "Deleted keys since the base snapshot were not logged");
+    }
+  }
+
+  // Both, base and delta snapshots are the base of the next delta.
+  if (incremental != IncrementalMode::NONE) {
+    db_slice_->StartDeletionLog(snapshot_version_,
+                                absl::GetFlag(FLAGS_snapshot_delta_max_deleted_keys));
+  }
+
   if (stream_journal) {
     journal_cb_id_ = journal::RegisterConsumer(this);
   }
@@ -113,7 +134,8 @@ void SliceSnapshot::Start(bool stream_journal, SnapshotFlush allow_flush) {
     serializer_->SetTagEntries(absl::GetFlag(FLAGS_serialization_tagged_chunks));
   }
 
-  VLOG(1) << "DbSaver::Start - saving entries with version less than " << snapshot_version_;
+  VLOG(1) << "DbSaver::Start - saving entries with version less than " << snapshot_version_
+          << ", delta base version " << delta_base_version_;
 
   fb2::Fiber::Opts opts{.priority = use_background_mode_ ? fb2::FiberPriority::BACKGROUND
                                                          : fb2::FiberPriority::NORMAL,
@@ -124,6 +146,7 @@ void SliceSnapshot::Start(bool stream_journal, SnapshotFlush allow_flush) {
       SearchSerializer::Serialize(serializer_.get(), db_slice_,
                                   std::bind(&SliceSnapshot::PushSerialized, this, false));
     }
+    this->SerializeDeletedKeys();
     this->IterateBucketsFb(stream_journal);
     UnregisterChangeListener();
     consumer_->Finalize();
@@ -238,6 +261,25 @@ void SliceSnapshot::IterateBucketsFb(bool send_full_sync_cut) {
   }
 }
 
+void SliceSnapshot::SerializeDeletedKeys() {
+  if (!deletion_log_)
+    return;
+
+  VLOG(1) << "Serializing " << deletion_log_->keys.size() << " deleted keys";
+  for (const auto& [db_index, key] : deletion_log_->keys) {
+    if (!base_cntx_->IsRunning())
+      break;
+
+    {
+      std::lock_guard lk{stream_mu_};
+      std::ignore = serializer_->SaveDeletedKey(key, db_index);
+    }
+    PushSerialized(false);
+  }
+  deletion_log_.reset();
+  PushSerialized(true);
+}
+
 unsigned SliceSnapshot::SerializeBucketLocked(DbIndex db_index, PrimeTable::bucket_iterator it,
                                               bool on_update) {
   // traverse physical bucket and write it into string file.
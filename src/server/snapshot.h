@@ -56,7 +56,9 @@ class SliceSnapshot : public SerializerBase, public journal::JournalConsumerInte
   // In journal streaming mode it needs to be stopped by either Stop or Cancel.
   enum class SnapshotFlush : uint8_t { kAllow, kDisallow };
 
-  void Start(bool stream_journal, SnapshotFlush allow_flush = SnapshotFlush::kDisallow);
+  // incremental selects whether the snapshot is a base or a delta of incremental DF snapshots.
+  void Start(bool stream_journal, SnapshotFlush allow_flush = SnapshotFlush::kDisallow,
+             IncrementalMode incremental = IncrementalMode::NONE);
 
   // Finalizes journal streaming writes. Only called for replication.
   // Blocking. Must be called from the Snapshot thread.
@@ -86,6 +88,9 @@ class SliceSnapshot : public SerializerBase, public journal::JournalConsumerInte
   // Main snapshotting fiber that iterates over all buckets in the db slice.
   void IterateBucketsFb(bool send_full_sync_cut);
 
+  // Writes tombstones of the keys deleted since the base of a delta snapshot.
+  void SerializeDeletedKeys();
+
   // Serialize single bucket.
   // Returns number of serialized entries.
   unsigned SerializeBucketLocked(DbIndex db_index, PrimeTable::bucket_iterator bucket_it,
@@ -116,6 +121,9 @@ class SliceSnapshot : public SerializerBase, public journal::JournalConsumerInte
 
   std::unique_ptr<RdbSerializer> serializer_;
 
+  // Keys deleted since the base snapshot, set only for delta snapshots.
+  std::unique_ptr<DbSlice::DeletionLog> deletion_log_;
+
   // Used for sanity checks.
   bool serialize_bucket_running_ = false;
   uint32_t journal_cb_id_ = 0;
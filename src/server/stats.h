@@ -92,6 +92,7 @@ struct SearchStats {
   size_t used_memory = 0;
   size_t num_indices = 0;
   size_t num_entries = 0;
+  size_t num_pending_docs = 0;  // Queued by async indexing, not indexed yet
 
   SearchStats& operator+=(const SearchStats&);
 };
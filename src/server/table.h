@@ -136,6 +136,9 @@ struct DbTable : boost::intrusive_ref_counter<DbTable, boost::thread_unsafe_coun
   std::unique_ptr<SlotStats[]> slots_stats;
   PrimeTable::Cursor expire_cursor;
 
+  // Sum of the key count hints of the snapshots that are loaded into the table.
+  size_t load_reserved_keys = 0;
+
   struct SampleTopKeys {
     TopKeys* top_keys = nullptr;
     uint64_t total_samples = 0;
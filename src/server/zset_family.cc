@@ -142,8 +142,10 @@ std::optional<double> GetZsetScore(const PrimeValue& pv, std::string_view member
   return 0;
 }
 
+// batch_left is the number of members of the current command that are yet to be added,
+// including this one. It is used to pre-size the skiplist when converting the listpack.
 int ZsetAdd(PrimeValue* pv, double score, std::string_view ele, int in_flags, int* out_flags,
-            double* newscore) {
+            double* newscore, size_t batch_left = 1) {
   *out_flags = 0; /* We'll return our response flags. */
   double curscore;
 
@@ -204,7 +206,7 @@ int ZsetAdd(PrimeValue* pv, double score, std::string_view ele, int in_flags, in
       /* check if the element is too large or the list
        * becomes too long *before* executing zzlInsert. */
       if (zl_len >= ZSET_MAX_LISTPACK_ENTRIES || ele.size() > ZSET_MAX_LISTPACK_VALUE) {
-        auto* ptr = detail::SortedMap::FromListPack(pv->memory_resource(), lp);
+        auto* ptr = detail::SortedMap::FromListPack(pv->memory_resource(), lp, batch_left);
         pv->InitRobj(OBJ_ZSET, OBJ_ENCODING_SKIPLIST, ptr);
       } else {
         lp = detail::ZzlInsert(lp, ele, score);
@@ -2002,7 +2004,8 @@ OpResult<ZSetFamily::AddResult> ZSetFamily::OpAdd(const OpArgs& op_args,
 
   for (size_t j = 0; j < members.size(); j++) {
     const auto& m = members[j];
-    int retval = ZsetAdd(&pv, m.first, m.second, zparams.flags, &retflags, &new_score);
+    int retval = ZsetAdd(&pv, m.first, m.second, zparams.flags, &retflags, &new_score,
+                         members.size() - j);
 
     if (zparams.flags & ZADD_IN_INCR) {
       if (retval == 0) {
@@ -6,6 +6,7 @@ import logging
 import random
 import re
 import string
+import struct
 import subprocess
 import time
 from binascii import crc_hqx
@@ -2160,6 +2161,83 @@ async def test_cluster_migration_huge_container(df_factory: DflyInstanceFactory)
     assert extract_int_after_prefix("buckets on_db_update ", line) == 0
 
 
+@dfly_args({"proactor_threads": 1, "cluster_mode": "yes"})
+@pytest.mark.parametrize("native", [True, False])
+@pytest.mark.asyncio
+async def test_cluster_migration_native_serialization(df_factory: DflyInstanceFactory, native):
+    instances, nodes = await create_cluster(
+        df_factory, 2, migration_native_serialization=native, vmodule="streamer=1"
+    )
+    nodes[0].slots = [(0, 16383)]
+    nodes[1].slots = []
+    await apply_config(nodes)
+
+    seeder = DebugPopulateSeeder(
+        key_target=20_000,
+        data_size=100,
+        collection_size=10,
+        types=["LIST", "HASH", "SET", "ZSET", "STRING"],
+    )
+    await seeder.run(nodes[0].client)
+    # Big values are still sent as chunked RESTORE commands.
+    await nodes[0].client.execute_command("DEBUG", "POPULATE", "10", "big", "1000000")
+    await nodes[0].client.pexpire("big:0", 10_000_000)
+    source_data = await DebugPopulateSeeder.capture(nodes[0].client)
+
+    nodes[0].migrations = [
+        MigrationInfo("127.0.0.1", instances[1].admin_port, [(0, 16383)], nodes[1].id)
+    ]
+    await apply_config(nodes)
+    await wait_for_status(nodes[0].admin_client, nodes[1].id, "FINISHED")
+
+    assert await DebugPopulateSeeder.capture(nodes[1].client) == source_data
+    assert await nodes[1].client.pttl("big:0") > 0
+
+    line = stop_and_get_restore_log(nodes[0].instance)
+    native_entries = extract_int_after_prefix("commands, ", line)
+    if native:
+        assert native_entries > 19_000
+        assert extract_int_after_prefix("with ", line) > 0
+    else:
+        assert native_entries == 0
+
+
+@dfly_args({"proactor_threads": 2, "cluster_mode": "yes", "cluster_proxy_mode": "true"})
+@pytest.mark.asyncio
+async def test_cluster_proxy_mode(df_factory: DflyInstanceFactory):
+    instances, nodes = await create_cluster(df_factory, 2)
+    nodes[0].slots = [(0, 8191)]
+    nodes[1].slots = [(8192, 16383)]
+    await apply_config(nodes)
+
+    keys = [f"key{i}" for i in range(100)]
+    remote_keys = [k for k in keys if key_slot(k) > 8191]
+    assert remote_keys and len(remote_keys) < len(keys)
+
+    # Single-slot commands are forwarded to the owner instead of replying with MOVED.
+    client = nodes[0].client
+    for k in remote_keys:
+        assert await client.set(k, k)
+    assert await nodes[1].client.get(remote_keys[0]) == remote_keys[0]
+    assert await client.get(remote_keys[0]) == remote_keys[0]
+
+    # Cross-slot commands are split per slot and the replies are merged in key order.
+    assert await client.mset({k: f"v{k}" for k in keys})
+    assert await client.mget(keys + ["missing"]) == [f"v{k}" for k in keys] + [None]
+    assert await client.exists(*keys, "missing") == len(keys)
+    assert await nodes[1].client.dbsize() == len(remote_keys)
+    assert await client.delete(*keys) == len(keys)
+    assert await client.dbsize() == 0
+
+    # Commands that can't be split keep the CROSSSLOT error, transactions keep MOVED.
+    with pytest.raises(aioredis.ResponseError, match="CROSSSLOT"):
+        await client.execute_command("MSETNX", *[x for k in keys for x in (k, k)])
+    pipe = client.pipeline(transaction=True)
+    pipe.get(remote_keys[0])
+    with pytest.raises(aioredis.ResponseError):
+        await pipe.execute()
+
+
 @dfly_args(
     {"proactor_threads": 2, "cluster_mode": "yes", "migration_buckets_serialization_threshold": 1}
 )
@@ -3446,6 +3524,38 @@ async def test_SearchRequestDistribution(df_factory: DflyInstanceFactory):
     await asyncio.gather(*(search_test() for _ in range(docs_num)))
 
 
+@dfly_args({"proactor_threads": 2, "cluster_mode": "yes", "cluster_search": "yes"})
+async def test_SearchUnreachableNode(df_factory: DflyInstanceFactory):
+    """
+    Create cluster of 2 nodes and stop the second one.
+    FT.SEARCH on the first node replies with an error instead of crashing it.
+    """
+
+    instances, nodes = await create_cluster(df_factory, 2)
+    nodes[0].slots = [(0, 8191)]
+    nodes[1].slots = [(8192, 16383)]
+
+    await apply_config(nodes)
+
+    assert (
+        await nodes[0].client.execute_command(
+            "FT.CREATE", "idx", "ON", "HASH", "SCHEMA", "title", "TEXT"
+        )
+        == "OK"
+    )
+    await wait_for_ft_index_creation(nodes[1].client, "idx")
+
+    instances[1].stop()
+
+    with pytest.raises(aioredis.ResponseError, match="Cluster search failed"):
+        await nodes[0].client.execute_command("FT.SEARCH", "idx", "*")
+    with pytest.raises(aioredis.ResponseError, match="Failed to create index"):
+        await nodes[0].client.execute_command(
+            "FT.CREATE", "idx2", "ON", "HASH", "SCHEMA", "title", "TEXT"
+        )
+    assert await nodes[0].client.ping()
+
+
 @dfly_args({"proactor_threads": 4, "cluster_mode": "yes", "cluster_search": "yes"})
 async def test_SortedSearchRequest(df_factory: DflyInstanceFactory):
     """
@@ -3509,6 +3619,90 @@ async def test_SortedSearchRequest(df_factory: DflyInstanceFactory):
     await asyncio.gather(*(search_test() for _ in range(2)))
 
 
+@dfly_args({"proactor_threads": 4, "cluster_mode": "yes", "cluster_search": "yes"})
+async def test_KnnSearchRequest(df_factory: DflyInstanceFactory):
+    """
+    Create cluster of 3 nodes.
+    Check that KNN results of all nodes are merged by distance and that scored queries work.
+    """
+
+    instances, nodes = await create_cluster(df_factory, 3)
+    nodes[0].slots = [(0, 5259)]
+    nodes[1].slots = [(5260, 10519)]
+    nodes[2].slots = [(10520, 16383)]
+
+    await apply_config(nodes)
+
+    schema = ["title", "TEXT", "size", "NUMERIC"]
+    schema += ["vec", "VECTOR", "HNSW", "6", "TYPE", "FLOAT32", "DIM", "2"]
+    schema += ["DISTANCE_METRIC", "L2"]
+    assert await nodes[0].client.execute_command(
+        "FT.CREATE", "idx", "ON", "HASH", "SCHEMA", *schema
+    )
+
+    for node in nodes:
+        await wait_for_ft_index_creation(node.client, "idx")
+
+    cclient = instances[0].cluster_client()
+
+    docs_num = 100
+    for i in range(0, docs_num):
+        vec = struct.pack("2f", i, 0)
+        await cclient.hset(f"s{i}", mapping={"title": f"test {i}", "size": i, "vec": vec})
+
+    query_vec = struct.pack("2f", 0, 0)
+    knn = "*=>[KNN 10 @vec $qv AS dist]"
+
+    # Sorted by distance, nodes send only their top offset + limit.
+    res = await nodes[0].client.execute_command(
+        "FT.SEARCH",
+        "idx",
+        knn,
+        "SORTBY",
+        "dist",
+        "RETURN",
+        "1",
+        "dist",
+        "LIMIT",
+        "2",
+        "5",
+        "PARAMS",
+        "2",
+        "qv",
+        query_vec,
+        "DIALECT",
+        "2",
+    )
+    assert res[1::2] == [f"s{i}" for i in range(2, 7)]
+
+    # Sorted by another field, the global top 10 by distance must be picked first.
+    res = await nodes[0].client.execute_command(
+        "FT.SEARCH",
+        "idx",
+        knn,
+        "SORTBY",
+        "size",
+        "DESC",
+        "NOCONTENT",
+        "LIMIT",
+        "0",
+        "3",
+        "PARAMS",
+        "2",
+        "qv",
+        query_vec,
+        "DIALECT",
+        "2",
+    )
+    assert res[1:] == ["s9", "s8", "s7"]
+
+    res = await nodes[0].client.execute_command(
+        "FT.SEARCH", "idx", "@title:test", "WITHSCORES", "NOCONTENT", "LIMIT", "0", "10"
+    )
+    assert res[0] == docs_num
+    assert len(res) == 1 + 2 * 10
+
+
 async def verify_keys_match_number_of_index_docs(client, expected_num_keys):
     # Get number of docs in index
     index_info = await client.execute_command("FT.INFO idx")
@@ -671,6 +671,42 @@ async def test_replica_reconnections_after_network_disconnect(
         await assert_replica_reconnections(replica, initial_reconnects_count)
 
 
+async def test_partial_sync_from_disk_backlog(df_factory, df_seeder_factory, proxy_factory):
+    # The in-memory backlog holds a single entry, so every missed entry must come from disk.
+    master = df_factory.create(
+        proactor_threads=4,
+        shard_repl_backlog_len=1,
+        shard_repl_backlog_disk_max_bytes=64 * 1024 * 1024,
+        shard_repl_backlog_disk_segment_bytes=64 * 1024,
+    )
+    replica = df_factory.create(proactor_threads=4)
+    df_factory.start_all([replica, master])
+    seeder = df_seeder_factory.create(port=master.port)
+
+    async with replica.client() as c_replica, master.client() as c_master:
+        await seeder.run(target_deviation=0.1)
+
+        proxy = await proxy_factory(master.port)
+        await c_replica.execute_command(f"REPLICAOF localhost {proxy.port}")
+        await wait_available_async(c_replica)
+
+        await proxy.close()
+        await wait_for_replica_status(c_replica, status="down")
+
+        await seeder.run(target_ops=5000)
+        assert (await c_master.info("memory"))["psync_disk_backlog_bytes"] > 0
+
+        await proxy.start_serving()
+        await wait_for_replica_status(c_replica, status="up")
+        await check_all_replicas_finished([c_replica], c_master)
+
+        info = await c_replica.info("replication")
+        assert info["psync_successes"] == 1
+
+        capture = await seeder.capture()
+        assert await seeder.compare(capture, replica.port)
+
+
 @pytest.mark.debug_only
 @dfly_args({"proactor_threads": 2})
 async def test_replicaof_reject_on_load(df_factory, df_seeder_factory):
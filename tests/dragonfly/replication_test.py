@@ -28,6 +28,7 @@ from .utility import (
     check_all_replicas_finished,
     gen_test_data,
     parse_client_list,
+    tmp_file_name,
     wait_available_async,
     wait_for_replicas_state,
 )
@@ -175,6 +176,108 @@ async def test_replication_all(
         assert select_calls < 16
 
 
+@pytest.mark.parametrize("batch_size", [1, 32])
+async def test_replica_apply_batch(df_factory: DflyInstanceFactory, batch_size):
+    master = df_factory.create(proactor_threads=4)
+    replica = df_factory.create(proactor_threads=4, replica_apply_batch_size=batch_size)
+    df_factory.start_all([master, replica])
+
+    c_master = master.client()
+    c_replica = replica.client()
+
+    await c_replica.execute_command(f"REPLICAOF localhost {master.port}")
+    await wait_for_replicas_state(c_replica)
+
+    # Single key commands mixed with multi-key and global ones that must keep their order.
+    for i in range(10):
+        pipe = c_master.pipeline(transaction=False)
+        for j in range(300):
+            pipe.set(f"key:{j}", f"{i}:{j}")
+            pipe.incr("counter")
+            pipe.lpush(f"list:{j % 10}", j)
+        pipe.mset({f"m:{j}": i for j in range(20)})
+        if i == 5:
+            pipe.flushall()
+        await pipe.execute()
+
+    await check_all_replicas_finished([c_replica], c_master)
+    await assert_replica_data_matches(c_master, [c_replica])
+    assert await c_replica.get("counter") == await c_master.get("counter")
+
+
+async def test_seeded_full_sync(df_factory: DflyInstanceFactory, tmp_dir):
+    dbfilename = f"seed_{tmp_file_name()}"
+    master = df_factory.create(proactor_threads=4, snapshot_lsn_watermark=True, dir=tmp_dir)
+    master.start()
+    c_master = master.client()
+
+    await c_master.execute_command("DEBUG POPULATE 10000 seed 16")
+    assert await c_master.execute_command("SAVE", "DF", dbfilename) == True
+
+    # Writes after the snapshot must arrive through the journal suffix only.
+    for i in range(500):
+        await c_master.set(f"after:{i}", i)
+    await c_master.delete(*[f"seed:{i}" for i in range(100)])
+
+    # The replica loads the snapshot on startup and then asks the master only for the suffix.
+    replica = df_factory.create(
+        proactor_threads=4,
+        dir=tmp_dir,
+        dbfilename=dbfilename,
+        replicaof=f"localhost:{master.port}",
+        replicaof_seed_from_snapshot=True,
+    )
+    replica.start()
+    c_replica = replica.client()
+    await wait_for_replicas_state(c_replica)
+
+    await check_all_replicas_finished([c_replica], c_master)
+    await assert_replica_data_matches(c_master, [c_replica])
+
+    info = await c_replica.info("replication")
+    assert info["psync_successes"] == 1
+
+    # A replica that loaded the same snapshot with DFLY LOAD is not seeded and syncs fully.
+    other = df_factory.create(proactor_threads=4, dir=tmp_dir)
+    other.start()
+    c_other = other.client()
+    assert await c_other.execute_command("DFLY", "LOAD", f"{dbfilename}-summary.dfs") == "OK"
+    await c_other.execute_command(f"REPLICAOF localhost {master.port}")
+    await wait_for_replicas_state(c_other)
+    await check_all_replicas_finished([c_other], c_master)
+    await assert_replica_data_matches(c_master, [c_other])
+
+    info = await c_other.info("replication")
+    assert info["psync_successes"] == 0
+
+
+@pytest.mark.parametrize("codec", ["lz4", "zstd"])
+async def test_replication_stream_compression(df_factory: DflyInstanceFactory, codec):
+    master = df_factory.create(proactor_threads=2, replication_stream_compression=codec)
+    replica = df_factory.create(proactor_threads=2)
+    df_factory.start_all([master, replica])
+
+    c_master = master.client()
+    c_replica = replica.client()
+
+    await c_replica.execute_command(f"REPLICAOF localhost {master.port}")
+    await wait_for_replicas_state(c_replica)
+
+    # Compressible values, written in pipelines so that the stream gets batched.
+    for i in range(20):
+        pipe = c_master.pipeline(transaction=False)
+        for j in range(200):
+            pipe.set(f"key:{i}:{j}", "value" * 20)
+        await pipe.execute()
+
+    await check_all_replicas_finished([c_replica], c_master)
+    await assert_replica_data_matches(c_master, [c_replica])
+
+    info = await c_master.info("stats")
+    assert info["repl_stream_compress_in_bytes"] > 0
+    assert info["repl_stream_compress_out_bytes"] < info["repl_stream_compress_in_bytes"]
+
+
 """
 Regression test for the double-apply bug during full sync.
 
@@ -799,6 +799,37 @@ async def test_knn_score_return(async_client: aioredis.Redis):
     await i1.dropindex()
 
 
+@dfly_args({"proactor_threads": 4})
+async def test_pipelined_knn_batch(async_client: aioredis.Redis):
+    """Pipelined KNN queries on an HNSW index are batched and return the same results."""
+    dim = 16
+    await async_client.execute_command(
+        "FT.CREATE", "i1", "ON", "HASH", "SCHEMA", "pos", "VECTOR", "HNSW", "6",
+        "TYPE", "FLOAT32", "DIM", dim, "DISTANCE_METRIC", "L2",
+    )  # fmt: skip
+
+    rng = np.random.default_rng(5)
+    pipe = async_client.pipeline(transaction=False)
+    for i in range(1000):
+        pipe.hset(f"k{i}", mapping={"pos": rng.random(dim, dtype=np.float32).tobytes()})
+    await pipe.execute()
+
+    queries = [rng.random(dim, dtype=np.float32).tobytes() for _ in range(100)]
+    query = ["FT.SEARCH", "i1", "* => [KNN 5 @pos $vec]", "NOCONTENT", "PARAMS", "2", "vec"]
+
+    expected = [await async_client.execute_command(*query, vec) for vec in queries]
+
+    pipe = async_client.pipeline(transaction=False)
+    for vec in queries:
+        pipe.execute_command(*query, vec)
+    assert await pipe.execute() == expected
+
+    info = await async_client.info("stats")
+    assert "batched_commands_total" in info
+
+    await async_client.ft("i1").dropindex()
+
+
 @dfly_args({"proactor_threads": 4, "dbfilename": "search-data"})
 async def test_index_persistence(df_server):
     client = aioredis.Redis(port=df_server.port)
@@ -313,3 +313,23 @@ async def test_huffman_tables_built(df_server: DflyInstance):
         assert m.samples[0].value > 0
 
     await check_metrics()
+
+
+@pytest.mark.opt_only
+@dfly_args({"proactor_threads": "2", "huffman_auto_train": True})
+async def test_huffman_auto_train(df_server: DflyInstance):
+    async_client = df_server.client()
+    key_name = "keyfooobarrsoooooooooooooooooooooooooooooooooooooooooooooooo"
+    await async_client.execute_command("DEBUG", "POPULATE", "1000000", key_name, "14")
+
+    @assert_eventually(times=500)
+    async def check_metrics():
+        metrics = await df_server.metrics()
+        m = metrics["dragonfly_huffman_reencode_saved_bytes"]
+        assert m.samples[0].value > 0
+
+    await check_metrics()
+
+    # Re-encoded keys must still be found by their original name.
+    assert (await async_client.get(f"{key_name}:1")).startswith("value:1")
+    assert await async_client.dbsize() == 1000000
@@ -481,6 +481,61 @@ async def test_s3_save_local_dir(async_client, tmp_dir):
         )
 
 
+def _minio_endpoint():
+    """host:port of the local MinIO server started by conftest, or None"""
+    endpoint = os.environ.get("MINIO_S3_ENDPOINT", "")
+    return endpoint.split("://")[-1] or None
+
+
+# Runs against the local MinIO stand-in with the aws-sdk client, which uploads parts with a
+# multipart upload and fetches read ahead blocks with ranged requests. Uses small upload parts and
+# read ahead blocks, so that the snapshot files span many of them.
+@pytest.mark.skipif(
+    _minio_endpoint() is None or _missing_s3_test_env(),
+    reason="MinIO S3 endpoint is not configured",
+)
+@dfly_args(
+    {
+        **BASIC_ARGS,
+        "s3_use_helio_client": "false",
+        "s3_endpoint": _minio_endpoint(),
+        "s3_use_https": "false",
+        "cloud_upload_parts": 4,
+        "cloud_upload_part_size": 5 * 1024 * 1024,  # the minimal part size of S3
+        "cloud_upload_streams": 3,
+        "cloud_read_ahead_blocks": 4,
+        "cloud_read_ahead_block_size": 64 * 1024,
+        "cloud_read_ahead_streams": 3,
+    }
+)
+async def test_s3_snapshot_pipelined_parts(async_client, tmp_dir):
+    seeder = DebugPopulateSeeder(key_target=100_000, data_size=500)
+    await seeder.run(async_client)
+
+    start_capture = await DebugPopulateSeeder.capture(async_client)
+    s3_path = "s3://" + os.environ["DRAGONFLY_S3_BUCKET"] + str(tmp_dir)
+
+    try:
+        await async_client.execute_command("SAVE", "DF", s3_path, "snapshot")
+        assert await async_client.flushall()
+        await async_client.execute_command("DFLY", "LOAD", s3_path + "/snapshot-summary.dfs")
+
+        assert await DebugPopulateSeeder.capture(async_client) == start_capture
+
+        # All multipart uploads were completed
+        client = boto3.client("s3")
+        uploads = client.list_multipart_uploads(
+            Bucket=os.environ["DRAGONFLY_S3_BUCKET"], Prefix=str(tmp_dir)[1:]
+        )
+        assert not uploads.get("Uploads")
+
+    finally:
+        delete_s3_objects(
+            os.environ["DRAGONFLY_S3_BUCKET"],
+            str(tmp_dir)[1:],
+        )
+
+
 def _missing_azure_test_env():
     return (
         "DRAGONFLY_AZURE_CONTAINER" not in os.environ
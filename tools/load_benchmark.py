@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+
+"""
+Measures snapshot load throughput in keys/sec per shard.
+
+Start dragonfly with the snapshot directory you want to use, for example:
+    ./dragonfly --dir /tmp/bench --proactor_threads 4
+and run:
+    ./load_benchmark.py --port 6379 --keys 5000000 --value-size 64 --rounds 3
+
+The script fills the instance with DEBUG POPULATE, saves a DF snapshot and reloads it
+with DEBUG RELOAD NOSAVE several times. Every round reports the load time and the
+throughput, both in total and per shard.
+"""
+
+import argparse
+import time
+
+import redis
+
+
+def num_shards(client, args):
+    if args.shards:
+        return args.shards
+    return int(client.info("server")["thread_count"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Snapshot load throughput")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=6379)
+    parser.add_argument("--keys", type=int, default=1_000_000)
+    parser.add_argument("--value-size", type=int, default=64)
+    parser.add_argument("--type", default="STRING", help="type of the populated keys")
+    parser.add_argument("--elements", type=int, default=1, help="elements per container")
+    parser.add_argument("--rounds", type=int, default=3)
+    parser.add_argument("--shards", type=int, default=0, help="defaults to thread_count")
+    args = parser.parse_args()
+
+    client = redis.Redis(host=args.host, port=args.port, socket_timeout=3600)
+    shards = num_shards(client, args)
+
+    client.flushall()
+    populate = ["DEBUG", "POPULATE", args.keys, "key", args.value_size, "RAND", "TYPE", args.type]
+    if args.type != "STRING":
+        populate += ["ELEMENTS", args.elements]
+    client.execute_command(*populate)
+    client.execute_command("SAVE", "DF")
+    keys = client.dbsize()
+    print(f"keys={keys} shards={shards} type={args.type} value_size={args.value_size}")
+
+    for i in range(args.rounds):
+        start = time.monotonic()
+        client.execute_command("DEBUG", "RELOAD", "NOSAVE")
+        elapsed = time.monotonic() - start
+        assert client.dbsize() == keys
+        print(
+            f"round={i} load_sec={elapsed:8.3f} keys/sec={keys / elapsed:12.0f} "
+            f"keys/sec/shard={keys / elapsed / shards:12.0f}"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+
+"""
+Measures replica lag versus write throughput of a master in stable sync.
+
+Start a master and a replica (for example with tools/run_master_replica.sh), then run:
+    ./replication_lag_benchmark.py --port 6379 --clients 32 --pipeline 50 --duration 20
+
+The script drives SET traffic against the master in several steps, each with more clients,
+and samples the lag (in journal records) that the master reports for its replicas.
+Run it with different replica flags, e.g. --replica_apply_batch_size=1 versus the default,
+to compare how fast the replica keeps up.
+"""
+
+import argparse
+import asyncio
+import time
+
+from redis import asyncio as aioredis
+
+
+async def writer(client, stop, args, counter, idx):
+    i = 0
+    value = "x" * args.value_size
+    while not stop.is_set():
+        pipe = client.pipeline(transaction=False)
+        for _ in range(args.pipeline):
+            pipe.set(f"{args.prefix}:{idx}:{i % args.keys}", value)
+            i += 1
+        await pipe.execute()
+        counter[0] += args.pipeline
+
+
+async def replica_lag(client):
+    info = await client.info("replication")
+    lags = [v["lag"] for k, v in info.items() if k.startswith("slave") and isinstance(v, dict)]
+    return max(lags) if lags else 0
+
+
+async def run_step(args, num_clients):
+    pool = aioredis.ConnectionPool(host=args.host, port=args.port, max_connections=num_clients + 1)
+    client = aioredis.Redis(connection_pool=pool)
+    stop = asyncio.Event()
+    counter = [0]
+    tasks = [
+        asyncio.create_task(writer(client, stop, args, counter, i)) for i in range(num_clients)
+    ]
+
+    lags = []
+    start = time.monotonic()
+    while time.monotonic() - start < args.duration:
+        await asyncio.sleep(args.sample_interval)
+        lags.append(await replica_lag(client))
+
+    stop.set()
+    await asyncio.gather(*tasks)
+    elapsed = time.monotonic() - start
+
+    # Time for the replica to drain the lag after the writes stop.
+    drain_start = time.monotonic()
+    while await replica_lag(client) > 0 and time.monotonic() - drain_start < 60:
+        await asyncio.sleep(0.05)
+    drain = time.monotonic() - drain_start
+
+    await client.aclose()
+    await pool.disconnect()
+
+    lags.sort()
+    p50 = lags[len(lags) // 2] if lags else 0
+    print(
+        f"clients={num_clients:4d} ops/sec={counter[0] / elapsed:12.0f} "
+        f"lag_p50={p50:8d} lag_max={max(lags, default=0):8d} drain_sec={drain:6.2f}"
+    )
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Replica lag versus write throughput")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=6379, help="master port")
+    parser.add_argument("--clients", type=int, default=32, help="clients in the last step")
+    parser.add_argument("--steps", type=int, default=4)
+    parser.add_argument("--pipeline", type=int, default=20)
+    parser.add_argument("--keys", type=int, default=100_000, help="keys per client")
+    parser.add_argument("--value-size", type=int, default=64)
+    parser.add_argument("--duration", type=float, default=10, help="seconds per step")
+    parser.add_argument("--sample-interval", type=float, default=0.1)
+    parser.add_argument("--prefix", default="lagbench")
+    args = parser.parse_args()
+
+    for step in range(1, args.steps + 1):
+        await run_step(args, max(1, args.clients * step // args.steps))
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
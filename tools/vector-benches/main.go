@@ -23,6 +23,7 @@ var nQueries = flag.Int("q", 1000, "Number of total queries")
 var nQueryJobs = flag.Int("t", 8, "Query threads (jobs)")
 var nDim = flag.Int("d", 100, "Vector dimension")
 var nTop = flag.Int("k", 10, "Top K vectors selected")
+var nBatch = flag.Int("b", 1, "Queries sent in one pipeline")
 
 var fPort = flag.Int("p", 6379, "Port")
 var fHost = flag.String("h", "localhost", "Host")
@@ -115,27 +116,37 @@ func FillParallel(ctx context.Context, rdb *redis.Client, entries uint, dim uint
 	wg.Wait()
 }
 
-// Perform queries and measure latencies
-func Query(ctx context.Context, rdb *redis.Client, queries uint, limit uint, dim uint) []time.Duration {
+// Perform queries in pipelines of `batch` queries and measure latencies. All queries of a
+// pipeline are assigned its latency.
+func Query(ctx context.Context, rdb *redis.Client, queries uint, limit uint, dim uint, batch uint) []time.Duration {
 	latencies := make([]time.Duration, queries)
 	query := fmt.Sprintf("*=>[KNN %v @v $vec]", limit)
 
-	for i := range latencies {
-		searchOptions := &redis.FTSearchOptions{
-			DialectVersion: 2,
-			NoContent:      true,
-			Params:         map[string]interface{}{"vec": VecToSlice(RandVec(dim))},
+	for i := uint(0); i < queries; i += batch {
+		end := min(i+batch, queries)
+		p := rdb.Pipeline()
+		cmds := make([]*redis.FTSearchCmd, 0, end-i)
+		for j := i; j < end; j += 1 {
+			searchOptions := &redis.FTSearchOptions{
+				DialectVersion: 2,
+				NoContent:      true,
+				Params:         map[string]interface{}{"vec": VecToSlice(RandVec(dim))},
+			}
+			cmds = append(cmds, p.FTSearchWithArgs(ctx, "idx", query, searchOptions))
 		}
 
 		start := time.Now()
-		res, err := rdb.FTSearchWithArgs(ctx, "idx", query, searchOptions).Result()
-		if err != nil {
+		if _, err := p.Exec(ctx); err != nil {
 			panic(err)
 		}
-		if res.Total != int(limit) {
-			panic("Didn't hit limit")
+		took := time.Since(start)
+
+		for j, cmd := range cmds {
+			if cmd.Val().Total != int(limit) {
+				panic("Didn't hit limit")
+			}
+			latencies[i+uint(j)] = took
 		}
-		latencies[i] = time.Since(start)
 	}
 	return latencies
 }
@@ -153,7 +164,7 @@ func RunQueries(ctx context.Context, rdb *redis.Client) (time.Duration, []time.D
 	for i := range latencies {
 		li := i
 		go func() {
-			latencies[li] = Query(ctx, rdb, jobQueries, uint(*nTop), uint(*nDim))
+			latencies[li] = Query(ctx, rdb, jobQueries, uint(*nTop), uint(*nDim), uint(max(*nBatch, 1)))
 			wg.Done()
 		}()
 	}
@@ -177,7 +188,7 @@ func Print(took time.Duration, latencies []time.Duration) {
 	style := pterm.NewStyle(pterm.Bold)
 
 	pterm.Print("Entries(n): ", formatLargeNumber(*nEntries), " Queries(q): ", formatLargeNumber(*nQueries), " ")
-	pterm.Print("Dimension(d): ", *nDim, " Threads(t): ", *nQueryJobs, " Top(k): ", *nTop)
+	pterm.Print("Dimension(d): ", *nDim, " Threads(t): ", *nQueryJobs, " Top(k): ", *nTop, " Batch(b): ", *nBatch)
 	pterm.Println()
 	pterm.Println()
 